@@ -0,0 +1,154 @@
+#include <memory/Logger.h>
+#include <memory/LogReader.h>
+#include <memory/StreamBuffer.h>
+#include <memory/ImageBlock.h>
+#include <memory/FrameInfoBlock.h>
+#include <common/Profiling.h>
+#include <AllocationCounter.h>
+#include <cstdlib>
+
+// Compares the StreamBuffer serialization that logging and streaming used to do
+// against ArenaBuffer, for a frame laid out the way the vision core streams it.
+
+static const char* BLOCKS[] = {
+  "raw_image", "vision_frame_info", "vision_joint_angles", "vision_sensors", "vision_body_model",
+  "world_objects", "localization", "opponents", "game_state", "robot_state"
+};
+
+// What Logger::writeMemory did with StreamBuffer: a buffer per piece, combined per
+// block and then again per frame
+static void legacySerialize(Memory& memory, const std::vector<std::string>& names, StreamBuffer& frame) {
+  std::vector<StreamBuffer> buffers;
+  StreamBuffer hbuffer;
+  {
+    std::vector<StreamBuffer> pieces;
+    for(unsigned int i = 0; i < names.size(); i++) {
+      StreamBuffer sb;
+      sb.read(names[i].c_str(), names[i].size() + 1);
+      pieces.push_back(sb);
+    }
+    StreamBuffer::combine(pieces, hbuffer);
+    StreamBuffer::clear(pieces);
+  }
+  buffers.push_back(hbuffer);
+  for(unsigned int i = 0; i < names.size(); i++) {
+    MemoryBlock* block = memory.getBlockPtrByName(names[i]);
+    std::vector<StreamBuffer> parts;
+    StreamBuffer part;
+    part.read((unsigned char*)&block->header, sizeof(MemoryBlockHeader));
+    parts.push_back(part);
+    if(names[i] == "raw_image") {
+      ImageBlock* image = (ImageBlock*)block;
+      StreamBuffer tparams, bparams, loaded, top, bottom;
+      tparams.read((unsigned char*)&image->top_params_, sizeof(ImageParams));
+      bparams.read((unsigned char*)&image->bottom_params_, sizeof(ImageParams));
+      loaded.read((unsigned char*)&image->loaded_, sizeof(bool));
+      top.read(image->getImgTop(), image->top_params_.rawSize);
+      bottom.read(image->getImgBottom(), image->bottom_params_.rawSize);
+      parts.push_back(tparams); parts.push_back(bparams); parts.push_back(loaded);
+      parts.push_back(top); parts.push_back(bottom);
+    } else {
+      StreamBuffer body;
+      body.read((unsigned char*)block, block->header.size);
+      parts.push_back(body);
+    }
+    StreamBuffer sb;
+    StreamBuffer::combine(parts, sb);
+    StreamBuffer::clear(parts);
+    buffers.push_back(sb);
+  }
+  StreamBuffer::combine(buffers, frame);
+  StreamBuffer::clear(buffers);
+}
+
+// What LogReader::readMemory did: separate copies of every level of the frame
+static void legacyDeserialize(const StreamBuffer& frame, Memory& memory) {
+  auto buffers = frame.separate();
+  auto names = buffers[0].separate();
+  for(unsigned int i = 1; i < buffers.size(); i++) {
+    MemoryBlock* block = memory.getBlockPtrByName((const char*)names[i - 1].buffer);
+    auto parts = buffers[i].separate();
+    if(block && parts.size() == 2 && parts[1].size == block->header.size)
+      memcpy((unsigned char*)block, parts[1].buffer, parts[1].size);
+    StreamBuffer::clear(parts);
+  }
+  StreamBuffer::clear(names);
+  StreamBuffer::clear(buffers);
+}
+
+int main(int argc, char** argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 500;
+  Memory memory(false, MemoryOwner::TOOL_MEM, 0, 1);
+  for(unsigned int i = 0; i < sizeof(BLOCKS) / sizeof(BLOCKS[0]); i++) {
+    memory.addBlockByName(BLOCKS[i]);
+    memory.setBlockLogging(BLOCKS[i], true);
+  }
+  ImageBlock* image;
+  memory.getBlockByName(image, "raw_image");
+  std::vector<unsigned char> top(image->top_params_.rawSize, 0x80), bottom(image->bottom_params_.rawSize, 0x40);
+  image->setImgTop(top.data());
+  image->setImgBottom(bottom.data());
+  image->loaded_ = true;
+  std::vector<std::string> names;
+  memory.getBlockNames(names, true);
+
+  StreamLogger logger;
+  Memory output(false, MemoryOwner::TOOL_MEM, 0, 1);
+  StreamBuffer legacy;
+  // One warm up frame each so both sides have grown their buffers. The logger stamps
+  // frame ids into the block headers, so it goes first.
+  logger.writeMemory(memory);
+  { LogReader reader(logger.getBuffer().span()); reader.readMemory(output); }
+  legacySerialize(memory, names, legacy);
+  legacyDeserialize(legacy, output);
+
+  bool identical = legacy.size == logger.getBuffer().size() &&
+    memcmp(legacy.buffer, logger.getBuffer().data(), legacy.size) == 0;
+  printf("Frame size %u bytes, %u blocks, layouts %s\n", logger.getBuffer().size(), (unsigned int)names.size(),
+    identical ? "identical" : "DIFFER");
+
+  Timer timer;
+  unsigned long before = allocations;
+  timer.start();
+  for(int i = 0; i < frames; i++) {
+    legacy.reset();
+    legacySerialize(memory, names, legacy);
+  }
+  timer.stop();
+  double legacyWrite = timer.lasttime() / frames;
+  double legacyWriteAllocs = (double)(allocations - before) / frames;
+
+  before = allocations;
+  timer.start();
+  for(int i = 0; i < frames; i++)
+    legacyDeserialize(legacy, output);
+  timer.stop();
+  double legacyRead = timer.lasttime() / frames;
+  double legacyReadAllocs = (double)(allocations - before) / frames;
+
+  before = allocations;
+  timer.start();
+  for(int i = 0; i < frames; i++) {
+    logger.clearBuffer();
+    logger.writeMemory(memory);
+  }
+  timer.stop();
+  double arenaWrite = timer.lasttime() / frames;
+  double arenaWriteAllocs = (double)(allocations - before) / frames;
+
+  before = allocations;
+  timer.start();
+  for(int i = 0; i < frames; i++) {
+    LogReader reader(logger.getBuffer().span());
+    reader.readMemory(output);
+  }
+  timer.stop();
+  double arenaRead = timer.lasttime() / frames;
+  double arenaReadAllocs = (double)(allocations - before) / frames;
+
+  printf("%-14s %12s %12s %14s %14s\n", "", "write [ms]", "read [ms]", "write allocs", "read allocs");
+  printf("%-14s %12.4f %12.4f %14.1f %14.1f\n", "StreamBuffer", legacyWrite * 1000, legacyRead * 1000, legacyWriteAllocs, legacyReadAllocs);
+  printf("%-14s %12.4f %12.4f %14.1f %14.1f\n", "ArenaBuffer", arenaWrite * 1000, arenaRead * 1000, arenaWriteAllocs, arenaReadAllocs);
+  legacy.clear();
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+#include <kinematics/CoMSolver.h>
+#include <kinematics/ForwardKinematics.h>
+#include <common/Profiling.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+
+// Shifts the feet of a sweep of kick stances to put the center of mass at a target
+// offset from the stance foot, once with the fixed step loop KickModule used and once
+// with CoMSolver, and reports the evaluations, remaining error and time per stance.
+
+static RobotDimensions dimensions;
+static MassCalibration mass_calibration;
+static Pose3D rel_parts[BodyPart::NUM_PARTS], abs_parts[BodyPart::NUM_PARTS];
+
+static float observation(int i, float scale) {
+  return scale * ((i * 7919) % 200 - 100) / 100.0f;
+}
+
+// Center of mass and stance foot in the virtual base frame for the leg targets
+static void evaluate(const Pose3D& left, const Pose3D& right, bool stance_is_left, float roll, float* angles,
+    Vector3<float>& center_of_mass, Vector3<float>& stance) {
+  CoMSolver::calcLegJoints(left, right, roll, angles, dimensions);
+  ForwardKinematics::calculateRelativePose(angles, rel_parts, dimensions.values_);
+  Pose3D base = ForwardKinematics::calculateVirtualBase(stance_is_left, rel_parts);
+  ForwardKinematics::calculateAbsolutePose(base, rel_parts, abs_parts);
+  ForwardKinematics::calculateCoM(abs_parts, center_of_mass, mass_calibration);
+  stance = abs_parts[stance_is_left ? BodyPart::left_foot : BodyPart::right_foot].translation;
+}
+
+// The loop KickModule::calcJointTargets ran: step both feet by the error against a
+// target that moves with the stance foot, at most 100 times
+static int legacySolve(Pose3D& left, Pose3D& right, bool stance_is_left, float com_target_y, float roll, float* angles) {
+  Vector3<float> com, stance;
+  evaluate(left, right, stance_is_left, roll, angles, com, stance);
+  float desired = com_target_y + stance.y;
+  int evaluations = 1;
+  for(int i = 0; i < 100; i++) {
+    float err = desired - com.y;
+    if(fabs(err) < 0.25f && i > 0)
+      break;
+    left.translation.y -= err;
+    right.translation.y -= err;
+    desired -= err;
+    evaluate(left, right, stance_is_left, roll, angles, com, stance);
+    evaluations++;
+  }
+  return evaluations;
+}
+
+int main(int argc, char** argv) {
+  int stances = argc > 1 ? atoi(argv[1]) : 2000;
+  float angles[NUM_JOINTS] = {0};
+
+  int legacyWorst = 0, solverWorst = 0, failures = 0;
+  double legacyEvaluations = 0, solverEvaluations = 0, legacyTime = 0, solverTime = 0;
+  float legacyError = 0, solverError = 0;
+  Timer timer;
+  for(int i = 0; i < stances; i++) {
+    bool stance_is_left = i % 2;
+    int side = stance_is_left ? 1 : -1;
+    float height = 185 + observation(i, 10);
+    Pose3D stance(observation(i + 1, 15), side * 50.0f, -height);
+    Pose3D swing(stance.translation.x + observation(i + 2, 20), -side * 50.0f, -height + 15 + observation(i + 3, 15));
+    Vector3<float> com_target(-stance.translation.x, observation(i + 4, 5), height);
+    float roll = observation(i + 5, 0.05);
+
+    Pose3D left = stance_is_left ? stance : swing, right = stance_is_left ? swing : stance;
+    timer.start();
+    int evaluations = legacySolve(left, right, stance_is_left, com_target.y, roll, angles);
+    timer.stop();
+    legacyTime += timer.lasttime();
+    legacyEvaluations += evaluations;
+    legacyWorst = std::max(legacyWorst, evaluations);
+    Vector3<float> com, foot;
+    evaluate(left, right, stance_is_left, roll, angles, com, foot);
+    legacyError = std::max(legacyError, fabsf(com.y - foot.y - com_target.y));
+
+    left = stance_is_left ? stance : swing;
+    right = stance_is_left ? swing : stance;
+    CoMSolver solver(dimensions, mass_calibration);
+    solver.setAxes(false, true, false);
+    timer.start();
+    if(!solver.solve(left, right, stance_is_left, com_target, roll, angles, rel_parts, abs_parts, com))
+      failures++;
+    timer.stop();
+    solverTime += timer.lasttime();
+    solverEvaluations += solver.iterations();
+    solverWorst = std::max(solverWorst, solver.iterations());
+    evaluate(left, right, stance_is_left, roll, angles, com, foot);
+    solverError = std::max(solverError, fabsf(com.y - foot.y - com_target.y));
+  }
+
+  printf("%d stances, %d not converged by CoMSolver\n", stances, failures);
+  printf("%-20s %12s %12s %12s %12s\n", "", "evals avg", "evals max", "error [mm]", "time [us]");
+  printf("%-20s %12.2f %12d %12.3f %12.3f\n", "KickModule loop", legacyEvaluations / stances, legacyWorst, legacyError, legacyTime / stances * 1e6);
+  printf("%-20s %12.2f %12d %12.3f %12.3f\n", "CoMSolver", solverEvaluations / stances, solverWorst, solverError, solverTime / stances * 1e6);
+  return failures == 0 ? 0 : 1;
+}
@@ -67,6 +67,8 @@ set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -Wno-write-strings" CACHE STRING "" FORC
 set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -Wno-deprecated-declarations" CACHE STRING "" FORCE)
 set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -Wno-conversion-null" CACHE STRING "" FORCE)
 set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -Wno-cpp" CACHE STRING "" FORCE)
+# the atom supports SSE2 and the vision kernels rely on it (see vision/SegmentationKernels.cpp)
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -msse2" CACHE STRING "" FORCE)
 set(CMAKE_SYSROOT ${NAO_HOME}/naoqi/crosstoolchain/atom/sysroot)
 
 message("C Compiler: " ${CMAKE_C_COMPILER})
@@ -5,73 +5,77 @@ import inspect, os, sys
 script_path = os.path.abspath(inspect.getfile(inspect.currentframe()))
 if len(sys.argv) > 1:
   f = open(sys.argv[1], 'w')
+  # The ids go in a separate, lightweight header next to the operations
+  ids = open(os.path.join(os.path.dirname(sys.argv[1]), 'MemoryBlockIds.h'), 'w')
 else:
   f = sys.stdout
+  ids = sys.stdout
 
-def generateWarning():
+def generateWarning(out):
   output = """/*
   THIS FILE HAS BEEN AUTOMATICALLY GENERATED BY %s
   DO NOT ALTER THIS FILE DIRECTLY - YOUR CHANGES WILL BE LOST
 */
   """ % script_path
-  print(output, file=f)
+  print(output, file=out)
+
+def blockId(name):
+  return name.upper()
+
+def generateIds():
+  names = sorted(blocks)
+  output = '#ifndef MEMORY_BLOCK_IDS_H\n#define MEMORY_BLOCK_IDS_H\n\n'
+  output += '#include <string>\n#include <string.h>\n\n'
+  output += '// X(id, name, type) for every block, in id order\n'
+  output += '#define MEMORY_BLOCK_TYPES(X) \\\n'
+  for name in names:
+    output += '  X(%s, "%s", %s) \\\n' % (blockId(name), name, blocks[name])
+  output += '\n'
+  output += 'namespace MemoryBlockId {\n'
+  output += '  enum Id {\n'
+  for name in names:
+    output += '    %s,\n' % blockId(name)
+  output += '    NUM_BLOCKS,\n    INVALID = NUM_BLOCKS\n  };\n\n'
+  output += '  inline const char* name(Id id) {\n'
+  output += '    static const char* const names[] = {\n'
+  for name in names:
+    output += '      "%s",\n' % name
+  output += '    };\n'
+  output += '    return id < NUM_BLOCKS ? names[id] : "";\n  }\n\n'
+  output += '  // Ids are assigned in name order, so a name is found by binary search\n'
+  output += '  inline Id fromName(const char* block) {\n'
+  output += '    int lo = 0, hi = NUM_BLOCKS - 1;\n'
+  output += '    while(lo <= hi) {\n'
+  output += '      int mid = (lo + hi) / 2;\n'
+  output += '      int c = strcmp(block, name((Id)mid));\n'
+  output += '      if(c == 0) return (Id)mid;\n'
+  output += '      if(c < 0) hi = mid - 1;\n'
+  output += '      else lo = mid + 1;\n'
+  output += '    }\n'
+  output += '    return INVALID;\n  }\n\n'
+  output += '  inline Id fromName(const std::string& block) { return fromName(block.c_str()); }\n'
+  output += '}\n\n#endif'
+  print(output, file=ids)
 
 def generateIncludes():
-  output = ""
+  output = "#include <memory/MemoryBlockIds.h>\n"
   for cname in sorted(set(blocks.values())):
     output += "#include <memory/%s.h>\n" % cname
   print(output, file=f)
 
-def generateNew():
-  output = '#define NEW_MEMORY_BLOCK(name) (\\\n'
-  for name in sorted(blocks):
-    cname = blocks[name]
-    output += '  name == "%s" ? (MemoryBlock*)new %s() : \\\n'  % (name,cname)
-  output += '  NULL)'
-  print(output, file=f)
-
-def generateCopy():
-  output = '#define COPY_MEMORY_BLOCK(name,ptr) (\\\n'
-  for name in sorted(blocks):
-    cname = blocks[name]
-    output += '  name == "%s" ? (MemoryBlock*)new %s(*(%s*)ptr) : \\\n'  % (name,cname,cname)
-  output += '  NULL)'
-  print(output, file=f)
-
-def generateDelete():
-  output = '#define DELETE_MEMORY_BLOCK(name,ptr) \\\n  '
-  for name in sorted(blocks):
-    cname = blocks[name]
-    output += 'if(name == "%s") delete (%s*)ptr; \\\n' % (name,cname)
-    output += '  else '
-  output += '{ fprintf(stderr, "ERROR DELETING MEMORY BLOCK \'%s\'\\n", name.c_str()); }'
-  print(output, file=f)
-
-def generateAddBlock():
-  output = '#define ADD_MEMORY_BLOCK(name,function) \\\n  '
-  for name in sorted(blocks):
-    cname = blocks[name]
-    output += 'if(name == "%s") return function(name, new %s()); \\\n' % (name,cname)
-    output += '  else '
-  output += '{ fprintf(stderr, "ERROR ADDING MEMORY BLOCK \'%s\'\\n", name.c_str()); return false; }'
-  print(output, file=f)
-
-def generateFunctionCall():
-  output = '#define MEMORY_BLOCK_TEMPLATE_FUNCTION_CALL(name,function,default_return,...) (\\\n  '
+def generateTypes():
+  output = '// The block type stored under each id\n'
+  output += 'template<int ID> struct MemoryBlockType;\n'
   for name in sorted(blocks):
-    cname = blocks[name]
-    output += 'name == "%s" ? function<%s>(__VA_ARGS__) : \\\n' % (name,cname)
-  output += ' default_return)'
+    output += 'template<> struct MemoryBlockType<MemoryBlockId::%s> { typedef %s type; };\n' % (blockId(name), blocks[name])
   print(output, file=f)
 
 def main():
-  generateWarning()
+  generateWarning(ids)
+  generateIds()
+  generateWarning(f)
   generateIncludes()
-  generateNew()
-  generateCopy()
-  generateDelete()
-  generateAddBlock()
-  generateFunctionCall()
+  generateTypes()
 
 
 blocks = {
@@ -145,6 +149,8 @@ blocks = {
   "sync_walk_param":"WalkParamBlock",
   "sync_al_walk_param":"ALWalkParamBlock",
   "sync_walk_info":"WalkInfoBlock",
+  "sync_motion_walk_request":"WalkRequestBlock",
+  "sync_channels":"SyncChannelBlock",
   "audio_processing":"AudioProcessingBlock"
 }
 
@@ -0,0 +1,329 @@
+#include <opponents/UKF4.h>
+#include <opponents/OppFilterBank.h>
+#include <sensor/InertialFilter.h>
+#include <common/Profiling.h>
+#include <AllocationCounter.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+
+// Counts heap allocations per update for UKF4 and InertialFilter on FixedMatrix, and
+// times the UKF4 updates and the InertialFilter frame against the same math on NMatrix,
+// checking both give exactly the same results. Also tracks several moving opponents
+// with OppFilterBank, and with one UKF4 per opponent told which detection is whose,
+// and checks the bank keeps them all.
+
+// The UKF4 updates as they were written on NMatrix
+struct LegacyUKF4 {
+  NMatrix A, X, S, Q, M1;
+  float kappa, outlierThresh, alpha;
+  int nStates;
+
+  LegacyUKF4(const UKF4& ukf) : A(ukf.updateUncertainties.toNMatrix()), X(ukf.stateEstimates.toNMatrix()),
+    S(ukf.stateStandardDeviations.toNMatrix()), Q(ukf.sqrtOfProcessNoise.toNMatrix()), M1(ukf.sqrtOfTestWeightings.toNMatrix()),
+    kappa(ukf.ukfParams.kappa), outlierThresh(ukf.ukfParams.outlier_rejection_thresh), alpha(ukf.alpha), nStates(ukf.nStates) { }
+
+  void timeUpdate(float timePassed, float decay) {
+    A[0][2] = timePassed;
+    A[1][3] = timePassed;
+    X[0][0] += X[2][0] * timePassed;
+    X[1][0] += X[3][0] * timePassed;
+    X[2][0] *= decay;
+    X[3][0] *= decay;
+    S = HT(horzcat(A * S, Q));
+  }
+
+  void linear2MeasurementUpdate(float Y1, float Y2, float SR11, float SR12, float SR22, int index1, int index2) {
+    NMatrix SR(2, 2, false);
+    SR[0][0] = SR11;
+    SR[0][1] = SR12;
+    SR[1][1] = SR22;
+    NMatrix R = SR * SR.transp();
+    NMatrix CS(2, 4, false);
+    CS.setRow(0, S.getRow(index1));
+    CS.setRow(1, S.getRow(index2));
+    NMatrix Py = CS * CS.transp();
+    NMatrix Pxy = S * CS.transp();
+    NMatrix K = Pxy * Invert22(Py + R);
+    NMatrix y(2, 1, false);
+    y[0][0] = Y1;
+    y[1][0] = Y2;
+    NMatrix yBar(2, 1, false);
+    yBar[0][0] = X[index1][0];
+    yBar[1][0] = X[index2][0];
+    S = HT(horzcat(S - K * CS, K * SR));
+    X = X - K * (yBar - y);
+  }
+
+  void opponentDetection(const WorldObject& self, float obsDistance, float obsBearing, float distanceErrorOffset, float distanceErrorRelative, float bearingError) {
+    float oppX = obsDistance * cos(obsBearing + self.orientation) + self.loc.x;
+    float oppY = obsDistance * sin(obsBearing + self.orientation) + self.loc.y;
+    if(fabs(oppX) > (GRASS_X / 20.0) || fabs(oppY) > (GRASS_Y / 20.0)) return;
+    float R_range = distanceErrorOffset + distanceErrorRelative * powf(obsDistance, 2);
+    float R_bearing = bearingError;
+    NMatrix S_obj_rel(2, 5, false);
+    S_obj_rel[0][0] = cos(obsBearing + self.orientation) * sqrtf(R_range);
+    S_obj_rel[0][1] = -sin(obsBearing + self.orientation) * obsDistance * sqrtf(R_bearing);
+    S_obj_rel[0][2] = self.sd.x;
+    S_obj_rel[0][3] = 0.0;
+    S_obj_rel[0][4] = -sin(obsBearing + self.orientation) * obsDistance * self.sdOrientation;
+    S_obj_rel[1][0] = sin(obsBearing + self.orientation) * sqrtf(R_range);
+    S_obj_rel[1][1] = cos(obsBearing + self.orientation) * obsDistance * sqrtf(R_bearing);
+    S_obj_rel[1][2] = 0.0;
+    S_obj_rel[1][3] = self.sd.y;
+    S_obj_rel[1][4] = cos(obsBearing + self.orientation) * obsDistance * self.sdOrientation;
+    NMatrix R_obj_rel = S_obj_rel * S_obj_rel.transp();
+
+    NMatrix scriptX(X.getm(), 2 * nStates + 1, false);
+    scriptX.setCol(0, X);
+    for(int i = 1; i < nStates + 1; i++) {
+      scriptX.setCol(i, X + sqrtf((float)nStates + kappa) * S.getCol(i - 1));
+      scriptX.setCol(nStates + i, X - sqrtf((float)nStates + kappa) * S.getCol(i - 1));
+    }
+    NMatrix scriptY(2, 2 * nStates + 1, false);
+    NMatrix temp(2, 1, false);
+    for(int i = 0; i < 2 * nStates + 1; i++) {
+      temp[0][0] = scriptX[0][i];
+      temp[1][0] = scriptX[1][i];
+      scriptY.setCol(i, temp.getCol(0));
+    }
+    NMatrix Mx(scriptX.getm(), 2 * nStates + 1, false);
+    NMatrix My(scriptY.getm(), 2 * nStates + 1, false);
+    for(int i = 0; i < 2 * nStates + 1; i++) {
+      Mx.setCol(i, M1[0][i] * scriptX.getCol(i));
+      My.setCol(i, M1[0][i] * scriptY.getCol(i));
+    }
+    NMatrix yBar = My * M1.transp();
+    NMatrix Py = (My - yBar * M1) * (My - yBar * M1).transp();
+    NMatrix Pxy = (Mx - X * M1) * (My - yBar * M1).transp();
+    NMatrix K = Pxy * Invert22(Py + R_obj_rel);
+    NMatrix y(2, 1, false);
+    y[0][0] = oppX;
+    y[1][0] = oppY;
+    float innovation2 = convDble((yBar - y).transp() * Invert22(Py + R_obj_rel) * (yBar - y));
+    float innovation2measError = convDble((yBar - y).transp() * Invert22(R_obj_rel) * (yBar - y));
+    alpha *= 1 / (1 + innovation2measError);
+    if(innovation2 > outlierThresh) return;
+    S = HT(horzcat(Mx - X * M1 - K * My + K * yBar * M1, K * S_obj_rel));
+    X = X - K * (yBar - y);
+  }
+};
+
+// InertialFilter::processFrame and predictFuture as they were written on NMatrix
+struct LegacyInertialFilter {
+  NMatrix A, C, L, Cz, Cz1, xhRoll, xhTilt;
+  float gyro_scale, filtRoll, filtTilt, filtRollVel, filtTiltVel;
+
+  LegacyInertialFilter(const InertialFilter& filter) : A(filter.getA().toNMatrix()), C(filter.getC().toNMatrix()),
+    L(filter.getL().toNMatrix()), Cz(filter.getCz().toNMatrix()), Cz1(filter.getCz1().toNMatrix()),
+    xhRoll(4, 1, false), xhTilt(4, 1, false), gyro_scale(M_PI / 180.0 * 0.405),
+    filtRoll(0), filtTilt(0), filtRollVel(0), filtTiltVel(0) { }
+
+  void processFrame(float x_acc, float y_acc, float x_gyro, float y_gyro) {
+    float x_g = x_gyro * gyro_scale;
+    float y_g = y_gyro * gyro_scale;
+    NMatrix xSen(2, 1, false);
+    xSen[0][0] = -y_acc;
+    xSen[1][0] = x_g;
+    xhRoll = A * xhRoll - L * (C * xhRoll - xSen);
+    filtRoll = convDble(Cz * xhRoll);
+    filtRollVel = convDble(Cz1 * xhRoll);
+    NMatrix ySen(2, 1, false);
+    ySen[0][0] = -x_acc;
+    ySen[1][0] = y_g;
+    xhTilt = A * xhTilt - L * (C * xhTilt - ySen);
+    filtTilt = convDble(Cz * xhTilt);
+    filtTiltVel = convDble(Cz1 * xhTilt);
+  }
+
+  void predictFuture(int numFrames, float& tilt, float& roll) {
+    NMatrix xhRollFuture = xhRoll, xhTiltFuture = xhTilt;
+    for(int i = 0; i < numFrames; i++) {
+      xhRollFuture = A * xhRollFuture;
+      xhTiltFuture = A * xhTiltFuture;
+    }
+    roll = convDble(Cz * xhRollFuture);
+    tilt = convDble(Cz * xhTiltFuture);
+  }
+};
+
+static bool same(const NMatrix& a, const float* b) {
+  for(int i = 0; i < a.getm() * a.getn(); i++)
+    if(a.getx()[i] != b[i]) return false;
+  return true;
+}
+
+static float observation(int i, float scale) {
+  return scale * ((i * 7919) % 200 - 100) / 100.0f;
+}
+
+// Opponents walk back and forth across the field in front of a robot at the center, in cm
+static const int OPPONENTS = 5;
+static const float OPPONENT_SPEED = 15;
+static const float MAX_TRACK_ERROR = 25;
+
+static void opponentAt(int o, float t, float& x, float& y) {
+  float phase = OPPONENT_SPEED * t / 200 + o;
+  x = 100 + 50 * o + 100 * sinf(phase);
+  y = -200 + 100 * o + 60 * cosf(phase);
+}
+
+int main(int argc, char** argv) {
+  int updates = argc > 1 ? atoi(argv[1]) : 100000;
+  const float dt = 1 / 30.0f;
+
+  SmallUKF4Params params = { 3, 0.95, 25, 3, 5, 100, 80, 20 };
+  UKF4 ukf;
+  ukf.setParams(params);
+  LegacyUKF4 legacy(ukf);
+
+  // The shared measurement update rejects outliers, so keep the measurements close
+  // enough to the estimate that every update goes through on both sides
+  Timer timer;
+  unsigned long before = allocations;
+  timer.start();
+  for(int i = 0; i < updates; i++) {
+    legacy.timeUpdate(dt, params.vel_decay_rate);
+    legacy.linear2MeasurementUpdate(legacy.X[0][0] + observation(i, 3), legacy.X[1][0] + observation(i + 1, 3), 10, 2, 8, 0, 1);
+  }
+  timer.stop();
+  double legacyTime = timer.lasttime() / updates;
+  double legacyAllocs = (double)(allocations - before) / updates;
+
+  before = allocations;
+  timer.start();
+  for(int i = 0; i < updates; i++) {
+    ukf.timeUpdate(dt);
+    ukf.linear2MeasurementUpdate(ukf.stateEstimates[0][0] + observation(i, 3), ukf.stateEstimates[1][0] + observation(i + 1, 3), 10, 2, 8, 0, 1);
+  }
+  timer.stop();
+  double fixedTime = timer.lasttime() / updates;
+  double fixedAllocs = (double)(allocations - before) / updates;
+
+  bool identical = same(legacy.X, ukf.stateEstimates.X) && same(legacy.S, ukf.stateStandardDeviations.X);
+
+  // Opponent detections go through the full sigma point update
+  WorldObjectBlock worldObjects;
+  RobotStateBlock robotState;
+  FrameInfoBlock frameInfo;
+  WorldObject& self = worldObjects.objects_[robotState.WO_SELF];
+  self.sd.x = self.sd.y = 10;
+  self.sdOrientation = 0.1;
+  UKF4 opponent;
+  opponent.setParams(params);
+  opponent.setMemory(&worldObjects, &robotState, &frameInfo);
+  LegacyUKF4 legacyOpponent(opponent);
+  timer.start();
+  for(int i = 0; i < updates; i++) {
+    legacyOpponent.timeUpdate(dt, params.vel_decay_rate);
+    legacyOpponent.opponentDetection(self, 150 + observation(i, 50), observation(i + 3, 1), 20, 0.05, 0.01);
+  }
+  timer.stop();
+  double legacyDetectionTime = timer.lasttime() / updates;
+
+  before = allocations;
+  timer.start();
+  for(int i = 0; i < updates; i++) {
+    frameInfo.frame_id = i;
+    opponent.timeUpdate(dt);
+    opponent.opponentDetection(150 + observation(i, 50), observation(i + 3, 1), 20, 0.05, 0.01);
+  }
+  timer.stop();
+  double detectionTime = timer.lasttime() / updates;
+  double detectionAllocs = (double)(allocations - before) / updates;
+  identical = identical && same(legacyOpponent.X, opponent.stateEstimates.X) && same(legacyOpponent.S, opponent.stateStandardDeviations.X)
+    && legacyOpponent.alpha == opponent.alpha;
+
+  // The bank sees every opponent every frame, with range and bearing noise
+  OppFilterBank bank;
+  UKF4 perOpponent[OPPONENTS];
+  for(UKF4& ukf : perOpponent) {
+    ukf.setParams(params);
+    ukf.setMemory(&worldObjects, &robotState, &frameInfo);
+  }
+  int frames = updates / 10;
+  double bankTime = 0, ukfTime = 0;
+  unsigned long bankAllocs = 0;
+  float trackError = 0;
+  int trackedFrames = 0;
+  for(int i = 0; i < frames; i++) {
+    frameInfo.frame_id = i;
+    OppObservation observations[OPPONENTS];
+    float distance[OPPONENTS], bearing[OPPONENTS];
+    for(int o = 0; o < OPPONENTS; o++) {
+      float x, y;
+      opponentAt(o, i * dt, x, y);
+      distance[o] = sqrtf(x * x + y * y) * (1 + observation(i * OPPONENTS + o, 0.05));
+      bearing[o] = atan2f(y, x) + observation(i * OPPONENTS + o + 1, 0.05);
+      observations[o] = OppObservation::fromRelative(distance[o], bearing[o], 0, 0, 0, self.sd.x, self.sd.y, self.sdOrientation, 20, 0.0025, 0.0025);
+    }
+    before = allocations;
+    timer.start();
+    bank.processFrame(dt, observations, OPPONENTS, i);
+    timer.stop();
+    bankTime += timer.lasttime();
+    bankAllocs += allocations - before;
+    timer.start();
+    for(int o = 0; o < OPPONENTS; o++) {
+      perOpponent[o].timeUpdate(dt);
+      perOpponent[o].opponentDetection(distance[o], bearing[o], 20, 0.0025, 0.0025);
+    }
+    timer.stop();
+    ukfTime += timer.lasttime();
+
+    // every opponent should have a track once they have all been seen a second
+    if(i < 30) continue;
+    trackedFrames++;
+    for(int o = 0; o < OPPONENTS; o++) {
+      float x, y, closest = 1e6;
+      opponentAt(o, i * dt, x, y);
+      for(int k = 0; k < OppFilterBank::MAX_FILTERS; k++)
+        if(bank.active(k))
+          closest = std::min(closest, hypotf(bank.x(k) - x, bank.y(k) - y));
+      trackError = std::max(trackError, closest);
+    }
+  }
+  bool tracked = bank.activeCount() == OPPONENTS && trackError < MAX_TRACK_ERROR;
+
+  InertialFilter inertial;
+  inertial.init(false);
+  LegacyInertialFilter legacyInertial(inertial);
+  float legacyTilt = 0, legacyRoll = 0;
+  timer.start();
+  for(int i = 0; i < updates; i++) {
+    legacyInertial.processFrame(observation(i, 1), observation(i + 1, 1), observation(i + 2, 10), observation(i + 3, 10));
+    legacyInertial.predictFuture(7, legacyTilt, legacyRoll);
+  }
+  timer.stop();
+  double legacyInertialTime = timer.lasttime() / updates;
+
+  float tilt = 0, roll = 0;
+  before = allocations;
+  timer.start();
+  for(int i = 0; i < updates; i++) {
+    inertial.setInertialData(observation(i, 1), observation(i + 1, 1), 9.8, observation(i + 2, 10), observation(i + 3, 10));
+    inertial.processFrame(true);
+    inertial.predictFuture(7, tilt, roll);
+  }
+  timer.stop();
+  double inertialTime = timer.lasttime() / updates;
+  double inertialAllocs = (double)(allocations - before) / updates;
+  identical = identical && legacyInertial.filtRoll == inertial.getRoll() && legacyInertial.filtTilt == inertial.getTilt()
+    && legacyInertial.filtRollVel == inertial.getRollVel() && legacyInertial.filtTiltVel == inertial.getTiltVel()
+    && legacyTilt == tilt && legacyRoll == roll;
+
+  printf("%d updates, NMatrix and FixedMatrix results %s\n", updates, identical ? "identical" : "DIFFER");
+  printf("%-28s %12s %12s\n", "", "update [us]", "allocs");
+  printf("%-28s %12.3f %12.1f\n", "UKF4 shared update NMatrix", legacyTime * 1e6, legacyAllocs);
+  printf("%-28s %12.3f %12.1f\n", "UKF4 shared update fixed", fixedTime * 1e6, fixedAllocs);
+  printf("%-28s %12.3f %12s\n", "UKF4 opponent det. NMatrix", legacyDetectionTime * 1e6, "");
+  printf("%-28s %12.3f %12.1f\n", "UKF4 opponent detection", detectionTime * 1e6, detectionAllocs);
+  printf("%-28s %12.3f %12s\n", "InertialFilter NMatrix", legacyInertialTime * 1e6, "");
+  printf("%-28s %12.3f %12.1f\n", "InertialFilter frame", inertialTime * 1e6, inertialAllocs);
+  printf("%-28s %12.3f %12s\n", "UKF4 per opponent frame", ukfTime / frames * 1e6, "");
+  printf("%-28s %12.3f %12.1f\n", "OppFilterBank frame", bankTime / frames * 1e6, (double)bankAllocs / frames);
+  printf("%d opponents over %d frames, %d tracks at the end, largest track error %.1f cm\n", OPPONENTS, trackedFrames,
+      bank.activeCount(), trackError);
+  return identical && tracked && fixedAllocs == 0 && detectionAllocs == 0 && inertialAllocs == 0 && bankAllocs == 0 ? 0 : 1;
+}
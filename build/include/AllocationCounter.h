@@ -0,0 +1,26 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <new>
+#include <cstdlib>
+
+// Replaces the global operator new and delete with ones that count every heap
+// allocation, for the benchmarks that check a path doesn't allocate. These are the
+// program's definitions of the operators, so include this from one file only.
+
+static unsigned long allocations = 0;
+
+void* operator new(size_t n) {
+  allocations++;
+  void* p = malloc(n);
+  if(!p) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+
+// For code that only takes a counter, e.g. LocalizationSimulation::allocationCount
+inline long allocationCount() { return allocations; }
+
+#endif
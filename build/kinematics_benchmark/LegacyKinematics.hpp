@@ -0,0 +1,106 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/io.hpp>
+#include <boost/numeric/ublas/lu.hpp>
+
+#include <perception/kinematics/Parameters.hpp>
+#include <perception/kinematics/Pose.hpp>
+#include <perception/vision/RSCamera.hpp>
+
+#include <utils/matrix_helpers.hpp>
+#include <types/RRCoord.hpp>
+#include <types/JointValues.hpp>
+#include <types/SensorValues.hpp>
+
+#include <perception/kinematics/Kinematics.hpp>
+
+
+/* The Kinematics class as it was before it moved to fixed size transforms,
+ * kept as the reference the benchmark checks the new one against.
+ */
+class LegacyKinematics {
+   public:
+      LegacyKinematics();
+
+      typedef Kinematics::Link Link;
+      typedef Kinematics::Chain Chain;
+
+      /* Creates a Pose with the current evaluated DH Chain */
+      Pose getPose();
+
+      void updateDHChain();
+
+      boost::numeric::ublas::matrix<float>
+      evaluateDHChain(Link from, Link to, Chain foot, bool top = true);
+
+      boost::numeric::ublas::matrix<float> evaluateMassChain();
+
+      boost::numeric::ublas::matrix<float>
+      createBodyToFootOnGroundTransform(Chain foot, boost::numeric::ublas::matrix<float> b2f);
+
+      boost::numeric::ublas::matrix<float>
+      createCameraToFootTransform(Chain foot, bool top);
+      
+      boost::numeric::ublas::matrix<float>
+      createNeckToFootTransform(Chain foot);
+
+      boost::numeric::ublas::matrix<float>
+      createFootToWorldTransform(Chain foot, bool top = true);
+
+      boost::numeric::ublas::matrix<float>
+      createCameraToWorldTransform(Chain foot, bool top);
+      
+      boost::numeric::ublas::matrix<float>
+      createNeckToWorldTransform(Chain foot);
+
+      boost::numeric::ublas::matrix<float>
+      createWorldToFOVTransform(
+         const boost::numeric::ublas::matrix<float> &m);
+
+      boost::numeric::ublas::matrix<float>
+      fovToImageSpaceTransform(
+         const boost::numeric::ublas::matrix<float> &transform,
+         const boost::numeric::ublas::matrix<float> &point, bool top);
+
+      void determineBodyExclusionArray(
+         const boost::numeric::ublas::matrix<float> &m,
+         int16_t *points, bool top);
+
+      Chain determineSupportChain();
+
+      void setSensorValues(SensorValues sensorValues);
+
+      std::pair<int, int> calculateHorizon(
+         const boost::numeric::ublas::matrix<float> &m);
+   private:
+      SensorValues sensorValues;
+      Chain supportChain;
+
+      boost::numeric::ublas::matrix<float> transformLTop[CAMERA_DH_CHAIN_LEN];
+      boost::numeric::ublas::matrix<float> transformLBot[CAMERA_DH_CHAIN_LEN];
+      boost::numeric::ublas::matrix<float> transformRTop[CAMERA_DH_CHAIN_LEN];
+      boost::numeric::ublas::matrix<float> transformRBot[CAMERA_DH_CHAIN_LEN];
+      
+      boost::numeric::ublas::matrix<float> cameraPanInverseHack;
+
+      // DH matrices for mass
+      boost::numeric::ublas::matrix<float> transformHB[HEAD_DH_CHAIN_LEN];
+      boost::numeric::ublas::matrix<float> transformRAB[ARM_DH_CHAIN_LEN];
+      boost::numeric::ublas::matrix<float> transformLAB[ARM_DH_CHAIN_LEN];
+      boost::numeric::ublas::matrix<float> transformRFB[LEG_DH_CHAIN_LEN];
+      boost::numeric::ublas::matrix<float> transformLFB[LEG_DH_CHAIN_LEN];
+
+      // Contains the masses and centre position of each joint
+      std::vector<float> masses;
+      std::vector<boost::numeric::ublas::matrix<float> > massesCom;
+
+      Parameters<float> parameters;
+
+      std::vector<std::vector<boost::numeric::ublas::matrix<float> > >
+      bodyParts;
+};
+
@@ -0,0 +1,129 @@
+#include <perception/kinematics/Kinematics.hpp>
+#include <common/Profiling.h>
+#include <AllocationCounter.h>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include "LegacyKinematics.hpp"
+
+// Checks Kinematics on fixed size transforms against the ublas version it replaced,
+// bit for bit, over a sequence of joint and inertial readings, and times the per tick
+// work BodyModel does through each. Both multiply in the same order, so the results
+// only match exactly when the compiler doesn't fuse multiply-adds (no -mfma).
+
+// Every entry has to be equal; the largest relative error is only reported to show
+// how far off a mismatch is
+static int mismatches = 0;
+static float maxError = 0;
+
+static void compare(const boost::numeric::ublas::matrix<float>& a, const boost::numeric::ublas::matrix<float>& b) {
+  for(unsigned int i = 0; i < a.size1(); i++)
+    for(unsigned int j = 0; j < a.size2(); j++) {
+      if(a(i, j) != b(i, j)) mismatches++;
+      maxError = std::max(maxError, std::fabs(a(i, j) - b(i, j)) / std::max(1.0f, std::fabs(a(i, j))));
+    }
+}
+
+static void compare(const Pose& a, const Pose& b) {
+  if(a.getHorizon() != b.getHorizon()) mismatches++;
+  for(int i = 0; i < Pose::EXCLUSION_RESOLUTION; i++) {
+    if(a.getTopExclusionArray()[i] != b.getTopExclusionArray()[i]) mismatches++;
+    if(a.getBotExclusionArray()[i] != b.getBotExclusionArray()[i]) mismatches++;
+  }
+}
+
+static float observation(int i, float scale) {
+  return scale * ((i * 7919) % 200 - 100) / 100.0f;
+}
+
+// Moves a few joints a tick, the way a walk does, so the cached prefixes get reused
+static void step(SensorValues& values, int tick) {
+  for(int j = 0; j < RSJoints::NUMBER_OF_JOINTS; j++)
+    if((tick + j) % 3 == 0)
+      values.joints.angles[j] = observation(tick * RSJoints::NUMBER_OF_JOINTS + j, 0.6);
+  values.sensors[RSSensors::InertialSensor_AngleX] = observation(tick, 0.1);
+  values.sensors[RSSensors::InertialSensor_AngleY] = observation(tick + 1, 0.1);
+  values.sensors[RSSensors::LFoot_FSR_FrontLeft] = 1 + observation(tick + 2, 1);
+  values.sensors[RSSensors::RFoot_FSR_FrontLeft] = 1 + observation(tick + 3, 1);
+}
+
+int main(int argc, char** argv) {
+  int ticks = argc > 1 ? atoi(argv[1]) : 20000;
+  const Kinematics::Chain chains[] = { Kinematics::LEFT_CHAIN, Kinematics::RIGHT_CHAIN };
+  const Kinematics::Link links[][2] = {
+    { Kinematics::FOOT, Kinematics::BODY }, { Kinematics::FOOT, Kinematics::NECK },
+    { Kinematics::FOOT, Kinematics::CAMERA }, { Kinematics::BODY, Kinematics::NECK },
+    { Kinematics::BODY, Kinematics::CAMERA }
+  };
+
+  SensorValues values(true);
+  Kinematics kinematics;
+  LegacyKinematics legacy;
+
+  // Every public transform, compared entry by entry
+  for(int tick = 0; tick < ticks / 10; tick++) {
+    step(values, tick);
+    kinematics.setSensorValues(values);
+    kinematics.updateDHChain();
+    legacy.setSensorValues(values);
+    legacy.updateDHChain();
+    for(int c = 0; c < 2; c++) {
+      for(int top = 0; top < 2; top++) {
+        for(unsigned int l = 0; l < sizeof(links) / sizeof(links[0]); l++)
+          compare(legacy.evaluateDHChain(links[l][0], links[l][1], chains[c], top), kinematics.evaluateDHChain(links[l][0], links[l][1], chains[c], top));
+        compare(legacy.createFootToWorldTransform(chains[c], top), kinematics.createFootToWorldTransform(chains[c], top));
+        compare(legacy.createCameraToWorldTransform(chains[c], top), kinematics.createCameraToWorldTransform(chains[c], top));
+        compare(legacy.createCameraToFootTransform(chains[c], top), kinematics.createCameraToFootTransform(chains[c], top));
+      }
+      compare(legacy.createNeckToWorldTransform(chains[c]), kinematics.createNeckToWorldTransform(chains[c]));
+      compare(legacy.createNeckToFootTransform(chains[c]), kinematics.createNeckToFootTransform(chains[c]));
+    }
+    compare(legacy.evaluateMassChain(), kinematics.evaluateMassChain());
+    if(legacy.determineSupportChain() != kinematics.determineSupportChain()) mismatches++;
+    compare(legacy.getPose(), kinematics.getPose());
+  }
+
+  // What BodyModel::processUpdate asks for every motion tick
+  Timer timer;
+  unsigned long before = allocations;
+  timer.start();
+  for(int tick = 0; tick < ticks; tick++) {
+    step(values, tick);
+    legacy.setSensorValues(values);
+    legacy.updateDHChain();
+    for(int c = 0; c < 2; c++) {
+      legacy.evaluateDHChain(Kinematics::FOOT, Kinematics::BODY, chains[c]);
+      legacy.evaluateDHChain(Kinematics::FOOT, Kinematics::NECK, chains[c]);
+    }
+    legacy.createFootToWorldTransform(Kinematics::LEFT_CHAIN);
+    legacy.evaluateMassChain();
+  }
+  timer.stop();
+  double legacyTime = timer.lasttime() / ticks;
+  double legacyAllocs = (double)(allocations - before) / ticks;
+
+  before = allocations;
+  timer.start();
+  for(int tick = 0; tick < ticks; tick++) {
+    step(values, tick);
+    kinematics.setSensorValues(values);
+    kinematics.updateDHChain();
+    for(int c = 0; c < 2; c++) {
+      kinematics.chainTransform(Kinematics::FOOT, Kinematics::BODY, chains[c]);
+      kinematics.chainTransform(Kinematics::FOOT, Kinematics::NECK, chains[c]);
+    }
+    kinematics.footToWorld(Kinematics::LEFT_CHAIN);
+    kinematics.centreOfMass();
+  }
+  timer.stop();
+  double fixedTime = timer.lasttime() / ticks;
+  double fixedAllocs = (double)(allocations - before) / ticks;
+
+  bool identical = mismatches == 0;
+  printf("%d ticks, ublas and fixed results %s (%d mismatches, max relative error %g)\n",
+    ticks, identical ? "identical" : "DIFFER", mismatches, maxError);
+  printf("%-24s %12s %12s\n", "", "tick [us]", "allocs");
+  printf("%-24s %12.3f %12.1f\n", "Kinematics ublas", legacyTime * 1e6, legacyAllocs);
+  printf("%-24s %12.3f %12.1f\n", "Kinematics fixed", fixedTime * 1e6, fixedAllocs);
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,268 @@
+#include <tool/simulation/LocalizationSimulation.h>
+#include <common/Random.h>
+#include <AllocationCounter.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+// Runs LocalizationSimulation without the tool over every path in a directory, once per
+// localization method and seed, in forked workers so the runs share no interpreter or
+// random state. Accuracy, localization cpu time and heap allocations per frame are
+// written out as json, with the manifest of random streams each run drew from, so a
+// localization change can be checked for both kinds of regression before it goes on a
+// robot and any run can be replayed exactly.
+
+static const LocSimAgent::Type TYPES[] = { LocSimAgent::Default, LocSimAgent::Particle };
+
+struct Job {
+  int path;
+  LocSimAgent::Type type;
+  int seed;
+};
+
+// Written by a worker to its pipe when the path is done, followed by its manifest
+struct Result {
+  AgentError error;
+  double seconds;
+};
+
+static void usage(const char* name) {
+  fprintf(stderr, "Usage: %s [path directory] [--random <count>] [--seeds <count>] [--jobs <count>] [--type <name>] [--out <file>] [--max-dist <mm>] [--max-cpu <ms>]\n", name);
+  fprintf(stderr, "  path directory  yaml paths to run, default $NAO_HOME/data/paths\n");
+  fprintf(stderr, "  --random        also run this many generated paths of 10 points\n");
+  fprintf(stderr, "  --seeds         runs of each path and method, default 3\n");
+  fprintf(stderr, "  --jobs          workers at once, default the number of cores\n");
+  fprintf(stderr, "  --type          only run this method, Default or Particle\n");
+  fprintf(stderr, "  --out           write the json here instead of stdout\n");
+  fprintf(stderr, "  --max-dist      fail if any method's mean dist RMSE is above this\n");
+  fprintf(stderr, "  --max-cpu       fail if any method's mean cpu per frame is above this\n");
+}
+
+static double wallSeconds() {
+  timeval t;
+  gettimeofday(&t, NULL);
+  return t.tv_sec + t.tv_usec * 1e-6;
+}
+
+static std::vector<std::string> listPaths(const std::string& directory) {
+  std::vector<std::string> files;
+  DIR* dir = opendir(directory.c_str());
+  if(!dir) return files;
+  while(dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if(name.size() > 5 && name.compare(name.size() - 5, 5, ".yaml") == 0)
+      files.push_back(name);
+  }
+  closedir(dir);
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+static Result run(const SimulationPath& path, const Job& job) {
+  Random::SEED = job.seed;
+  srand(job.seed);
+  LocalizationSimulation::allocationCount = allocationCount;
+  double start = wallSeconds();
+  LocalizationSimulation sim(job.type);
+  sim.setPath(path);
+  while(!sim.complete())
+    sim.simulationStep();
+  Result result;
+  result.error = sim.getError(job.type);
+  result.seconds = wallSeconds() - start;
+  return result;
+}
+
+int main(int argc, char** argv) {
+  const char* home = getenv("NAO_HOME");
+  if(!home) {
+    fprintf(stderr, "NAO_HOME is not set\n");
+    return 1;
+  }
+  std::string directory = std::string(home) + "/data/paths", out, onlyType;
+  int randomPaths = 0, seeds = 3, jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  float maxDist = 0, maxCpu = 0;
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "--random") && i + 1 < argc)
+      randomPaths = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "--seeds") && i + 1 < argc)
+      seeds = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "--jobs") && i + 1 < argc)
+      jobs = std::max(atoi(argv[++i]), 1);
+    else if(!strcmp(argv[i], "--type") && i + 1 < argc)
+      onlyType = argv[++i];
+    else if(!strcmp(argv[i], "--out") && i + 1 < argc)
+      out = argv[++i];
+    else if(!strcmp(argv[i], "--max-dist") && i + 1 < argc)
+      maxDist = atof(argv[++i]);
+    else if(!strcmp(argv[i], "--max-cpu") && i + 1 < argc)
+      maxCpu = atof(argv[++i]);
+    else if(argv[i][0] != '-')
+      directory = argv[i];
+    else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  // every worker gets the same paths, so they're all loaded or generated up front
+  std::vector<std::string> names;
+  std::vector<SimulationPath> paths;
+  for(auto& file : listPaths(directory)) {
+    SimulationPath path;
+    if(!path.loadFromFile(directory + "/" + file) || path.empty()) {
+      fprintf(stderr, "Skipping %s, no path points\n", file.c_str());
+      continue;
+    }
+    names.push_back(file);
+    paths.push_back(path);
+  }
+  for(int i = 0; i < randomPaths; i++) {
+    char name[32];
+    snprintf(name, sizeof(name), "random_%i", i);
+    names.push_back(name);
+    paths.push_back(SimulationPath::generate(10));
+  }
+  if(paths.empty()) {
+    fprintf(stderr, "No paths in %s, use --random to generate some\n", directory.c_str());
+    usage(argv[0]);
+    return 1;
+  }
+
+  std::vector<LocSimAgent::Type> types;
+  for(auto type : TYPES)
+    if(onlyType.empty() || LocSimAgent(type).name == onlyType)
+      types.push_back(type);
+  if(types.empty()) {
+    fprintf(stderr, "Unknown localization type %s\n", onlyType.c_str());
+    return 1;
+  }
+
+  std::vector<Job> queue;
+  for(int p = 0; p < (int)paths.size(); p++)
+    for(auto type : types)
+      for(int s = 0; s < seeds; s++)
+        queue.push_back({p, type, s});
+
+  // fork up to jobs workers at a time, each sends its Result back down a pipe
+  std::vector<Result> results(queue.size());
+  std::vector<std::string> manifests(queue.size());
+  std::vector<bool> succeeded(queue.size(), false);
+  std::vector<std::pair<pid_t,int>> running(queue.size(), std::make_pair(0, -1));
+  int next = 0, active = 0, done = 0;
+  double start = wallSeconds();
+  while(done < (int)queue.size()) {
+    while(active < jobs && next < (int)queue.size()) {
+      int fds[2];
+      if(pipe(fds)) {
+        perror("pipe");
+        return 1;
+      }
+      fflush(NULL);
+      pid_t pid = fork();
+      if(pid == 0) {
+        close(fds[0]);
+        // keep the simulation's chatter off the json
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+        Result result = run(paths[queue[next].path], queue[next]);
+        std::string manifest = Random::manifest();
+        bool written = write(fds[1], &result, sizeof(result)) == sizeof(result) &&
+          write(fds[1], manifest.c_str(), manifest.size()) == (ssize_t)manifest.size();
+        _exit(written ? 0 : 1);
+      }
+      close(fds[1]);
+      running[next] = std::make_pair(pid, fds[0]);
+      next++;
+      active++;
+    }
+    // Drain every running worker's pipe as it fills, so no worker blocks on a full pipe,
+    // and reap each one only once its pipe is at EOF
+    std::vector<pollfd> polled;
+    std::vector<int> owners;
+    for(int i = 0; i < next; i++) {
+      if(!running[i].first) continue;
+      pollfd p = { running[i].second, POLLIN, 0 };
+      polled.push_back(p);
+      owners.push_back(i);
+    }
+    if(poll(&polled[0], polled.size(), -1) < 0) {
+      if(errno == EINTR) continue;
+      perror("poll");
+      return 1;
+    }
+    for(int k = 0; k < (int)polled.size(); k++) {
+      if(!polled[k].revents) continue;
+      int i = owners[k];
+      // the worker's output, its Result then its manifest, collects in manifests[i]
+      char buffer[4096];
+      ssize_t n = read(running[i].second, buffer, sizeof(buffer));
+      if(n > 0) {
+        manifests[i].append(buffer, n);
+        continue;
+      }
+      if(n < 0 && errno == EINTR) continue;
+      close(running[i].second);
+      int status;
+      bool exited = waitpid(running[i].first, &status, 0) == running[i].first && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+      if(exited && manifests[i].size() >= sizeof(Result)) {
+        memcpy(&results[i], manifests[i].data(), sizeof(Result));
+        manifests[i].erase(0, sizeof(Result));
+        succeeded[i] = true;
+      } else
+        manifests[i].clear();
+      running[i].first = 0;
+      active--;
+      done++;
+      auto error = results[i].error;
+      fprintf(stderr, "[%i/%i] %s %s seed %i: %s dist %2.1f, rot %2.2f, cpu %2.3f ms\n", done, (int)queue.size(),
+        names[queue[i].path].c_str(), LocSimAgent(queue[i].type).name.c_str(), queue[i].seed,
+        succeeded[i] ? "" : "FAILED", error.dist, error.rot, error.cpu);
+    }
+  }
+  double elapsed = wallSeconds() - start;
+
+  FILE* f = out.empty() ? stdout : fopen(out.c_str(), "w");
+  if(!f) {
+    perror(out.c_str());
+    return 1;
+  }
+  fprintf(f, "{\n  \"seeds\": %i,\n  \"jobs\": %i,\n  \"wallSeconds\": %.3f,\n  \"results\": [\n", seeds, jobs, elapsed);
+  for(int i = 0; i < (int)queue.size(); i++) {
+    auto& e = results[i].error;
+    fprintf(f, "    {\"path\": \"%s\", \"type\": \"%s\", \"seed\": %i, \"succeeded\": %s",
+      names[queue[i].path].c_str(), LocSimAgent(queue[i].type).name.c_str(), queue[i].seed, succeeded[i] ? "true" : "false");
+    if(succeeded[i])
+      fprintf(f, ", \"steps\": %i, \"distRMSE\": %.3f, \"rotRMSE\": %.4f, \"cpuMsPerFrame\": %.5f, \"maxCpuMs\": %.5f, \"allocationsPerFrame\": %.3f, \"wallSeconds\": %.3f, \"manifest\": %s",
+        (int)e.steps, e.dist, e.rot, e.cpu, e.maxCpu, e.allocations, results[i].seconds, manifests[i].empty() ? "null" : manifests[i].c_str());
+    fprintf(f, "}%s\n", i + 1 < (int)queue.size() ? "," : "");
+  }
+  fprintf(f, "  ],\n  \"summary\": {\n");
+  bool passed = true;
+  for(int t = 0; t < (int)types.size(); t++) {
+    std::vector<AgentError> errors;
+    int failed = 0;
+    for(int i = 0; i < (int)queue.size(); i++) {
+      if(queue[i].type != types[t]) continue;
+      if(succeeded[i]) errors.push_back(results[i].error);
+      else failed++;
+    }
+    AgentError avg = errors.empty() ? AgentError() : AgentError::average(errors);
+    fprintf(f, "    \"%s\": {\"runs\": %i, \"failed\": %i, \"distRMSE\": %.3f, \"rotRMSE\": %.4f, \"cpuMsPerFrame\": %.5f, \"maxCpuMs\": %.5f, \"allocationsPerFrame\": %.3f}%s\n",
+      LocSimAgent(types[t]).name.c_str(), (int)errors.size() + failed, failed, avg.dist, avg.rot, avg.cpu, avg.maxCpu, avg.allocations,
+      t + 1 < (int)types.size() ? "," : "");
+    if(failed || errors.empty() || (maxDist > 0 && avg.dist > maxDist) || (maxCpu > 0 && avg.cpu > maxCpu))
+      passed = false;
+  }
+  fprintf(f, "  },\n  \"passed\": %s\n}\n", passed ? "true" : "false");
+  if(f != stdout) fclose(f);
+  return passed ? 0 : 1;
+}
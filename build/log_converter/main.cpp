@@ -0,0 +1,39 @@
+#include <memory/LogReader.h>
+#include <memory/IndexedLog.h>
+#include <memory/Memory.h>
+
+// Converts logs from the frames.log format, with images in separate per frame
+// files, to a single indexed frames.ulog in the same directory.
+int main(int argc, char** argv) {
+  if(argc < 2) {
+    fprintf(stderr, "Usage: %s <log directory> [<log directory> ...]\n", argv[0]);
+    return 1;
+  }
+  int failures = 0;
+  for(int i = 1; i < argc; i++) {
+    std::string directory = argv[i];
+    if(IndexedLogReader::exists(directory)) {
+      printf("%s already has an indexed log, skipping\n", directory.c_str());
+      continue;
+    }
+    LogReader reader(directory);
+    unsigned int frames = reader.mdata().frames;
+    IndexedLogWriter writer;
+    if(!writer.open(IndexedLogFormat::filename(directory))) {
+      fprintf(stderr, "Couldn't open %s for writing\n", IndexedLogFormat::filename(directory).c_str());
+      failures++;
+      continue;
+    }
+    Memory memory(false, MemoryOwner::TOOL_MEM, 0, 1);
+    std::vector<std::string> names;
+    for(unsigned int frame = 0; frame < frames; frame++) {
+      reader.readFrame(frame, memory);
+      names.clear();
+      memory.getBlockNames(names, false);
+      writer.writeMemory(memory, names);
+    }
+    writer.close();
+    printf("Converted %i frames in %s\n", frames, directory.c_str());
+  }
+  return failures;
+}
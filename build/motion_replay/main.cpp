@@ -0,0 +1,203 @@
+#include <MotionCore.h>
+#include <memory/LogReader.h>
+#include <memory/IndexedLog.h>
+#include <memory/FrameInfoBlock.h>
+#include <memory/SensorBlock.h>
+#include <memory/JointBlock.h>
+#include <memory/JointCommandBlock.h>
+#include <memory/OdometryBlock.h>
+#include <memory/WalkRequestBlock.h>
+#include <memory/KickRequestBlock.h>
+#include <memory/KickParamBlock.h>
+#include <memory/WalkParamBlock.h>
+#include <memory/ALWalkParamBlock.h>
+#include <memory/SyncChannelBlock.h>
+#include <common/LatencyTrace.h>
+#include <common/TimingHistogram.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+
+// Runs MotionCore on the sensors and vision requests recorded in a log, one motion
+// frame per logged frame and as fast as it will go. The joint commands and odometry
+// it produces can be written out as a log of their own and checked against an earlier
+// replay, so a walk change can be run on the same recordings before and after.
+
+// Blocks written to the output log for every frame
+static const char* OUTPUT_BLOCKS[] = {"frame_info", "raw_joint_commands", "processed_joint_commands", "odometry"};
+
+static void usage(const char* name) {
+  fprintf(stderr, "Usage: %s <log directory> [--out <directory>] [--reference <directory>] [--tolerance <degrees>]\n", name);
+  fprintf(stderr, "  --out        write the joint commands and odometry of every frame to <directory>/frames.ulog\n");
+  fprintf(stderr, "  --reference  compare them against the output of an earlier replay of the same log\n");
+  fprintf(stderr, "  --tolerance  largest joint command difference allowed by --reference, default 0\n");
+}
+
+// Copies the logged block over the core's, false if this frame of the log doesn't have it
+template <class T>
+static bool copyBlock(Memory& log, const char* name, T* to) {
+  T* from;
+  if (!log.getBlockByName(from, name, false)) return false;
+  *to = *from;
+  return true;
+}
+
+// Hands motion the vision requests logged with the frame, as VisionCore::publishData would
+static void publishVision(Memory& log, Memory& memory) {
+  SyncChannelBlock* channels;
+  WalkRequestBlock* walk_request;
+  KickRequestBlock* kick_request;
+  JointCommandBlock* joint_commands;
+  KickParamBlock *kick_params, *logged_kick_params;
+  WalkParamBlock *walk_param, *logged_walk_param;
+  ALWalkParamBlock *al_walk_param, *logged_al_walk_param;
+  memory.getBlockByName(channels, "sync_channels", true, MemoryOwner::SYNC);
+  memory.getBlockByName(walk_request, "sync_walk_request", true, MemoryOwner::SYNC);
+  memory.getBlockByName(kick_request, "sync_kick_request", true, MemoryOwner::SYNC);
+  memory.getBlockByName(joint_commands, "sync_joint_commands", true, MemoryOwner::SYNC);
+  memory.getBlockByName(kick_params, "sync_kick_params", true, MemoryOwner::SYNC);
+  memory.getBlockByName(walk_param, "sync_walk_param", true, MemoryOwner::SYNC);
+  memory.getBlockByName(al_walk_param, "sync_al_walk_param", true, MemoryOwner::SYNC);
+  log.getBlockByName(logged_kick_params, "vision_kick_params", false);
+  log.getBlockByName(logged_walk_param, "vision_walk_param", false);
+  log.getBlockByName(logged_al_walk_param, "vision_al_walk_param", false);
+
+  channels->vision_.write([&] {
+    copyBlock(log, "vision_walk_request", walk_request);
+    copyBlock(log, "vision_kick_request", kick_request);
+    copyBlock(log, "vision_joint_commands", joint_commands);
+    if (logged_kick_params && logged_kick_params->send_params_) {
+      *kick_params = *logged_kick_params;
+      channels->kick_params_sent_++;
+    }
+    if (logged_walk_param && logged_walk_param->send_params_) {
+      *walk_param = *logged_walk_param;
+      channels->walk_param_sent_++;
+    }
+    if (logged_al_walk_param && logged_al_walk_param->send_params_) {
+      *al_walk_param = *logged_al_walk_param;
+      channels->al_walk_param_sent_++;
+    }
+  });
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argv[1][0] == '-') {
+    usage(argv[0]);
+    return 1;
+  }
+  std::string directory = argv[1], out, reference;
+  float tolerance = 0;
+  for (int i = 2; i < argc; i++) {
+    if (!strcmp(argv[i], "--out") && i + 1 < argc)
+      out = argv[++i];
+    else if (!strcmp(argv[i], "--reference") && i + 1 < argc)
+      reference = argv[++i];
+    else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc)
+      tolerance = DEG_T_RAD * atof(argv[++i]);
+    else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  LogReader reader(directory);
+  unsigned int frames = reader.mdata().frames;
+  Memory log(false, MemoryOwner::TOOL_MEM, 0, 1);
+
+  MotionCore core(CORE_TOOL, false, 0, 1);
+  Memory& memory = core.memory_;
+
+  IndexedLogWriter writer;
+  std::vector<std::string> output_blocks(OUTPUT_BLOCKS, OUTPUT_BLOCKS + sizeof(OUTPUT_BLOCKS) / sizeof(OUTPUT_BLOCKS[0]));
+  if (!out.empty()) {
+    mkdir(out.c_str(), S_IRWXU);
+    if (!writer.open(IndexedLogFormat::filename(out))) {
+      fprintf(stderr, "Couldn't open %s for writing\n", IndexedLogFormat::filename(out).c_str());
+      return 1;
+    }
+  }
+
+  LogReader* reference_reader = NULL;
+  Memory reference_memory(false, MemoryOwner::TOOL_MEM, 0, 1);
+  if (!reference.empty()) {
+    reference_reader = new LogReader(reference);
+  }
+
+  LatencyHistogram latency;
+  unsigned int replayed = 0, mismatches = 0, first_mismatch = 0;
+  float command_error = 0;
+  Pose2D odometry(0, 0, 0);
+  double replay_time = 0;
+  for (unsigned int frame = 0; frame < frames; frame++) {
+    if (!reader.readFrame(frame, log) || !copyBlock(log, "raw_sensors", core.raw_sensors_) ||
+        !copyBlock(log, "raw_joint_angles", core.raw_joint_angles_))
+      continue;
+    copyBlock(log, "frame_info", core.frame_info_);
+    // logs are usually taken at the vision rate, so renumber the frames to keep
+    // motion from treating every gap as a skipped frame
+    core.frame_info_->frame_id = frame + 1;
+    publishVision(log, memory);
+
+    double start = TimingHistogram::now();
+    core.preProcess();
+    core.receiveData();
+    core.processMotionFrame();
+    core.postProcess();
+    double end = TimingHistogram::now();
+    latency.add((end - start) * 1e6);
+    replay_time += end - start;
+
+    odometry += core.odometry_->displacement;
+    if (writer.isOpen())
+      writer.writeMemory(memory, output_blocks);
+    // the output log only has the frames that were replayed, so they line up by count
+    if (reference_reader && replayed < reference_reader->mdata().frames) {
+      JointCommandBlock* expected;
+      reference_reader->readFrame(replayed, reference_memory);
+      if (reference_memory.getBlockByName(expected, "raw_joint_commands", false)) {
+        float error = 0;
+        for (int i = 0; i < NUM_JOINTS; i++)
+          error = std::max(error, std::fabs(expected->angles_[i] - core.raw_joint_commands_->angles_[i]));
+        if (error > tolerance && !mismatches++)
+          first_mismatch = frame;
+        command_error = std::max(command_error, error);
+      }
+    }
+    // odometry goes to vision, and is reset, once the frame is published
+    core.publishData();
+    replayed++;
+  }
+  if (writer.isOpen())
+    writer.close();
+
+  printf("Replayed %u of %u frames from %s", replayed, frames, directory.c_str());
+  if (replayed < frames)
+    printf(", the rest have no raw sensors or joint angles");
+  printf("\n");
+  if (!replayed) return 1;
+  printf("%.0f frames/s, %.1fx real time at 100 Hz\n", replayed / replay_time, replayed * 0.01 / replay_time);
+  printf("frame [ms]: mean %.3f p50 %.3f p99 %.3f max %.3f\n", latency.mean() / 1000, latency.percentile(0.5) / 1000.0,
+      latency.percentile(0.99) / 1000.0, latency.max() / 1000.0);
+  printf("odometry: %.1f mm, %.1f mm, %.1f deg\n", odometry.translation.x, odometry.translation.y,
+      RAD_T_DEG * odometry.rotation);
+  LatencyTracer::collect();
+  LatencyTracer::print();
+  if (reference_reader) {
+    printf("largest joint command difference from %s: %.4f deg\n", reference.c_str(), RAD_T_DEG * command_error);
+    unsigned int reference_frames = reference_reader->mdata().frames;
+    delete reference_reader;
+    if (reference_frames != replayed) {
+      printf("%s has %u frames, this replay has %u\n", reference.c_str(), reference_frames, replayed);
+      return 1;
+    }
+    if (mismatches) {
+      printf("%u frames over the %.4f deg tolerance, the first is frame %u\n", mismatches, RAD_T_DEG * tolerance, first_mismatch);
+      return 1;
+    }
+  }
+  return 0;
+}
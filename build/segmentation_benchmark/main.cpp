@@ -0,0 +1,86 @@
+#include <vision/SegmentationKernels.h>
+#include <vision/ColorTableMethods.h>
+#include <common/RobotInfo.h>
+#include <common/Profiling.h>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+// Checks SegmentationKernels::classifyRow against the per-pixel xy2color loop that
+// Classifier::classifyImage used to run, byte for byte over the whole segmented image,
+// for even and odd strides and area bounds. Then times both on full rows.
+
+static const int WIDTH = 640, HEIGHT = 480, VSTEP = 2;
+// anything the kernel writes outside its area shows up against this
+static const unsigned char UNTOUCHED = 0xAA;
+
+// Classifier::classifyImage before the kernels
+static void legacyClassify(const unsigned char* img, const unsigned char* colorTable, unsigned char* seg, int x1, int x2, int hstep) {
+  for(int y = 0; y < HEIGHT; y += VSTEP) {
+    for(int x = x1; x <= x2; x += hstep) {
+      auto c = ColorTableMethods::xy2color(img, colorTable, x, y, WIDTH);
+      seg[WIDTH * y + x] = c;
+    }
+  }
+}
+
+static void kernelClassify(const unsigned char* img, const unsigned char* colorTable, unsigned char* seg, int x1, int x2, int hstep) {
+  for(int y = 0; y < HEIGHT; y += VSTEP) {
+    const unsigned char* row = img + WIDTH * y * 2;
+    SegmentationKernels::classifyRow(row, colorTable, seg + WIDTH * y, x1, x2, hstep);
+  }
+}
+
+int main(int argc, char** argv) {
+  int reps = argc > 1 ? atoi(argv[1]) : 200;
+
+  srand(1);
+  std::vector<unsigned char> img(WIDTH * HEIGHT * 2), colorTable(LUT_SIZE);
+  for(auto& b : img) b = rand() & 0xFF;
+  for(auto& b : colorTable) b = rand() % NUM_COLORS;
+
+  std::vector<unsigned char> expected(WIDTH * HEIGHT), actual(WIDTH * HEIGHT);
+  const int hsteps[] = { 1, 2, 3, 4, 5 };
+  const int starts[] = { 0, 1, 2, 3, 7 };
+  const int ends[] = { WIDTH - 1, WIDTH - 2, WIDTH - 5, 13 };
+  int cases = 0, failures = 0;
+  for(int hstep : hsteps) {
+    for(int x1 : starts) {
+      for(int x2 : ends) {
+        memset(expected.data(), UNTOUCHED, expected.size());
+        memset(actual.data(), UNTOUCHED, actual.size());
+        legacyClassify(img.data(), colorTable.data(), expected.data(), x1, x2, hstep);
+        kernelClassify(img.data(), colorTable.data(), actual.data(), x1, x2, hstep);
+        cases++;
+        if(expected != actual) {
+          int first = 0;
+          while(expected[first] == actual[first]) first++;
+          printf("MISMATCH hstep %d x %d..%d: first at x %d y %d, %d vs %d\n", hstep, x1, x2,
+              first % WIDTH, first / WIDTH, expected[first], actual[first]);
+          failures++;
+        }
+      }
+    }
+  }
+  printf("%s kernel, %d of %d cases identical to xy2color\n", SegmentationKernels::name(), cases - failures, cases);
+
+  // Full rows as the classifier sees them, reported per row
+  const int rows = HEIGHT / VSTEP;
+  Timer timer;
+  printf("%-8s %14s %14s %8s\n", "hstep", "xy2color [us]", "kernel [us]", "speedup");
+  for(int hstep : hsteps) {
+    timer.start();
+    for(int i = 0; i < reps; i++)
+      legacyClassify(img.data(), colorTable.data(), expected.data(), 0, WIDTH - 1, hstep);
+    timer.stop();
+    double legacyTime = timer.lasttime() / reps / rows;
+    timer.start();
+    for(int i = 0; i < reps; i++)
+      kernelClassify(img.data(), colorTable.data(), actual.data(), 0, WIDTH - 1, hstep);
+    timer.stop();
+    double kernelTime = timer.lasttime() / reps / rows;
+    printf("%-8d %14.3f %14.3f %8.2f\n", hstep, legacyTime * 1e6, kernelTime * 1e6, legacyTime / kernelTime);
+  }
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+#include "Walk2014Generator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Drives two Walk2014Generators through the same walks, one solving the legs in closed
+// form and one from the leg table, and reports the largest difference in the joints they
+// command and the time per tick of each. Also compares the table against turnLeg at
+// random points all over its grid. Exits non-zero if either difference is over the bound.
+
+static const float MAX_ERROR = DEG2RAD(0.25);
+static const int TICKS_PER_COMMAND = 300;
+static const int TICKS_PER_STEP = 25;
+
+static double now() {
+  return std::chrono::duration<double>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+}
+
+static float random(float min, float max) {
+  return min + (max - min) * rand() / RAND_MAX;
+}
+
+static float sample(const WalkTable::Axis& axis) {
+  return random(axis.min, axis.max);
+}
+
+int main(int argc, char** argv) {
+  const int forwards[] = {0, 100, 200, 300, -150, -300};
+  const int lefts[] = {0, 100, 200, -200};
+  const float turns[] = {0, 0.4f, 0.87f, -0.87f};
+
+  Walk2014Generator analytic, table;
+  double start = now();
+  table.buildLegTable();
+  printf("Built the leg table in %.2f s\n", now() - start);
+
+  BodyModel analyticBody, tableBody;
+  for(BodyModel* body : {&analyticBody, &tableBody}) {
+    body->walkKick = body->walkKickStart = false;
+    body->walkKickLeftLeg = false;
+    body->walkKickHeading = 0;
+  }
+  SensorValues sensors;
+  for(int i = 0; i < RSSensors::NUMBER_OF_SENSORS; i++)
+    sensors.sensors[i] = 0;
+  sensors.joints = JointValues(true);
+  Odometry analyticOdometry, tableOdometry;
+
+  // every command in turn, each walked from the last one
+  float walkError = 0, zmp = 1;
+  double analyticTime = 0, tableTime = 0;
+  int ticks = 0;
+  for(int forward : forwards) {
+    for(int left : lefts) {
+      for(float turn : turns) {
+        ActionCommand::Body body(ActionCommand::Body::WALK, forward, left, turn, 1.0, 1.0);
+        ActionCommand::All analyticRequest, tableRequest;
+        analyticRequest.body = tableRequest.body = body;
+        for(int i = 0; i < TICKS_PER_COMMAND; i++, ticks++) {
+          // the support foot changes when the ZMP crosses over
+          for(BodyModel* model : {&analyticBody, &tableBody}) {
+            model->lastZMPL = zmp;
+            model->ZMPL = (ticks / TICKS_PER_STEP) % 2 ? -1 : 1;
+          }
+          zmp = analyticBody.ZMPL;
+
+          double t0 = now();
+          JointValues a = analytic.makeJoints(&analyticRequest, &analyticOdometry, sensors, analyticBody, 0, 0);
+          double t1 = now();
+          JointValues b = table.makeJoints(&tableRequest, &tableOdometry, sensors, tableBody, 0, 0);
+          double t2 = now();
+          analyticTime += t1 - t0;
+          tableTime += t2 - t1;
+          for(int j = 0; j < RSJoints::NUMBER_OF_JOINTS; j++)
+            walkError = std::max(walkError, std::fabs(a.angles[j] - b.angles[j]));
+        }
+      }
+    }
+  }
+
+  // anywhere in the grid, including the corners walks never reach
+  int samples = argc > 1 ? atoi(argv[1]) : 100000;
+  float gridError = 0;
+  int unreachable = 0;
+  double solveTime = 0, lookupTime = 0;
+  srand(1);
+  for(int i = 0; i < samples; i++) {
+    float forward = sample(WalkTable::FORWARD), left = sample(WalkTable::LEFT);
+    float height = sample(WalkTable::HEIGHT), turn = sample(WalkTable::TURN);
+    LegJoints a = analytic.legJoints(forward, left, height), b = a, correction;
+    double t0 = now();
+    analytic.turnLeg(a, turn);
+    double t1 = now();
+    bool found = table.legTable.lookup(forward, left, height, turn, correction);
+    double t2 = now();
+    solveTime += t1 - t0;
+    lookupTime += t2 - t1;
+    // cells with a corner out of the leg's reach are left to turnLeg
+    if(!found) {
+      unreachable++;
+      continue;
+    }
+    b.Hp += correction.Hp;
+    b.Ap += correction.Ap;
+    b.Hr += correction.Hr;
+    b.Ar += correction.Ar;
+    gridError = std::max(gridError, std::max(std::fabs(a.Hp - b.Hp), std::fabs(a.Kp - b.Kp)));
+    gridError = std::max(gridError, std::max(std::fabs(a.Ap - b.Ap), std::max(std::fabs(a.Hr - b.Hr), std::fabs(a.Ar - b.Ar))));
+  }
+
+  printf("%d of %d grid samples out of reach\n", unreachable, samples);
+  printf("%-24s %14s %14s\n", "", "error [deg]", "time [us]");
+  printf("%-24s %14s %14.3f\n", "makeJoints, closed form", "", analyticTime / ticks * 1e6);
+  printf("%-24s %14.4f %14.3f\n", "makeJoints, table", RAD2DEG(walkError), tableTime / ticks * 1e6);
+  printf("%-24s %14s %14.3f\n", "turnLeg", "", solveTime / samples * 1e6);
+  printf("%-24s %14.4f %14.3f\n", "legTable.lookup", RAD2DEG(gridError), lookupTime / samples * 1e6);
+  if(walkError > MAX_ERROR || gridError > MAX_ERROR) {
+    printf("Table error is over the %.2f degree bound\n", RAD2DEG(MAX_ERROR));
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,29 @@
+#include "Walk2014Generator.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// Writes the leg table Walk2014Generator loads from its config directory. Rerun it
+// whenever the leg dimensions, the walk's leg kinematics or the table's grid change,
+// since a table built for anything else is refused at load time.
+
+int main(int argc, char** argv) {
+  std::string file;
+  if(argc > 1)
+    file = argv[1];
+  else if(getenv("NAO_HOME"))
+    file = std::string(getenv("NAO_HOME")) + "/data/config/rswalk2014/walk_table.bin";
+  else {
+    fprintf(stderr, "Usage: %s [file], file defaults to $NAO_HOME/data/config/rswalk2014/walk_table.bin\n", argv[0]);
+    return 1;
+  }
+
+  Walk2014Generator walk;
+  walk.buildLegTable();
+  if(!walk.legTable.save(file)) {
+    fprintf(stderr, "Could not write %s\n", file.c_str());
+    return 1;
+  }
+  printf("Wrote the leg table to %s\n", file.c_str());
+  return 0;
+}
@@ -17,6 +17,7 @@
 #include <memory/WalkRequestBlock.h>
 #include <memory/WalkResponseBlock.h>
 #include <memory/ProcessedSonarBlock.h>
+#include <memory/SyncChannelBlock.h>
 
 #include <kinematics/KinematicsModule.h>
 #include <motion/KickModule.h>
@@ -33,9 +34,11 @@
 #include <common/Calibration.h>
 #include <common/PIDController.h>
 #include <common/RobotCalibration.h>
+#include <common/LatencyTrace.h>
 
 #include <boost/interprocess/sync/named_mutex.hpp>
 #include <boost/lexical_cast.hpp>
+#include <string.h>
 #include <common/RobotConfig.h>
 
 MotionCore *MotionCore::inst_ = NULL;
@@ -66,6 +69,18 @@ MotionCore::MotionCore (CoreType type, bool use_shared_memory,int team_num, int
   sync_walk_param_(NULL),
   sync_al_walk_param_(NULL),
   sync_walk_info_(NULL),
+  sync_motion_walk_request_(NULL),
+  sync_channels_(NULL),
+  vision_sequence_(0),
+  kick_params_sent_(0),
+  walk_param_sent_(0),
+  al_walk_param_sent_(0),
+  trace_dumps_requested_(0),
+  missed_receives_(0),
+  trace_reports_sent_(0),
+  sync_times_(0.00002, 50),
+  frame_periods_(0.0005, 40),
+  last_frame_time_(0),
   fps_frames_processed_(0),
   calibration_(NULL)
 {
@@ -88,8 +103,6 @@ MotionCore::~MotionCore() {
     delete walk_;
   //if (htwk_walk_ != NULL)
     //delete htwk_walk_;
-  if (walk_ != NULL)
-    delete walk_;
 }
 
 void MotionCore::loadCalibration() {
@@ -156,15 +169,32 @@ void MotionCore::processMotionFrame() {
     //std::cout << "processMotionFrame, skipping frame " << frame_info_->frame_id << std::endl;
     return;
   }
+  // a motion frame has to fit in the 10 ms between DCM updates
+  LATENCY_PROBE("motion frame", 0.010);
 
   if (frame_id > last_frame_processed_ + 1) {
     std::cout << "Skipped a frame: went from " << last_frame_processed_ << " to " << frame_id << std::endl;
   }
   // frame rate
+  double now = TimingHistogram::now();
+  if (last_frame_time_ > 0)
+    frame_periods_.add(now - last_frame_time_);
+  last_frame_time_ = now;
   double time_passed = frame_info_->seconds_since_start - fps_time_;
   fps_frames_processed_++;
   if (time_passed >= 10.0) {
     std::cout << "MOTION FRAME RATE: " << fps_frames_processed_ / time_passed << std::endl;
+    if (sync_times_.count() > 0) {
+      frame_periods_.print("Motion frame period");
+      sync_times_.print("Motion/vision sync");
+      if (missed_receives_ > 0)
+        std::cout << "Vision data unreadable in " << missed_receives_ << " frames" << std::endl;
+    }
+    frame_periods_.clear();
+    sync_times_.clear();
+    // keeps the probe rings from filling up between dumps
+    LatencyTracer::collect();
+    missed_receives_ = 0;
     fps_frames_processed_ = 0;
     fps_time_ = frame_info_->seconds_since_start;
   }
@@ -212,6 +242,7 @@ void MotionCore::processMotionFrame() {
 }
 
 void MotionCore::processSensorUpdate() {
+  LATENCY_PROBE("sensor update", 0);
   sensor_->processSensors();
   kinematics_->calculatePose();
   sonar_->processFrame();
@@ -269,6 +300,15 @@ void MotionCore::initMemory() {
   //memory_.addBlockByName("sonar");
 
   memory_.getOrAddBlockByName(frame_info_,"frame_info");
+  // the interface provides the raw blocks and vision shares world_objects and speech with
+  // the walk, in the tool whoever drives the core stands in for both
+  if (type_ == CORE_TOOL) {
+    memory_.addBlockByName("raw_joint_angles");
+    memory_.addBlockByName("raw_joint_commands");
+    memory_.addBlockByName("raw_sensors");
+    memory_.addBlockByName("world_objects",MemoryOwner::SHARED);
+    memory_.addBlockByName("speech",MemoryOwner::SHARED);
+  }
   // joint angles
   memory_.getBlockByName(raw_joint_angles_,"raw_joint_angles");
   memory_.getOrAddBlockByName(processed_joint_angles_,"processed_joint_angles");
@@ -309,6 +349,14 @@ void MotionCore::initMemory() {
   memory_.getOrAddBlockByName(sync_walk_param_,"sync_walk_param",MemoryOwner::SYNC);
   memory_.getOrAddBlockByName(sync_al_walk_param_,"sync_al_walk_param",MemoryOwner::SYNC);
   memory_.getOrAddBlockByName(sync_walk_info_,"sync_walk_info",MemoryOwner::SYNC);
+  memory_.getOrAddBlockByName(sync_motion_walk_request_,"sync_motion_walk_request",MemoryOwner::SYNC);
+  memory_.getOrAddBlockByName(sync_channels_,"sync_channels",MemoryOwner::SYNC);
+  // only pick up params vision sends from here on
+  kick_params_sent_ = sync_channels_->kick_params_sent_;
+  walk_param_sent_ = sync_channels_->walk_param_sent_;
+  al_walk_param_sent_ = sync_channels_->al_walk_param_sent_;
+  trace_dumps_requested_ = sync_channels_->trace_dumps_requested_;
+  trace_reports_sent_ = sync_channels_->trace_reports_sent_;
 
   // Read configuration file and place appropriate values in memory
   if (type_ == CORE_ROBOT) {
@@ -463,61 +511,104 @@ void MotionCore::postProcess() {
 }
 
 void MotionCore::publishData() {
-  memory_.motion_vision_lock_->lock();
-
-  *sync_body_model_ = *body_model_;
-  *sync_joint_angles_ = *processed_joint_angles_;
-  *sync_sensors_ = *processed_sensors_;
-  *sync_odometry_ = *odometry_;
-  sync_kick_request_->kick_running_ = kick_request_->kick_running_;
-  sync_kick_request_->finished_with_step_ = kick_request_->finished_with_step_;
+  double start = TimingHistogram::now();
+
+  // the walk has seen these, they should only be acted on once
+  walk_request_->new_command_ = false;
+  walk_request_->slow_stand_ = false;
+  walk_request_->set_kick_step_params_ = false;
+
+  // motion is the only writer of these blocks, so this never waits on vision
+  sync_channels_->motion_.write([&] {
+    *sync_body_model_ = *body_model_;
+    *sync_joint_angles_ = *processed_joint_angles_;
+    *sync_sensors_ = *processed_sensors_;
+    *sync_odometry_ = *odometry_;
+    sync_channels_->kick_running_ = kick_request_->kick_running_;
+    sync_channels_->finished_with_step_ = kick_request_->finished_with_step_;
+    if (odometry_->didKick)
+      sync_channels_->kicks_++;
+    sync_channels_->odometry_x_ += odometry_->displacement.translation.x;
+    sync_channels_->odometry_y_ += odometry_->displacement.translation.y;
+    sync_channels_->odometry_rotation_ += odometry_->displacement.rotation;
+    if (!trace_report_.empty()) {
+      strncpy(sync_channels_->trace_report_, trace_report_.c_str(), SyncChannelBlock::TRACE_REPORT_LENGTH - 1);
+      sync_channels_->trace_report_[SyncChannelBlock::TRACE_REPORT_LENGTH - 1] = 0;
+      sync_channels_->trace_reports_sent_ = ++trace_reports_sent_;
+    }
 
-  *sync_walk_request_ = *walk_request_;
-  *sync_walk_response_ = *walk_response_;
-  sync_walk_request_->new_command_ = false;
-  sync_walk_request_->slow_stand_ = false;
-  sync_walk_request_->set_kick_step_params_ = false;
+    *sync_motion_walk_request_ = *walk_request_;
+    *sync_walk_response_ = *walk_response_;
+    *sync_processed_sonar_ = *processed_sonar_;
+    *sync_walk_info_ = *walk_info_;
+  });
 
-  *sync_processed_sonar_ = *processed_sonar_;
-  *sync_walk_info_ = *walk_info_;
+  // the totals above carry the odometry now, start the next frame from zero
+  odometry_->reset();
+  trace_report_.clear();
 
-  memory_.motion_vision_lock_->unlock();
+  sync_times_.add(TimingHistogram::now() - start);
 }
 
 void MotionCore::receiveData() {
-  memory_.motion_vision_lock_->lock();
-
-  bool typechange = false;
-  if(walk_request_->walk_type_ != sync_walk_request_->walk_type_)
-    typechange = true;
-
-  *kick_request_ = *sync_kick_request_;
-  *walk_request_ = *sync_walk_request_;
-  *processed_joint_commands_ = *sync_joint_commands_;
-  *odometry_ = *sync_odometry_;
-
-  if (sync_kick_params_->send_params_) {
-    *kick_params_ = *sync_kick_params_;
-    sync_kick_params_->send_params_ = false;
-  }
-  if (sync_walk_param_->send_params_) {
-    *walk_param_ = *sync_walk_param_;
-    sync_walk_param_->send_params_ = false;
-  }
-  if (sync_al_walk_param_->send_params_){
-    *al_walk_param_ = *sync_al_walk_param_;
-    sync_al_walk_param_->send_params_ = false;
-  }
-  
-  if(typechange) {
-    initWalkEngine();
+  double start = TimingHistogram::now();
+
+  // the kick state is motion's, the rest of the kick request comes from vision
+  bool kick_running = kick_request_->kick_running_;
+  bool finished_with_step = kick_request_->finished_with_step_;
+  auto walk_type = walk_request_->walk_type_;
+
+  unsigned int sequence, kick_params_sent, walk_param_sent, al_walk_param_sent, trace_dumps_requested;
+  bool received = sync_channels_->vision_.read([&](unsigned int s) {
+    sequence = s;
+    *kick_request_ = *sync_kick_request_;
+    *processed_joint_commands_ = *sync_joint_commands_;
+    odometry_->fall_direction_ = sync_channels_->fall_direction_;
+    // between vision frames motion keeps its own copy of the walk request
+    if (s != vision_sequence_)
+      *walk_request_ = *sync_walk_request_;
+
+    kick_params_sent = sync_channels_->kick_params_sent_;
+    walk_param_sent = sync_channels_->walk_param_sent_;
+    al_walk_param_sent = sync_channels_->al_walk_param_sent_;
+    trace_dumps_requested = sync_channels_->trace_dumps_requested_;
+    if (kick_params_sent != kick_params_sent_)
+      *kick_params_ = *sync_kick_params_;
+    if (walk_param_sent != walk_param_sent_)
+      *walk_param_ = *sync_walk_param_;
+    if (al_walk_param_sent != al_walk_param_sent_)
+      *al_walk_param_ = *sync_al_walk_param_;
+  });
+
+  kick_request_->kick_running_ = kick_running;
+  kick_request_->finished_with_step_ = finished_with_step;
+
+  if (received) {
+    vision_sequence_ = sequence;
+    kick_params_sent_ = kick_params_sent;
+    walk_param_sent_ = walk_param_sent;
+    al_walk_param_sent_ = al_walk_param_sent;
+    if (walk_request_->walk_type_ != walk_type)
+      initWalkEngine();
+    if (trace_dumps_requested != trace_dumps_requested_) {
+      // report everything since the last dump and start over
+      trace_dumps_requested_ = trace_dumps_requested;
+      LatencyTracer::collect();
+      trace_report_ = LatencyTracer::report();
+      printf("%s", trace_report_.c_str());
+      LatencyTracer::clear();
+    }
+  } else {
+    // only happens if vision died mid publish, the watchdog restarts it
+    missed_receives_++;
   }
 
-  memory_.motion_vision_lock_->unlock();
+  sync_times_.add(TimingHistogram::now() - start);
 }
 
 
 void MotionCore::updateOdometry(){
+  LATENCY_PROBE("odometry", 0);
   // TODO RE-ENABLE ODOMETRY
 /*
   // set if standing or walking
@@ -5,6 +5,7 @@
 #include <memory/Logger.h>
 #include <memory/TextLogger.h>
 #include <common/InterfaceInfo.h> // for core_type
+#include <common/TimingHistogram.h>
 
 class BodyModelBlock;
 class FrameInfoBlock;
@@ -21,6 +22,7 @@ class WalkRequestBlock;
 class WalkResponseBlock;
 class ProcessedSonarBlock;
 class WalkInfoBlock;
+class SyncChannelBlock;
 class RobotInfoBlock;
 //class WorldObjectBlock; //for rswalk2014
 class RobotStateBlock;
@@ -116,6 +118,22 @@ private:
   WalkParamBlock *sync_walk_param_;
   ALWalkParamBlock *sync_al_walk_param_;
   WalkInfoBlock* sync_walk_info_;
+  WalkRequestBlock *sync_motion_walk_request_;
+  SyncChannelBlock *sync_channels_;
+
+  // what has been taken from vision so far
+  unsigned int vision_sequence_;
+  unsigned int kick_params_sent_, walk_param_sent_, al_walk_param_sent_;
+  unsigned int trace_dumps_requested_;
+  unsigned int missed_receives_;
+
+  // latency report waiting to be published, and how many have been published
+  std::string trace_report_;
+  unsigned int trace_reports_sent_;
+
+  TimingHistogram sync_times_;
+  TimingHistogram frame_periods_;
+  double last_frame_time_;
 
   double fps_time_;
   unsigned int fps_frames_processed_;
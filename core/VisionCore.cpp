@@ -18,6 +18,7 @@
 #include <memory/WalkParamBlock.h>
 #include <memory/ALWalkParamBlock.h>
 #include <memory/WalkInfoBlock.h>
+#include <memory/SyncChannelBlock.h>
 #include <memory/RobotStateBlock.h>
 #include <memory/RobotVisionBlock.h>
 #include <memory/WorldObjectBlock.h>
@@ -37,6 +38,7 @@
 #include <python/PythonInterface.h>
 
 #include <iostream>
+#include <string.h>
 
 VisionCore *VisionCore::inst_ = NULL;
 LocalizationMethod::Type LocalizationMethod::DEFAULT = LocalizationMethod::Default;
@@ -73,12 +75,23 @@ VisionCore::VisionCore (CoreType type, bool use_shared_memory, int team_num, int
   sync_walk_param_(NULL),
   sync_al_walk_param_(NULL),
   sync_walk_info_(NULL),
+  sync_motion_walk_request_(NULL),
+  sync_channels_(NULL),
+  motion_kicks_(0),
+  motion_odometry_x_(0),
+  motion_odometry_y_(0),
+  motion_odometry_rotation_(0),
+  motion_finished_standing_(false),
+  motion_trace_requested_(false),
+  motion_trace_reports_(0),
   frames_to_log_(0),
   disable_log_(false),
   is_logging_(false)
 {
   init(team_num, player_num);
   initModules(locMethod);
+  // Keep disk writes off the vision thread
+  log_->setAsync(true);
   vtimer_.setInterval(30 * 5);
   camtimer_.setInterval(30 * 5);
 }
@@ -86,7 +99,7 @@ VisionCore::VisionCore (CoreType type, bool use_shared_memory, int team_num, int
 VisionCore::~VisionCore() {
   // stop walking
   if ((sync_walk_request_ != NULL)  && (sync_walk_request_->motion_ == WalkRequestBlock::WALK)) {
-    sync_walk_request_->stand();
+    sync_channels_->vision_.write([&] { sync_walk_request_->stand(); });
   }
 
   // clean up modules
@@ -154,6 +167,8 @@ void VisionCore::processVisionFrame() {
 #ifndef TOOL
     printf("Vision: %2.2f Hz [%2.2f ms] (capped by %2.2f Hz [%2.2f ms] with camera)\n", 
       vtimer_.avgrate(), vtimer_.avgtime() * 1000, camtimer_.avgrate(), camtimer_.avgtime() * 1000);
+    if(is_logging_)
+      printf("Logging: queue depth %u (max %u), %u frames dropped\n", log_->queueDepth(), log_->maxQueueDepth(), log_->droppedFrames());
 #endif
   }
 }
@@ -240,7 +255,7 @@ void VisionCore::initModules(LocalizationMethod::Type locMethod) {
   audio_ = new AudioModule();
   audio_->init(memory_,&textlog_);
   
-  localization_ = new LocalizationModule();
+  localization_ = new LocalizationModule(locMethod);
   localization_->init(memory_,&textlog_);
 
   opponents_ = new OppModule();
@@ -313,6 +328,16 @@ void VisionCore::initMemory() {
     memory_->getOrAddBlockByName(sync_walk_param_,"sync_walk_param",MemoryOwner::SYNC);
     memory_->getOrAddBlockByName(sync_al_walk_param_,"sync_al_walk_param",MemoryOwner::SYNC);
     memory_->getOrAddBlockByName(sync_walk_info_,"sync_walk_info",MemoryOwner::SYNC);
+    memory_->getOrAddBlockByName(sync_motion_walk_request_,"sync_motion_walk_request",MemoryOwner::SYNC);
+    memory_->getOrAddBlockByName(sync_channels_,"sync_channels",MemoryOwner::SYNC);
+    // odometry motion accumulated before vision started isn't ours
+    sync_channels_->motion_.read([&](unsigned int) {
+      motion_kicks_ = sync_channels_->kicks_;
+      motion_odometry_x_ = sync_channels_->odometry_x_;
+      motion_odometry_y_ = sync_channels_->odometry_y_;
+      motion_odometry_rotation_ = sync_channels_->odometry_rotation_;
+      motion_trace_reports_ = sync_channels_->trace_reports_sent_;
+    });
   }
 
   // print out all the memory blocks we're using
@@ -379,6 +404,11 @@ void VisionCore::startDisableLogging(){
   }
 }
 
+void VisionCore::requestMotionTrace() {
+  // picked up by the next publishData, the report comes back through receiveData
+  motion_trace_requested_ = true;
+}
+
 void VisionCore::disableLogging() {
   if(!is_logging_) return;
   disableMemoryLogging();
@@ -486,30 +516,36 @@ void VisionCore::publishData() {
   //std::cout << "publishDATA" << std::endl;
   // SHOULD BE CALLED WHILE VISION LOCK IS NOT HELD
 
-  memory_->motion_vision_lock_->lock();
-  // copy over data to the motion process
-  bool temp_kick_running = sync_kick_request_->kick_running_;
-  bool temp_finished_with_step = sync_kick_request_->finished_with_step_;
-  *sync_kick_request_ = *vision_kick_request_;
-  sync_kick_request_->kick_running_ = temp_kick_running;
-  sync_kick_request_->finished_with_step_ = temp_finished_with_step;
-  //std::cout << "vis: " << vision_walk_request_->step_into_kick_ << std::endl;
-  bool temp_finished_standing = sync_walk_request_->finished_standing_;
-  *sync_walk_request_ = *vision_walk_request_;
-  if(temp_finished_standing && !vision_walk_request_->start_command_)
-    sync_walk_request_->finished_standing_ = temp_finished_standing;
-  sync_walk_request_->start_command_ = vision_walk_request_->start_command_ = false;
-  // just so motion has this info from vision
-  sync_odometry_->fall_direction_ = vision_odometry_->fall_direction_;
-  //std::cout << vision_walk_request_->odometry_fwd_offset_ << std::endl;
-  *sync_joint_commands_ = *vision_joint_commands_;
-  if (vision_kick_params_->send_params_)
-    *sync_kick_params_ = *vision_kick_params_;
-  if (vision_walk_param_->send_params_)
-    *sync_walk_param_ = *vision_walk_param_;
-  if (vision_al_walk_param_->send_params_)
-    *sync_al_walk_param_ = *vision_al_walk_param_;
-  memory_->motion_vision_lock_->unlock();
+  // vision is the only writer of these blocks, motion picks them up without waiting on us
+  sync_channels_->vision_.write([&] {
+    // motion keeps its own kick running flags, so the request can be copied whole
+    *sync_kick_request_ = *vision_kick_request_;
+    //std::cout << "vis: " << vision_walk_request_->step_into_kick_ << std::endl;
+    *sync_walk_request_ = *vision_walk_request_;
+    if(motion_finished_standing_ && !vision_walk_request_->start_command_)
+      sync_walk_request_->finished_standing_ = true;
+    sync_walk_request_->start_command_ = vision_walk_request_->start_command_ = false;
+    // just so motion has this info from vision
+    sync_channels_->fall_direction_ = vision_odometry_->fall_direction_;
+    //std::cout << vision_walk_request_->odometry_fwd_offset_ << std::endl;
+    *sync_joint_commands_ = *vision_joint_commands_;
+    if (vision_kick_params_->send_params_) {
+      *sync_kick_params_ = *vision_kick_params_;
+      sync_channels_->kick_params_sent_++;
+    }
+    if (vision_walk_param_->send_params_) {
+      *sync_walk_param_ = *vision_walk_param_;
+      sync_channels_->walk_param_sent_++;
+    }
+    if (vision_al_walk_param_->send_params_) {
+      *sync_al_walk_param_ = *vision_al_walk_param_;
+      sync_channels_->al_walk_param_sent_++;
+    }
+    if (motion_trace_requested_) {
+      sync_channels_->trace_dumps_requested_++;
+      motion_trace_requested_ = false;
+    }
+  });
 
   // copy over data to the interface's vision thread
   memory_->vision_lock_->lock();
@@ -526,33 +562,69 @@ void VisionCore::receiveData() {
   *vision_frame_info_ = *raw_vision_frame_info_;
   camera_info_->copyFromImageCapture(raw_camera_info_);
 
-  memory_->motion_vision_lock_->lock();
+  float fwdOffset = vision_walk_request_->odometry_fwd_offset_;
+  float sideOffset = vision_walk_request_->odometry_side_offset_;
+  float turnOffset = vision_walk_request_->odometry_turn_offset_;
+  auto walk_type = vision_walk_request_->walk_type_;
+
+  // motion publishes without waiting on us, the copy is retried if it overlapped a write
+  unsigned int kicks, trace_reports;
+  double odometry_x, odometry_y, odometry_rotation;
+  char trace_report[SyncChannelBlock::TRACE_REPORT_LENGTH];
+  bool received = sync_channels_->motion_.read([&](unsigned int) {
+    if (type_ != CORE_TOOLSIM){
+      // copy over data from the motion process
+      *vision_body_model_ = *sync_body_model_;
+      *vision_joint_angles_ = *sync_joint_angles_;
+      *vision_sensors_ = *sync_sensors_;
+      *vision_odometry_ = *sync_odometry_;
+    }
+    kicks = sync_channels_->kicks_;
+    odometry_x = sync_channels_->odometry_x_;
+    odometry_y = sync_channels_->odometry_y_;
+    odometry_rotation = sync_channels_->odometry_rotation_;
+    trace_reports = sync_channels_->trace_reports_sent_;
+    if (trace_reports != motion_trace_reports_)
+      memcpy(trace_report, sync_channels_->trace_report_, sizeof(trace_report));
+
+    vision_kick_request_->kick_running_ = sync_channels_->kick_running_;
+    vision_kick_request_->finished_with_step_ = sync_channels_->finished_with_step_;
+    *vision_walk_request_ = *sync_motion_walk_request_;
+    *vision_walk_response_ = *sync_walk_response_;
+    *vision_walk_info_ = *sync_walk_info_;
+    *vision_processed_sonar_ = *sync_processed_sonar_;
+  });
+  if (!received)
+    std::cerr << "VisionCore::receiveData: motion data was unreadable" << std::endl;
+  else if (trace_reports != motion_trace_reports_) {
+    motion_trace_reports_ = trace_reports;
+    trace_report[sizeof(trace_report) - 1] = 0;
+    if (communications_)
+      communications_->sendToolResponse(ToolPacket(ToolPacket::MotionTraceDump, trace_report));
+  }
+
   static double cum_x=0, cum_y=0, cum_rot= 0;
   if (type_ != CORE_TOOLSIM){
-    // copy over data from the motion process
-    *vision_body_model_ = *sync_body_model_;
-    *vision_joint_angles_ = *sync_joint_angles_;
-    *vision_sensors_ = *sync_sensors_;
-    // odom
-    *vision_odometry_ = *sync_odometry_;
+    // odom: motion keeps running totals, we take what has been added since the last frame
+    if (received) {
+      vision_odometry_->displacement = Pose2D(odometry_rotation - motion_odometry_rotation_, odometry_x - motion_odometry_x_, odometry_y - motion_odometry_y_);
+      vision_odometry_->didKick = (kicks != motion_kicks_);
+      motion_kicks_ = kicks;
+      motion_odometry_x_ = odometry_x;
+      motion_odometry_y_ = odometry_y;
+      motion_odometry_rotation_ = odometry_rotation;
+    } else
+      vision_odometry_->reset();
     cum_x += vision_odometry_->displacement.translation.x;
     cum_y += vision_odometry_->displacement.translation.y;
     cum_rot += vision_odometry_->displacement.rotation;
     //cout << "Vision Cumul. Odometry: " << cum_x << ", " << cum_y << ", " <<cum_rot<< endl;;
-    sync_odometry_->reset();
   }
 
   // kick request
-  vision_kick_request_->kick_running_ = sync_kick_request_->kick_running_;
-  vision_kick_request_->finished_with_step_ = sync_kick_request_->finished_with_step_;
   vision_kick_request_->kick_type_ = Kick::NO_KICK;
   vision_kick_request_->vision_kick_running_ = false;
-  float fwdOffset = vision_walk_request_->odometry_fwd_offset_;
-  float sideOffset = vision_walk_request_->odometry_side_offset_;
-  float turnOffset = vision_walk_request_->odometry_turn_offset_;
-  auto walk_type = vision_walk_request_->walk_type_;
-  *vision_walk_request_ = *sync_walk_request_;
-  *vision_walk_response_ = *sync_walk_response_;
+  motion_finished_standing_ = vision_walk_request_->finished_standing_;
   vision_walk_request_->odometry_fwd_offset_ = fwdOffset;
   vision_walk_request_->odometry_side_offset_ = sideOffset;
   vision_walk_request_->odometry_turn_offset_ = turnOffset;
@@ -566,12 +638,6 @@ void VisionCore::receiveData() {
   vision_al_walk_param_->send_params_ = false;
   vision_kick_params_->send_params_ = false;
 
-  // walk
-  *vision_walk_info_ = *sync_walk_info_;
-
-  //sonar
-  *vision_processed_sonar_ = *sync_processed_sonar_;
-
   // joint commands
   // Todd: no need to receive these here
   // just reset them to sending no commands
@@ -581,9 +647,6 @@ void VisionCore::receiveData() {
   vision_joint_commands_->send_stiffness_ = false;
   vision_joint_commands_->send_sonar_command_ = false;
   vision_joint_commands_->send_arm_angles_  = false;
-
-  memory_->motion_vision_lock_->unlock();
-
 }
 
 void VisionCore::motionLock() {
@@ -8,6 +8,7 @@
 #include <memory/Logger.h>
 #include <memory/TextLogger.h>
 #include <math/Vector2.h>
+#include <localization/LocalizationMethod.h>
 
 class CommunicationModule;
 class PerfectLocalizationModule;
@@ -19,15 +20,9 @@ class ButtonModule;
 class LEDModule;
 class AudioModule;
 class ImageCapture;
+class SyncChannelBlock;
 
 class LocalizationModule;
-class LocalizationMethod {
-  public:
-    enum Type {
-      Default
-    };
-    static Type DEFAULT;
-};
 
 class VisionCore {
 public:
@@ -44,6 +39,8 @@ public:
   void startDisableLogging();
   void enableTextLogging(const char *filename = NULL);
   void disableTextLogging();
+  // Has motion send its latency report, which is forwarded to the tool
+  void requestMotionTrace();
 
   void updateMemory(Memory* memory, bool locOnly = false);
   void setMemoryVariables();
@@ -117,6 +114,16 @@ private:
   WalkParamBlock *sync_walk_param_;
   ALWalkParamBlock *sync_al_walk_param_;
   WalkInfoBlock *sync_walk_info_;
+  WalkRequestBlock *sync_motion_walk_request_;
+  SyncChannelBlock *sync_channels_;
+
+  // motion's running totals as of the last frame vision read
+  unsigned int motion_kicks_;
+  double motion_odometry_x_, motion_odometry_y_, motion_odometry_rotation_;
+  bool motion_finished_standing_;
+  // trace dump waiting to go to motion, and the last report forwarded to the tool
+  bool motion_trace_requested_;
+  unsigned int motion_trace_reports_;
 
   unsigned int frames_to_log_;
   double log_interval_;
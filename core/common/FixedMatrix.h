@@ -0,0 +1,223 @@
+#ifndef FIXED_MATRIX_H
+#define FIXED_MATRIX_H
+
+#include <math.h>
+#include <string.h>
+#include <common/NMatrix.h>
+
+/* Row major MxN float matrix held inline, so filters built on it never touch the heap.
+ * The operations mirror NMatrix one for one, including the order values are
+ * accumulated in, so porting a filter from NMatrix leaves its results unchanged.
+ * Dimensions are checked at compile time instead of being silently zeroed. */
+template <int M, int N>
+class FixedMatrix {
+  public:
+    float X[M * N];
+
+    FixedMatrix(bool I = false) {
+      memset(X, 0, sizeof(X));
+      if(I && M == N)
+        for(int i = 0; i < M; i++)
+          (*this)[i][i] = 1;
+    }
+
+    // Conversions for code that still passes NMatrix around
+    explicit FixedMatrix(const NMatrix& a) {
+      memset(X, 0, sizeof(X));
+      if(a.getm() == M && a.getn() == N)
+        memcpy(X, a.getx(), sizeof(X));
+    }
+    NMatrix toNMatrix() const {
+      NMatrix a(M, N);
+      memcpy(a.getx(), X, sizeof(X));
+      return a;
+    }
+
+    static inline int getm() { return M; }
+    static inline int getn() { return N; }
+
+    // Returns a pointer to the ith row, as NMatrix does
+    inline float* operator[](int i) { return &X[i * N]; }
+    inline const float* operator[](int i) const { return &X[i * N]; }
+
+    FixedMatrix<N,M> transp() const {
+      FixedMatrix<N,M> t;
+      for(int i = 0; i < M; i++)
+        for(int j = 0; j < N; j++)
+          t[j][i] = (*this)[i][j];
+      return t;
+    }
+
+    FixedMatrix<1,N> getRow(int index) const {
+      FixedMatrix<1,N> row;
+      for(int i = 0; i < N; i++)
+        row[0][i] = (*this)[index][i];
+      return row;
+    }
+
+    FixedMatrix<M,1> getCol(int index) const {
+      FixedMatrix<M,1> col;
+      for(int i = 0; i < M; i++)
+        col[i][0] = (*this)[i][index];
+      return col;
+    }
+
+    void setRow(int index, const FixedMatrix<1,N>& in) {
+      for(int i = 0; i < N; i++)
+        (*this)[index][i] = in[0][i];
+    }
+
+    void setCol(int index, const FixedMatrix<M,1>& in) {
+      for(int i = 0; i < M; i++)
+        (*this)[i][index] = in[i][0];
+    }
+};
+
+template <int M, int N>
+FixedMatrix<M,N> operator+(const FixedMatrix<M,N>& a, const FixedMatrix<M,N>& b) {
+  FixedMatrix<M,N> c;
+  for(int i = 0; i < M * N; i++)
+    c.X[i] = a.X[i] + b.X[i];
+  return c;
+}
+
+template <int M, int N>
+FixedMatrix<M,N> operator-(const FixedMatrix<M,N>& a, const FixedMatrix<M,N>& b) {
+  FixedMatrix<M,N> c;
+  for(int i = 0; i < M * N; i++)
+    c.X[i] = a.X[i] - b.X[i];
+  return c;
+}
+
+template <int M, int K, int N>
+FixedMatrix<M,N> operator*(const FixedMatrix<M,K>& a, const FixedMatrix<K,N>& b) {
+  FixedMatrix<M,N> c;
+  for(int i = 0; i < M; i++) {
+    for(int j = 0; j < N; j++) {
+      float temp = 0;
+      for(int k = 0; k < K; k++)
+        temp += a[i][k] * b[k][j];
+      c[i][j] = temp;
+    }
+  }
+  return c;
+}
+
+template <int M, int N>
+FixedMatrix<M,N> operator*(const float& a, const FixedMatrix<M,N>& b) {
+  FixedMatrix<M,N> c;
+  for(int i = 0; i < M * N; i++)
+    c.X[i] = b.X[i] * a;
+  return c;
+}
+
+template <int M, int N>
+FixedMatrix<M,N> operator*(const FixedMatrix<M,N>& a, const float& b) {
+  FixedMatrix<M,N> c;
+  for(int i = 0; i < M * N; i++)
+    c.X[i] = a.X[i] * b;
+  return c;
+}
+
+template <int M, int N>
+FixedMatrix<M,N> operator/(const FixedMatrix<M,N>& a, const float& b) {
+  FixedMatrix<M,N> c;
+  for(int i = 0; i < M * N; i++)
+    c.X[i] = a.X[i] / b;
+  return c;
+}
+
+inline float convDble(const FixedMatrix<1,1>& a) { return a[0][0]; }
+
+inline FixedMatrix<2,2> Invert22(const FixedMatrix<2,2>& a) {
+  FixedMatrix<2,2> inv;
+  inv[0][0] = a[1][1];
+  inv[0][1] = -a[0][1];
+  inv[1][0] = -a[1][0];
+  inv[1][1] = a[0][0];
+  float divisor = a[0][0] * a[1][1] - a[0][1] * a[1][0];
+  return inv / divisor;
+}
+
+template <int M1, int M2, int N>
+FixedMatrix<M1 + M2, N> vertcat(const FixedMatrix<M1,N>& a, const FixedMatrix<M2,N>& b) {
+  FixedMatrix<M1 + M2, N> c;
+  memcpy(c.X, a.X, sizeof(a.X));
+  memcpy(c.X + M1 * N, b.X, sizeof(b.X));
+  return c;
+}
+
+template <int M, int N1, int N2>
+FixedMatrix<M, N1 + N2> horzcat(const FixedMatrix<M,N1>& a, const FixedMatrix<M,N2>& b) {
+  FixedMatrix<M, N1 + N2> c;
+  for(int i = 0; i < M; i++) {
+    memcpy(c[i], a[i], sizeof(float) * N1);
+    memcpy(c[i] + N1, b[i], sizeof(float) * N2);
+  }
+  return c;
+}
+
+template <int M1, int N1, int M2, int N2>
+FixedMatrix<M1 + M2, N1 + N2> diagcat(const FixedMatrix<M1,N1>& a, const FixedMatrix<M2,N2>& b) {
+  FixedMatrix<M1 + M2, N1 + N2> c;
+  for(int i = 0; i < M1; i++)
+    for(int j = 0; j < N1; j++)
+      c[i][j] = a[i][j];
+  for(int i = 0; i < M2; i++)
+    for(int j = 0; j < N2; j++)
+      c[i + M1][j + N1] = b[i][j];
+  return c;
+}
+
+template <int M>
+FixedMatrix<M,M> cholesky(const FixedMatrix<M,M>& P) {
+  FixedMatrix<M,M> L;
+  float a = 0;
+  for(int i = 0; i < M; i++) {
+    for(int j = 0; j < i; j++) {
+      a = P[i][j];
+      for(int k = 0; k < j; k++)
+        a = a - L[i][k] * L[j][k];
+      L[i][j] = a / L[j][j];
+    }
+    a = P[i][i];
+    for(int k = 0; k < i; k++)
+      a = a - powf(L[i][k], 2);
+    L[i][i] = sqrtf(a);
+  }
+  return L;
+}
+
+// Householder triangularization of [M x N] down to the trailing [M x M] block
+template <int M, int N>
+FixedMatrix<M,M> HT(FixedMatrix<M,N> A) {
+  const int r = N - M;
+  float sigma, a, b;
+  float v[N];
+  for(int k = M - 1; k >= 0; k--) {
+    sigma = 0.0;
+    for(int j = 0; j <= r + k; j++)
+      sigma = sigma + A[k][j] * A[k][j];
+    a = sqrtf(sigma);
+    sigma = 0.0;
+    for(int j = 0; j <= r + k; j++) {
+      v[j] = (j == r + k) ? A[k][j] - a : A[k][j];
+      sigma = sigma + v[j] * v[j];
+    }
+    a = 2.0 / (sigma + 1e-15);
+    for(int i = 0; i <= k; i++) {
+      sigma = 0.0;
+      for(int j = 0; j <= r + k; j++)
+        sigma = sigma + A[i][j] * v[j];
+      b = a * sigma;
+      for(int j = 0; j <= r + k; j++)
+        A[i][j] = A[i][j] - b * v[j];
+    }
+  }
+  FixedMatrix<M,M> B;
+  for(int i = 0; i < M; i++)
+    memcpy(B[i], A[i] + r, sizeof(float) * M);
+  return B;
+}
+
+#endif
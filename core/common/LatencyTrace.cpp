@@ -0,0 +1,155 @@
+#include <common/LatencyTrace.h>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include <string.h>
+#include <stdio.h>
+
+LatencyHistogram::LatencyHistogram() {
+  clear();
+}
+
+int LatencyHistogram::bucket(unsigned int micros) {
+  if (micros < 2 * SUB_BUCKETS) return micros;
+  // position of the highest bit past the sub bucket bits
+  int shift = 31 - __builtin_clz(micros) - 4;
+  int b = (shift + 1) * SUB_BUCKETS + (micros >> shift) - SUB_BUCKETS;
+  return b < BUCKETS ? b : BUCKETS - 1;
+}
+
+unsigned int LatencyHistogram::upperEdge(int bucket) {
+  if (bucket < 2 * SUB_BUCKETS) return bucket + 1;
+  int shift = bucket / SUB_BUCKETS - 1;
+  return (unsigned int)(bucket % SUB_BUCKETS + SUB_BUCKETS + 1) << shift;
+}
+
+void LatencyHistogram::add(unsigned int micros) {
+  counts_[bucket(micros)]++;
+  count_++;
+  total_ += micros;
+  if (micros > max_) max_ = micros;
+}
+
+void LatencyHistogram::clear() {
+  memset(counts_, 0, sizeof(counts_));
+  count_ = max_ = 0;
+  total_ = 0;
+}
+
+unsigned int LatencyHistogram::percentile(double fraction) const {
+  unsigned int target = fraction * count_, seen = 0;
+  for (int i = 0; i < BUCKETS; i++) {
+    seen += counts_[i];
+    if (seen > target) return std::min(upperEdge(i), max_);
+  }
+  return max_;
+}
+
+LatencyRing::LatencyRing() : head_(0), tail_(0), dropped_(0) {
+}
+
+void LatencyRing::push(unsigned short probe, unsigned int micros) {
+  unsigned int head = head_.load(std::memory_order_relaxed);
+  if (head - tail_.load(std::memory_order_acquire) >= SIZE) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  samples_[head % SIZE].probe = probe;
+  samples_[head % SIZE].micros = micros;
+  head_.store(head + 1, std::memory_order_release);
+}
+
+namespace {
+  struct Probe {
+    const char* name;
+    unsigned int budget;
+    LatencyHistogram histogram;
+    unsigned int misses;
+  };
+
+  // Registration and the list of rings only change under the mutex, which the probes
+  // take once per site and once per thread respectively
+  std::mutex registry_mutex;
+  Probe probes[LatencyTracer::MAX_PROBES];
+  int num_probes = 0;
+  std::vector<LatencyRing*> rings;
+  unsigned int dropped_seen = 0;
+
+  thread_local LatencyRing* ring = NULL;
+}
+
+int LatencyTracer::probe(const char* name, double budget) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (int i = 0; i < num_probes; i++)
+    if (!strcmp(probes[i].name, name)) return i;
+  if (num_probes == MAX_PROBES) {
+    fprintf(stderr, "LatencyTracer: too many probes, not tracing %s\n", name);
+    return -1;
+  }
+  Probe& p = probes[num_probes];
+  p.name = name;
+  p.budget = budget * 1e6;
+  p.misses = 0;
+  return num_probes++;
+}
+
+void LatencyTracer::record(int probe, unsigned int micros) {
+  if (probe < 0) return;
+  if (!ring) {
+    // threads in the motion process live as long as it does, so rings are never freed
+    ring = new LatencyRing();
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    rings.push_back(ring);
+  }
+  ring->push(probe, micros);
+}
+
+void LatencyTracer::collect() {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (unsigned int i = 0; i < rings.size(); i++) {
+    rings[i]->drain([](unsigned short probe, unsigned int micros) {
+      Probe& p = probes[probe];
+      p.histogram.add(micros);
+      if (p.budget && micros > p.budget) p.misses++;
+    });
+  }
+}
+
+void LatencyTracer::clear() {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (int i = 0; i < num_probes; i++) {
+    probes[i].histogram.clear();
+    probes[i].misses = 0;
+  }
+  dropped_seen = 0;
+  for (unsigned int i = 0; i < rings.size(); i++)
+    dropped_seen += rings[i]->dropped();
+}
+
+std::string LatencyTracer::report() {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  std::string text;
+  char line[128];
+  snprintf(line, sizeof(line), "%-16s %7s %8s %8s %8s %8s %6s\n", "probe [ms]", "count", "mean", "p50", "p99", "max", "miss");
+  text += line;
+  for (int i = 0; i < num_probes; i++) {
+    const Probe& p = probes[i];
+    if (!p.histogram.count()) continue;
+    snprintf(line, sizeof(line), "%-16s %7u %8.3f %8.3f %8.3f %8.3f %6u\n", p.name, p.histogram.count(),
+      p.histogram.mean() / 1000, p.histogram.percentile(0.5) / 1000.0, p.histogram.percentile(0.99) / 1000.0,
+      p.histogram.max() / 1000.0, p.misses);
+    text += line;
+  }
+  unsigned int dropped = 0;
+  for (unsigned int i = 0; i < rings.size(); i++)
+    dropped += rings[i]->dropped();
+  if (dropped > dropped_seen) {
+    snprintf(line, sizeof(line), "%u samples dropped, collect more often\n", dropped - dropped_seen);
+    text += line;
+  }
+  return text;
+}
+
+void LatencyTracer::print() {
+  printf("%s", report().c_str());
+}
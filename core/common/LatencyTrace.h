@@ -0,0 +1,102 @@
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <atomic>
+#include <string>
+#include <common/TimingHistogram.h>
+
+/* Latency histogram with HDR style buckets. Below 32 us every microsecond has its own
+ * bucket, above that each power of two is split into SUB_BUCKETS equal buckets, so
+ * percentiles keep the same relative precision (better than 7%) from a microsecond up
+ * to several seconds with a fixed 320 counters. */
+class LatencyHistogram {
+  public:
+    static const int SUB_BUCKETS = 16;
+    static const int MAGNITUDES = 20;
+    static const int BUCKETS = SUB_BUCKETS * MAGNITUDES;
+
+    LatencyHistogram();
+    void add(unsigned int micros);
+    void clear();
+
+    inline unsigned int count() const { return count_; }
+    inline unsigned int max() const { return max_; }
+    inline double mean() const { return count_ ? total_ / count_ : 0; }
+    // Upper edge in microseconds of the bucket holding the given fraction of the samples
+    unsigned int percentile(double fraction) const;
+
+  private:
+    static int bucket(unsigned int micros);
+    static unsigned int upperEdge(int bucket);
+
+    unsigned int counts_[BUCKETS];
+    unsigned int count_, max_;
+    double total_;
+};
+
+/* Timings of finished probes, written by the one thread that owns the ring and read by
+ * whichever thread collects them. Pushing never locks or waits; when the collector
+ * falls behind and the ring is full the sample is dropped and counted instead. */
+class LatencyRing {
+  public:
+    static const unsigned int SIZE = 16384;
+    struct Sample {
+      unsigned short probe;
+      unsigned int micros;
+    };
+
+    LatencyRing();
+    void push(unsigned short probe, unsigned int micros);
+    // Hands every pending sample to f(probe, micros), oldest first
+    template <class F> void drain(F f) {
+      unsigned int tail = tail_.load(std::memory_order_relaxed);
+      unsigned int head = head_.load(std::memory_order_acquire);
+      for (; tail != head; tail++)
+        f(samples_[tail % SIZE].probe, samples_[tail % SIZE].micros);
+      tail_.store(tail, std::memory_order_release);
+    }
+    inline unsigned int dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  private:
+    Sample samples_[SIZE];
+    std::atomic<unsigned int> head_, tail_, dropped_;
+};
+
+/* Scoped latency probes for the motion loop. Each thread records into its own
+ * LatencyRing, and collect() folds the rings into a histogram per probe along with a
+ * count of the runs that went over the probe's budget. */
+class LatencyTracer {
+  public:
+    static const int MAX_PROBES = 32;
+
+    // The id of the probe with this name, registering it the first time. Runs longer
+    // than budget seconds count as deadline misses, a budget of 0 never misses.
+    static int probe(const char* name, double budget = 0);
+    static void record(int probe, unsigned int micros);
+
+    // Only one thread may collect at a time
+    static void collect();
+    static void clear();
+    // One line per probe that has run: count, mean, p50, p99, max and misses
+    static std::string report();
+    static void print();
+};
+
+class LatencyScope {
+  public:
+    LatencyScope(int probe) : probe_(probe), start_(TimingHistogram::now()) { }
+    ~LatencyScope() { LatencyTracer::record(probe_, (TimingHistogram::now() - start_) * 1e6); }
+
+  private:
+    int probe_;
+    double start_;
+};
+
+#define LATENCY_PROBE_NAME2(a, b) a##b
+#define LATENCY_PROBE_NAME(a, b) LATENCY_PROBE_NAME2(a, b)
+// Times the rest of the enclosing scope as probe name, e.g. LATENCY_PROBE("kick", 0)
+#define LATENCY_PROBE(name, budget) \
+  static const int LATENCY_PROBE_NAME(latency_probe_, __LINE__) = LatencyTracer::probe(name, budget); \
+  LatencyScope LATENCY_PROBE_NAME(latency_scope_, __LINE__)(LATENCY_PROBE_NAME(latency_probe_, __LINE__))
+
+#endif
@@ -1,14 +1,18 @@
 #include <common/Profiling.h>
+#include <mutex>
 #define FIRST_ID 1
 static int __id = FIRST_ID;
 static int __lastid = __id;
 static std::map<int,timeval> __times;
 static std::map<int,TimeList> __timelists;
 static bool __enable_profiling = false;
+// Timers may be started and stopped from worker threads, e.g. per-camera vision timing
+static std::mutex __mutex;
 
 int tic(int id) {
   timeval t;
   gettimeofday(&t, NULL);
+  std::lock_guard<std::mutex> lock(__mutex);
   if(id >= FIRST_ID) {
     __times[id] = t;
     return id;
@@ -21,10 +25,12 @@ int tic(int id) {
 }
 
 double toc(int id) {
-  if(id < 0) id = __lastid;
-  timeval tstart = __times[id];
   timeval tend;
   gettimeofday(&tend, NULL);
+  std::unique_lock<std::mutex> lock(__mutex);
+  if(id < 0) id = __lastid;
+  timeval tstart = __times[id];
+  lock.unlock();
   double elapsed = 
     (tend.tv_sec - tstart.tv_sec) +
     (tend.tv_usec - tstart.tv_usec) / 1000000.0;
@@ -32,6 +38,7 @@ double toc(int id) {
 }
 
 int clockavg(int maxSize) {
+  std::lock_guard<std::mutex> lock(__mutex);
   TimeList tl;
   tl.maxSize = maxSize;
   __timelists[__id] = tl;
@@ -41,11 +48,13 @@ int clockavg(int maxSize) {
 void ticavg(int id) {
   timeval t;
   gettimeofday(&t, NULL);
+  std::lock_guard<std::mutex> lock(__mutex);
   __times[id] = t;
 }
 
 double tocavg(int id) {
   double elapsed = toc(id);
+  std::lock_guard<std::mutex> lock(__mutex);
   TimeList& tl = __timelists[id];
   tl.times.push_back(elapsed);
   if(tl.times.size() > tl.maxSize)
@@ -71,7 +80,7 @@ void printtime(const char* name, int id) {
   printtime(id);
 }
 
-Timer::Timer() : id_(0), pauseId_(0), elapsed_(0), paused_(0), interval_(1), iterations_(0) { }
+Timer::Timer() : id_(0), pauseId_(0), interval_(1), iterations_(0), elapsed_(0), paused_(0), last_(0) { }
 
 void Timer::start() {
   if(!id_) id_ = tic();
@@ -79,8 +88,8 @@ void Timer::start() {
 }
 
 void Timer::stop() {
-  elapsed_ += toc(id_);
-  elapsed_ -= paused_;
+  last_ = toc(id_) - paused_;
+  elapsed_ += last_;
   paused_ = 0;
   int i = (iterations_ + 1) % (interval_ + 1);
   if(i == 0) restart();
@@ -118,6 +127,10 @@ double Timer::elapsed() {
   return toc(id_);
 }
 
+double Timer::lasttime() {
+  return last_;
+}
+
 void Timer::setMessage(std::string message) {
   message_ = message;
 }
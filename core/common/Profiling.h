@@ -8,7 +8,7 @@
 #include <iostream>
 
 struct TimeList {
-  int maxSize;
+  size_t maxSize;
   std::list<double> times;
 };
 
@@ -36,10 +36,11 @@ class Timer {
     double avgrate();
     double avgtime();
     double elapsed();
+    double lasttime();
   private:
     int id_, pauseId_;
     int interval_, iterations_;
-    double elapsed_, paused_;
+    double elapsed_, paused_, last_;
     std::string message_;
 };
 
@@ -1,37 +1,190 @@
 #include <common/Random.h>
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <mutex>
+#include <vector>
 
 int Random::SEED = 0;
 Random Random::inst_ = Random();
 
-Random::Random(int seed) :
-  random_(seed),
-  ndistribution_(0.0,1.0),
-  ngenerator_(std::bind(ndistribution_, random_)) {
+namespace {
+  const double TO_UNIT = 1.0 / 4294967296.0;
+  // blocks per group, enough for the vector loop to pay for setting up the key schedule
+  const int BLOCKS = Random::GROUP / 4;
+
+  struct Stream {
+    std::string name;
+    int agent;
+    uint64_t key;
+  };
+
+  // streams made so far, for the manifest; a function static so streams can be
+  // made during static initialization
+  struct Streams {
+    std::mutex mutex;
+    std::vector<Stream> list;
+  };
+
+  Streams& streams() {
+    static Streams s;
+    return s;
+  }
+
+  // SplitMix64 finalizer, spreads seeds and names over the whole key space
+  inline uint64_t mix(uint64_t z) {
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  inline void philoxRound(uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3, uint32_t k0, uint32_t k1) {
+    uint64_t p0 = (uint64_t)0xD2511F53u * c0, p1 = (uint64_t)0xCD9E8D57u * c2;
+    uint32_t hi0 = p0 >> 32, lo0 = (uint32_t)p0, hi1 = p1 >> 32, lo1 = (uint32_t)p1;
+    c0 = hi1 ^ c1 ^ k0;
+    c1 = lo1;
+    c2 = hi0 ^ c3 ^ k1;
+    c3 = lo0;
+  }
+
+  // One group, the four values of each of GROUP / 4 consecutive blocks, stored a value
+  // of every block at a time so the compiler vectorizes across the blocks
+  void philox(uint64_t key, uint64_t first, uint32_t *__restrict__ out) {
+    uint32_t low = (uint32_t)first, high = first >> 32;
+    for(int i = 0; i < BLOCKS; i++) {
+      uint32_t c0 = low + i, c1 = high, c2 = 0, c3 = 0;
+      uint32_t k0 = (uint32_t)key, k1 = key >> 32;
+      // ten rounds, written out so there's no inner loop
+      philoxRound(c0, c1, c2, c3, k0, k1); k0 += 0x9E3779B9u; k1 += 0xBB67AE85u;
+      philoxRound(c0, c1, c2, c3, k0, k1); k0 += 0x9E3779B9u; k1 += 0xBB67AE85u;
+      philoxRound(c0, c1, c2, c3, k0, k1); k0 += 0x9E3779B9u; k1 += 0xBB67AE85u;
+      philoxRound(c0, c1, c2, c3, k0, k1); k0 += 0x9E3779B9u; k1 += 0xBB67AE85u;
+      philoxRound(c0, c1, c2, c3, k0, k1); k0 += 0x9E3779B9u; k1 += 0xBB67AE85u;
+      philoxRound(c0, c1, c2, c3, k0, k1); k0 += 0x9E3779B9u; k1 += 0xBB67AE85u;
+      philoxRound(c0, c1, c2, c3, k0, k1); k0 += 0x9E3779B9u; k1 += 0xBB67AE85u;
+      philoxRound(c0, c1, c2, c3, k0, k1); k0 += 0x9E3779B9u; k1 += 0xBB67AE85u;
+      philoxRound(c0, c1, c2, c3, k0, k1); k0 += 0x9E3779B9u; k1 += 0xBB67AE85u;
+      philoxRound(c0, c1, c2, c3, k0, k1);
+      out[i] = c0;
+      out[BLOCKS + i] = c1;
+      out[2 * BLOCKS + i] = c2;
+      out[3 * BLOCKS + i] = c3;
+    }
+  }
+}
+
+Random::Random(int seed) : key_(mix((uint32_t)seed)), position_(0), group_(~0ull) {
+}
+
+Random Random::stream(const std::string& name, int agent) {
+  // FNV-1a of the name
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for(char c : name)
+    hash = (hash ^ (uint8_t)c) * 0x100000001B3ull;
+  Random random;
+  random.key_ = mix(mix(mix((uint32_t)SEED) ^ hash) ^ (uint32_t)agent);
+
+  Streams& s = streams();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  bool known = false;
+  for(auto& stream : s.list)
+    known |= stream.key == random.key_;
+  if(!known)
+    s.list.push_back({name, agent, random.key_});
+  return random;
 }
 
 const Random& Random::inst() { return inst_; }
 
+std::string Random::manifest() {
+  Streams& s = streams();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  std::string json = "{\"seed\": " + std::to_string(SEED) + ", \"streams\": [";
+  for(unsigned i = 0; i < s.list.size(); i++) {
+    char key[24];
+    snprintf(key, sizeof(key), "%016llx", (unsigned long long)s.list[i].key);
+    json += (i ? ", " : "") + std::string("{\"name\": \"") + s.list[i].name + "\", \"agent\": " +
+      std::to_string(s.list[i].agent) + ", \"key\": \"" + key + "\"}";
+  }
+  return json + "]}";
+}
+
+void Random::seek(uint64_t position) {
+  position_ = position;
+}
+
+inline uint32_t Random::next() {
+  uint64_t group = position_ / GROUP;
+  if(group != group_) {
+    philox(key_, group * BLOCKS, values_);
+    group_ = group;
+  }
+  return values_[position_++ % GROUP];
+}
+
+void Random::fill(uint32_t* out, int n) {
+  int i = 0;
+  for(; i < n && position_ % GROUP; i++)
+    out[i] = next();
+  for(; i + GROUP <= n; i += GROUP, position_ += GROUP)
+    philox(key_, position_ / 4, out + i);
+  for(; i < n; i++)
+    out[i] = next();
+}
+
 double Random::sampleN(double mean, double stddev) {
-  double v = ngenerator_();
-  return v * stddev + mean;
+  // Box-Muller, the first value is kept off zero for the log
+  double u = (next() + 1.0) * TO_UNIT, v = next() * TO_UNIT;
+  return sqrt(-2 * log(u)) * cos(2 * M_PI * v) * stddev + mean;
 }
 
 double Random::sampleU(double max) {
-  return (double)random_()/random_.max() * max;
+  return next() * TO_UNIT * max;
 }
 
 double Random::sampleU(double min, double max) {
-  return (double)random_()/random_.max() * (max - min) + min;
+  return next() * TO_UNIT * (max - min) + min;
 }
 
 int Random::sampleU(int max) {
-  return random_() % (max + 1);
+  return next() % (uint32_t)(max + 1);
 }
 
 int Random::sampleU(int min, int max) {
-  return random_() % (max - min + 1) + min;
+  return (int)(next() % (uint32_t)(max - min + 1)) + min;
 }
 
 bool Random::sampleB(double p) {
   return sampleU() < p;
 }
+
+void Random::sampleN(float* out, int n, float mean, float stddev) {
+  const int CHUNK = 256;
+  uint32_t bits[CHUNK];
+  for(int start = 0; start < n; start += CHUNK) {
+    int m = std::min(n - start, CHUNK);
+    fill(bits, (m + 1) & ~1);
+    float* o = out + start;
+    for(int i = 0; i + 1 < m; i += 2) {
+      float r = sqrtf(-2 * logf((bits[i] + 1.0f) * (float)TO_UNIT)) * stddev;
+      float t = (float)(2 * M_PI * TO_UNIT) * bits[i + 1];
+      o[i] = r * cosf(t) + mean;
+      o[i + 1] = r * sinf(t) + mean;
+    }
+    if(m & 1)
+      o[m - 1] = sqrtf(-2 * logf((bits[m - 1] + 1.0f) * (float)TO_UNIT)) * cosf((float)(2 * M_PI * TO_UNIT) * bits[m]) * stddev + mean;
+  }
+}
+
+void Random::sampleU(float* out, int n, float min, float max) {
+  const int CHUNK = 256;
+  uint32_t bits[CHUNK];
+  float scale = (float)TO_UNIT * (max - min);
+  for(int start = 0; start < n; start += CHUNK) {
+    int m = std::min(n - start, CHUNK);
+    fill(bits, m);
+    for(int i = 0; i < m; i++)
+      out[start + i] = bits[i] * scale + min;
+  }
+}
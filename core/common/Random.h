@@ -1,26 +1,52 @@
 #ifndef RANDOM_H
 #define RANDOM_H
 
-#include <functional>
-#include <random>
+#include <stdint.h>
+#include <string>
 #include <ctime>
 
+/* Counter based random numbers, Philox4x32-10. The n'th value of a stream is a pure
+ * function of its 64 bit key and n, so streams share no state, can be moved to any
+ * point with seek(), and a run is reproduced from its keys alone however its work was
+ * split across threads or processes. stream() derives the key from SEED, a purpose and
+ * an agent, so each robot and each noise source in a simulation draws its own
+ * sequence; every stream made is recorded for manifest(). */
 class Random {
+  public:
+    // Values are made GROUP at a time
+    static const int GROUP = 64;
+
   private:
-    std::mt19937 random_;
-    std::normal_distribution<> ndistribution_;
-    std::function<double()> ngenerator_;
+    uint32_t next();
+    void fill(uint32_t* out, int n);
+
+    uint64_t key_;
+    // index of the next 32 bit value, and the group of values_ it comes from
+    uint64_t position_, group_;
+    uint32_t values_[GROUP];
     static Random inst_;
 
   public:
     static int SEED;
     Random(int seed = Random::SEED);
+    // The stream for one purpose of one agent, e.g. stream("observations", player)
+    static Random stream(const std::string& name, int agent = 0);
     static const Random& inst();
+    // Json with SEED and the name, agent and key of every stream made so far
+    static std::string manifest();
+
+    uint64_t key() const { return key_; }
+    uint64_t position() const { return position_; }
+    void seek(uint64_t position);
+
     double sampleN(double mean, double stddev);
     double sampleU(double max = 1.0);
     double sampleU(double min, double max);
     int sampleU(int max);
     int sampleU(int min, int max);
     bool sampleB(double p = .5);
+    // Fill out with n samples at once; the normals come in pairs, one per pair of values
+    void sampleN(float* out, int n, float mean, float stddev);
+    void sampleU(float* out, int n, float min, float max);
 };
 #endif
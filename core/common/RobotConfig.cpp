@@ -11,6 +11,8 @@ RobotConfig::RobotConfig() {
   walk_type = getName(RUNSWIFT2014_WALK);
   team = 1;
   audio_enabled = false;
+  vision_scheduler = false;
+  vision_parallel_cameras = false;
 }
 
 void RobotConfig::deserialize(const YAML::Node& node) {
@@ -26,6 +28,11 @@ void RobotConfig::deserialize(const YAML::Node& node) {
   YAML_DESERIALIZE(node, team_broadcast_ip);
   YAML_DESERIALIZE(node, walk_type);
   YAML_DESERIALIZE(node, audio_enabled);
+  // optional, so configs written before these existed still load
+  if(const YAML::Node* child = node.FindValue("vision_scheduler"))
+    *child >> vision_scheduler;
+  if(const YAML::Node* child = node.FindValue("vision_parallel_cameras"))
+    *child >> vision_parallel_cameras;
 }
 
 void RobotConfig::serialize(YAML::Emitter& emitter) const {
@@ -41,4 +48,6 @@ void RobotConfig::serialize(YAML::Emitter& emitter) const {
   YAML_SERIALIZE(emitter, team_broadcast_ip);
   YAML_SERIALIZE(emitter, walk_type);
   YAML_SERIALIZE(emitter, audio_enabled);
+  YAML_SERIALIZE(emitter, vision_scheduler);
+  YAML_SERIALIZE(emitter, vision_parallel_cameras);
 }
@@ -17,5 +17,8 @@ class RobotConfig : public YamlConfig {
     int team_udp;
     std::string walk_type;
     bool audio_enabled;
+    // Vision options still being tried out on the robots, off unless set
+    bool vision_scheduler;
+    bool vision_parallel_cameras;
 };
 #endif
@@ -0,0 +1,52 @@
+#include <common/TimingHistogram.h>
+#include <time.h>
+#include <stdio.h>
+
+TimingHistogram::TimingHistogram(double binWidth, int bins) : binWidth_(binWidth), bins_(bins, 0) {
+  clear();
+}
+
+double TimingHistogram::now() {
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+void TimingHistogram::add(double seconds) {
+  int bin = seconds / binWidth_;
+  if (bin < 0) bin = 0;
+  if (bin >= (int)bins_.size()) bin = bins_.size() - 1;
+  bins_[bin]++;
+  count_++;
+  total_ += seconds;
+  if (seconds > max_) max_ = seconds;
+}
+
+void TimingHistogram::clear() {
+  for (unsigned int i = 0; i < bins_.size(); i++)
+    bins_[i] = 0;
+  count_ = 0;
+  total_ = max_ = 0;
+}
+
+double TimingHistogram::percentile(double fraction) const {
+  int target = fraction * count_, seen = 0;
+  for (unsigned int i = 0; i < bins_.size(); i++) {
+    seen += bins_[i];
+    if (seen > target) return (i + 1) * binWidth_;
+  }
+  return bins_.size() * binWidth_;
+}
+
+void TimingHistogram::print(const char* name) const {
+  printf("%s: %i samples, mean %.3f ms, p50 < %.3f ms, p99 < %.3f ms, max %.3f ms\n", name, count_,
+    mean() * 1000, percentile(0.5) * 1000, percentile(0.99) * 1000, max_ * 1000);
+  // only the occupied bins, the tail is what matters
+  for (unsigned int i = 0; i < bins_.size(); i++) {
+    if (!bins_[i]) continue;
+    if (i + 1 == bins_.size())
+      printf("  >= %6.3f ms: %i\n", i * binWidth_ * 1000, bins_[i]);
+    else
+      printf("  %6.3f - %6.3f ms: %i\n", i * binWidth_ * 1000, (i + 1) * binWidth_ * 1000, bins_[i]);
+  }
+}
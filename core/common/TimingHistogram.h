@@ -0,0 +1,33 @@
+#ifndef TIMING_HISTOGRAM_H
+#define TIMING_HISTOGRAM_H
+
+#include <vector>
+
+/* Counts durations in fixed width bins to show how a loop's timing is spread rather
+ * than just its average. Anything past the last bin is counted in the last bin. */
+class TimingHistogram {
+  public:
+    TimingHistogram(double binWidth = 0.0005, int bins = 40);
+
+    // Monotonic wall clock in seconds, for timing code that can't take a mutex
+    static double now();
+
+    void add(double seconds);
+    void clear();
+
+    inline int count() const { return count_; }
+    inline double max() const { return max_; }
+    inline double mean() const { return count_ ? total_ / count_ : 0; }
+    // Upper edge of the bin holding the given fraction of the samples
+    double percentile(double fraction) const;
+
+    void print(const char* name) const;
+
+  private:
+    double binWidth_;
+    std::vector<int> bins_;
+    int count_;
+    double total_, max_;
+};
+
+#endif
@@ -32,7 +32,8 @@ struct ToolPacket {
     GetCameraParameters,
     ResetCameraParameters,
     ManualControl,
-    RunBehavior
+    RunBehavior,
+    MotionTraceDump
   );
   MessageType message;
   int frames;
@@ -0,0 +1,59 @@
+#include <common/WorkerPool.h>
+#include <algorithm>
+
+WorkerPool::WorkerPool(int workers) : jobs_(NULL), generation_(0), dispatched_(0), pending_(0), stop_(false) {
+  for(int i = 0; i < workers; i++)
+    threads_.push_back(std::thread(&WorkerPool::work, this, i));
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_.notify_all();
+  for(unsigned int i = 0; i < threads_.size(); i++)
+    threads_[i].join();
+}
+
+void WorkerPool::run(const std::vector<Job>& jobs) {
+  if(jobs.empty()) return;
+  // Jobs beyond the pool size are run on the calling thread
+  int dispatched = std::min((int)jobs.size() - 1, (int)threads_.size());
+  if(dispatched > 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_ = &jobs;
+    dispatched_ = dispatched;
+    pending_ = dispatched;
+    generation_++;
+  }
+  start_.notify_all();
+  jobs[0]();
+  for(unsigned int i = dispatched + 1; i < jobs.size(); i++)
+    jobs[i]();
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] { return pending_ == 0; });
+  jobs_ = NULL;
+}
+
+void WorkerPool::work(int index) {
+  unsigned int seen = 0;
+  while(true) {
+    const Job* job = NULL;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if(stop_) return;
+      seen = generation_;
+      if(jobs_ && index < dispatched_)
+        job = &(*jobs_)[index + 1];
+    }
+    if(!job) continue;
+    (*job)();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_--;
+    }
+    done_.notify_one();
+  }
+}
@@ -0,0 +1,35 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/* A fixed set of persistent threads for running a batch of jobs each frame.
+ * run() executes the first job on the calling thread and the rest on the
+ * workers, and returns only once every job has finished. */
+class WorkerPool {
+  public:
+    typedef std::function<void()> Job;
+
+    WorkerPool(int workers);
+    ~WorkerPool();
+
+    void run(const std::vector<Job>& jobs);
+    inline int size() const { return threads_.size(); }
+
+  private:
+    void work(int index);
+
+    std::vector<std::thread> threads_;
+    const std::vector<Job>* jobs_;
+    std::mutex mutex_;
+    std::condition_variable start_, done_;
+    unsigned int generation_;
+    int dispatched_, pending_;
+    bool stop_;
+};
+
+#endif
@@ -268,6 +268,7 @@ void CommunicationModule::listenToolUDP(void* arg ) {
         module->core_->interpreter_->runBehavior((char*)&tp.data);
       }
       break;
+    case ToolPacket::MotionTraceDump: module->core_->requestMotionTrace(); break;
   }
 
   if(prev_state != module->game_state_->state()) {
@@ -412,8 +413,8 @@ void CommunicationModule::optionallyStream() {
 }
 
 void CommunicationModule::prepareSendTCP() {
-  const StreamBuffer& buffer = streaming_logger_->getBuffer();
-  if(buffer.size > 0) return;
+  const ArenaBuffer& buffer = streaming_logger_->getBuffer();
+  if(buffer.size() > 0) return;
   {
     std::lock_guard<std::mutex> lock(STREAM_MUTEX);
     streaming_logger_->writeMemory(*memory_);
@@ -423,11 +424,11 @@ void CommunicationModule::prepareSendTCP() {
 
 void CommunicationModule::sendTCP() {
   std::unique_lock<std::mutex> lock(STREAM_MUTEX);
-  const StreamBuffer& buffer = streaming_logger_->getBuffer();
-  while(buffer.size == 0) {
+  const ArenaBuffer& buffer = streaming_logger_->getBuffer();
+  while(buffer.size() == 0) {
     STREAM_CV.wait(lock);
   }
-  if (!stream_msg_->sendMessage(sock, buffer.buffer, buffer.size)) {
+  if (!stream_msg_->sendMessage(sock, buffer.span())) {
     std::cout << "Problem sending tcp, disconnecting" << std::endl;
     tcp_connected_ = false;
   }
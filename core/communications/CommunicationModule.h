@@ -107,7 +107,6 @@ private:
   void prepareSendTCP();
   Logger *streaming_logger_;
   StreamingMessage *stream_msg_;
-  StreamBuffer cbuffer_;
   char *log_buffer_;
   Lock *stream_lock_;
   pthread_t stream_thread_;
@@ -5,6 +5,7 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <zlib.h>
+#include <memory/ArenaBuffer.h>
 
 /// @addtogroup communications
 ///@{
@@ -17,7 +18,7 @@ class StreamingMessage {
 public:
   StreamingMessage() {}
 
-  bool preSend(unsigned char *data,unsigned long n) {
+  bool preSend(const unsigned char *data,unsigned long n) {
     send_len_ = MAX_STREAMING_MESSAGE_LEN;
     orig_len_ = n;
     int res = compress2(data_,&send_len_,data,n,3);
@@ -31,10 +32,10 @@ public:
     return true;
   }
 
-  bool sendMessage(tcp::socket &sock, unsigned char *data, unsigned long n) {
+  bool sendMessage(tcp::socket &sock, const BufferSpan& message) {
     long ret;
 
-    if (!preSend(data,n))
+    if (!preSend(message.data,message.size))
       return false;
     //ret = send(sockTCP,(const char *)this,send_len_,0);
     //std::cout << "before write" << std::endl << std::flush;
@@ -55,35 +56,39 @@ public:
     return true;
   }
 
-  unsigned char* postReceive(long read_size) {
+  // The returned span points into this message and is valid until the next postReceive
+  BufferSpan postReceive(long read_size) {
     //memcpy(&send_len_,data_,sizeof(send_len_));
     //memcpy(&orig_len_,data_+sizeof(send_len_),sizeof(orig_len_));
     if (read_size != (long)(send_len_ - 2 * sizeof(send_len_))) {
       std::cout << "Bad TCP Message " << read_size << " " << send_len_ << std::endl;
-      return NULL;
+      return BufferSpan();
     }
 
-    unsigned char* buffer = new unsigned char[orig_len_];
+    received_.reset();
+    unsigned char* buffer = received_.allocate(orig_len_);
     unsigned long orig_len = orig_len_;
     int ret = uncompress(buffer,&orig_len,data_,send_len_);
     if (ret != Z_OK) {
       std::cout << "BAD UNCOMPRESS of tcp message " << ret << std::endl;
-      delete []buffer;
-      return NULL;
+      return BufferSpan();
     }
     //std::cout << "UNCOMPRESS " << orig_len << std::endl << std::flush;
     if (orig_len != orig_len_) {
       std::cout << "LEN MISMATCH " << orig_len << " " << orig_len_ << std::endl;
-      delete []buffer;
-      return NULL;
+      return BufferSpan();
     }
-    return buffer;
+    return received_.span();
   }
 
 public:
   unsigned long send_len_;
   unsigned long orig_len_;
   unsigned char data_[MAX_STREAMING_MESSAGE_LEN];
+
+private:
+  // Only the fields above go on the wire; received messages are decompressed here
+  ArenaBuffer received_;
 };
 
 ///@}
@@ -17,5 +17,10 @@
 #define JERSEY_HEIGHT 160
 #define MAX_FOCUS_AREA_COUNT 20
 #define MAX_FOCUS_AREA 3000
+// Smallest blob findBall takes for the ball. Blob pixel counts cover the whole hstep x vstep
+// block each classified sample stands for, so this is the old 200 sample threshold at the
+// default 4 x 2 steps, but it now has to be met by one connected blob rather than by all
+// ball colored samples in the image added together.
+#define MIN_BALL_BLOB_PIXELS 1600
 
 #endif
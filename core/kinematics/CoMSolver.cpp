@@ -0,0 +1,168 @@
+#include "CoMSolver.h"
+#include <kinematics/ForwardKinematics.h>
+#include <kinematics/InverseKinematics.h>
+#include <Eigen/Core>
+#include <Eigen/LU>
+#include <algorithm>
+
+CoMSolver::CoMSolver(const RobotDimensions& dimensions, const MassCalibration& mass_calibration, int max_iterations, float tolerance, float damping) :
+  dimensions_(dimensions), mass_calibration_(mass_calibration), max_iterations_(max_iterations),
+  tolerance_(tolerance), damping_(damping), iterations_(0) {
+  setAxes(true, true, false);
+}
+
+void CoMSolver::setAxes(bool x, bool y, bool z) {
+  axes_[0] = x;
+  axes_[1] = y;
+  axes_[2] = z;
+}
+
+bool CoMSolver::calcLegJoints(Pose3D left_target, Pose3D right_target, float roll, Joints angles, const RobotDimensions& dimensions) {
+  RotationMatrix rot;
+  RotationMatrix foot_rotation;
+  rot.rotateX(roll);
+  foot_rotation.rotateX(-roll);
+  left_target.translation = rot * left_target.translation;
+  left_target.rotation = left_target.rotation * foot_rotation;
+  right_target.translation = rot * right_target.translation;
+  right_target.rotation = right_target.rotation * foot_rotation;
+
+  bool reachable = InverseKinematics::calcLegJoints(left_target, right_target, angles, dimensions);
+  angles[LHipYawPitch] = 0.0;
+  angles[RHipYawPitch] = 0.0;
+  return reachable;
+}
+
+Vector3<float> CoMSolver::evaluate(const Pose3D& left_target, const Pose3D& right_target, bool stance_is_left,
+    float roll, Joints angles, Pose3D* rel_parts, Pose3D* abs_parts, Vector3<float>& center_of_mass) const {
+  calcLegJoints(left_target, right_target, roll, angles, dimensions_);
+  ForwardKinematics::calculateRelativePose(angles, rel_parts, &dimensions_.values_[0]);
+  Pose3D base = ForwardKinematics::calculateVirtualBase(stance_is_left, rel_parts);
+  ForwardKinematics::calculateAbsolutePose(base, rel_parts, abs_parts);
+  ForwardKinematics::calculateCoM(abs_parts, center_of_mass, mass_calibration_);
+  return center_of_mass - abs_parts[stance_is_left ? BodyPart::left_foot : BodyPart::right_foot].translation;
+}
+
+// Axis of leg joint k in the torso frame, signed the way calculateRelativePose applies it
+static Vector3<float> jointAxis(const Pose3D* rel_parts, int pelvis, int sign, int k) {
+  if(k == 1 || k == 5)
+    return rel_parts[pelvis + k].rotation.c[0] * (float)sign;
+  return rel_parts[pelvis + k].rotation.c[1];
+}
+
+// Changes of leg joints 1 to 5 that move the ankle by delta without tilting the foot.
+// HipYawPitch is held, so this is the leg the inverse kinematics solves.
+static bool legJointDeltas(const Pose3D* rel_parts, bool left, const Vector3<float>& delta, float dq[5]) {
+  int pelvis = left ? BodyPart::left_pelvis : BodyPart::right_pelvis;
+  int sign = left ? -1 : 1;
+  const Pose3D& ankle = rel_parts[pelvis + 5];
+  Eigen::Matrix<float, 5, 5> A;
+  Eigen::Matrix<float, 5, 1> b;
+  for(int k = 1; k <= 5; k++) {
+    Vector3<float> axis = jointAxis(rel_parts, pelvis, sign, k);
+    Vector3<float> v = axis ^ (ankle.translation - rel_parts[pelvis + k].translation);
+    A(0, k - 1) = v.x;
+    A(1, k - 1) = v.y;
+    A(2, k - 1) = v.z;
+    A(3, k - 1) = axis * ankle.rotation.c[0];
+    A(4, k - 1) = axis * ankle.rotation.c[1];
+  }
+  b << delta.x, delta.y, delta.z, 0, 0;
+  Eigen::PartialPivLU<Eigen::Matrix<float, 5, 5> > lu(A);
+  // a straight knee leaves the ankle no room to move along the leg, so compare the
+  // determinant against the largest it could be for these columns
+  float volume = 1;
+  for(int k = 0; k < 5; k++)
+    volume *= A.col(k).norm();
+  if(fabsf(lu.determinant()) < 1e-3f * volume)
+    return false;
+  Eigen::Matrix<float, 5, 1> x = lu.solve(b);
+  for(int k = 0; k < 5; k++)
+    dq[k] = x(k);
+  return true;
+}
+
+// J[i][c] is the change of component i of the center of mass relative to the stance
+// ankle, in the virtual base frame, per unit shift of both feet along torso axis c
+void CoMSolver::jacobian(bool stance_is_left, float roll, Pose3D* rel_parts, float J[3][3]) const {
+  RotationMatrix rot;
+  rot.rotateX(roll);
+  const RotationMatrix to_base = rel_parts[BodyPart::virtual_base].rotation.invert();
+  const RotationMatrix& stance = rel_parts[stance_is_left ? BodyPart::left_foot : BodyPart::right_foot].rotation;
+  float total_mass = 0;
+  for(int i = 0; i < BodyPart::NUM_PARTS; i++)
+    total_mass += mass_calibration_.masses[i].mass;
+
+  for(int c = 0; c < 3; c++) {
+    if(!axes_[c]) {
+      J[0][c] = J[1][c] = J[2][c] = 0;
+      continue;
+    }
+    Vector3<float> shift(0, 0, 0);
+    shift[c] = 1;
+    Vector3<float> delta = rot * shift;
+    Vector3<float> dcom(0, 0, 0);
+    for(int side = 0; side < 2; side++) {
+      bool left = side == 0;
+      float dq[5];
+      if(!legJointDeltas(rel_parts, left, delta, dq))
+        continue;
+      int pelvis = left ? BodyPart::left_pelvis : BodyPart::right_pelvis;
+      int sign = left ? -1 : 1;
+      for(int m = 1; m <= 6; m++) {
+        const MassCalibration::MassInfo& limb(mass_calibration_.masses[pelvis + m]);
+        Vector3<float> p = rel_parts[pelvis + m] * limb.offset;
+        Vector3<float> dp(0, 0, 0);
+        for(int k = 1; k <= m && k <= 5; k++)
+          dp += (jointAxis(rel_parts, pelvis, sign, k) ^ (p - rel_parts[pelvis + k].translation)) * dq[k - 1];
+        dcom += dp * limb.mass;
+      }
+    }
+    // the virtual base stays under the torso, so it only follows the stance foot in height
+    Vector3<float> foot_delta = stance.invert() * delta;
+    dcom += stance * Vector3<float>(0, 0, foot_delta.z) * mass_calibration_.masses[BodyPart::virtual_base].mass;
+    dcom /= total_mass;
+
+    // the stance ankle moves by exactly delta, the virtual base motion cancels out
+    Vector3<float> column = to_base * (dcom - delta);
+    for(int i = 0; i < 3; i++)
+      J[i][c] = column[i];
+  }
+}
+
+bool CoMSolver::solve(Pose3D& left_target, Pose3D& right_target, bool stance_is_left, const Vector3<float>& com_target,
+    float roll, Joints angles, Pose3D* rel_parts, Pose3D* abs_parts, Vector3<float>& center_of_mass) {
+  iterations_ = 0;
+  while(true) {
+    Vector3<float> com = evaluate(left_target, right_target, stance_is_left, roll, angles, rel_parts, abs_parts, center_of_mass);
+    iterations_++;
+
+    error_ = com_target - com;
+    float max_error = 0;
+    for(int i = 0; i < 3; i++) {
+      if(!axes_[i])
+        error_[i] = 0;
+      max_error = std::max(max_error, fabsf(error_[i]));
+    }
+    if(max_error < tolerance_)
+      return true;
+    if(iterations_ >= max_iterations_)
+      return false;
+
+    // damped least squares step over the active axes, step = J^T (J J^T + damping^2 I)^-1 error
+    float J[3][3];
+    jacobian(stance_is_left, roll, rel_parts, J);
+    Eigen::Matrix3f Jm;
+    Eigen::Vector3f e;
+    for(int i = 0; i < 3; i++) {
+      e(i) = error_[i];
+      for(int c = 0; c < 3; c++)
+        Jm(i, c) = axes_[i] && axes_[c] ? J[i][c] : (i == c ? 1.0f : 0.0f);
+    }
+    Eigen::Matrix3f JJt = Jm * Jm.transpose() + damping_ * damping_ * Eigen::Matrix3f::Identity();
+    Eigen::Vector3f step = Jm.transpose() * JJt.partialPivLu().solve(e);
+    Vector3<float> shift(step(0), step(1), step(2));
+    left_target.translation += shift;
+    right_target.translation += shift;
+  }
+}
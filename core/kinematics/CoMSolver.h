@@ -0,0 +1,54 @@
+#ifndef COM_SOLVER_H
+#define COM_SOLVER_H
+
+#include <math/Pose3D.h>
+#include <math/Vector3.h>
+#include <common/MassCalibration.h>
+#include <common/RobotDimensions.h>
+#include <common/RobotInfo.h>
+
+/* Moves the center of mass over the stance foot by shifting both foot targets relative
+ * to the torso. Every iteration solves the legs with InverseKinematics, evaluates the
+ * center of mass and takes a damped least squares step along the analytic Jacobian of
+ * the center of mass with respect to the shift. It stops as soon as the error is within
+ * tolerance and never runs more than a fixed number of iterations, so the worst case
+ * cost on the motion thread is known up front. */
+class CoMSolver {
+  public:
+    CoMSolver(const RobotDimensions& dimensions, const MassCalibration& mass_calibration,
+      int max_iterations = 8, float tolerance = 0.25f, float damping = 0.1f);
+
+    // Which components of the center of mass are solved for, and shifted along
+    void setAxes(bool x, bool y, bool z);
+
+    /* Solves the leg joints for the foot targets, given relative to the torso, shifting
+     * both along the active axes until the center of mass relative to the stance ankle,
+     * in the virtual base frame, is within tolerance of com_target. The targets are
+     * updated with the shift and only the leg joints of angles are written. The body
+     * model of the final joints is left in rel_parts, abs_parts and center_of_mass.
+     * Returns whether it converged. */
+    bool solve(Pose3D& left_target, Pose3D& right_target, bool stance_is_left, const Vector3<float>& com_target,
+      float roll, Joints angles, Pose3D* rel_parts, Pose3D* abs_parts, Vector3<float>& center_of_mass);
+
+    /* InverseKinematics::calcLegJoints for targets rolled about the torso x axis, with
+     * HipYawPitch held at zero, which is the leg model the solver differentiates. */
+    static bool calcLegJoints(Pose3D left_target, Pose3D right_target, float roll, Joints angles, const RobotDimensions& dimensions);
+
+    inline int iterations() const { return iterations_; }
+    inline const Vector3<float>& error() const { return error_; }
+
+  private:
+    Vector3<float> evaluate(const Pose3D& left_target, const Pose3D& right_target, bool stance_is_left,
+      float roll, Joints angles, Pose3D* rel_parts, Pose3D* abs_parts, Vector3<float>& center_of_mass) const;
+    void jacobian(bool stance_is_left, float roll, Pose3D* rel_parts, float J[3][3]) const;
+
+    const RobotDimensions& dimensions_;
+    const MassCalibration& mass_calibration_;
+    int max_iterations_;
+    float tolerance_, damping_;
+    bool axes_[3];
+    int iterations_;
+    Vector3<float> error_;
+};
+
+#endif
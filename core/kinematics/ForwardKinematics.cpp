@@ -5,17 +5,17 @@
   printf("%s x,y,z: %2.4f, %2.4f, %2.4f\n", name, arr[part].translation.x, arr[part].translation.y, arr[part].translation.z); \
   printf("%s rotX, rotY, rotZ: %2.4f, %2.4f, %2.4f\n", name, arr[part].rotation.getXAngle() * RAD_T_DEG, arr[part].rotation.getYAngle() * RAD_T_DEG, arr[part].rotation.getZAngle() * RAD_T_DEG);
 
-void ForwardKinematics::calculateRelativePose(vector<float> joint_angles, Pose3D* rel_parts, vector<float> dimensions) {
+void ForwardKinematics::calculateRelativePose(const vector<float>& joint_angles, Pose3D* rel_parts, const vector<float>& dimensions) {
   calculateRelativePose(&joint_angles[0], rel_parts, &dimensions[0]);
 }
-void ForwardKinematics::calculateRelativePose(float *joint_angles, Pose3D* rel_parts, float* dimensions) {
+void ForwardKinematics::calculateRelativePose(const float *joint_angles, Pose3D* rel_parts, const float* dimensions) {
   calculateRelativePose(joint_angles, 0, 0, rel_parts, dimensions);
 }
 
-void ForwardKinematics::calculateRelativePose(vector<float> joint_angles, float angleXval, float angleYval, Pose3D *rel_parts, vector<float> dimensions) {
+void ForwardKinematics::calculateRelativePose(const vector<float>& joint_angles, float angleXval, float angleYval, Pose3D *rel_parts, const vector<float>& dimensions) {
   return calculateRelativePose(&joint_angles[0], angleXval, angleYval, rel_parts, &dimensions[0]);
 }
-void ForwardKinematics::calculateRelativePose(float *joint_angles, float angleXval, float angleYval, Pose3D *rel_parts, float* dimensions) {
+void ForwardKinematics::calculateRelativePose(const float *joint_angles, float angleXval, float angleYval, Pose3D *rel_parts, const float* dimensions) {
   Pose3D base = Pose3D(0,0,0)
     .rotateX(angleXval)
     .rotateY(angleYval);
@@ -112,11 +112,11 @@ Pose3D ForwardKinematics::calculateVirtualBase(bool useLeft, Pose3D *rel_parts)
   return base;
 }
 
-Pose3D ForwardKinematics::calculateVirtualBase(vector<float> sensors, Pose3D *rel_parts) {
+Pose3D ForwardKinematics::calculateVirtualBase(const vector<float>& sensors, Pose3D *rel_parts) {
   return calculateVirtualBase(&sensors[0], rel_parts);
 }
 
-Pose3D ForwardKinematics::calculateVirtualBase(float *sensors, Pose3D *rel_parts) {
+Pose3D ForwardKinematics::calculateVirtualBase(const float *sensors, Pose3D *rel_parts) {
   // Choose the foot with the most force as the base
   float leftForce = 0;
   for(int i = fsrLFL; i <= fsrLRR; i++)
@@ -128,10 +128,10 @@ Pose3D ForwardKinematics::calculateVirtualBase(float *sensors, Pose3D *rel_parts
   return base;
 }
 
-void ForwardKinematics::calculateAbsolutePose(vector<float> sensors, Pose3D *rel_parts, Pose3D *abs_parts) {
+void ForwardKinematics::calculateAbsolutePose(const vector<float>& sensors, Pose3D *rel_parts, Pose3D *abs_parts) {
   calculateAbsolutePose(&sensors[0], rel_parts, abs_parts);
 }
-void ForwardKinematics::calculateAbsolutePose(float* sensors, Pose3D *rel_parts, Pose3D *abs_parts) {
+void ForwardKinematics::calculateAbsolutePose(const float* sensors, Pose3D *rel_parts, Pose3D *abs_parts) {
   Pose3D base = calculateVirtualBase(sensors, rel_parts);
   calculateAbsolutePose(base, rel_parts, abs_parts);
 }
@@ -8,17 +8,17 @@
 #include <common/RobotDimensions.h>
 
 namespace ForwardKinematics {
-  void calculateRelativePose(vector<float> joint_angles, Pose3D *rel_parts, vector<float> dimensions);
-  void calculateRelativePose(float *joint_angles, Pose3D *rel_parts, float* dimensions);
-  void calculateRelativePose(vector<float> joint_angles, float angleX, float angleY, Pose3D *rel_parts, vector<float> dimensions);
-  void calculateRelativePose(float *joint_angles, float angleX, float angleY, Pose3D *rel_parts, float* dimensions);
-  void calculateAbsolutePose(vector<float> sensors, Pose3D *rel_parts, Pose3D *abs_parts);
-  void calculateAbsolutePose(float* sensors, Pose3D *rel_parts, Pose3D *abs_parts);
+  void calculateRelativePose(const vector<float>& joint_angles, Pose3D *rel_parts, const vector<float>& dimensions);
+  void calculateRelativePose(const float *joint_angles, Pose3D *rel_parts, const float* dimensions);
+  void calculateRelativePose(const vector<float>& joint_angles, float angleX, float angleY, Pose3D *rel_parts, const vector<float>& dimensions);
+  void calculateRelativePose(const float *joint_angles, float angleX, float angleY, Pose3D *rel_parts, const float* dimensions);
+  void calculateAbsolutePose(const vector<float>& sensors, Pose3D *rel_parts, Pose3D *abs_parts);
+  void calculateAbsolutePose(const float* sensors, Pose3D *rel_parts, Pose3D *abs_parts);
   void calculateAbsolutePose(Pose3D base, Pose3D *rel_parts, Pose3D *abs_parts);
   void calculateCoM(Pose3D *abs_parts, Vector3<float> &center_of_mass, const MassCalibration &mass_calibration); /**< Calculates the position of the center of mass relative to the robot's origin. */
   Pose3D calculateVirtualBase(bool useLeft, Pose3D *rel_parts);
-  Pose3D calculateVirtualBase(vector<float> sensors, Pose3D *rel_parts);
-  Pose3D calculateVirtualBase(float *sensors, Pose3D *rel_parts);
+  Pose3D calculateVirtualBase(const vector<float>& sensors, Pose3D *rel_parts);
+  Pose3D calculateVirtualBase(const float *sensors, Pose3D *rel_parts);
   TiltRoll calculateTiltRollFromLeg(bool left, float *joint_angles, const RobotDimensions &dimensions);
 }
 
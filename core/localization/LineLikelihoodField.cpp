@@ -0,0 +1,29 @@
+#include <localization/LineLikelihoodField.h>
+#include <common/Field.h>
+#include <common/WorldObject.h>
+#include <algorithm>
+
+LineLikelihoodField::LineLikelihoodField(const std::vector<LineSegment>& lines) :
+  originX_(-HALF_GRASS_X), originY_(-HALF_GRASS_Y),
+  cols_((int)(GRASS_X / RESOLUTION) + 1), rows_((int)(GRASS_Y / RESOLUTION) + 1),
+  distance2_(cols_ * rows_) {
+  for (int r = 0; r < rows_; r++) {
+    for (int c = 0; c < cols_; c++) {
+      Point2D p(originX_ + (c + 0.5f) * RESOLUTION, originY_ + (r + 0.5f) * RESOLUTION);
+      float best = MAX_DISTANCE;
+      for (const LineSegment& line : lines)
+        best = std::min(best, line.getDistanceTo(p));
+      distance2_[r * cols_ + c] = best * best;
+    }
+  }
+}
+
+const LineLikelihoodField& LineLikelihoodField::field() {
+  static LineLikelihoodField instance([] {
+    std::vector<LineSegment> lines;
+    for (int i = WO_OPP_GOAL_LINE; i <= WO_BOTTOM_SIDE_LINE; i++)
+      lines.push_back(LineSegment(lineLocationStarts[i - LINE_OFFSET], lineLocationEnds[i - LINE_OFFSET]));
+    return lines;
+  }());
+  return instance;
+}
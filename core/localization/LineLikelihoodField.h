@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <math/Geometry.h>
+
+/* Squared distance from every point of the grass to the nearest field line, sampled
+ * on a grid once so the particle filter can score seen lines with one lookup per
+ * point instead of a search over the line segments. */
+class LineLikelihoodField {
+  public:
+    // Grid cell size in mm
+    static const int RESOLUTION = 50;
+    // Distances are clamped to this, in mm
+    static const int MAX_DISTANCE = 1000;
+
+    explicit LineLikelihoodField(const std::vector<LineSegment>& lines);
+
+    // Field built from the lines the world objects are initialized with
+    static const LineLikelihoodField& field();
+
+    inline float distance2(float x, float y) const {
+      float fx = std::min(std::max((x - originX_) * (1.0f / RESOLUTION), 0.0f), (float)(cols_ - 1));
+      float fy = std::min(std::max((y - originY_) * (1.0f / RESOLUTION), 0.0f), (float)(rows_ - 1));
+      return distance2_[(int)fy * cols_ + (int)fx];
+    }
+
+  private:
+    float originX_, originY_;
+    int cols_, rows_;
+    std::vector<float> distance2_;
+};
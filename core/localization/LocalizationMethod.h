@@ -0,0 +1,10 @@
+#pragma once
+
+class LocalizationMethod {
+  public:
+    enum Type {
+      Default,
+      Particle
+    };
+    static Type DEFAULT;
+};
@@ -1,10 +1,28 @@
 #include <localization/LocalizationModule.h>
+#include <localization/LocalizationState.h>
+#include <memory/TextLogger.h>
+#include <memory/FrameInfoBlock.h>
+#include <memory/GameStateBlock.h>
+#include <memory/LocalizationBlock.h>
+#include <memory/OdometryBlock.h>
+#include <memory/RobotStateBlock.h>
+#include <memory/WorldObjectBlock.h>
+#include <common/Field.h>
+#include <algorithm>
 
-LocalizationModule::LocalizationModule() : tlogger_(textlogger) {
+// Longest gap between frames the models are predicted across, in seconds
+#define MAX_TIME_PASSED 0.5
+
+LocalizationModule::LocalizationModule(LocalizationMethod::Type method) : tlogger_(textlogger), method_(method), ballVar_(MultiModelEKF::BALL_LOST_VAR * 4),
+  last_time_(-1), last_state_(UNDEFINED_STATE), getting_up_(false) {
+  ekf_.setParams(params_);
+  particles_.setParams(params_);
 }
 
 void LocalizationModule::loadParams(LocalizationParams params) {
   params_ = params;
+  ekf_.setParams(params_);
+  particles_.setParams(params_);
 }
 
 void LocalizationModule::specifyMemoryDependency() {
@@ -13,6 +31,7 @@ void LocalizationModule::specifyMemoryDependency() {
   requiresMemoryBlock("vision_frame_info");
   requiresMemoryBlock("robot_state");
   requiresMemoryBlock("game_state");
+  requiresMemoryBlock("vision_odometry");
 }
 
 void LocalizationModule::specifyMemoryBlocks() {
@@ -21,19 +40,190 @@ void LocalizationModule::specifyMemoryBlocks() {
   getOrAddMemoryBlock(cache_.frame_info,"vision_frame_info");
   getOrAddMemoryBlock(cache_.robot_state,"robot_state");
   getOrAddMemoryBlock(cache_.game_state,"game_state");
+  getOrAddMemoryBlock(cache_.odometry,"vision_odometry");
 }
 
 void LocalizationModule::initSpecificModule() {
+  // every robot in a simulation draws its own particle noise
+  particles_.setRandom(Random::stream("particles", cache_.robot_state->global_index_));
+  reInit();
 }
 
 void LocalizationModule::initFromMemory() {
+  auto& state = cache_.localization_mem->state[0];
+  Pose2D pose(state[(int)LocalizationState::SelfTheta], state[(int)LocalizationState::SelfX], state[(int)LocalizationState::SelfY]);
+  resetPoses(&pose, 1);
+  last_time_ = -1;
+  publish();
 }
 
 void LocalizationModule::initFromWorld() {
+  auto& self = cache_.world_object->objects_[cache_.robot_state->WO_SELF];
+  Pose2D pose(self.orientation, self.loc.x, self.loc.y);
+  resetPoses(&pose, 1);
+  last_time_ = -1;
+  publish();
 }
 
 void LocalizationModule::reInit() {
+  for (int i = 0; i < Spawns::NUM_SpawnTypes; i++)
+    cache_.localization_mem->spawnFrames[i] = 0;
+  spawnSideline(Spawns::InitialState);
+  last_time_ = -1;
+  last_state_ = cache_.game_state->state();
+  getting_up_ = false;
+  publish();
+}
+
+void LocalizationModule::spawnSideline(Spawns::SpawnType spawn) {
+  // either sideline of our half, facing into the field
+  Pose2D poses[] = {
+    Pose2D(-M_PI / 2, -HALF_FIELD_X / 2, HALF_FIELD_Y),
+    Pose2D(M_PI / 2, -HALF_FIELD_X / 2, -HALF_FIELD_Y)
+  };
+  resetPoses(poses, 2);
+  cache_.localization_mem->spawnFrames[spawn] = cache_.frame_info->frame_id;
+}
+
+void LocalizationModule::resetPoses(const Pose2D* poses, int count) {
+  if (method_ == LocalizationMethod::Particle)
+    particles_.reset(poses, count, params_.spawn_sd_xy, params_.spawn_sd_theta);
+  else
+    ekf_.reset(poses, count, params_.spawn_sd_xy, params_.spawn_sd_theta);
+  ball_ = Point2D(0, 0);
+  ballVar_ = MultiModelEKF::BALL_LOST_VAR * 4;
 }
 
 void LocalizationModule::processFrame() {
+  timer_.start();
+  double now = cache_.frame_info->seconds_since_start;
+  float timePassed = last_time_ < 0 ? 0 : std::min(std::max(now - last_time_, 0.0), (double)MAX_TIME_PASSED);
+  last_time_ = now;
+
+  int state = cache_.game_state->state();
+  if (last_state_ == PENALISED && state != PENALISED) {
+    spawnSideline(Spawns::PenalizedState);
+    locLog((20, "returning from penalty, models reset to the sidelines"));
+  }
+  last_state_ = state;
+
+  bool gettingUp = cache_.odometry->getting_up_side_ != Getup::NONE;
+  if (gettingUp && !getting_up_) {
+    if (method_ == LocalizationMethod::Particle)
+      particles_.addOrientationUncertainty(params_.fallen_sd_theta);
+    else
+      ekf_.addOrientationUncertainty(params_.fallen_sd_theta);
+    cache_.localization_mem->spawnFrames[Spawns::Fallen] = cache_.frame_info->frame_id;
+    locLog((20, "fallen, orientation sd widened by %2.2f", params_.fallen_sd_theta));
+  }
+  getting_up_ = gettingUp;
+
+  LocalizationObservation observations[MultiModelEKF::MAX_OBSERVATIONS];
+  int count = LocalizationObservation::collect(*cache_.world_object, params_, observations, MultiModelEKF::MAX_OBSERVATIONS);
+  if (method_ == LocalizationMethod::Particle) {
+    particles_.predict(cache_.odometry->displacement);
+    particles_.update(observations, count);
+  } else {
+    ekf_.predict(cache_.odometry->displacement, timePassed);
+    ekf_.update(observations, count);
+  }
+  publish(timePassed);
+  timer_.stop();
+
+  locLog((40, "%i observations, %i %s, best (%5.0f, %5.0f, %2.2f) alpha %1.3f, frame took %.3f ms",
+    count, method_ == LocalizationMethod::Particle ? particles_.size() : ekf_.size(),
+    method_ == LocalizationMethod::Particle ? "particles" : "models",
+    cache_.localization_mem->state[0][0], cache_.localization_mem->state[0][1], cache_.localization_mem->state[0][2],
+    cache_.localization_mem->alpha[0], timer_.lasttime() * 1000));
+}
+
+void LocalizationModule::publish(float timePassed) {
+  if (method_ == LocalizationMethod::Particle)
+    publishParticles(timePassed);
+  else
+    publishModels();
+  publishWorldObjects();
+}
+
+void LocalizationModule::publishParticles(float timePassed) {
+  LocalizationBlock& mem = *cache_.localization_mem;
+  mem.factor = 1;
+  mem.useSR = false;
+  mem.bestModel = 0;
+  mem.fallenModels = cache_.frame_info->frame_id - mem.spawnFrames[Spawns::Fallen] < 30 && mem.spawnFrames[Spawns::Fallen] > 0;
+  for (int i = 0; i < MAX_MODELS_IN_MEM; i++) {
+    mem.state[i].setZero();
+    mem.covariance[i].setZero();
+    mem.alpha[i] = 0;
+  }
+
+  float varX, varY, varTheta, weight;
+  Pose2D pose = particles_.estimate(varX, varY, varTheta, weight);
+  mem.oppositeModels = particles_.oppositeWeight(pose) > 0.1;
+  mem.modelNumber[0] = 0;
+  mem.alpha[0] = mem.bestAlpha = weight;
+
+  // the particles only carry the pose, so the ball is placed wherever it was last seen from
+  // it; while it isn't seen its variance grows as the EKF's does, until it reads as lost
+  WorldObject& seen = cache_.world_object->objects_[WO_BALL];
+  if (seen.seen) {
+    ball_ = Point2D(seen.visionDistance, seen.visionBearing, POLAR).relativeToGlobal(Point2D(pose.translation.x, pose.translation.y), pose.rotation);
+    ballVar_ = square(params_.dist_error_offset + params_.ball_dist_error_relative * seen.visionDistance);
+  } else
+    ballVar_ += square(params_.ball_position_noise * timePassed);
+  mem.state[0] << pose.translation.x, pose.translation.y, pose.rotation, ball_.x, ball_.y, 0, 0, 0, 0, 0;
+  mem.covariance[0].diagonal() << varX, varY, varTheta, ballVar_, ballVar_, 0, 0, 0, 0, 0;
+}
+
+void LocalizationModule::publishModels() {
+  LocalizationBlock& mem = *cache_.localization_mem;
+  mem.factor = 1;
+  mem.useSR = false;
+  mem.bestModel = 0;
+  mem.bestAlpha = ekf_.model(0).alpha;
+  mem.oppositeModels = false;
+  mem.fallenModels = cache_.frame_info->frame_id - mem.spawnFrames[Spawns::Fallen] < 30 && mem.spawnFrames[Spawns::Fallen] > 0;
+  const MultiModelEKF::Model& best = ekf_.model(0);
+  for (int i = 0; i < MAX_MODELS_IN_MEM; i++) {
+    mem.state[i].setZero();
+    mem.covariance[i].setZero();
+    if (i >= ekf_.size()) {
+      mem.alpha[i] = 0;
+      continue;
+    }
+    const MultiModelEKF::Model& model = ekf_.model(i);
+    mem.modelNumber[i] = model.id;
+    mem.alpha[i] = model.alpha;
+    mem.state[i].head<MultiModelEKF::STATES>() = model.x;
+    mem.covariance[i].topLeftCorner<MultiModelEKF::STATES, MultiModelEKF::STATES>() = model.P;
+    if (i > 0 && fabs(normalizeAngle(model.x[2] - best.x[2])) > M_PI / 2 && model.alpha > 0.1)
+      mem.oppositeModels = true;
+  }
+}
+
+void LocalizationModule::publishWorldObjects() {
+  LocalizationBlock& mem = *cache_.localization_mem;
+  auto& best = mem.state[mem.bestModel];
+  auto& cov = mem.covariance[mem.bestModel];
+  WorldObject& self = cache_.world_object->objects_[cache_.robot_state->WO_SELF];
+  self.loc = Point2D(best[0], best[1]);
+  self.orientation = best[2];
+  self.sd = Point2D(sqrtf(cov(0, 0)), sqrtf(cov(1, 1)));
+  self.sdOrientation = sqrtf(cov(2, 2));
+
+  WorldObject& ball = cache_.world_object->objects_[WO_BALL];
+  ball.loc = Point2D(best[3], best[4]);
+  ball.absVel = Point2D(best[5], best[6]);
+  ball.sd = Point2D(sqrtf(cov(3, 3)), sqrtf(cov(4, 4)));
+  ball.relPos = ball.loc.globalToRelative(self.loc, self.orientation);
+  ball.relVel = ball.absVel.rotate(-self.orientation);
+  ball.distance = ball.relPos.getMagnitude();
+  ball.bearing = ball.relPos.getDirection();
+
+  // relative positions of the fixed landmarks from the best pose
+  for (int i = LANDMARK_OFFSET; i < LANDMARK_OFFSET + NUM_LANDMARKS; i++) {
+    WorldObject& wo = cache_.world_object->objects_[i];
+    wo.distance = self.loc.getDistanceTo(wo.loc);
+    wo.bearing = self.loc.getBearingTo(wo.loc, self.orientation);
+  }
 }
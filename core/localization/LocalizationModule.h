@@ -3,10 +3,15 @@
 #include <Module.h>
 #include <memory/MemoryCache.h>
 #include <localization/LocalizationParams.h>
+#include <localization/LocalizationMethod.h>
+#include <localization/MultiModelEKF.h>
+#include <localization/ParticleFilter.h>
+#include <memory/LocalizationBlock.h>
+#include <common/Profiling.h>
 
 class LocalizationModule : public Module {
   public:
-    LocalizationModule();
+    LocalizationModule(LocalizationMethod::Type method = LocalizationMethod::Default);
     void specifyMemoryDependency();
     void specifyMemoryBlocks();
     void initSpecificModule();
@@ -17,7 +22,26 @@ class LocalizationModule : public Module {
 
     void loadParams(LocalizationParams params);
   protected:
+    // Restarts the filter from the sideline poses robots enter the field from
+    void spawnSideline(Spawns::SpawnType spawn);
+    void resetPoses(const Pose2D* poses, int count);
+    // Publishes the estimate, with the ball aged by timePassed seconds on the particle filter
+    void publish(float timePassed = 0);
+    void publishModels();
+    void publishParticles(float timePassed);
+    // Fills the robot, ball and landmark world objects from the best model in memory
+    void publishWorldObjects();
+
     MemoryCache cache_;
     TextLogger*& tlogger_;
     LocalizationParams params_;
+    LocalizationMethod::Type method_;
+    MultiModelEKF ekf_;
+    ParticleFilter particles_;
+    Point2D ball_;
+    float ballVar_;
+    Timer timer_;
+    double last_time_;
+    int last_state_;
+    bool getting_up_;
 };
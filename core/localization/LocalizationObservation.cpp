@@ -0,0 +1,90 @@
+#include <localization/LocalizationObservation.h>
+#include <memory/WorldObjectBlock.h>
+#include <common/Field.h>
+
+namespace {
+  void addCandidates(LocalizationObservation& obs, int first, int last) {
+    for (int i = first; i <= last && obs.numCandidates < LocalizationObservation::MAX_CANDIDATES; i++)
+      obs.candidates[obs.numCandidates++] = i;
+  }
+
+  // The field objects an observed world object may be, none if it isn't a landmark
+  void fillCandidates(LocalizationObservation& obs, int type) {
+    obs.numCandidates = 0;
+    switch (type) {
+      case WO_UNKNOWN_GOAL: addCandidates(obs, WO_OWN_GOAL, WO_OPP_GOAL); break;
+      case WO_UNKNOWN_LEFT_GOALPOST: addCandidates(obs, WO_OWN_LEFT_GOALPOST, WO_OPP_LEFT_GOALPOST); break;
+      case WO_UNKNOWN_RIGHT_GOALPOST: addCandidates(obs, WO_OWN_RIGHT_GOALPOST, WO_OPP_RIGHT_GOALPOST); break;
+      case WO_UNKNOWN_GOALPOST: addCandidates(obs, WO_OWN_LEFT_GOALPOST, WO_OPP_RIGHT_GOALPOST); break;
+      case WO_UNKNOWN_L_1: case WO_UNKNOWN_L_2: addCandidates(obs, WO_OPP_FIELD_LEFT_L, WO_OWN_BACK_LEFT_GOAL_L); break;
+      case WO_UNKNOWN_T_1: case WO_UNKNOWN_T_2: addCandidates(obs, WO_OPP_PEN_LEFT_T, WO_OWN_FRONT_LEFT_GOAL_T); break;
+      case WO_UNKNOWN_PENALTY_CROSS: addCandidates(obs, WO_OWN_PENALTY_CROSS, WO_OPP_PENALTY_CROSS); break;
+      case WO_UNKNOWN_FIELD_LINE_1: case WO_UNKNOWN_FIELD_LINE_2:
+      case WO_UNKNOWN_FIELD_LINE_3: case WO_UNKNOWN_FIELD_LINE_4:
+        addCandidates(obs, LINE_OFFSET, LINE_OFFSET + NUM_LINES - 1); break;
+      default:
+        if ((type >= LANDMARK_OFFSET && type < LANDMARK_OFFSET + NUM_LANDMARKS) ||
+            (type >= INTERSECTION_OFFSET && type < INTERSECTION_OFFSET + NUM_INTERSECTIONS) ||
+            (type >= LINE_OFFSET && type < LINE_OFFSET + NUM_LINES) ||
+            type == WO_OWN_PENALTY_CROSS || type == WO_OPP_PENALTY_CROSS)
+          addCandidates(obs, type, type);
+    }
+  }
+}
+
+Point2D LocalizationObservation::location(int type) {
+  if (type >= LANDMARK_OFFSET && type < LANDMARK_OFFSET + NUM_LANDMARKS)
+    return landmarkLocation[type - LANDMARK_OFFSET];
+  if (type >= INTERSECTION_OFFSET && type < INTERSECTION_OFFSET + NUM_INTERSECTIONS)
+    return intersectionLocation[type - INTERSECTION_OFFSET];
+  if (type == WO_OWN_PENALTY_CROSS) return ownCrossLocation;
+  return oppCrossLocation;
+}
+
+int LocalizationObservation::collect(const WorldObjectBlock& objects, const LocalizationParams& params,
+    LocalizationObservation* observations, int maxCount) {
+  int count = 0;
+  for (int i = 0; i < NUM_WORLD_OBJS && count < maxCount; i++) {
+    const WorldObject& wo = objects.objects_[i];
+    if (!wo.seen) continue;
+    LocalizationObservation& obs = observations[count];
+    obs.type = i;
+    if (i == WO_BALL) {
+      obs.kind = LocalizationObservation::Ball;
+      obs.numCandidates = 0;
+      obs.distance = wo.visionDistance;
+      obs.bearing = wo.visionBearing;
+      obs.distanceVar = square(params.dist_error_offset + params.ball_dist_error_relative * obs.distance);
+      obs.bearingVar = square(params.ball_bearing_error);
+      count++;
+      continue;
+    }
+    fillCandidates(obs, i);
+    if (obs.numCandidates == 0) continue;
+    if (wo.isUnknownLine() || wo.isKnownLine()) {
+      // the closest point of the infinite line through the seen segment
+      Point2D start = wo.visionLine.start, end = wo.visionLine.end;
+      Point2D dir = end - start;
+      float length2 = dir.x * dir.x + dir.y * dir.y;
+      if (length2 < 1) continue;
+      float t = -(start.x * dir.x + start.y * dir.y) / length2;
+      Point2D foot = start + dir * t;
+      obs.kind = LocalizationObservation::Line;
+      obs.start = start;
+      obs.end = end;
+      obs.distance = sqrtf(foot.x * foot.x + foot.y * foot.y);
+      if (obs.distance < params.min_line_distance) continue;
+      obs.bearing = atan2f(foot.y, foot.x);
+      obs.distanceVar = square(params.dist_error_offset + params.line_dist_error_relative * obs.distance);
+      obs.bearingVar = square(params.line_bearing_error);
+    } else {
+      obs.kind = LocalizationObservation::Point;
+      obs.distance = wo.visionDistance;
+      obs.bearing = wo.visionBearing;
+      obs.distanceVar = square(params.dist_error_offset + params.dist_error_relative * obs.distance);
+      obs.bearingVar = square(params.bearing_error);
+    }
+    count++;
+  }
+  return count;
+}
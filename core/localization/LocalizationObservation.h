@@ -0,0 +1,30 @@
+#pragma once
+
+#include <common/WorldObject.h>
+#include <localization/LocalizationParams.h>
+
+class WorldObjectBlock;
+
+/* A landmark observation taken from the world objects once per frame and shared by
+ * every model or particle: the range and bearing to a point, and the field objects it
+ * may be. For lines the point is the foot of the perpendicular from the robot to the
+ * line, the candidates are lines rather than points, and the ends of the seen segment
+ * are kept as well. */
+struct LocalizationObservation {
+  static const int MAX_CANDIDATES = NUM_LINES;
+  enum Kind { Point, Line, Ball };
+
+  Kind kind;
+  int type;
+  float distance, bearing;
+  float distanceVar, bearingVar;
+  Point2D start, end;
+  int candidates[MAX_CANDIDATES];
+  int numCandidates;
+
+  // Collects the seen landmarks and ball from the world objects, returns the count
+  static int collect(const WorldObjectBlock& objects, const LocalizationParams& params,
+      LocalizationObservation* observations, int maxCount);
+  // Field location of a point landmark candidate
+  static Point2D location(int type);
+};
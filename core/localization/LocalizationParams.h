@@ -1,4 +1,73 @@
 #pragma once
 
 struct LocalizationParams {
+  // Observation noise: range sd is offset + relative * distance (mm), bearing sd in rad
+  float dist_error_offset;
+  float dist_error_relative;
+  float bearing_error;
+  float ball_dist_error_relative;
+  float ball_bearing_error;
+  float line_dist_error_relative;
+  float line_bearing_error;
+  // Lines whose closest point is nearer than this (mm) have no usable direction
+  float min_line_distance;
+
+  // Odometry noise per frame: sd of the robot's motion is base + relative * motion
+  float odometry_xy_base;
+  float odometry_xy_relative;
+  float odometry_theta_base;
+  float odometry_theta_relative;
+  float ball_position_noise;  // mm per second
+  float ball_velocity_noise;  // mm/s per second
+  float ball_friction;        // fraction of ball velocity kept after a second
+
+  // Observations are dropped past this squared Mahalanobis distance
+  float outlier_thresh;
+  // Alpha of a model is multiplied by this for every unique landmark it rejects
+  float outlier_alpha_factor;
+  // An ambiguous observation splits a model into at most this many candidates
+  int max_splits;
+  // Models closer than these are merged
+  float merge_distance;
+  float merge_angle;
+  // Models below this share of the total alpha are dropped
+  float min_alpha;
+
+  // Uncertainty of the poses models are spawned at
+  float spawn_sd_xy;
+  float spawn_sd_theta;
+  float fallen_sd_theta;
+
+  // Particle filter: the particle count adapts between these (KLD sampling)
+  int min_particles;
+  int max_particles;
+  // KLD bound on the error of the sampled belief, and the upper normal quantile of its confidence
+  float kld_epsilon;
+  float kld_z;
+  // Histogram bins the KLD bound counts particles in
+  float kld_bin_xy;
+  float kld_bin_theta;
+  // Resample when the effective sample size drops below this fraction of the particles
+  float resample_thresh;
+  // Averaging rates of the short and long term observation likelihood; particles are
+  // injected across the field as the short term average falls below the long term one
+  float recovery_fast;
+  float recovery_slow;
+  // Points sampled along each seen line for the line likelihood field
+  int line_samples;
+  // Particles within these of the best particle form the published pose
+  float cluster_distance;
+  float cluster_angle;
+
+  LocalizationParams() :
+    dist_error_offset(100), dist_error_relative(0.15), bearing_error(0.1),
+    ball_dist_error_relative(0.1), ball_bearing_error(0.1),
+    line_dist_error_relative(0.1), line_bearing_error(0.2), min_line_distance(200),
+    odometry_xy_base(2), odometry_xy_relative(0.25), odometry_theta_base(0.003), odometry_theta_relative(0.25),
+    ball_position_noise(50), ball_velocity_noise(200), ball_friction(0.3),
+    outlier_thresh(16), outlier_alpha_factor(0.7), max_splits(4), merge_distance(300), merge_angle(0.3),
+    min_alpha(0.001), spawn_sd_xy(500), spawn_sd_theta(0.3), fallen_sd_theta(0.8),
+    min_particles(300), max_particles(2000), kld_epsilon(0.05), kld_z(2.33), kld_bin_xy(200), kld_bin_theta(0.2),
+    resample_thresh(0.5), recovery_fast(0.1), recovery_slow(0.01), line_samples(4),
+    cluster_distance(500), cluster_angle(0.5) { }
 };
@@ -3,5 +3,9 @@
 enum class LocalizationState {
   SelfX = 0,
   SelfY = 1,
-  SelfTheta = 2
+  SelfTheta = 2,
+  BallX = 3,
+  BallY = 4,
+  BallVelX = 5,
+  BallVelY = 6
 };
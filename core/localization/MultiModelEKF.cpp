@@ -0,0 +1,324 @@
+#include <localization/MultiModelEKF.h>
+#include <common/Field.h>
+#include <math/Geometry.h>
+#include <Eigen/Cholesky>
+#include <Eigen/LU>
+#include <algorithm>
+
+#define BALL_SPAWN_VEL_SD 500.0f
+
+typedef Eigen::Matrix<float, 2, MultiModelEKF::STATES> Jacobian;
+typedef Eigen::Matrix<float, Eigen::Dynamic, 1, 0, MultiModelEKF::MAX_ROWS, 1> RowVector;
+typedef Eigen::Matrix<float, Eigen::Dynamic, MultiModelEKF::STATES, 0, MultiModelEKF::MAX_ROWS, MultiModelEKF::STATES> RowJacobian;
+typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, 0, MultiModelEKF::MAX_ROWS, MultiModelEKF::MAX_ROWS> RowCovariance;
+typedef Eigen::Matrix<float, MultiModelEKF::STATES, Eigen::Dynamic, 0, MultiModelEKF::STATES, MultiModelEKF::MAX_ROWS> Gain;
+
+MultiModelEKF::MultiModelEKF() : size_(0), nextId_(0) {
+  Pose2D origin;
+  reset(&origin, 1, 0, 0);
+}
+
+void MultiModelEKF::setParams(const LocalizationParams& params) {
+  params_ = params;
+  if (params_.max_splits > MAX_SPLITS) params_.max_splits = MAX_SPLITS;
+  if (params_.max_splits < 1) params_.max_splits = 1;
+}
+
+void MultiModelEKF::reset(const Pose2D* poses, int count, float sdXY, float sdTheta) {
+  size_ = std::min(count, (int)MAX_MODELS);
+  for (int i = 0; i < size_; i++) {
+    Model& model = models_[i];
+    model.x << poses[i].translation.x, poses[i].translation.y, poses[i].rotation, 0, 0, 0, 0;
+    model.P.setZero();
+    model.P.diagonal() << square(sdXY), square(sdXY), square(sdTheta), BALL_LOST_VAR * 4, BALL_LOST_VAR * 4,
+      square(BALL_SPAWN_VEL_SD), square(BALL_SPAWN_VEL_SD);
+    model.alpha = 1.0f / size_;
+    model.id = nextId_++;
+  }
+}
+
+void MultiModelEKF::addOrientationUncertainty(float sdTheta) {
+  for (int i = 0; i < size_; i++)
+    models_[i].P(2, 2) += square(sdTheta);
+}
+
+void MultiModelEKF::predict(const Pose2D& odometry, float timePassed) {
+  float dx = odometry.translation.x, dy = odometry.translation.y;
+  float sdXY = params_.odometry_xy_base + params_.odometry_xy_relative * sqrtf(dx * dx + dy * dy);
+  float sdTheta = params_.odometry_theta_base + params_.odometry_theta_relative * fabs(odometry.rotation);
+  float friction = powf(params_.ball_friction, timePassed);
+
+  Covariance Q = Covariance::Zero();
+  Q.diagonal() << square(sdXY), square(sdXY), square(sdTheta),
+    square(params_.ball_position_noise * timePassed), square(params_.ball_position_noise * timePassed),
+    square(params_.ball_velocity_noise * timePassed), square(params_.ball_velocity_noise * timePassed);
+
+  for (int i = 0; i < size_; i++) {
+    Model& model = models_[i];
+    float c = cosf(model.x[2]), s = sinf(model.x[2]);
+    Covariance F = Covariance::Identity();
+    F(0, 2) = -s * dx - c * dy;
+    F(1, 2) = c * dx - s * dy;
+    F(3, 5) = F(4, 6) = timePassed;
+    F(5, 5) = F(6, 6) = friction;
+
+    model.x[0] += c * dx - s * dy;
+    model.x[1] += s * dx + c * dy;
+    model.x[2] = normalizeAngle(model.x[2] + odometry.rotation);
+    model.x[3] += model.x[5] * timePassed;
+    model.x[4] += model.x[6] * timePassed;
+    model.x[5] *= friction;
+    model.x[6] *= friction;
+    model.P = F * model.P * F.transpose() + Q;
+  }
+}
+
+void MultiModelEKF::predictMeasurement(const Model& model, const LocalizationObservation& obs, int candidate,
+    float& distance, float& bearing, Jacobian& H) const {
+  H.setZero();
+  if (obs.kind == LocalizationObservation::Line) {
+    // the foot of the perpendicular doesn't turn as the robot moves, only its distance changes
+    Point2D start = lineLocationStarts[candidate - LINE_OFFSET], end = lineLocationEnds[candidate - LINE_OFFSET];
+    Point2D dir = end - start;
+    float t = ((model.x[0] - start.x) * dir.x + (model.x[1] - start.y) * dir.y) / (dir.x * dir.x + dir.y * dir.y);
+    float dx = start.x + dir.x * t - model.x[0], dy = start.y + dir.y * t - model.x[1];
+    distance = std::max(sqrtf(dx * dx + dy * dy), 1.0f);
+    bearing = normalizeAngle(atan2f(dy, dx) - model.x[2]);
+    H(0, 0) = -dx / distance;
+    H(0, 1) = -dy / distance;
+    H(1, 2) = -1;
+    return;
+  }
+  float dx, dy;
+  if (obs.kind == LocalizationObservation::Ball) {
+    dx = model.x[3] - model.x[0];
+    dy = model.x[4] - model.x[1];
+  } else {
+    Point2D loc = LocalizationObservation::location(candidate);
+    dx = loc.x - model.x[0];
+    dy = loc.y - model.x[1];
+  }
+  float distance2 = std::max(dx * dx + dy * dy, 1.0f);
+  distance = sqrtf(distance2);
+  bearing = normalizeAngle(atan2f(dy, dx) - model.x[2]);
+  H(0, 0) = -dx / distance;
+  H(0, 1) = -dy / distance;
+  H(1, 0) = dy / distance2;
+  H(1, 1) = -dx / distance2;
+  H(1, 2) = -1;
+  if (obs.kind == LocalizationObservation::Ball) {
+    H(0, 3) = -H(0, 0);
+    H(0, 4) = -H(0, 1);
+    H(1, 3) = -H(1, 0);
+    H(1, 4) = -H(1, 1);
+  }
+}
+
+float MultiModelEKF::innovation(const Model& model, const LocalizationObservation& obs, int candidate, float& likelihood) const {
+  float distance, bearing;
+  Jacobian H;
+  predictMeasurement(model, obs, candidate, distance, bearing, H);
+  Eigen::Matrix2f S = H * model.P * H.transpose();
+  S(0, 0) += obs.distanceVar;
+  S(1, 1) += obs.bearingVar;
+  Eigen::Vector2f y(obs.distance - distance, normalizeAngle(obs.bearing - bearing));
+  float m2 = y.dot(S.inverse() * y);
+  likelihood = -0.5f * m2;
+  return m2;
+}
+
+int MultiModelEKF::nearestCandidate(const Model& model, const LocalizationObservation& obs, float& likelihood) const {
+  int best = -1;
+  float bestM2 = params_.outlier_thresh;
+  for (int i = 0; i < obs.numCandidates; i++) {
+    float l;
+    float m2 = innovation(model, obs, obs.candidates[i], l);
+    if (m2 < bestM2) {
+      bestM2 = m2;
+      best = obs.candidates[i];
+      likelihood = l;
+    }
+  }
+  return best;
+}
+
+void MultiModelEKF::batchUpdate(Model& model, const LocalizationObservation* const* observations, const int* candidates, int count) const {
+  if (count == 0) return;
+  int rows = 2 * count;
+  RowVector y(rows), R(rows);
+  RowJacobian H(rows, STATES);
+  for (int i = 0; i < count; i++) {
+    const LocalizationObservation& obs = *observations[i];
+    float distance, bearing;
+    Jacobian h;
+    predictMeasurement(model, obs, candidates[i], distance, bearing, h);
+    H.middleRows<2>(2 * i) = h;
+    y[2 * i] = obs.distance - distance;
+    y[2 * i + 1] = normalizeAngle(obs.bearing - bearing);
+    R[2 * i] = obs.distanceVar;
+    R[2 * i + 1] = obs.bearingVar;
+  }
+  Gain PHt = model.P * H.transpose();
+  RowCovariance S = H * PHt;
+  S.diagonal() += R;
+  Gain K = S.ldlt().solve(PHt.transpose()).transpose();
+  model.x += K * y;
+  model.x[2] = normalizeAngle(model.x[2]);
+  model.P -= K * H * model.P;
+  model.P = 0.5f * (model.P + model.P.transpose());
+}
+
+void MultiModelEKF::update(const LocalizationObservation* observations, int count) {
+  // The ball and the landmarks each model can associate alone go in one batch per model
+  float logLikelihood[MAX_MODELS * MAX_SPLITS];
+  for (int m = 0; m < size_; m++) {
+    Model& model = models_[m];
+    const LocalizationObservation* batch[MAX_OBSERVATIONS];
+    int candidates[MAX_OBSERVATIONS];
+    int n = 0;
+    logLikelihood[m] = 0;
+    for (int i = 0; i < count; i++) {
+      const LocalizationObservation& obs = observations[i];
+      float l = 0;
+      if (obs.kind == LocalizationObservation::Ball) {
+        if (model.P(3, 3) > BALL_LOST_VAR || innovation(model, obs, -1, l) > params_.outlier_thresh) {
+          // a ball that is new or was moved is placed where it's seen
+          float c = cosf(model.x[2] + obs.bearing), s = sinf(model.x[2] + obs.bearing);
+          model.x[3] = model.x[0] + obs.distance * c;
+          model.x[4] = model.x[1] + obs.distance * s;
+          model.x[5] = model.x[6] = 0;
+          model.P.block<4, STATES>(3, 0).setZero();
+          model.P.block<STATES, 4>(0, 3).setZero();
+          float along = obs.distanceVar, across = obs.bearingVar * obs.distance * obs.distance;
+          model.P(3, 3) = c * c * along + s * s * across;
+          model.P(4, 4) = s * s * along + c * c * across;
+          model.P(3, 4) = model.P(4, 3) = c * s * (along - across);
+          model.P(5, 5) = model.P(6, 6) = square(BALL_SPAWN_VEL_SD);
+          continue;
+        }
+        batch[n] = &obs;
+        candidates[n++] = -1;
+        continue;
+      }
+      if (obs.kind == LocalizationObservation::Point && obs.numCandidates > 1) continue;
+      int candidate = nearestCandidate(model, obs, l);
+      if (candidate < 0) {
+        if (obs.kind == LocalizationObservation::Point)
+          logLikelihood[m] += logf(params_.outlier_alpha_factor);
+        continue;
+      }
+      logLikelihood[m] += l;
+      batch[n] = &obs;
+      candidates[n++] = candidate;
+    }
+    batchUpdate(model, batch, candidates, n);
+  }
+
+  // Ambiguous landmarks split every model into one child per candidate inside the gate
+  for (int i = 0; i < count; i++) {
+    const LocalizationObservation& obs = observations[i];
+    if (obs.kind != LocalizationObservation::Point || obs.numCandidates < 2) continue;
+    int children = 0;
+    float childLikelihood[MAX_MODELS * MAX_SPLITS];
+    for (int m = 0; m < size_; m++) {
+      int best[MAX_SPLITS];
+      float bestM2[MAX_SPLITS], bestL[MAX_SPLITS];
+      int found = 0;
+      for (int c = 0; c < obs.numCandidates; c++) {
+        float l;
+        float m2 = innovation(models_[m], obs, obs.candidates[c], l);
+        if (m2 > params_.outlier_thresh) continue;
+        if (found == params_.max_splits && m2 >= bestM2[found - 1]) continue;
+        int j = found < params_.max_splits ? found++ : found - 1;
+        for (; j > 0 && bestM2[j - 1] > m2; j--) {
+          best[j] = best[j - 1];
+          bestM2[j] = bestM2[j - 1];
+          bestL[j] = bestL[j - 1];
+        }
+        best[j] = obs.candidates[c];
+        bestM2[j] = m2;
+        bestL[j] = l;
+      }
+      if (found == 0) {
+        children_[children] = models_[m];
+        childLikelihood[children++] = logLikelihood[m] + logf(params_.outlier_alpha_factor);
+        continue;
+      }
+      for (int c = 0; c < found; c++) {
+        Model& child = children_[children];
+        child = models_[m];
+        if (c > 0) child.id = nextId_++;
+        const LocalizationObservation* single = &obs;
+        batchUpdate(child, &single, &best[c], 1);
+        childLikelihood[children++] = logLikelihood[m] + bestL[c];
+      }
+    }
+    for (int m = 0; m < children; m++) {
+      models_[m] = children_[m];
+      logLikelihood[m] = childLikelihood[m];
+    }
+    size_ = children;
+    if (size_ > MAX_MODELS) {
+      // fold the likelihoods in so the reduction keeps the strongest children
+      float maxL = logLikelihood[0];
+      for (int m = 1; m < size_; m++) maxL = std::max(maxL, logLikelihood[m]);
+      for (int m = 0; m < size_; m++) {
+        models_[m].alpha *= expf(logLikelihood[m] - maxL);
+        logLikelihood[m] = 0;
+      }
+      reduce();
+    }
+  }
+
+  if (size_ == 0) return;
+  float maxL = logLikelihood[0];
+  for (int m = 1; m < size_; m++) maxL = std::max(maxL, logLikelihood[m]);
+  for (int m = 0; m < size_; m++)
+    models_[m].alpha *= expf(logLikelihood[m] - maxL);
+  reduce();
+}
+
+void MultiModelEKF::normalize() {
+  float total = 0;
+  for (int i = 0; i < size_; i++) total += models_[i].alpha;
+  if (total <= 0) {
+    for (int i = 0; i < size_; i++) models_[i].alpha = 1.0f / size_;
+    return;
+  }
+  for (int i = 0; i < size_; i++) models_[i].alpha /= total;
+}
+
+void MultiModelEKF::reduce() {
+  normalize();
+
+  // Merge models that have converged onto the same pose, matching their moments
+  for (int i = 0; i < size_; i++) {
+    for (int j = i + 1; j < size_; j++) {
+      Model &a = models_[i], &b = models_[j];
+      if (fabs(a.x[0] - b.x[0]) > params_.merge_distance || fabs(a.x[1] - b.x[1]) > params_.merge_distance ||
+          fabs(normalizeAngle(a.x[2] - b.x[2])) > params_.merge_angle)
+        continue;
+      float alpha = a.alpha + b.alpha;
+      float wa = a.alpha / alpha, wb = b.alpha / alpha;
+      State db = b.x - a.x;
+      db[2] = normalizeAngle(db[2]);
+      State x = a.x + wb * db;
+      State da = a.x - x, dbm = a.x + db - x;
+      a.P = wa * (a.P + da * da.transpose()) + wb * (b.P + dbm * dbm.transpose());
+      a.x = x;
+      a.x[2] = normalizeAngle(a.x[2]);
+      if (b.alpha > a.alpha) a.id = b.id;
+      a.alpha = alpha;
+      models_[j--] = models_[--size_];
+    }
+  }
+
+  // Sort by alpha, then drop the weak and everything past MAX_MODELS
+  for (int i = 1; i < size_; i++) {
+    for (int j = i; j > 0 && models_[j].alpha > models_[j - 1].alpha; j--)
+      std::swap(models_[j], models_[j - 1]);
+  }
+  while (size_ > 1 && (size_ > MAX_MODELS || models_[size_ - 1].alpha < params_.min_alpha))
+    size_--;
+  normalize();
+}
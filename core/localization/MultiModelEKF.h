@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <math/Pose2D.h>
+#include <localization/LocalizationObservation.h>
+
+/* Multi-model extended Kalman filter over the robot pose and the ball. Each model is
+ * a 7 state EKF, x, y, theta (mm, rad) then the ball's position and velocity (mm,
+ * mm/s), on fixed-size Eigen types. Every frame all the observations a model can
+ * associate on its own, the ball, unique landmarks and field lines matched to the
+ * nearest candidate line, are stacked into one batched update. Ambiguous landmarks
+ * with more than one plausible candidate then split the model, one child per
+ * candidate, weighted by their likelihoods. Models that converge are merged and
+ * the weakest are dropped after every split, so no more than MAX_MODELS are ever
+ * carried between frames or MAX_MODELS * max_splits within one. */
+class MultiModelEKF {
+  public:
+    static const int STATES = 7;
+    static const int MAX_MODELS = 8;
+    static const int MAX_SPLITS = 4;
+    static const int MAX_OBSERVATIONS = 16;
+    static const int MAX_ROWS = 2 * MAX_OBSERVATIONS;
+    // Ball position variance past which the ball is lost and respawned where it's next seen
+    static constexpr float BALL_LOST_VAR = 2000.0f * 2000.0f;
+
+    typedef Eigen::Matrix<float, STATES, 1> State;
+    typedef Eigen::Matrix<float, STATES, STATES> Covariance;
+
+    struct Model {
+      State x;
+      Covariance P;
+      float alpha;
+      int id;
+    };
+
+    MultiModelEKF();
+    void setParams(const LocalizationParams& params);
+
+    // Drops every model and starts over from the given poses, with equal alpha
+    void reset(const Pose2D* poses, int count, float sdXY, float sdTheta);
+    // Widens the orientation uncertainty of every model, after a fall
+    void addOrientationUncertainty(float sdTheta);
+
+    void predict(const Pose2D& odometry, float timePassed);
+    void update(const LocalizationObservation* observations, int count);
+
+    int size() const { return size_; }
+    // Models by descending alpha, which sums to 1
+    const Model& model(int i) const { return models_[i]; }
+
+  private:
+    // Expected measurement and its Jacobian for observation against candidate
+    void predictMeasurement(const Model& model, const LocalizationObservation& obs, int candidate,
+        float& distance, float& bearing, Eigen::Matrix<float, 2, STATES>& H) const;
+    // Squared Mahalanobis distance of the observation from the candidate, and its likelihood
+    float innovation(const Model& model, const LocalizationObservation& obs, int candidate, float& likelihood) const;
+    // Picks the candidate of a line with the smallest innovation, -1 if none is inside the gate
+    int nearestCandidate(const Model& model, const LocalizationObservation& obs, float& likelihood) const;
+    void batchUpdate(Model& model, const LocalizationObservation* const* observations, const int* candidates, int count) const;
+    void reduce();
+    void normalize();
+
+    LocalizationParams params_;
+    Model models_[MAX_MODELS * MAX_SPLITS];
+    Model children_[MAX_MODELS * MAX_SPLITS];
+    int size_;
+    int nextId_;
+};
@@ -0,0 +1,267 @@
+#include <localization/ParticleFilter.h>
+#include <localization/LineLikelihoodField.h>
+#include <common/Field.h>
+#include <math/Geometry.h>
+#include <algorithm>
+
+ParticleFilter::ParticleFilter() : size_(0), target_(0), recoveryFast_(0), recoverySlow_(0) {
+  // built here rather than on the first seen line, so no frame pays for it
+  LineLikelihoodField::field();
+  float* arrays[] = { x_, y_, theta_, weight_, cos_, sin_, logLikelihood_, scratch_, nextX_, nextY_, nextTheta_, noiseX_, noiseY_, noiseTheta_ };
+  for (float* array : arrays) std::fill(array, array + MAX_PARTICLES, 0.0f);
+  setParams(params_);
+  resetUniform();
+}
+
+void ParticleFilter::setParams(const LocalizationParams& params) {
+  params_ = params;
+  params_.max_particles = std::min(std::max(params_.max_particles, 1), (int)MAX_PARTICLES);
+  params_.min_particles = std::min(std::max(params_.min_particles, 1), params_.max_particles);
+  params_.line_samples = std::max(params_.line_samples, 1);
+  binsX_ = (int)(GRASS_X / params_.kld_bin_xy) + 1;
+  binsY_ = (int)(GRASS_Y / params_.kld_bin_xy) + 1;
+  binsTheta_ = (int)(2 * M_PI / params_.kld_bin_theta) + 1;
+  occupied_.assign((binsX_ * binsY_ * binsTheta_ + 63) / 64, 0);
+  clustersX_ = (int)(GRASS_X / params_.cluster_distance) + 1;
+  clustersY_ = (int)(GRASS_Y / params_.cluster_distance) + 1;
+  clustersTheta_ = (int)(2 * M_PI / params_.cluster_angle) + 1;
+  clusters_.assign(clustersX_ * clustersY_ * clustersTheta_, 0);
+  target_ = std::min(std::max(target_, params_.min_particles), params_.max_particles);
+}
+
+void ParticleFilter::reset(const Pose2D* poses, int count, float sdXY, float sdTheta) {
+  size_ = target_ = params_.max_particles;
+  for (int i = 0; i < size_; i++) {
+    const Pose2D& pose = poses[i * count / size_];
+    x_[i] = rand_.sampleN(pose.translation.x, sdXY);
+    y_[i] = rand_.sampleN(pose.translation.y, sdXY);
+    theta_[i] = normalizeAngle(rand_.sampleN(pose.rotation, sdTheta));
+    weight_[i] = 1.0f / size_;
+  }
+  recoveryFast_ = recoverySlow_ = 0;
+}
+
+void ParticleFilter::resetUniform() {
+  size_ = target_ = params_.max_particles;
+  for (int i = 0; i < size_; i++) {
+    x_[i] = rand_.sampleU(-HALF_FIELD_X, HALF_FIELD_X);
+    y_[i] = rand_.sampleU(-HALF_FIELD_Y, HALF_FIELD_Y);
+    theta_[i] = rand_.sampleU(-M_PI, M_PI);
+    weight_[i] = 1.0f / size_;
+  }
+  recoveryFast_ = recoverySlow_ = 0;
+}
+
+void ParticleFilter::addOrientationUncertainty(float sdTheta) {
+  for (int i = 0; i < size_; i++)
+    theta_[i] = normalizeAngle(rand_.sampleN(theta_[i], sdTheta));
+}
+
+void ParticleFilter::predict(const Pose2D& odometry) {
+  float dx = odometry.translation.x, dy = odometry.translation.y, dtheta = odometry.rotation;
+  float sdXY = params_.odometry_xy_base + params_.odometry_xy_relative * sqrtf(dx * dx + dy * dy);
+  float sdTheta = params_.odometry_theta_base + params_.odometry_theta_relative * fabs(dtheta);
+  rand_.sampleN(noiseX_, size_, 0, sdXY);
+  rand_.sampleN(noiseY_, size_, 0, sdXY);
+  rand_.sampleN(noiseTheta_, size_, 0, sdTheta);
+  for (int i = 0; i < size_; i++) {
+    cos_[i] = cosf(theta_[i]);
+    sin_[i] = sinf(theta_[i]);
+  }
+  // headings are wrapped back into range by update, which takes their cosines anyway
+  for (int i = 0, n = lanes(); i < n; i++) {
+    float mx = dx + noiseX_[i], my = dy + noiseY_[i];
+    x_[i] += cos_[i] * mx - sin_[i] * my;
+    y_[i] += sin_[i] * mx + cos_[i] * my;
+    theta_[i] += dtheta + noiseTheta_[i];
+  }
+}
+
+void ParticleFilter::scorePoint(const LocalizationObservation& obs) {
+  float rx = obs.distance * cosf(obs.bearing), ry = obs.distance * sinf(obs.bearing);
+  float cb = cosf(obs.bearing), sb = sinf(obs.bearing);
+  float invR = 0.5f / obs.distanceVar, invT = 0.5f / (obs.distanceVar + obs.distance * obs.distance * obs.bearingVar);
+  float floor = -0.5f * params_.outlier_thresh;
+  int n = lanes();
+  for (int i = 0; i < n; i++) scratch_[i] = floor;
+  for (int c = 0; c < obs.numCandidates; c++) {
+    Point2D loc = LocalizationObservation::location(obs.candidates[c]);
+    float lx = loc.x, ly = loc.y;
+    for (int i = 0; i < n; i++) {
+      // the error of the seen point along and across the line of sight
+      float ux = cos_[i] * cb - sin_[i] * sb, uy = sin_[i] * cb + cos_[i] * sb;
+      float ex = x_[i] + cos_[i] * rx - sin_[i] * ry - lx;
+      float ey = y_[i] + sin_[i] * rx + cos_[i] * ry - ly;
+      float along = ex * ux + ey * uy, across = ex * uy - ey * ux;
+      scratch_[i] = std::max(scratch_[i], -(along * along * invR + across * across * invT));
+    }
+  }
+  for (int i = 0; i < n; i++) logLikelihood_[i] += scratch_[i];
+}
+
+void ParticleFilter::scoreLine(const LocalizationObservation& obs) {
+  const LineLikelihoodField& field = LineLikelihoodField::field();
+  float floor = -0.5f * params_.outlier_thresh / params_.line_samples;
+  for (int k = 0; k < params_.line_samples; k++) {
+    Point2D p = obs.start + (obs.end - obs.start) * ((k + 0.5f) / params_.line_samples);
+    float sd = params_.dist_error_offset + params_.line_dist_error_relative * p.getMagnitude();
+    float inv = 0.5f / (sd * sd * params_.line_samples);
+    for (int i = 0; i < size_; i++) {
+      float gx = x_[i] + cos_[i] * p.x - sin_[i] * p.y;
+      float gy = y_[i] + sin_[i] * p.x + cos_[i] * p.y;
+      logLikelihood_[i] += std::max(-field.distance2(gx, gy) * inv, floor);
+    }
+  }
+}
+
+void ParticleFilter::update(const LocalizationObservation* observations, int count) {
+  for (int i = 0; i < size_; i++) {
+    if (theta_[i] > M_PI) theta_[i] -= 2 * M_PI;
+    else if (theta_[i] < -M_PI) theta_[i] += 2 * M_PI;
+    cos_[i] = cosf(theta_[i]);
+    sin_[i] = sinf(theta_[i]);
+    logLikelihood_[i] = 0;
+  }
+  int scored = 0;
+  for (int o = 0; o < count; o++) {
+    const LocalizationObservation& obs = observations[o];
+    if (obs.kind == LocalizationObservation::Point) scorePoint(obs);
+    else if (obs.kind == LocalizationObservation::Line) scoreLine(obs);
+    else continue;
+    scored++;
+  }
+  if (scored == 0) return;
+
+  float maxL = logLikelihood_[0];
+  for (int i = 1; i < size_; i++) maxL = std::max(maxL, logLikelihood_[i]);
+  // average likelihood per observation, for noticing the robot was moved
+  float average = 0, total = 0;
+  for (int i = 0; i < size_; i++) {
+    average += weight_[i] * expf(logLikelihood_[i] / scored);
+    weight_[i] *= expf(logLikelihood_[i] - maxL);
+    total += weight_[i];
+  }
+  float squares = 0;
+  for (int i = 0; i < size_; i++) {
+    weight_[i] /= total;
+    squares += weight_[i] * weight_[i];
+  }
+  if (recoverySlow_ == 0) recoveryFast_ = recoverySlow_ = average;
+  recoveryFast_ += params_.recovery_fast * (average - recoveryFast_);
+  recoverySlow_ += params_.recovery_slow * (average - recoverySlow_);
+
+  if (1 / squares < params_.resample_thresh * size_)
+    resample();
+}
+
+int ParticleFilter::kldCount(int bins) const {
+  if (bins <= 1) return params_.min_particles;
+  float a = 2.0f / (9 * (bins - 1));
+  float b = 1 - a + sqrtf(a) * params_.kld_z;
+  return (int)ceilf((bins - 1) / (2 * params_.kld_epsilon) * b * b * b);
+}
+
+void ParticleFilter::resample() {
+  // Low variance resampling: one random offset, then a comb of evenly spaced draws
+  float step = 1.0f / target_;
+  float u = rand_.sampleU(step), cumulative = weight_[0];
+  for (int m = 0, j = 0; m < target_; m++, u += step) {
+    while (u > cumulative && j < size_ - 1) cumulative += weight_[++j];
+    nextX_[m] = x_[j];
+    nextY_[m] = y_[j];
+    nextTheta_[m] = theta_[j];
+  }
+
+  // Spread some of them over the field while the observations fit worse than they used
+  // to. Every other one goes to the mirror image of the particle it replaces, since the
+  // field is symmetric and that is the likeliest place to be if not where we thought.
+  float inject = recoverySlow_ > 0 ? std::max(0.0f, 1 - recoveryFast_ / recoverySlow_) : 0;
+  int injected = (int)(inject * target_);
+  for (int k = 0; k < injected; k++) {
+    int m = k * target_ / injected;
+    if (k % 2) {
+      nextX_[m] = -nextX_[m];
+      nextY_[m] = -nextY_[m];
+      nextTheta_[m] = normalizeAngle(nextTheta_[m] + M_PI);
+      continue;
+    }
+    nextX_[m] = rand_.sampleU(-HALF_FIELD_X, HALF_FIELD_X);
+    nextY_[m] = rand_.sampleU(-HALF_FIELD_Y, HALF_FIELD_Y);
+    nextTheta_[m] = rand_.sampleU(-M_PI, M_PI);
+  }
+  if (injected > 0) recoveryFast_ = recoverySlow_;
+
+  size_ = target_;
+  std::copy(nextX_, nextX_ + size_, x_);
+  std::copy(nextY_, nextY_ + size_, y_);
+  std::copy(nextTheta_, nextTheta_ + size_, theta_);
+  std::fill(weight_, weight_ + size_, 1.0f / size_);
+
+  // KLD sampling: size the next resample by how many histogram bins this set covers
+  std::fill(occupied_.begin(), occupied_.end(), 0);
+  int bins = 0;
+  for (int i = 0; i < size_; i++) {
+    int bx = std::min(std::max((int)((x_[i] + HALF_GRASS_X) / params_.kld_bin_xy), 0), binsX_ - 1);
+    int by = std::min(std::max((int)((y_[i] + HALF_GRASS_Y) / params_.kld_bin_xy), 0), binsY_ - 1);
+    int bt = std::min(std::max((int)((theta_[i] + M_PI) / params_.kld_bin_theta), 0), binsTheta_ - 1);
+    int bin = (bt * binsY_ + by) * binsX_ + bx;
+    uint64_t bit = (uint64_t)1 << (bin & 63);
+    if (!(occupied_[bin >> 6] & bit)) {
+      occupied_[bin >> 6] |= bit;
+      bins++;
+    }
+  }
+  target_ = std::min(std::max(kldCount(bins), params_.min_particles), params_.max_particles);
+}
+
+Pose2D ParticleFilter::estimate(float& varX, float& varY, float& varTheta, float& weight) {
+  // The heaviest cell of a coarse histogram picks the cluster
+  std::fill(clusters_.begin(), clusters_.end(), 0);
+  int best = 0;
+  for (int i = 0; i < size_; i++) {
+    int cx = std::min(std::max((int)((x_[i] + HALF_GRASS_X) / params_.cluster_distance), 0), clustersX_ - 1);
+    int cy = std::min(std::max((int)((y_[i] + HALF_GRASS_Y) / params_.cluster_distance), 0), clustersY_ - 1);
+    int ct = std::min(std::max((int)((theta_[i] + M_PI) / params_.cluster_angle), 0), clustersTheta_ - 1);
+    int cell = (ct * clustersY_ + cy) * clustersX_ + cx;
+    clusters_[cell] += weight_[i];
+    if (clusters_[cell] > clusters_[best]) best = cell;
+    cluster_[i] = cell;
+  }
+  float sx = 0, sy = 0, sc = 0, ss = 0, sw = 0;
+  for (int i = 0; i < size_; i++) {
+    if (cluster_[i] != best) continue;
+    sx += weight_[i] * x_[i];
+    sy += weight_[i] * y_[i];
+    sc += weight_[i] * cosf(theta_[i]);
+    ss += weight_[i] * sinf(theta_[i]);
+    sw += weight_[i];
+  }
+  float cx = sx / sw, cy = sy / sw, ct = atan2f(ss, sc);
+
+  // then every particle around the cell's mean is averaged into the estimate
+  const float pi = M_PI, twoPi = 2 * M_PI;
+  float mx = 0, my = 0, mt = 0, mxx = 0, myy = 0, mtt = 0;
+  weight = 0;
+  for (int i = 0; i < size_; i++) {
+    float dx = x_[i] - cx, dy = y_[i] - cy, dt = theta_[i] - ct;
+    dt = dt > pi ? dt - twoPi : dt;
+    dt = dt < -pi ? dt + twoPi : dt;
+    bool inside = fabs(dx) < params_.cluster_distance && fabs(dy) < params_.cluster_distance && fabs(dt) < params_.cluster_angle;
+    float w = inside ? weight_[i] : 0;
+    mx += w * dx; my += w * dy; mt += w * dt;
+    mxx += w * dx * dx; myy += w * dy * dy; mtt += w * dt * dt;
+    weight += w;
+  }
+  mx /= weight; my /= weight; mt /= weight;
+  varX = mxx / weight - mx * mx;
+  varY = myy / weight - my * my;
+  varTheta = mtt / weight - mt * mt;
+  return Pose2D(normalizeAngle(ct + mt), cx + mx, cy + my);
+}
+
+float ParticleFilter::oppositeWeight(const Pose2D& estimate) const {
+  float total = 0;
+  for (int i = 0; i < size_; i++)
+    total += fabs(normalizeAngle(theta_[i] - estimate.rotation)) > M_PI / 2 ? weight_[i] : 0;
+  return total;
+}
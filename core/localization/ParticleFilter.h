@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include <math/Pose2D.h>
+#include <common/Random.h>
+#include <localization/LocalizationObservation.h>
+
+/* Monte Carlo localization over the robot pose. Particles are stored structure of
+ * arrays, x, y and theta (mm, rad) each contiguous, and the motion and landmark
+ * steps run across all of them with plain loops the compiler vectorizes, padded to a
+ * whole number of LANES so no scalar remainder is needed. The motion noise is drawn a
+ * whole array at a time; headings and line likelihood field lookups stay scalar.
+ *
+ * Point landmarks are scored against their nearest candidate in the frame of the
+ * observation, along and across the line of sight, and seen lines by the distance of
+ * points sampled along them from the nearest field line. Particles are resampled
+ * systematically once the effective sample size drops, to a count adapted by KLD
+ * sampling to how spread out the previous resampled set was, and are injected
+ * uniformly across the field while the observations fit much worse than they used
+ * to, so the filter recovers when the robot is moved. */
+class ParticleFilter {
+  public:
+    static const int MAX_PARTICLES = 4096;
+    // The vectorized loops run over whole groups of this many particles
+    static const int LANES = 8;
+
+    ParticleFilter();
+    void setParams(const LocalizationParams& params);
+    // The stream the particle noise is drawn from
+    void setRandom(const Random& random) { rand_ = random; }
+
+    // Spreads the particles around the given poses, an equal share each
+    void reset(const Pose2D* poses, int count, float sdXY, float sdTheta);
+    // Spreads the particles uniformly over the field
+    void resetUniform();
+    void addOrientationUncertainty(float sdTheta);
+
+    void predict(const Pose2D& odometry);
+    void update(const LocalizationObservation* observations, int count);
+
+    // Weighted mean of the particles around the best one, with its covariance and weight
+    Pose2D estimate(float& varX, float& varY, float& varTheta, float& weight);
+    // Total weight of the particles facing away from the estimate
+    float oppositeWeight(const Pose2D& estimate) const;
+
+    int size() const { return size_; }
+    int target() const { return target_; }
+    inline float x(int i) const { return x_[i]; }
+    inline float y(int i) const { return y_[i]; }
+    inline float theta(int i) const { return theta_[i]; }
+    inline float weight(int i) const { return weight_[i]; }
+
+  private:
+    void scorePoint(const LocalizationObservation& obs);
+    void scoreLine(const LocalizationObservation& obs);
+    void resample();
+    int kldCount(int bins) const;
+    // Particle count rounded up to whole LANES; the lanes past size_ are ignored
+    inline int lanes() const { return (size_ + LANES - 1) & ~(LANES - 1); }
+
+    LocalizationParams params_;
+    Random rand_;
+    int size_, target_;
+    float recoveryFast_, recoverySlow_;
+    // KLD histogram occupancy bits, and the coarse histogram the estimate is picked from
+    int binsX_, binsY_, binsTheta_;
+    std::vector<uint64_t> occupied_;
+    int clustersX_, clustersY_, clustersTheta_;
+    std::vector<float> clusters_;
+
+    float x_[MAX_PARTICLES], y_[MAX_PARTICLES], theta_[MAX_PARTICLES], weight_[MAX_PARTICLES];
+    // Per frame scratch: heading, log likelihood and the resampled set
+    float cos_[MAX_PARTICLES], sin_[MAX_PARTICLES], logLikelihood_[MAX_PARTICLES], scratch_[MAX_PARTICLES];
+    float nextX_[MAX_PARTICLES], nextY_[MAX_PARTICLES], nextTheta_[MAX_PARTICLES];
+    float noiseX_[MAX_PARTICLES], noiseY_[MAX_PARTICLES], noiseTheta_[MAX_PARTICLES];
+    int cluster_[MAX_PARTICLES];
+};
@@ -0,0 +1,124 @@
+#include <memory/ArenaBuffer.h>
+#include <stdio.h>
+
+#define MAX_BUFFER_SIZE 1000000000u
+
+SpanReader::SpanReader(const BufferSpan& buffer) : buffer_(buffer), count_(0), index_(0), offset_(0) {
+  if(buffer_.data == NULL || buffer_.size < sizeof(unsigned int)) return;
+  memcpy(&count_, buffer_.data, sizeof(unsigned int));
+  offset_ = sizeof(unsigned int);
+}
+
+bool SpanReader::next(BufferSpan& piece) {
+  if(index_ >= count_ || buffer_.size - offset_ < sizeof(unsigned int)) return false;
+  unsigned int n;
+  memcpy(&n, buffer_.data + offset_, sizeof(unsigned int));
+  offset_ += sizeof(unsigned int);
+  if(n > buffer_.size - offset_) {
+    fprintf(stderr, "INVALID BUFFER PIECE!! The log file is most likely broken\n");
+    index_ = count_;
+    return false;
+  }
+  piece = BufferSpan(buffer_.data + offset_, n);
+  offset_ += n;
+  index_++;
+  return true;
+}
+
+ArenaBuffer::ArenaBuffer() : buffer_(NULL), size_(0), capacity_(0), allocations_(0) {
+}
+
+ArenaBuffer::~ArenaBuffer() {
+  clear();
+}
+
+void ArenaBuffer::reset() {
+  size_ = 0;
+  open_.clear();
+}
+
+void ArenaBuffer::clear() {
+  if(buffer_ != NULL) delete [] buffer_;
+  buffer_ = NULL;
+  size_ = capacity_ = 0;
+  open_.clear();
+}
+
+void ArenaBuffer::grow(unsigned int n) {
+  if(size_ + n <= capacity_) return;
+  unsigned int capacity = capacity_ ? capacity_ : 4096;
+  while(capacity < size_ + n) capacity *= 2;
+  unsigned char* buffer = new unsigned char[capacity];
+  if(buffer_ != NULL) {
+    memcpy(buffer, buffer_, size_);
+    delete [] buffer_;
+  }
+  buffer_ = buffer;
+  capacity_ = capacity;
+  allocations_++;
+}
+
+unsigned char* ArenaBuffer::allocate(unsigned int n) {
+  grow(n);
+  unsigned char* p = buffer_ + size_;
+  size_ += n;
+  return p;
+}
+
+void ArenaBuffer::countPiece() {
+  // Pieces have arbitrary sizes, so count words aren't necessarily aligned
+  unsigned int count;
+  memcpy(&count, buffer_ + open_.back(), sizeof(unsigned int));
+  count++;
+  memcpy(buffer_ + open_.back(), &count, sizeof(unsigned int));
+}
+
+void ArenaBuffer::beginList() {
+  if(!open_.empty()) {
+    countPiece();
+    // The piece size is filled in by endList
+    allocate(sizeof(unsigned int));
+  }
+  open_.push_back(size_);
+  unsigned int zero = 0;
+  memcpy(allocate(sizeof(unsigned int)), &zero, sizeof(unsigned int));
+}
+
+void ArenaBuffer::endList() {
+  if(open_.empty()) return;
+  unsigned int start = open_.back();
+  open_.pop_back();
+  if(!open_.empty()) {
+    unsigned int n = size_ - start;
+    memcpy(buffer_ + start - sizeof(unsigned int), &n, sizeof(unsigned int));
+  }
+}
+
+unsigned char* ArenaBuffer::reserve(unsigned int n) {
+  if(open_.empty()) beginList();
+  countPiece();
+  memcpy(allocate(sizeof(unsigned int)), &n, sizeof(unsigned int));
+  return allocate(n);
+}
+
+void ArenaBuffer::add(const void* data, unsigned int n) {
+  unsigned char* p = reserve(n);
+  memcpy(p, data, n);
+}
+
+bool ArenaBuffer::read(std::istream& is) {
+  unsigned int n;
+  if(!is.read((char*)&n, sizeof(unsigned int))) return false;
+  if(n == 0 || n > MAX_BUFFER_SIZE) {
+    fprintf(stderr, "INVALID BUFFER REQUEST!! The log file is most likely broken\n");
+    return false;
+  }
+  reset();
+  is.read((char*)allocate(n), n);
+  return (unsigned int)is.gcount() == n;
+}
+
+void ArenaBuffer::write(std::ostream& os) const {
+  os.write((const char*)&size_, sizeof(unsigned int));
+  os.write((const char*)buffer_, size_);
+}
@@ -0,0 +1,89 @@
+#ifndef ARENA_BUFFER_H
+#define ARENA_BUFFER_H
+
+#include <iostream>
+#include <string.h>
+#include <vector>
+
+/* A non-owning view of serialized bytes: a piece of an ArenaBuffer, a frame read
+ * from a log or a region of a mapped file. It is only valid while the bytes it
+ * points at are. */
+struct BufferSpan {
+  const unsigned char* data;
+  unsigned int size;
+
+  BufferSpan() : data(NULL), size(0) { }
+  BufferSpan(const unsigned char* data, unsigned int size) : data(data), size(size) { }
+
+  template<typename T>
+  void write(T& dest) const {
+    memcpy((unsigned char*)&dest, data, size);
+  }
+  template<typename T>
+  void write(T* dest) const {
+    memcpy((unsigned char*)dest, data, size);
+  }
+};
+
+/* Walks the pieces of a combined buffer in order, handing each out as a span into
+ * the original bytes. Nested lists are read by constructing another reader on a
+ * piece. Malformed or truncated buffers end the walk early. */
+class SpanReader {
+  public:
+    SpanReader(const BufferSpan& buffer);
+
+    inline unsigned int count() const { return count_; }
+    inline unsigned int remaining() const { return count_ - index_; }
+    bool next(BufferSpan& piece);
+
+  private:
+    BufferSpan buffer_;
+    unsigned int count_, index_, offset_;
+};
+
+/* Serialization buffer that appends everything into one growable arena. Pieces are
+ * written in place with the same layout StreamBuffer::combine produces, i.e. a piece
+ * count followed by (size, bytes) pairs, and lists may be nested. reset() keeps the
+ * storage so a buffer that is reused every frame stops allocating once it has grown
+ * to the largest frame. */
+class ArenaBuffer {
+  public:
+    ArenaBuffer();
+    ~ArenaBuffer();
+
+    void reset();
+    void clear();
+
+    // Opens a list, either at the top of the buffer or as the next piece of the open list
+    void beginList();
+    void endList();
+    void add(const void* data, unsigned int n);
+    // Appends an n byte piece to the open list and returns where to write its contents
+    unsigned char* reserve(unsigned int n);
+    // Appends n unframed bytes, e.g. for a buffer that holds a single blob
+    unsigned char* allocate(unsigned int n);
+
+    // Length prefixed, compatible with StreamBuffer::read(std::istream&) and write(std::ostream&)
+    bool read(std::istream& is);
+    void write(std::ostream& os) const;
+
+    inline BufferSpan span() const { return BufferSpan(buffer_, size_); }
+    inline unsigned char* data() const { return buffer_; }
+    inline unsigned int size() const { return size_; }
+    inline unsigned int capacity() const { return capacity_; }
+    inline unsigned int allocations() const { return allocations_; }
+
+  private:
+    ArenaBuffer(const ArenaBuffer&);
+    ArenaBuffer& operator=(const ArenaBuffer&);
+
+    void grow(unsigned int n);
+    void countPiece();
+
+    unsigned char* buffer_;
+    unsigned int size_, capacity_, allocations_;
+    // Offsets of the count word of each open list, outermost first
+    std::vector<unsigned int> open_;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#include <memory/AsyncLogWriter.h>
+#include <memory/LogMetadata.h>
+
+AsyncLogWriter::AsyncLogWriter(IndexedLogWriter& writer, const std::string& metadataFile, int slots) :
+  writer_(writer), metadataFile_(metadataFile), slots_(slots),
+  head_(0), count_(0), maxCount_(0), dropped_(0), written_(0), stop_(false) {
+  thread_ = std::thread(&AsyncLogWriter::work, this);
+}
+
+AsyncLogWriter::~AsyncLogWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  queued_.notify_one();
+  thread_.join();
+}
+
+bool AsyncLogWriter::push(Memory& memory, const std::vector<std::string>& blockNames) {
+  unsigned int index;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(count_ == slots_.size()) {
+      dropped_++;
+      return false;
+    }
+    index = (head_ + count_) % slots_.size();
+  }
+  // The writer only touches queued slots, so this one can be filled without the lock
+  IndexedLogWriter::pack(memory, blockNames, slots_[index]);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    count_++;
+    if(count_ > maxCount_) maxCount_ = count_;
+  }
+  queued_.notify_one();
+  return true;
+}
+
+void AsyncLogWriter::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  drained_.wait(lock, [this] { return count_ == 0; });
+}
+
+void AsyncLogWriter::work() {
+  LogMetadata mdata;
+  while(true) {
+    unsigned int index;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      queued_.wait(lock, [this] { return count_ > 0 || stop_; });
+      if(count_ == 0) break;
+      index = head_;
+    }
+    writer_.write(slots_[index]);
+    unsigned int written;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      head_ = (head_ + 1) % slots_.size();
+      count_--;
+      written = ++written_;
+    }
+    drained_.notify_all();
+    // Saved now and then in case the robot goes down before the log is closed
+    if(written % 100 == 0) {
+      mdata.frames = written;
+      mdata.saveToFile(metadataFile_);
+    }
+  }
+  drained_.notify_all();
+}
+
+unsigned int AsyncLogWriter::queueDepth() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return count_;
+}
+
+unsigned int AsyncLogWriter::maxQueueDepth() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return maxCount_;
+}
+
+unsigned int AsyncLogWriter::droppedFrames() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_;
+}
+
+unsigned int AsyncLogWriter::writtenFrames() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return written_;
+}
@@ -0,0 +1,42 @@
+#ifndef ASYNC_LOG_WRITER_H
+#define ASYNC_LOG_WRITER_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory/IndexedLog.h>
+
+/* Moves log writes off the calling thread. push() packs the selected blocks into
+ * the next free slot of a fixed ring and returns; a writer thread drains the ring
+ * into an IndexedLogWriter. When the ring is full push() drops the frame rather
+ * than wait on the disk, so the caller never blocks on I/O. */
+class AsyncLogWriter {
+  public:
+    AsyncLogWriter(IndexedLogWriter& writer, const std::string& metadataFile, int slots);
+    // Writes out everything still queued before returning
+    ~AsyncLogWriter();
+
+    bool push(Memory& memory, const std::vector<std::string>& blockNames);
+    void flush();
+
+    unsigned int queueDepth();
+    unsigned int maxQueueDepth();
+    unsigned int droppedFrames();
+    unsigned int writtenFrames();
+
+  private:
+    void work();
+
+    IndexedLogWriter& writer_;
+    std::string metadataFile_;
+    std::vector<IndexedLogFrame> slots_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable queued_, drained_;
+    unsigned int head_, count_, maxCount_, dropped_, written_;
+    bool stop_;
+};
+
+#endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory/MemoryBlock.h>
+#include <common/Enum.h>
 
 #define SAMPLE_RATE 48000
 #define SAMPLE_COUNT 4096
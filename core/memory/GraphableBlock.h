@@ -3,6 +3,7 @@
 
 #include "MemoryBlock.h"
 #include <cstring>
+#include <cassert>
 
 #define NUM_GRAPHABLE_DATA 100
 #define MAX_NAME_LENGTH 30
@@ -37,39 +37,51 @@ ImageBlock& ImageBlock::operator=(const ImageBlock& other) {
     img_bottom_local_ = new unsigned char[bottom_params_.rawSize];
   }
 
-  memcpy(img_top_local_, other.img_top_local_, top_params_.rawSize);
-  memcpy(img_bottom_local_, other.img_bottom_local_, bottom_params_.rawSize);
+  // The other block's images may live outside its local arrays, e.g. in a mapped log
+  if(other.img_top_ != NULL)
+    memcpy(img_top_local_, other.img_top_.get(), top_params_.rawSize);
+  if(other.img_bottom_ != NULL)
+    memcpy(img_bottom_local_, other.img_bottom_.get(), bottom_params_.rawSize);
   img_top_ = img_top_local_;
   img_bottom_ = img_bottom_local_;
   loaded_ = other.loaded_;
   return *this;
 }
   
-void ImageBlock::serialize(StreamBuffer& buffer, std::string data_dir) {
-  std::vector<StreamBuffer> all;
-
-  StreamBuffer main;
-  main.read((unsigned char*)&header, sizeof(MemoryBlockHeader));
-  all.push_back(main);
-
-  StreamBuffer tparams, bparams;
-  tparams.read((unsigned char*)&top_params_, sizeof(ImageParams));
-  all.push_back(tparams);
-  bparams.read((unsigned char*)&bottom_params_, sizeof(ImageParams));
-  all.push_back(bparams);
+void ImageBlock::addInfo(ArenaBuffer& buffer) {
+  buffer.add(&header, sizeof(MemoryBlockHeader));
+  buffer.add(&top_params_, sizeof(ImageParams));
+  buffer.add(&bottom_params_, sizeof(ImageParams));
+  buffer.add(&loaded_, sizeof(bool));
+}
 
-  StreamBuffer imageLoaded;
-  imageLoaded.read((unsigned char*)&loaded_, sizeof(bool));
-  all.push_back(imageLoaded);
+bool ImageBlock::readInfo(SpanReader& parts) {
+  BufferSpan main, tparams, bparams, imageLoaded;
+  if(!parts.next(main) || !parts.next(tparams) || !parts.next(bparams) || !parts.next(imageLoaded))
+    return false;
+  if(!validateHeader(main)) return false;
+  int tsize = top_params_.rawSize, bsize = bottom_params_.rawSize;
+  main.write(header);
+  tparams.write(top_params_);
+  bparams.write(bottom_params_);
+  imageLoaded.write(loaded_);
+  if(tsize < top_params_.rawSize) {
+    delete [] img_top_local_;
+    img_top_local_ = new unsigned char[top_params_.rawSize];
+  }
+  if(bsize < bottom_params_.rawSize) {
+    delete [] img_bottom_local_;
+    img_bottom_local_ = new unsigned char[bottom_params_.rawSize];
+  }
+  return true;
+}
 
+void ImageBlock::serialize(ArenaBuffer& buffer, const std::string& data_dir) {
+  buffer.beginList();
+  addInfo(buffer);
   if(buffer_logging_) {
-    StreamBuffer top;
-    top.read(getImgTop(), top_params_.rawSize);
-    all.push_back(top);
-
-    StreamBuffer bottom;
-    bottom.read(getImgBottom(), bottom_params_.rawSize);
-    all.push_back(bottom);
+    buffer.add(getImgTop(), top_params_.rawSize);
+    buffer.add(getImgBottom(), bottom_params_.rawSize);
   }
   else {
     std::stringstream ss;
@@ -83,11 +95,19 @@ void ImageBlock::serialize(StreamBuffer& buffer, std::string data_dir) {
     writeImageBinary(getImgBottom(), ss.str(), bottom_params_);
     //writeImage(getImgBottom(), ss.str(), bottom_params_);
   }
+  buffer.endList();
+}
 
-  StreamBuffer::combine(all, buffer);
-  StreamBuffer::clear(all);
+void ImageBlock::serializeInfo(ArenaBuffer& buffer) {
+  buffer.beginList();
+  addInfo(buffer);
+  buffer.endList();
 }
 
+bool ImageBlock::deserializeInfo(const BufferSpan& buffer) {
+  SpanReader parts(buffer);
+  return readInfo(parts);
+}
 
 void ImageBlock::writeImageBinary(const unsigned char *imgraw, std::string path, const ImageParams &iparams){
   ofstream out;
@@ -103,28 +123,14 @@ void ImageBlock::readImageBinary(unsigned char* imgraw, std::string path, const
 }
 
 
-bool ImageBlock::deserialize(const StreamBuffer& buffer, std::string data_dir) {
-  auto parts = buffer.separate();
-  if(!validateHeader(parts[0])) {
-    StreamBuffer::clear(parts);
-    return false;
-  }
-  int tsize = top_params_.rawSize, bsize = bottom_params_.rawSize;
-  parts[0].write(header);
-  parts[1].write(top_params_);
-  parts[2].write(bottom_params_);
-  parts[3].write(loaded_);
-  if(tsize < top_params_.rawSize) {
-    delete [] img_top_local_;
-    img_top_local_ = new unsigned char[top_params_.rawSize];
-  }
-  if(bsize < bottom_params_.rawSize) {
-    delete [] img_bottom_local_;
-    img_bottom_local_ = new unsigned char[bottom_params_.rawSize];
-  }
+bool ImageBlock::deserialize(const BufferSpan& buffer, const std::string& data_dir) {
+  SpanReader parts(buffer);
+  if(!readInfo(parts)) return false;
   if(buffer_logging_) {
-    parts[4].write(img_top_local_);
-    parts[5].write(img_bottom_local_);
+    BufferSpan top, bottom;
+    if(!parts.next(top) || !parts.next(bottom)) return false;
+    top.write(img_top_local_);
+    bottom.write(img_bottom_local_);
   }
   else {
     std::stringstream ss;
@@ -150,6 +156,5 @@ bool ImageBlock::deserialize(const StreamBuffer& buffer, std::string data_dir) {
   }
   img_top_ = boost::interprocess::offset_ptr<unsigned char>(img_top_local_);
   img_bottom_ = boost::interprocess::offset_ptr<unsigned char>(img_bottom_local_);
-  StreamBuffer::clear(parts);
   return true;
 }
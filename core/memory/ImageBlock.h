@@ -34,8 +34,11 @@ public:
     return isTopFromLog && isBottomFromLog;
   }
 
-  void serialize(StreamBuffer& buffer, std::string data_dir);
-  bool deserialize(const StreamBuffer& buffer, std::string data_dir);
+  void serialize(ArenaBuffer& buffer, const std::string& data_dir);
+  bool deserialize(const BufferSpan& buffer, const std::string& data_dir);
+  // Header, params and loaded flag only; the caller stores and sets the images
+  void serializeInfo(ArenaBuffer& buffer);
+  bool deserializeInfo(const BufferSpan& buffer);
 
   void writeImage(const unsigned char* imgraw, std::string path, const ImageParams& iparams) {
     cv::Mat cvimage = color::rawToMat(imgraw, iparams);
@@ -55,6 +58,10 @@ public:
   
   boost::interprocess::offset_ptr<unsigned char> img_top_;
   boost::interprocess::offset_ptr<unsigned char> img_bottom_;
+
+private:
+  void addInfo(ArenaBuffer& buffer);
+  bool readInfo(SpanReader& parts);
 };
 
 #endif /* end of include guard: IMAGEBLOCK_95BEQPL8 */
@@ -0,0 +1,381 @@
+#include <memory/IndexedLog.h>
+#include <memory/ImageBlock.h>
+#include <memory/RobotVisionBlock.h>
+#include <memory/MemoryBlockRegistry.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+const char IndexedLogFormat::MAGIC[4] = { 'U', 'T', 'L', 'X' };
+const char IndexedLogFormat::FRAME_MAGIC[4] = { 'F', 'R', 'M', 'E' };
+
+typedef IndexedLogFormat ILF;
+
+static inline uint64_t pageAlign(uint64_t offset) {
+  return (offset + ILF::PAGE_SIZE - 1) / ILF::PAGE_SIZE * ILF::PAGE_SIZE;
+}
+
+IndexedLogWriter::IndexedLogWriter() : offset_(0), zeros_(ILF::PAGE_SIZE, 0) {
+}
+
+IndexedLogWriter::~IndexedLogWriter() {
+  close();
+}
+
+bool IndexedLogWriter::open(const std::string& filename) {
+  close();
+  names_.clear();
+  nameIndices_.clear();
+  frames_.clear();
+  blocks_.clear();
+  file_.open(filename.c_str(), std::ios::binary);
+  if(!file_.is_open()) return false;
+  ILF::FileHeader header;
+  memcpy(header.magic, ILF::MAGIC, sizeof(header.magic));
+  header.version = ILF::VERSION;
+  header.pageSize = ILF::PAGE_SIZE;
+  header.reserved = 0;
+  file_.write((const char*)&header, sizeof(header));
+  offset_ = sizeof(header);
+  return true;
+}
+
+uint32_t IndexedLogWriter::nameIndex(const std::string& name) {
+  auto it = nameIndices_.find(name);
+  if(it != nameIndices_.end()) return it->second;
+  uint32_t index = names_.size();
+  names_.push_back(name);
+  nameIndices_[name] = index;
+  return index;
+}
+
+void IndexedLogWriter::pad() {
+  uint64_t aligned = pageAlign(offset_);
+  file_.write(&zeros_[0], aligned - offset_);
+  offset_ = aligned;
+}
+
+void IndexedLogWriter::writeMemory(Memory& memory, const std::vector<std::string>& blockNames) {
+  if(!file_.is_open()) return;
+  pack(memory, blockNames, scratch_);
+  write(scratch_);
+}
+
+static inline void append(std::vector<unsigned char>& data, const void* src, unsigned int n) {
+  const unsigned char* bytes = (const unsigned char*)src;
+  data.insert(data.end(), bytes, bytes + n);
+}
+
+void IndexedLogWriter::pack(Memory& memory, const std::vector<std::string>& blockNames, IndexedLogFrame& frame) {
+  frame.records.reset();
+  frame.blocks.clear();
+  frame.images.clear();
+
+  ILF::FrameHeader fheader;
+  memcpy(fheader.magic, ILF::FRAME_MAGIC, sizeof(fheader.magic));
+  fheader.blocks = 0;
+  memcpy(frame.records.allocate(sizeof(fheader)), &fheader, sizeof(fheader));
+
+  for(unsigned int i = 0; i < blockNames.size(); i++) {
+    const std::string& name = blockNames[i];
+    MemoryBlock* block = memory.getBlockPtrByName(name);
+    if(!block) continue;
+    // Names are assigned in place so their storage is reused from frame to frame
+    if(fheader.blocks < frame.names.size()) frame.names[fheader.blocks] = name;
+    else frame.names.push_back(name);
+    fheader.blocks++;
+
+    ILF::BlockHeader bheader;
+    bheader.nameLength = name.size();
+    bheader.topImageSize = bheader.bottomImageSize = 0;
+    // The header is filled in once the block has been serialized behind it
+    unsigned int hoffset = frame.records.size();
+    frame.records.allocate(sizeof(bheader));
+    memcpy(frame.records.allocate(name.size()), name.c_str(), name.size());
+    unsigned int offset = frame.records.size();
+    if(name == "raw_image") {
+      ImageBlock* image = (ImageBlock*)block;
+      image->serializeInfo(frame.records);
+      if(image->getImgTop()) {
+        bheader.topImageSize = image->top_params_.rawSize;
+        append(frame.images, image->getImgTop(), bheader.topImageSize);
+      }
+      if(image->getImgBottom()) {
+        bheader.bottomImageSize = image->bottom_params_.rawSize;
+        append(frame.images, image->getImgBottom(), bheader.bottomImageSize);
+      }
+    }
+    else if(name == "robot_vision")
+      ((RobotVisionBlock*)block)->serialize(frame.records, "");
+    else
+      block->serialize(frame.records);
+    bheader.size = frame.records.size() - offset;
+    memcpy(frame.records.data() + hoffset, &bheader, sizeof(bheader));
+
+    ILF::BlockEntry entry;
+    entry.name = 0;
+    entry.size = bheader.size;
+    entry.offset = offset;
+    entry.topImageSize = bheader.topImageSize;
+    entry.bottomImageSize = bheader.bottomImageSize;
+    entry.topImageOffset = entry.bottomImageOffset = 0;
+    frame.blocks.push_back(entry);
+  }
+  frame.names.resize(fheader.blocks);
+  memcpy(frame.records.data(), &fheader, sizeof(fheader));
+}
+
+void IndexedLogWriter::write(const IndexedLogFrame& frame) {
+  if(!file_.is_open()) return;
+  ILF::FrameEntry fentry;
+  fentry.offset = offset_;
+  fentry.firstBlock = blocks_.size();
+  fentry.blocks = frame.blocks.size();
+  file_.write((const char*)frame.records.data(), frame.records.size());
+  for(unsigned int i = 0; i < frame.blocks.size(); i++) {
+    ILF::BlockEntry entry = frame.blocks[i];
+    entry.name = nameIndex(frame.names[i]);
+    entry.offset += offset_;
+    blocks_.push_back(entry);
+  }
+  offset_ += frame.records.size();
+
+  uint64_t image = 0;
+  for(unsigned int i = fentry.firstBlock; i < blocks_.size(); i++) {
+    ILF::BlockEntry& entry = blocks_[i];
+    if(entry.topImageSize) {
+      pad();
+      entry.topImageOffset = offset_;
+      file_.write((const char*)&frame.images[image], entry.topImageSize);
+      offset_ += entry.topImageSize;
+      image += entry.topImageSize;
+    }
+    if(entry.bottomImageSize) {
+      pad();
+      entry.bottomImageOffset = offset_;
+      file_.write((const char*)&frame.images[image], entry.bottomImageSize);
+      offset_ += entry.bottomImageSize;
+      image += entry.bottomImageSize;
+    }
+  }
+  frames_.push_back(fentry);
+}
+
+void IndexedLogWriter::close() {
+  if(!file_.is_open()) return;
+  ILF::Trailer trailer;
+  trailer.indexOffset = offset_;
+  memcpy(trailer.magic, ILF::MAGIC, sizeof(trailer.magic));
+  trailer.version = ILF::VERSION;
+
+  uint32_t count = names_.size();
+  file_.write((const char*)&count, sizeof(count));
+  for(unsigned int i = 0; i < names_.size(); i++) {
+    uint32_t length = names_[i].size();
+    file_.write((const char*)&length, sizeof(length));
+    file_.write(names_[i].c_str(), length);
+  }
+  count = frames_.size();
+  file_.write((const char*)&count, sizeof(count));
+  if(count) file_.write((const char*)&frames_[0], count * sizeof(ILF::FrameEntry));
+  count = blocks_.size();
+  file_.write((const char*)&count, sizeof(count));
+  if(count) file_.write((const char*)&blocks_[0], count * sizeof(ILF::BlockEntry));
+  file_.write((const char*)&trailer, sizeof(trailer));
+  file_.close();
+}
+
+IndexedLogReader::IndexedLogReader(const std::string& filename) : data_(NULL), size_(0) {
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if(fd < 0) return;
+  struct stat st;
+  if(fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(ILF::FileHeader)) {
+    // Private and writable so code that draws on an image only touches its own copy of the page
+    void* data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if(data != MAP_FAILED) {
+      data_ = (unsigned char*)data;
+      size_ = st.st_size;
+    }
+  }
+  ::close(fd);
+  if(!data_) return;
+  const ILF::FileHeader* header = (const ILF::FileHeader*)data_;
+  if(memcmp(header->magic, ILF::MAGIC, sizeof(header->magic)) != 0 || header->version != ILF::VERSION) {
+    fprintf(stderr, "%s is not an indexed log\n", filename.c_str());
+    munmap(data_, size_);
+    data_ = NULL;
+    return;
+  }
+  if(!readIndex()) {
+    fprintf(stderr, "Log index missing from %s, scanning frames\n", filename.c_str());
+    scan();
+  }
+}
+
+IndexedLogReader::~IndexedLogReader() {
+  if(data_) munmap(data_, size_);
+}
+
+bool IndexedLogReader::exists(const std::string& directory) {
+  struct stat st;
+  return stat(ILF::filename(directory).c_str(), &st) == 0;
+}
+
+bool IndexedLogReader::readIndex() {
+  if(size_ < sizeof(ILF::FileHeader) + sizeof(ILF::Trailer)) return false;
+  const ILF::Trailer* trailer = (const ILF::Trailer*)(data_ + size_ - sizeof(ILF::Trailer));
+  if(memcmp(trailer->magic, ILF::MAGIC, sizeof(trailer->magic)) != 0 || trailer->version != ILF::VERSION) return false;
+  uint64_t pos = trailer->indexOffset, end = size_ - sizeof(ILF::Trailer);
+  uint32_t count;
+#define INDEX_READ(dest, n) \
+  if(pos + (n) > end) return false; \
+  memcpy(dest, data_ + pos, n); \
+  pos += n;
+  INDEX_READ(&count, sizeof(count));
+  names_.resize(count);
+  for(unsigned int i = 0; i < names_.size(); i++) {
+    uint32_t length;
+    INDEX_READ(&length, sizeof(length));
+    if(pos + length > end) return false;
+    names_[i].assign((const char*)data_ + pos, length);
+    pos += length;
+  }
+  INDEX_READ(&count, sizeof(count));
+  frames_.resize(count);
+  if(count) { INDEX_READ(&frames_[0], count * sizeof(ILF::FrameEntry)); }
+  INDEX_READ(&count, sizeof(count));
+  blocks_.resize(count);
+  if(count) { INDEX_READ(&blocks_[0], count * sizeof(ILF::BlockEntry)); }
+#undef INDEX_READ
+  for(unsigned int i = 0; i < frames_.size(); i++)
+    if(frames_[i].firstBlock + frames_[i].blocks > blocks_.size()) return false;
+  for(unsigned int i = 0; i < blocks_.size(); i++) {
+    const ILF::BlockEntry& b = blocks_[i];
+    if(b.name >= names_.size() || b.offset + b.size > size_ ||
+        b.topImageOffset + b.topImageSize > size_ || b.bottomImageOffset + b.bottomImageSize > size_)
+      return false;
+  }
+  return true;
+}
+
+bool IndexedLogReader::scan() {
+  names_.clear();
+  frames_.clear();
+  blocks_.clear();
+  std::map<std::string, uint32_t> indices;
+  uint64_t pos = sizeof(ILF::FileHeader);
+  while(pos + sizeof(ILF::FrameHeader) <= size_) {
+    const ILF::FrameHeader* fheader = (const ILF::FrameHeader*)(data_ + pos);
+    if(memcmp(fheader->magic, ILF::FRAME_MAGIC, sizeof(fheader->magic)) != 0) break;
+    ILF::FrameEntry frame;
+    frame.offset = pos;
+    frame.firstBlock = blocks_.size();
+    frame.blocks = fheader->blocks;
+    pos += sizeof(ILF::FrameHeader);
+    std::vector<ILF::BlockEntry> blocks;
+    bool complete = true;
+    for(unsigned int i = 0; complete && i < frame.blocks; i++) {
+      if(pos + sizeof(ILF::BlockHeader) > size_) { complete = false; break; }
+      ILF::BlockHeader bheader;
+      memcpy(&bheader, data_ + pos, sizeof(bheader));
+      pos += sizeof(bheader);
+      if(pos + bheader.nameLength + bheader.size > size_) { complete = false; break; }
+      std::string name((const char*)data_ + pos, bheader.nameLength);
+      pos += bheader.nameLength;
+      if(indices.find(name) == indices.end()) {
+        indices[name] = names_.size();
+        names_.push_back(name);
+      }
+      ILF::BlockEntry entry;
+      entry.name = indices[name];
+      entry.size = bheader.size;
+      entry.offset = pos;
+      entry.topImageSize = bheader.topImageSize;
+      entry.bottomImageSize = bheader.bottomImageSize;
+      entry.topImageOffset = entry.bottomImageOffset = 0;
+      blocks.push_back(entry);
+      pos += bheader.size;
+    }
+    // Images follow the records in the same order the writer laid them out
+    for(unsigned int i = 0; complete && i < blocks.size(); i++) {
+      ILF::BlockEntry& entry = blocks[i];
+      if(entry.topImageSize) {
+        pos = pageAlign(pos);
+        entry.topImageOffset = pos;
+        pos += entry.topImageSize;
+      }
+      if(entry.bottomImageSize) {
+        pos = pageAlign(pos);
+        entry.bottomImageOffset = pos;
+        pos += entry.bottomImageSize;
+      }
+      if(pos > size_) complete = false;
+    }
+    if(!complete) break;
+    blocks_.insert(blocks_.end(), blocks.begin(), blocks.end());
+    frames_.push_back(frame);
+  }
+  return !frames_.empty();
+}
+
+const ILF::BlockEntry* IndexedLogReader::findBlock(unsigned int frame, const std::string& name) const {
+  if(frame >= frames_.size()) return NULL;
+  const ILF::FrameEntry& f = frames_[frame];
+  for(unsigned int i = f.firstBlock; i < f.firstBlock + f.blocks; i++)
+    if(names_[blocks_[i].name] == name) return &blocks_[i];
+  return NULL;
+}
+
+BufferSpan IndexedLogReader::getBlockView(unsigned int frame, const std::string& name) const {
+  const ILF::BlockEntry* entry = findBlock(frame, name);
+  if(!entry) return BufferSpan();
+  return BufferSpan(data_ + entry->offset, entry->size);
+}
+
+unsigned char* IndexedLogReader::getTopImage(unsigned int frame) const {
+  const ILF::BlockEntry* entry = findBlock(frame, "raw_image");
+  if(!entry || !entry->topImageSize) return NULL;
+  return data_ + entry->topImageOffset;
+}
+
+unsigned char* IndexedLogReader::getBottomImage(unsigned int frame) const {
+  const ILF::BlockEntry* entry = findBlock(frame, "raw_image");
+  if(!entry || !entry->bottomImageSize) return NULL;
+  return data_ + entry->bottomImageOffset;
+}
+
+bool IndexedLogReader::readMemory(unsigned int frame, Memory& memory) const {
+  if(frame >= frames_.size()) return false;
+  const ILF::FrameEntry& f = frames_[frame];
+  for(unsigned int i = f.firstBlock; i < f.firstBlock + f.blocks; i++) {
+    const ILF::BlockEntry& entry = blocks_[i];
+    const std::string& id = names_[entry.name];
+    MemoryBlockId::Id blockId = MemoryBlockId::fromName(id);
+    MemoryBlock* block = memory.getBlockPtrById(blockId);
+    if(block == NULL) {
+      if(blockId == MemoryBlockId::INVALID || !memory.addBlockById(blockId)) {
+        std::cout << "Adding block " << id << " failed, just skipping" << std::endl << std::flush;
+        continue;
+      }
+      block = memory.getBlockPtrById(blockId);
+    }
+    block->buffer_logging_ = false;
+    block->log_block = true;
+    BufferSpan view(data_ + entry.offset, entry.size);
+    bool valid = true;
+    if(blockId == MemoryBlockId::RAW_IMAGE) {
+      ImageBlock* image = (ImageBlock*)block;
+      valid = image->deserializeInfo(view);
+      if(valid && entry.topImageSize) image->setImgTop(data_ + entry.topImageOffset);
+      if(valid && entry.bottomImageSize) image->setImgBottom(data_ + entry.bottomImageOffset);
+    }
+    else if(blockId == MemoryBlockId::ROBOT_VISION)
+      valid = ((RobotVisionBlock*)block)->deserialize(view, "");
+    else
+      valid = MemoryBlockRegistry::get(blockId)->deserialize(block, view);
+    if(!valid)
+      fprintf(stderr, "Error deserializing %s\n", id.c_str());
+  }
+  return true;
+}
@@ -0,0 +1,138 @@
+#ifndef INDEXED_LOG_H
+#define INDEXED_LOG_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+#include <memory/Memory.h>
+#include <memory/ArenaBuffer.h>
+
+/* Single file log container (frames.ulog):
+ *
+ *   file header | frame 0 | frame 1 | ... | index | trailer
+ *
+ * A frame is a frame header followed by one record per block (record header, block
+ * name, serialized block). Raw images are not serialized with their block; they
+ * follow the frame's records, each starting on a page boundary so the reader can
+ * point ImageBlocks straight into the mapped file. The index at the end holds the
+ * offset of every frame, block and image. Every record is self describing, so a log
+ * whose writer died before writing the index can still be read by scanning it. */
+struct IndexedLogFormat {
+  static const uint32_t VERSION = 1;
+  static const uint32_t PAGE_SIZE = 4096;
+  static const char MAGIC[4];
+  static const char FRAME_MAGIC[4];
+
+  struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t pageSize;
+    uint32_t reserved;
+  };
+  struct FrameHeader {
+    char magic[4];
+    uint32_t blocks;
+  };
+  struct BlockHeader {
+    uint32_t nameLength;
+    uint32_t size;
+    uint32_t topImageSize;
+    uint32_t bottomImageSize;
+  };
+  struct Trailer {
+    uint64_t indexOffset;
+    char magic[4];
+    uint32_t version;
+  };
+  // Index entry for one block of one frame
+  struct BlockEntry {
+    uint32_t name;
+    uint32_t size;
+    uint64_t offset;
+    uint64_t topImageOffset, bottomImageOffset;
+    uint32_t topImageSize, bottomImageSize;
+  };
+  struct FrameEntry {
+    uint64_t offset;
+    uint32_t firstBlock, blocks;
+  };
+
+  static std::string filename(const std::string& directory) { return directory + "/frames.ulog"; }
+};
+
+/* One frame serialized by IndexedLogWriter::pack, ready to be written. The buffers
+ * keep their capacity between frames, so a reused frame doesn't allocate. */
+struct IndexedLogFrame {
+  // Frame header and block records, laid out as they go to disk
+  ArenaBuffer records;
+  // Offsets are relative to the start of records; image offsets are filled in on write
+  std::vector<IndexedLogFormat::BlockEntry> blocks;
+  std::vector<std::string> names;
+  // Top then bottom image of each image block, in block order
+  std::vector<unsigned char> images;
+};
+
+class IndexedLogWriter {
+  public:
+    IndexedLogWriter();
+    ~IndexedLogWriter();
+
+    bool open(const std::string& filename);
+    bool isOpen() const { return file_.is_open(); }
+    void writeMemory(Memory& memory, const std::vector<std::string>& blockNames);
+    void close();
+    unsigned int frames() const { return frames_.size(); }
+
+    // pack only reads the memory, so it can run on the thread that owns the memory
+    // while write runs on the thread that owns the file
+    static void pack(Memory& memory, const std::vector<std::string>& blockNames, IndexedLogFrame& frame);
+    void write(const IndexedLogFrame& frame);
+
+  private:
+    uint32_t nameIndex(const std::string& name);
+    void pad();
+
+    IndexedLogFrame scratch_;
+    std::ofstream file_;
+    uint64_t offset_;
+    std::vector<std::string> names_;
+    std::map<std::string, uint32_t> nameIndices_;
+    std::vector<IndexedLogFormat::FrameEntry> frames_;
+    std::vector<IndexedLogFormat::BlockEntry> blocks_;
+    std::vector<char> zeros_;
+};
+
+class IndexedLogReader {
+  public:
+    IndexedLogReader(const std::string& filename);
+    ~IndexedLogReader();
+
+    static bool exists(const std::string& directory);
+
+    bool good() const { return data_ != NULL; }
+    unsigned int size() const { return frames_.size(); }
+
+    // Views into the mapped file, valid while the reader is open
+    BufferSpan getBlockView(unsigned int frame, const std::string& name) const;
+    unsigned char* getTopImage(unsigned int frame) const;
+    unsigned char* getBottomImage(unsigned int frame) const;
+
+    // Fills memory with the frame's blocks. Images are not copied; the ImageBlock
+    // points into the mapped file.
+    bool readMemory(unsigned int frame, Memory& memory) const;
+
+  private:
+    bool readIndex();
+    bool scan();
+    const IndexedLogFormat::BlockEntry* findBlock(unsigned int frame, const std::string& name) const;
+
+    unsigned char* data_;
+    uint64_t size_;
+    std::vector<std::string> names_;
+    std::vector<IndexedLogFormat::FrameEntry> frames_;
+    std::vector<IndexedLogFormat::BlockEntry> blocks_;
+};
+
+#endif
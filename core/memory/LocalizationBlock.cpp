@@ -59,11 +59,11 @@ Matrix2f LocalizationBlock::getBallCov(int model) {
   Matrix2f cov;
   auto& full = covariance[model];
   cov << full.block<2,2>(3,3);
-  cov *= factor;
+  cov *= factor * factor;
   return cov;
 }
 
 float LocalizationBlock::getOrientationVar(int model) {
   auto& full = covariance[model];
-  return full(2,2) * full(2,2);
+  return full(2,2);
 }
@@ -13,6 +13,7 @@ Log::Log(std::string directory, int start, int finish) : directory_(directory),
 Log::~Log() {
   for(auto& kvp : cache_)
     delete kvp.second;
+  if(memory_) delete memory_;
 }
 
 std::vector<ImageParams> Log::getTopParams() {
@@ -94,8 +95,8 @@ Memory& Log::getFrame(unsigned int idx, bool manage) {
     }
     return *memory;
   } else {
-    if(memory_) delete memory_;
-    memory_ = reader_.readFrame(frame);
+    if(!memory_) memory_ = new Memory(false, MemoryOwner::TOOL_MEM, 0, 1);
+    reader_.readFrame(frame, *memory_);
     return *memory_;
   }
 }
@@ -2,13 +2,23 @@
 #include <iostream>
 #include <memory/ImageBlock.h>
 #include <memory/RobotVisionBlock.h>
-#include <memory/MemoryBlockOperations.h>
+#include <memory/MemoryBlockRegistry.h>
 
 #define MAX_EXPECTED_MODULES_PER_MEMORY 40
 
 LogReader::LogReader(const char *directory):
-  using_buffers_(false) {
+  using_buffers_(false), indexed_(NULL) {
   directory_ = directory;
+  if (IndexedLogReader::exists(directory_)) {
+    filename_ = IndexedLogFormat::filename(directory_);
+    indexed_ = new IndexedLogReader(filename_);
+    if (!indexed_->good())
+      std::cout << "problem opening log" << std::endl << std::flush;
+    // The metadata is optional here; the frame count comes from the log itself
+    mdata_.loadFromFile(directory_ + "/metadata.yaml");
+    mdata_.frames = indexed_->size();
+    return;
+  }
   filename_ = directory_ + "/frames.log";
   log_file_.open(filename_.c_str(),std::ios::binary);
   if (!good() || !mdata_.loadFromFile(directory_ + "/metadata.yaml")) {
@@ -18,83 +28,85 @@ LogReader::LogReader(const char *directory):
 
 LogReader::LogReader(const std::string& directory) : LogReader(directory.c_str()) { }
 
-LogReader::LogReader(const StreamBuffer& buffer) :
-  using_buffers_(true), main_buffer_(buffer) {
+LogReader::LogReader(const BufferSpan& buffer) :
+  using_buffers_(true), frame_(buffer), indexed_(NULL) {
 }
 
 LogReader::~LogReader() {
   close();
-}
-
-bool LogReader::readMemoryHeader(const StreamBuffer& buffer, MemoryHeader& header) {
-  std::vector<StreamBuffer> blockNames;
-  StreamBuffer::separate(buffer, blockNames);
-  if (blockNames.size() > MAX_EXPECTED_MODULES_PER_MEMORY) {
-    std::cout << "LogReader::readMemoryHeader: BAD NUMBER OF BLOCKS: " << blockNames.size() << std::endl;
-    return false;
-  }
-  for(unsigned int i = 0; i < blockNames.size(); i++) {
-    std::string name = (const char*)blockNames[i].buffer;
-    header.block_names.push_back(name);
-  }
-  StreamBuffer::clear(blockNames);
-  return true;
+  if (indexed_) delete indexed_;
 }
 
 Memory* LogReader::readFrame(int frame) {
   Memory* memory = new Memory(false,MemoryOwner::TOOL_MEM, 0, 1);
-  MemoryHeader header;
-  unsigned int position = mdata_.offsets[frame];
-  log_file_.seekg(position);
-  main_buffer_.read(log_file_);
-  if(!readMemory(*memory)) {
+  readFrame(frame, *memory);
+  return memory;
+}
+
+bool LogReader::readFrame(int frame, Memory& memory) {
+  bool ok;
+  if (indexed_) {
+    ok = indexed_->readMemory(frame, memory);
+  } else {
+    unsigned int position = mdata_.offsets[frame];
+    log_file_.seekg(position);
+    ok = main_buffer_.read(log_file_);
+    frame_ = main_buffer_.span();
+    ok = ok && readMemory(memory);
+  }
+  if(!ok) {
     printf("Error reading frame %i\n", frame);
   }
-  return memory;
+  return ok;
 }
 
 bool LogReader::readMemory(Memory &memory, bool /*suppress_errors*/) {
-  // get the header and see how many blocks we need to read
-  auto buffers = main_buffer_.separate();
-
-  MemoryHeader header;
-  bool res;
-  res = readMemoryHeader(buffers[0], header);
-  if (!res) {
-    StreamBuffer::clear(buffers);
+  // the frame is the header, a list of block names, followed by one piece per block
+  SpanReader blocks(frame_);
+  BufferSpan hbuffer;
+  if (!blocks.next(hbuffer)) {
+    printf("Error: frame has no header\n");
+    return false;
+  }
+  SpanReader names(hbuffer);
+  if (names.count() > MAX_EXPECTED_MODULES_PER_MEMORY) {
+    std::cout << "LogReader::readMemory: BAD NUMBER OF BLOCKS: " << names.count() << std::endl;
     return false;
   }
-  if (header.block_names.size()<1) {
-    printf("Error: header has %i blocks\n", header.block_names.size());
+  if (names.count() < 1) {
+    printf("Error: header has %i blocks\n", names.count());
     return false;
   }
-  for (unsigned int i = 1; i < buffers.size(); i++) {
-    std::string &id = header.block_names[i - 1];
-    MemoryBlock *block = memory.getBlockPtrByName(id);
+  BufferSpan name, bbuffer;
+  while (blocks.next(bbuffer) && names.next(name)) {
+    // reusing the string keeps block lookups from allocating
+    block_name_.assign((const char*)name.data, strnlen((const char*)name.data, name.size));
+    std::string &id = block_name_;
+    MemoryBlockId::Id block_id = MemoryBlockId::fromName(id);
+    MemoryBlock *block = memory.getBlockPtrById(block_id);
     if (block == NULL) {
-      bool res = memory.addBlockByName(id);
+      bool res = block_id != MemoryBlockId::INVALID && memory.addBlockById(block_id);
       if (!res) {
         std::cout << "Adding block " << id << " failed, just skipping" << std::endl << std::flush;
         continue;
       }
       else {
-        block = memory.getBlockPtrByName(id);
+        block = memory.getBlockPtrById(block_id);
         assert(block != NULL); // really shouldn't happen
       }
     }
     block->buffer_logging_ = using_buffers_;
     block->log_block = true; // if we're reading a log we should be able to re-log it
     bool valid = true;
-    if(id == "raw_image")
-      valid = ((ImageBlock*)block)->deserialize(buffers[i], directory_);
-    else if (id == "robot_vision")
-      valid = ((RobotVisionBlock*)block)->deserialize(buffers[i], directory_);
+    if(block_id == MemoryBlockId::RAW_IMAGE)
+      valid = ((ImageBlock*)block)->deserialize(bbuffer, directory_);
+    else if (block_id == MemoryBlockId::ROBOT_VISION)
+      valid = ((RobotVisionBlock*)block)->deserialize(bbuffer, directory_);
     else
-      valid = MEMORY_BLOCK_TEMPLATE_FUNCTION_CALL(id,block->deserialize,false,buffers[i]);
+      valid = MemoryBlockRegistry::get(block_id)->deserialize(block, bbuffer);
     if(!valid)
       fprintf(stderr, "Error deserializing %s\n", id.c_str());
   }
-  StreamBuffer::clear(buffers);
   return true;
 }
 
@@ -5,26 +5,30 @@
 #include <cstring>
 #include <vector>
 #include <memory/LogMetadata.h>
-#include <memory/StreamBuffer.h>
+#include <memory/ArenaBuffer.h>
 #include <memory/Memory.h>
 #include <memory/MemoryBlock.h>
+#include <memory/IndexedLog.h>
 
 class LogReader {
   public:
     LogReader (const char *directory);
     LogReader (const std::string& directory);
-    LogReader (const StreamBuffer& buffer);
+    // Reads a single streamed frame in place; the bytes must outlive the reader
+    LogReader (const BufferSpan& buffer);
     ~LogReader ();
     
     Memory* readFrame(int frame);
+    // Reads into an existing memory so scrubbing through a log doesn't allocate per frame
+    bool readFrame(int frame, Memory& memory);
     bool readMemory(Memory &memory, bool suppress_errors = false);
     const LogMetadata& mdata() const { return mdata_; }
+    bool isIndexed() const { return indexed_ != NULL; }
 
     const std::string& directory() { return directory_; }
 
   private:
 
-    bool readMemoryHeader(const StreamBuffer& buffer, MemoryHeader &header);
     bool readBlock(const MemoryBlockHeader &header,MemoryBlock &module);
     void readAndIgnoreBlock(const MemoryBlockHeader &header);
     void close();
@@ -38,7 +42,11 @@ class LogReader {
     void read();
     bool good();
 
-    StreamBuffer main_buffer_;
+    // Frames read from the file land in main_buffer_, which is reused for every frame
+    ArenaBuffer main_buffer_;
+    BufferSpan frame_;
+    std::string block_name_;
+    IndexedLogReader* indexed_;
 };
 
 #endif /* end of include guard: LOGREADER_ZN55JIC8 */
@@ -3,9 +3,11 @@
 #include <common/File.h>
 #include <memory/ImageBlock.h>
 #include <memory/RobotVisionBlock.h>
+#include <memory/AsyncLogWriter.h>
 
 Logger::Logger(bool useBuffers, const char* directory, bool appendUniqueId, bool useAllBlocks):
-  using_buffers_(useBuffers), use_all_blocks_(useAllBlocks)
+  using_buffers_(useBuffers), use_all_blocks_(useAllBlocks), indexed_(true),
+  async_(false), async_slots_(8), async_writer_(NULL)
 {
   if (directory) {
     open(directory, appendUniqueId);
@@ -13,67 +15,74 @@ Logger::Logger(bool useBuffers, const char* directory, bool appendUniqueId, bool
 }
 
 Logger::~Logger() {
-  if(using_buffers_) {
-    if(main_buffer_.buffer)
-      delete [] main_buffer_.buffer;
-  }
   close();
 }
 
 bool Logger::isOpen() {
-  return log_file_.is_open();
+  return log_file_.is_open() || indexed_writer_.isOpen();
 }
 
 void Logger::clearBuffer() {
   main_buffer_.reset();
 }
 
-void Logger::writeMemoryHeader(const MemoryHeader &header, StreamBuffer& buffer) {
-  unsigned int num_blocks = header.block_names.size();
-  std::vector<StreamBuffer> buffers;
-  for (unsigned int i = 0; i < num_blocks; i++) {
-    StreamBuffer bbuffer;
-    bbuffer.read(header.block_names[i].c_str(), header.block_names[i].size() + 1);
-    buffers.push_back(bbuffer);
-  }
-  StreamBuffer::combine(buffers, buffer);
+void Logger::writeMemoryHeader(const std::vector<std::string>& blockNames) {
+  main_buffer_.beginList();
+  for (unsigned int i = 0; i < blockNames.size(); i++)
+    main_buffer_.add(blockNames[i].c_str(), blockNames[i].size() + 1);
+  main_buffer_.endList();
 }
 
 void Logger::writeMemory(Memory &memory) {
-  if (using_buffers_ || log_file_.is_open()) {
+  if (indexed_writer_.isOpen()) {
+    block_names_.clear();
+    memory.getBlockNames(block_names_, !use_all_blocks_);
+    for (unsigned int i = 0; i < block_names_.size(); i++) {
+      MemoryBlock *block = memory.getBlockPtrByName(block_names_[i]);
+      block->buffer_logging_ = false;
+      block->header.frameid = frame_id_;
+    }
+    // Dropped frames still take a frame id so gaps show up when the log is replayed
+    frame_id_++;
+    if(async_writer_) {
+      // The writer thread keeps the metadata up to date
+      async_writer_->push(memory, block_names_);
+      return;
+    }
+    mdata_.frames++;
+    indexed_writer_.writeMemory(memory, block_names_);
+    // Frame offsets live in the log's own index, so the metadata only tracks the count
+    if(mdata_.frames % 100 == 0) mdata_.saveToFile(directory_ + "/metadata.yaml");
+  }
+  else if (using_buffers_ || log_file_.is_open()) {
     mdata_.frames++;
     mdata_.offsets.push_back(log_file_.tellp());
-    MemoryHeader header;
     MemoryBlock *block;
     // first get a list of the blocks we're loading
-    memory.getBlockNames(header.block_names, !use_all_blocks_);
-    // write the header
-    StreamBuffer hbuffer;
-    writeMemoryHeader(header, hbuffer);
-    // write each block
-    std::vector<StreamBuffer> buffers;
-    buffers.push_back(hbuffer);
-    for (unsigned int i = 0; i < header.block_names.size(); i++) {
-      std::string& id = header.block_names[i];
+    block_names_.clear();
+    memory.getBlockNames(block_names_, !use_all_blocks_);
+    // the frame is a list of the header followed by each block, all written in place
+    main_buffer_.reset();
+    main_buffer_.beginList();
+    writeMemoryHeader(block_names_);
+    for (unsigned int i = 0; i < block_names_.size(); i++) {
+      std::string& id = block_names_[i];
       block = memory.getBlockPtrByName(id);
       block->buffer_logging_ = using_buffers_;
       block->header.frameid = frame_id_;
-      StreamBuffer sb;
       if(id == "raw_image")
-        ((ImageBlock*)block)->serialize(sb, directory_);
+        ((ImageBlock*)block)->serialize(main_buffer_, directory_);
       else if(id == "robot_vision")
-        ((RobotVisionBlock*)block)->serialize(sb, directory_);
+        ((RobotVisionBlock*)block)->serialize(main_buffer_, directory_);
       else
-        block->serialize(sb);
-      buffers.push_back(sb);
+        block->serialize(main_buffer_);
     }
-    StreamBuffer::combine(buffers, main_buffer_);
+    main_buffer_.endList();
     if(!using_buffers_) {
       write();
       // Write out metadata every 100 frames just in case of a crash
       if(mdata_.frames % 100 == 0) mdata_.saveToFile(directory_ + "/metadata.yaml");
     }
-    StreamBuffer::clear(buffers);
     frame_id_++;
   }
 }
@@ -88,6 +97,14 @@ void Logger::open(const char *directory, bool appendUniqueId) {
     directory_ = directory;
   }
   mkdir_recursive(directory_.c_str());
+  if (indexed_) {
+    filename_ = IndexedLogFormat::filename(directory_);
+    printf("Logging to file: %s\n", filename_.c_str());
+    indexed_writer_.open(filename_);
+    if(async_ && indexed_writer_.isOpen())
+      async_writer_ = new AsyncLogWriter(indexed_writer_, directory_ + "/metadata.yaml", async_slots_);
+    return;
+  }
   filename_ = directory_ + "/frames.log";
   printf("Logging to file: %s\n", filename_.c_str());
   log_file_.open(filename_.c_str(), std::ios::binary);
@@ -112,6 +129,20 @@ void Logger::mkdir_recursive(const char *dir) {
 }
 
 void Logger::close() {
+  if (async_writer_) {
+    // Let the queued frames reach the disk before reporting
+    async_writer_->flush();
+    printf("Log writer: %u frames written, %u dropped, max queue depth %u of %i\n",
+      async_writer_->writtenFrames(), async_writer_->droppedFrames(), async_writer_->maxQueueDepth(), async_slots_);
+    delete async_writer_;
+    async_writer_ = NULL;
+    mdata_.frames = indexed_writer_.frames();
+  }
+  if (indexed_writer_.isOpen()) {
+    std::cout << "Closing log file" << std::endl;
+    indexed_writer_.close();
+    mdata_.saveToFile(directory_ + "/metadata.yaml");
+  }
   if (log_file_.is_open()) {
     std::cout << "Closing log file" << std::endl;
     log_file_.close();
@@ -120,6 +151,18 @@ void Logger::close() {
   frame_id_ = 0;
 }
 
+unsigned int Logger::queueDepth() const {
+  return async_writer_ ? async_writer_->queueDepth() : 0;
+}
+
+unsigned int Logger::maxQueueDepth() const {
+  return async_writer_ ? async_writer_->maxQueueDepth() : 0;
+}
+
+unsigned int Logger::droppedFrames() const {
+  return async_writer_ ? async_writer_->droppedFrames() : 0;
+}
+
 void Logger::setType(int t){
   type_ = t;
 }
@@ -142,8 +185,7 @@ std::string Logger::generateDirectoryName(const char* basename) {
 }
 
 void Logger::write() {
-  log_file_.write((const char*)&(main_buffer_.size), sizeof(int));
-  log_file_.write((const char*)main_buffer_.buffer, main_buffer_.size);
+  main_buffer_.write(log_file_);
 }
 
 int Logger::frame_id_ = 0;
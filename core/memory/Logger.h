@@ -6,9 +6,12 @@
 #include <memory/Memory.h>
 #include <memory/MemoryBlock.h>
 #include <common/InterfaceInfo.h>
-#include <memory/StreamBuffer.h>
+#include <memory/ArenaBuffer.h>
+#include <memory/IndexedLog.h>
 #include <sys/stat.h>
 
+class AsyncLogWriter;
+
 class Logger {
 public:
   virtual ~Logger ();
@@ -20,24 +23,36 @@ public:
   void close();
   void write();
   void setType(int type);
+  // File logs are written as a single indexed frames.ulog unless this is turned off before open()
+  void setIndexed(bool value) { indexed_ = value; }
+  // Indexed logs are handed to a writer thread through a ring of this many frames; full rings drop frames
+  void setAsync(bool value, int slots = 8) { async_ = value; async_slots_ = slots; }
+  unsigned int queueDepth() const;
+  unsigned int maxQueueDepth() const;
+  unsigned int droppedFrames() const;
   void clearBuffer();
   static void mkdir_recursive(const char* dir);
-  inline const StreamBuffer& getBuffer() const { return main_buffer_; }
+  inline const ArenaBuffer& getBuffer() const { return main_buffer_; }
 
 protected:
   Logger(bool useBuffers, const char* directory, bool appendUniqueId, bool useAllBlocks = false);
 
 private:
   std::string generateDirectoryName(const char *basename);
-  void writeMemoryHeader(const MemoryHeader &header, StreamBuffer& buffer);
+  void writeMemoryHeader(const std::vector<std::string>& blockNames);
 
   std::ofstream log_file_;
   std::string directory_, filename_;
   int type_;
   static int frame_id_;
   
-  bool using_buffers_, use_all_blocks_;
-  StreamBuffer main_buffer_;
+  bool using_buffers_, use_all_blocks_, indexed_, async_;
+  int async_slots_;
+  IndexedLogWriter indexed_writer_;
+  AsyncLogWriter* async_writer_;
+  // Both are reused from frame to frame so logging doesn't allocate once they have grown
+  ArenaBuffer main_buffer_;
+  std::vector<std::string> block_names_;
   LogMetadata mdata_;
 };
 
@@ -2,6 +2,8 @@
 
 #include <memory/MemoryBlockOperations.h>
 
+#include <string.h>
+
 #include <boost/thread.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
@@ -26,6 +28,7 @@ Memory::Memory(bool use_shared_memory, MemoryOwner::Owner owner, int team_num, i
     shared_memory_ = NULL;
     private_memory_ = new PrivateMemory();
   }
+  memset(blocks_by_id_, 0, sizeof(blocks_by_id_));
 }
 
 Memory::Memory(const Memory &old):
@@ -41,6 +44,7 @@ Memory::Memory(const Memory &old):
   private_memory_ = new PrivateMemory(*old.private_memory_);
   shared_memory_ = NULL;
   owner_ = old.owner_;
+  memset(blocks_by_id_, 0, sizeof(blocks_by_id_));
 }
 
 Memory::~Memory() {
@@ -72,11 +76,41 @@ Memory& Memory::operator=(const Memory &old) {
   private_memory_ = new PrivateMemory(*old.private_memory_);
   shared_memory_ = NULL;
   owner_ = old.owner_;
+  memset(blocks_by_id_, 0, sizeof(blocks_by_id_));
   return *this;
 }
 
 
+MemoryBlock* Memory::findBlock(MemoryBlockId::Id id) const {
+  MemoryBlock *ptr = blocks_by_id_[id];
+  if (ptr != NULL)
+    return ptr;
+  std::string name(MemoryBlockId::name(id));
+  if (use_shared_memory_)
+    ptr = shared_memory_->getBlockPtr(name);
+  else
+    ptr = private_memory_->getBlockPtr(name);
+  blocks_by_id_[id] = ptr;
+  return ptr;
+}
+
+MemoryBlock* Memory::getBlockPtr(MemoryBlockId::Id id, MemoryOwner::Owner expect_owner) const {
+  if (id >= MemoryBlockId::NUM_BLOCKS)
+    return NULL;
+  MemoryBlock *ptr = findBlock(id);
+  if (ptr != NULL) {
+    if (expect_owner == MemoryOwner::UNKNOWN)
+      expect_owner = owner_;
+    ptr->checkOwner(MemoryBlockId::name(id),expect_owner);
+  }
+  return ptr;
+}
+
 MemoryBlock* Memory::getBlockPtr(const std::string &name, MemoryOwner::Owner expect_owner) {
+  MemoryBlockId::Id id = MemoryBlockId::fromName(name);
+  if (id != MemoryBlockId::INVALID)
+    return getBlockPtr(id,expect_owner);
+
   MemoryBlock *ptr;
   if (use_shared_memory_)
     ptr = shared_memory_->getBlockPtr(name);
@@ -86,12 +120,16 @@ MemoryBlock* Memory::getBlockPtr(const std::string &name, MemoryOwner::Owner exp
   if (ptr != NULL) {
     if (expect_owner == MemoryOwner::UNKNOWN)
       expect_owner = owner_;
-    ptr->checkOwner(name,expect_owner);
+    ptr->checkOwner(name.c_str(),expect_owner);
   }
   return ptr;
 }
 
 const MemoryBlock* Memory::getBlockPtr(const std::string &name, MemoryOwner::Owner expect_owner) const {
+  MemoryBlockId::Id id = MemoryBlockId::fromName(name);
+  if (id != MemoryBlockId::INVALID)
+    return getBlockPtr(id,expect_owner);
+
   MemoryBlock *ptr;
   if (use_shared_memory_)
     ptr = shared_memory_->getBlockPtr(name);
@@ -101,7 +139,7 @@ const MemoryBlock* Memory::getBlockPtr(const std::string &name, MemoryOwner::Own
   if (ptr != NULL) {
     if (expect_owner == MemoryOwner::UNKNOWN)
       expect_owner = owner_;
-    ptr->checkOwner(name,expect_owner);
+    ptr->checkOwner(name.c_str(),expect_owner);
   }
   return ptr;
 }
@@ -128,9 +166,33 @@ const MemoryBlock* Memory::getBlockPtrByName(const std::string &name) const {
 }
 
 bool Memory::addBlockByName(const std::string &name, MemoryOwner::Owner owner) {
+  MemoryBlockId::Id id = MemoryBlockId::fromName(name);
+  if (id == MemoryBlockId::INVALID) {
+    fprintf(stderr, "ERROR ADDING MEMORY BLOCK '%s'\n", name.c_str());
+    return false;
+  }
+  return addBlockById(id, owner);
+}
+
+MemoryBlock* Memory::getBlockPtrById(MemoryBlockId::Id id) {
+  return getBlockPtr(id,MemoryOwner::UNKNOWN);
+}
+
+typedef bool (Memory::*BlockAdder)(const std::string&);
+
+bool Memory::addBlockById(MemoryBlockId::Id id, MemoryOwner::Owner owner) {
+#define BLOCK_ADDER(id, name, type) &Memory::addNewBlock<type>,
+  static const BlockAdder adders[MemoryBlockId::NUM_BLOCKS] = {
+    MEMORY_BLOCK_TYPES(BLOCK_ADDER)
+  };
+#undef BLOCK_ADDER
+  if (id >= MemoryBlockId::NUM_BLOCKS) {
+    fprintf(stderr, "ERROR ADDING MEMORY BLOCK WITH ID %i\n", id);
+    return false;
+  }
   if (owner == MemoryOwner::UNKNOWN) {
     owner = owner_;
   }
   temp_add_owner_ = owner;
-  ADD_MEMORY_BLOCK(name,addBlock);
+  return (this->*adders[id])(MemoryBlockId::name(id));
 }
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include "MemoryBlock.h"
+#include <memory/MemoryBlockIds.h>
 #include "SharedMemory.h"
 #include "PrivateMemory.h"
 #include "Lock.h"
@@ -24,6 +25,15 @@ public:
   MemoryBlock* getBlockPtrByName(const std::string &name);
   const MemoryBlock* getBlockPtrByName(const std::string &name) const;
   bool addBlockByName(const std::string &name, MemoryOwner::Owner owner = MemoryOwner::UNKNOWN);
+  // Lookups by id are an array index once the block has been found the first time
+  MemoryBlock* getBlockPtrById(MemoryBlockId::Id id);
+  bool addBlockById(MemoryBlockId::Id id, MemoryOwner::Owner owner = MemoryOwner::UNKNOWN);
+
+  template <class T>
+  bool getBlockById(T *&ptr, MemoryBlockId::Id id, MemoryOwner::Owner expect_owner = MemoryOwner::UNKNOWN) {
+    ptr = (T*)getBlockPtr(id,expect_owner);
+    return ptr != NULL;
+  }
 
   template <class T>
   bool getBlockByName(T *&ptr, const std::string &name, bool output_no_exist = true, MemoryOwner::Owner expect_owner = MemoryOwner::UNKNOWN) {
@@ -72,8 +82,15 @@ private:
     return res;
   };
 
+  template <class T>
+  bool addNewBlock(const std::string &name) {
+    return addBlock(name, new T());
+  }
+
   MemoryBlock* getBlockPtr(const std::string &name, MemoryOwner::Owner expect_owner);
   const MemoryBlock* getBlockPtr(const std::string &name, MemoryOwner::Owner expect_owner) const;
+  MemoryBlock* getBlockPtr(MemoryBlockId::Id id, MemoryOwner::Owner expect_owner) const;
+  MemoryBlock* findBlock(MemoryBlockId::Id id) const;
 
 private:
   bool use_shared_memory_;
@@ -84,6 +101,8 @@ private:
   PrivateMemory *private_memory_;
 
   MemoryOwner::Owner temp_add_owner_;
+  // Blocks found so far, by id. Blocks are never removed, so only misses go to the map.
+  mutable MemoryBlock* blocks_by_id_[MemoryBlockId::NUM_BLOCKS];
 
 public:
   Lock *vision_lock_;
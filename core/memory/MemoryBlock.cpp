@@ -14,7 +14,7 @@ MemoryBlock& MemoryBlock::operator=(const MemoryBlock &that) {
   return *this;
 }
 
-bool MemoryBlock::checkOwner(const std::string &name, MemoryOwner::Owner expect_owner, bool no_exit) const {
+bool MemoryBlock::checkOwner(const char *name, MemoryOwner::Owner expect_owner, bool no_exit) const {
   if (owner != expect_owner) {
     // the tool is master of all it surveys
     if (expect_owner == MemoryOwner::TOOL_MEM)
@@ -43,19 +43,17 @@ bool MemoryBlock::checkOwner(const std::string &name, MemoryOwner::Owner expect_
   return true;
 }
 
-void MemoryBlock::serialize(StreamBuffer& buffer) {
-  StreamBuffer hbuffer, bbuffer;
-  hbuffer.read((unsigned char*)&header, sizeof(MemoryBlockHeader));
-  bbuffer.read((unsigned char*)this, header.size);
-  std::vector<StreamBuffer> buffers;
-  buffers.push_back(hbuffer); buffers.push_back(bbuffer);
-  StreamBuffer::combine(buffers, buffer);
-  StreamBuffer::clear(buffers);
+void MemoryBlock::serialize(ArenaBuffer& buffer) {
+  buffer.beginList();
+  buffer.add(&header, sizeof(MemoryBlockHeader));
+  buffer.add(this, header.size);
+  buffer.endList();
 }
 
-bool MemoryBlock::validateHeader(const StreamBuffer& thbuffer) {
+bool MemoryBlock::validateHeader(const BufferSpan& thbuffer) {
+  if(thbuffer.size < sizeof(MemoryBlockHeader)) return false;
   MemoryBlockHeader theader;
-  memcpy((unsigned char*)&theader, thbuffer.buffer, sizeof(MemoryBlockHeader));
+  memcpy((unsigned char*)&theader, thbuffer.data, sizeof(MemoryBlockHeader));
   return validateHeader(theader);
 }
 
@@ -4,7 +4,8 @@
 #include <cstring>
 #include <string>
 #include <stdlib.h>
-#include <memory/StreamBuffer.h>
+#include <stdio.h>
+#include <memory/ArenaBuffer.h>
 
 struct MemoryBlockHeader {
   unsigned int version;
@@ -36,25 +37,25 @@ public:
 
   virtual MemoryBlock& operator=(const MemoryBlock &that);
 
-  void serialize(StreamBuffer& buffer);
+  void serialize(ArenaBuffer& buffer);
   template <class T>
-  bool deserialize(const StreamBuffer& buffer) {
-    std::vector<StreamBuffer> buffers;
-    StreamBuffer::separate(buffer, buffers);
-    MemoryBlockHeader theader;
-    memcpy((unsigned char*)&theader, buffers[0].buffer, sizeof(MemoryBlockHeader));
-    if(!validateHeader(theader)) return false;
-    *(T*)this = *(T*)buffers[1].buffer;
-    if(sizeof(T) != buffers[1].size)
-      fprintf(stderr, "ERROR: Invalid buffer size: %i (expected %i)\n", buffers[1].size, sizeof(T));
-    StreamBuffer::clear(buffers);
+  bool deserialize(const BufferSpan& buffer) {
+    SpanReader parts(buffer);
+    BufferSpan hbuffer, bbuffer;
+    if(!parts.next(hbuffer) || !parts.next(bbuffer)) return false;
+    if(!validateHeader(hbuffer)) return false;
+    if(sizeof(T) != bbuffer.size) {
+      fprintf(stderr, "ERROR: Invalid buffer size: %i (expected %i)\n", bbuffer.size, sizeof(T));
+      if(sizeof(T) > bbuffer.size) return false;
+    }
+    *(T*)this = *(const T*)bbuffer.data;
     return true;
   }
 
-  bool validateHeader(const StreamBuffer& buffer);
+  bool validateHeader(const BufferSpan& buffer);
   bool validateHeader(const MemoryBlockHeader& theader);
 
-  bool checkOwner(const std::string &name, MemoryOwner::Owner expect_owner, bool no_exit = false) const;
+  bool checkOwner(const char *name, MemoryOwner::Owner expect_owner, bool no_exit = false) const;
 
   bool buffer_logging_;
 };
@@ -0,0 +1,31 @@
+#include <memory/MemoryBlockRegistry.h>
+#include <memory/MemoryBlockOperations.h>
+
+template<class T>
+static MemoryBlock* createBlock() {
+  return new T();
+}
+
+template<class T>
+static MemoryBlock* copyBlock(const MemoryBlock* block) {
+  return new T(*(const T*)block);
+}
+
+template<class T>
+static void destroyBlock(MemoryBlock* block) {
+  delete (T*)block;
+}
+
+template<class T>
+static bool deserializeBlock(MemoryBlock* block, const BufferSpan& buffer) {
+  return block->deserialize<T>(buffer);
+}
+
+#define REGISTRY_ENTRY(id, name, type) \
+  { name, &createBlock<type>, &copyBlock<type>, &destroyBlock<type>, &deserializeBlock<type> },
+
+const MemoryBlockRegistry::Entry MemoryBlockRegistry::TABLE[MemoryBlockId::NUM_BLOCKS] = {
+  MEMORY_BLOCK_TYPES(REGISTRY_ENTRY)
+};
+
+#undef REGISTRY_ENTRY
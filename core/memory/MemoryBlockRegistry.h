@@ -0,0 +1,27 @@
+#ifndef MEMORY_BLOCK_REGISTRY_H
+#define MEMORY_BLOCK_REGISTRY_H
+
+#include <memory/MemoryBlock.h>
+#include <memory/MemoryBlockIds.h>
+
+/* Per type block operations indexed by MemoryBlockId, so code that handles blocks
+ * generically dispatches with an array lookup instead of comparing the name against
+ * every block. The table is built from the generated MEMORY_BLOCK_TYPES list, so a
+ * block added to generate_block_operations.py is picked up automatically. */
+class MemoryBlockRegistry {
+  public:
+    struct Entry {
+      const char* name;
+      MemoryBlock* (*create)();
+      MemoryBlock* (*copy)(const MemoryBlock* block);
+      void (*destroy)(MemoryBlock* block);
+      bool (*deserialize)(MemoryBlock* block, const BufferSpan& buffer);
+    };
+
+    static inline const Entry* get(MemoryBlockId::Id id) { return id < MemoryBlockId::NUM_BLOCKS ? &TABLE[id] : NULL; }
+
+  private:
+    static const Entry TABLE[MemoryBlockId::NUM_BLOCKS];
+};
+
+#endif
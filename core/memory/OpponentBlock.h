@@ -41,6 +41,12 @@ public:
       OpponentModel &gen = genModels[i], &loc = locModels[i];
       for(float *g = &gen.X00, *l = &loc.X00; g <= &gen.P33; g++, l++)
         *g = *l * 10;
+      gen.SRXX = loc.SRXX * 10;
+      gen.SRXY = loc.SRXY * 10;
+      gen.SRYY = loc.SRYY * 10;
+      gen.modelNumber = loc.modelNumber;
+      gen.alpha = loc.alpha;
+      gen.frameLastObserved = loc.frameLastObserved;
 
       gen.loc = Point2D(gen.X00, gen.X10);
       gen.sd = Point2D(gen.P00, gen.P11);
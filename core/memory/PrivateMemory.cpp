@@ -2,7 +2,7 @@
 #include <iostream>
 #include <memory/ImageBlock.h>
 #include <memory/RobotVisionBlock.h>
-#include <memory/MemoryBlockOperations.h>
+#include <memory/MemoryBlockRegistry.h>
 
 PrivateMemory::PrivateMemory() : is_copy_(false) {
   //std::cout << "PRIVATE MEMORY CONSTRUCTOR" << std::endl << std::flush;
@@ -10,14 +10,17 @@ PrivateMemory::PrivateMemory() : is_copy_(false) {
 
 PrivateMemory::PrivateMemory(const PrivateMemory &mem) : is_copy_(true) {
   for (MemMap::const_iterator it = mem.blocks_.begin(); it != mem.blocks_.end(); it++) {
-    MemoryBlock *temp = COPY_MEMORY_BLOCK(it->first, it->second);
+    const MemoryBlockRegistry::Entry *entry = MemoryBlockRegistry::get(MemoryBlockId::fromName(it->first));
+    MemoryBlock *temp = entry ? entry->copy(it->second) : NULL;
     if(temp) blocks_.insert(std::pair<std::string,MemoryBlock*>(it->first,temp));
   }
 }
 
 PrivateMemory::~PrivateMemory() {
   for (MemMap::iterator it = blocks_.begin(); it != blocks_.end(); it ++) {
-    DELETE_MEMORY_BLOCK(it->first, it->second);
+    const MemoryBlockRegistry::Entry *entry = MemoryBlockRegistry::get(MemoryBlockId::fromName(it->first));
+    if(entry) entry->destroy(it->second);
+    else fprintf(stderr, "ERROR DELETING MEMORY BLOCK '%s'\n", it->first.c_str());
   }
   blocks_.clear();
 }
@@ -49,10 +52,9 @@ const MemoryBlock* PrivateMemory::getBlockPtr(const std::string &name) const {
 }
 
 void PrivateMemory::getBlockNames(std::vector<std::string> &module_names, bool only_log, MemoryOwner::Owner for_owner) const {
-  for(auto kvp : blocks_) {
-    std::string name = kvp.first;
+  for(const auto& kvp : blocks_) {
     auto block = kvp.second;
-    if((!only_log || block->log_block) && block->checkOwner(name, for_owner, true))
-      module_names.push_back(name);
+    if((!only_log || block->log_block) && block->checkOwner(kvp.first.c_str(), for_owner, true))
+      module_names.push_back(kvp.first);
   }
 }
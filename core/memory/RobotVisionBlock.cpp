@@ -50,71 +50,55 @@ RobotVisionBlock& RobotVisionBlock::operator=(const RobotVisionBlock& other) {
   return *this;
 }
 
-void RobotVisionBlock::serialize(StreamBuffer& buffer, std::string) {
-  std::vector<StreamBuffer> all;
+void RobotVisionBlock::serialize(ArenaBuffer& buffer, const std::string&) {
+  buffer.beginList();
+  buffer.add(&header, sizeof(MemoryBlockHeader));
+  buffer.add(&top_params_, sizeof(ImageParams));
+  buffer.add(&bottom_params_, sizeof(ImageParams));
 
-  StreamBuffer main;
-  main.read((unsigned char*)&header, sizeof(MemoryBlockHeader));
-  all.push_back(main);
-
-  StreamBuffer tparams, bparams;
-  tparams.read((unsigned char*)&top_params_, sizeof(ImageParams));
-  all.push_back(tparams);
-  bparams.read((unsigned char*)&bottom_params_, sizeof(ImageParams));
-  all.push_back(bparams);
-
-  StreamBuffer top;
-  top.read(getSegImgTop(), top_params_.size);
+  unsigned char* top = buffer.reserve(top_params_.size);
+  memcpy(top, getSegImgTop(), top_params_.size);
   // Fill in values for the segmented image based on last classified pixel
   for (int i = 0; i < top_params_.size; i++){
-    if (top.buffer[i] == c_UNDEFINED){
+    if (top[i] == c_UNDEFINED){
       int x = (i % top_params_.width);
       x -= (x % (1 << top_params_.defaultHorizontalStepScale));
       int y = (i / top_params_.width);
       y -= (y % (1 << top_params_.defaultVerticalStepScale));
-      top.buffer[i] = top.buffer[x + (y * top_params_.width)];
+      top[i] = top[x + (y * top_params_.width)];
     }
   }
 
-  all.push_back(top);
-
-  StreamBuffer bottom;
-  bottom.read(getSegImgBottom(), bottom_params_.size);
-  all.push_back(bottom);
-
-  StreamBuffer hbuff;
-  hbuff.read((unsigned char*)&horizon, sizeof(HorizonLine));
-  all.push_back(hbuff);
-
-  StreamBuffer::combine(all, buffer);
-  StreamBuffer::clear(all);
+  buffer.add(getSegImgBottom(), bottom_params_.size);
+  buffer.add(&horizon, sizeof(HorizonLine));
+  buffer.endList();
 }
 
-bool RobotVisionBlock::deserialize(const StreamBuffer& buffer, std::string) {
-  auto parts = buffer.separate();
-  if(!validateHeader(parts[0])) {
-    StreamBuffer::clear(parts);
+bool RobotVisionBlock::deserialize(const BufferSpan& buffer, const std::string&) {
+  SpanReader parts(buffer);
+  BufferSpan main, tparams, bparams, top, bottom, hbuff;
+  if(!parts.next(main) || !parts.next(tparams) || !parts.next(bparams) ||
+      !parts.next(top) || !parts.next(bottom) || !parts.next(hbuff))
     return false;
-  }
-  if(top_params_.rawSize < parts[3].size) {
+  if(!validateHeader(main)) return false;
+  if(top_params_.rawSize < (int)top.size) {
     delete [] segImgTopLocal;
-    segImgTopLocal = new unsigned char[parts[3].size];
+    segImgTopLocal = new unsigned char[top.size];
   }
-  if(bottom_params_.rawSize < parts[4].size) {
+  if(bottom_params_.rawSize < (int)bottom.size) {
     delete [] segImgBottomLocal;
-    segImgBottomLocal = new unsigned char[parts[4].size];
+    segImgBottomLocal = new unsigned char[bottom.size];
   }
 
-  parts[0].write(header);
-  parts[1].write(top_params_);
-  parts[2].write(bottom_params_);
-  parts[3].write(segImgTopLocal);
-  parts[4].write(segImgBottomLocal);
-  parts[5].write(horizon);
+  main.write(header);
+  tparams.write(top_params_);
+  bparams.write(bottom_params_);
+  top.write(segImgTopLocal);
+  bottom.write(segImgBottomLocal);
+  hbuff.write(horizon);
   loaded_ = true;
 
   segImgTop = segImgTopLocal;
   segImgBottom = segImgBottomLocal;
-  StreamBuffer::clear(parts);
   return true;
 }
@@ -46,8 +46,8 @@ public:
   inline void setSegImgTop(unsigned char* img) { segImgTop = img; }
   inline void setSegImgBottom(unsigned char* img) { segImgBottom = img; }
 
-  void serialize(StreamBuffer& buffer, std::string);
-  bool deserialize(const StreamBuffer& buffer, std::string);
+  void serialize(ArenaBuffer& buffer, const std::string&);
+  bool deserialize(const BufferSpan& buffer, const std::string&);
 
   bool doHighResBallScan;
   bool lookForCross;
@@ -0,0 +1,66 @@
+#ifndef SEQ_LOCK_H
+#define SEQ_LOCK_H
+
+#include <atomic>
+
+/* Single writer sequence lock for data in shared memory. The sequence is odd while
+ * a write is in progress and goes up by two for every completed write, so the writer
+ * never waits and a reader that raced with it just copies again. Readers give up
+ * after a bounded wait rather than spinning on a writer that died mid write. */
+class SeqLock {
+  public:
+    static const int READ_ATTEMPTS = 8;
+    // a write copies a few blocks, so this comfortably outlasts one
+    static const int WRITE_SPINS = 1 << 16;
+
+    SeqLock() : sequence_(0) { }
+    SeqLock(const SeqLock& other) : sequence_(other.sequence()) { }
+    SeqLock& operator=(const SeqLock& other) {
+      sequence_.store(other.sequence(), std::memory_order_relaxed);
+      return *this;
+    }
+
+    inline void beginWrite() {
+      unsigned int s = sequence_.load(std::memory_order_relaxed);
+      // a writer that was killed mid write leaves the sequence odd, keep it that way
+      sequence_.store(s + 1 + (s & 1), std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    inline void endWrite() {
+      sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    template <class Write>
+    void write(Write write) {
+      beginWrite();
+      write();
+      endWrite();
+    }
+
+    // Runs copy(sequence) until it completes without a write overlapping it. Returns
+    // false if no attempt was clean, in which case the copy may be torn.
+    template <class Copy>
+    bool read(Copy copy, int attempts = READ_ATTEMPTS) const {
+      for (int i = 0; i < attempts; i++) {
+        unsigned int s = sequence_.load(std::memory_order_acquire);
+        for (int spin = 0; (s & 1) && spin < WRITE_SPINS; spin++)
+          s = sequence_.load(std::memory_order_acquire);
+        if (s & 1)
+          return false;
+        copy(s);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) == s)
+          return true;
+      }
+      return false;
+    }
+
+    // Sequence of the last completed write, changes whenever new data is published
+    inline unsigned int sequence() const { return sequence_.load(std::memory_order_acquire); }
+
+  private:
+    std::atomic<unsigned int> sequence_;
+};
+
+#endif
@@ -52,7 +52,7 @@ const MemoryBlock* SharedMemory::getBlockPtr(const std::string &name) const {
 
 void SharedMemory::getBlockNames(std::vector<std::string> &module_names, bool only_log, MemoryOwner::Owner for_owner) const {
   for (SharedMemMap::const_iterator it = blocks_->begin(); it != blocks_->end(); it++) {
-    if (((!only_log) || (*it).second->log_block) && ((*it).second->checkOwner(std::string((*it).first.c_str()),for_owner,true)))
+    if (((!only_log) || (*it).second->log_block) && ((*it).second->checkOwner((*it).first.c_str(),for_owner,true)))
       module_names.push_back(std::string((*it).first.c_str()));
   }
 }
@@ -24,7 +24,7 @@ void StreamBuffer::clear() {
 
 void StreamBuffer::rclear() {
   clear();
-  for(auto child : children)
+  for(auto& child : children)
     child.rclear();
   children.clear();
 }
@@ -110,7 +110,7 @@ StreamBuffer StreamBuffer::combine(const std::vector<StreamBuffer>& buffers) {
 
 void StreamBuffer::combine(const std::vector<StreamBuffer>& buffers, StreamBuffer& combined) {
   unsigned int totalSize = 0;
-  for(auto buffer : buffers)
+  for(const auto& buffer : buffers)
     totalSize += buffer.size;
 
   combined.resize(totalSize + buffers.size() * sizeof(unsigned int) + sizeof(unsigned int));
@@ -131,7 +131,7 @@ void StreamBuffer::combine(const std::vector<StreamBuffer>& buffers, StreamBuffe
 
 void StreamBuffer::combine(const std::list<StreamBuffer>& buffers, StreamBuffer& combined) {
   unsigned int totalSize = 0;
-  for(auto buffer : buffers)
+  for(const auto& buffer : buffers)
     totalSize += buffer.size;
 
   combined.resize(totalSize + buffers.size() * sizeof(unsigned int) + sizeof(unsigned int));
@@ -198,10 +198,10 @@ void StreamBuffer::separate(const StreamBuffer& buffer, std::list<StreamBuffer>&
 }
 
 void StreamBuffer::clear(std::vector<StreamBuffer>& buffers) {
-  for(auto sb : buffers) sb.clear();
+  for(auto& sb : buffers) sb.clear();
 }
 
 void StreamBuffer::clear(std::list<StreamBuffer>& buffers) {
-  for(auto sb : buffers) sb.clear();
+  for(auto& sb : buffers) sb.clear();
 }
 
@@ -7,6 +7,7 @@
 #include <assert.h>
 #include <vector>
 #include <list>
+#include <utility>
 
 struct StreamBuffer {
   unsigned int size;
@@ -32,7 +33,7 @@ struct StreamBuffer {
   template<typename T>
   void write(T& dest) {
     if(children.size()) {
-      auto sb = children.front();
+      auto sb = std::move(children.front());
       children.pop_front();
       sb.write(dest);
     } else {
@@ -42,7 +43,7 @@ struct StreamBuffer {
   template<typename T>
   void write(T* dest) {
     if(children.size()) {
-      auto sb = children.front();
+      auto sb = std::move(children.front());
       children.pop_front();
       sb.write(dest);
     } else {
@@ -0,0 +1,53 @@
+#ifndef SYNC_CHANNEL_BLOCK_H
+#define SYNC_CHANNEL_BLOCK_H
+
+#include "MemoryBlock.h"
+#include "SeqLock.h"
+#include "OdometryBlock.h"
+
+// Sequence locks for the blocks motion and vision exchange. Every sync block has
+// exactly one writer, so publishing never waits on the other process.
+struct SyncChannelBlock : public MemoryBlock {
+public:
+  SyncChannelBlock() {
+    header.version = 0;
+    header.size = sizeof(SyncChannelBlock);
+
+    kick_running_ = false;
+    finished_with_step_ = false;
+    kicks_ = 0;
+    odometry_x_ = odometry_y_ = odometry_rotation_ = 0;
+    trace_reports_sent_ = 0;
+    trace_report_[0] = 0;
+
+    fall_direction_ = Fall::NONE;
+    kick_params_sent_ = walk_param_sent_ = al_walk_param_sent_ = 0;
+    trace_dumps_requested_ = 0;
+  }
+
+  // Fits in the data of one ToolPacket
+  static const int TRACE_REPORT_LENGTH = 1024;
+
+  // Written by motion: sync_body_model, sync_joint_angles, sync_sensors, sync_odometry,
+  // sync_motion_walk_request, sync_walk_response, sync_processed_sonar, sync_walk_info
+  SeqLock motion_;
+  bool kick_running_;
+  bool finished_with_step_;
+  // Kicks and odometry only ever count up, vision takes the difference since its last read
+  unsigned int kicks_;
+  double odometry_x_, odometry_y_, odometry_rotation_;
+  // Latency report for the last trace dump vision asked for
+  unsigned int trace_reports_sent_;
+  char trace_report_[TRACE_REPORT_LENGTH];
+
+  // Written by vision: sync_kick_request, sync_walk_request, sync_joint_commands,
+  // sync_kick_params, sync_walk_param, sync_al_walk_param
+  SeqLock vision_;
+  Fall::FallDir fall_direction_;
+  // Bumped each time vision sends the matching params block
+  unsigned int kick_params_sent_, walk_param_sent_, al_walk_param_sent_;
+  // Bumped each time the tool asks for motion's latency report
+  unsigned int trace_dumps_requested_;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <ctime>
 #include <stdarg.h>
+#include <mutex>
 
 #define MESSAGE_SIZE (1024 * 8)
 
@@ -18,6 +19,9 @@ char __TextLoggerLevels[0] = { };
   } \
   next:
 
+// Vision may log from both camera threads at once
+static std::mutex __writeMutex;
+
 TextLogger::TextLogger(const char *filename, bool appendUniqueId) : frameInfo(NULL) {
   enabled = false;
   toolSimMode = false;
@@ -59,6 +63,7 @@ void TextLogger::setFrameInfo(FrameInfoBlock* fi){
 }
 
 void TextLogger::writeDebug(int loglevel, int frame, int moduleType, char *msg ) {
+  std::lock_guard<std::mutex> lock(__writeMutex);
 
   if ( toolSimMode ){
     char buffer[MESSAGE_SIZE];
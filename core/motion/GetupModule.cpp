@@ -1,4 +1,5 @@
 #include "GetupModule.h"
+#include <common/LatencyTrace.h>
 
 #include <memory/FrameInfoBlock.h>
 #include <memory/JointCommandBlock.h>
@@ -50,6 +51,7 @@ void GetupModule::setFrontGetup() {
 }
 
 bool GetupModule::processFrameChild() {
+  LATENCY_PROBE("getup", 0);
   //std::cout << frame_info_->frame_id << " " << getName(state) << std::endl;
   // set getting up odometry
   if (isGettingUp()){
@@ -1,5 +1,7 @@
 #include "KickModule.h"
 #include <kinematics/ForwardKinematics.h>
+#include <kinematics/CoMSolver.h>
+#include <common/LatencyTrace.h>
 #include <memory/FrameInfoBlock.h>
 #include <memory/JointBlock.h>
 #include <memory/JointCommandBlock.h>
@@ -64,6 +66,7 @@ void KickModule::initSpecificModule() {
 }
 
 void KickModule::processFrame() {
+  LATENCY_PROBE("kick", 0);
   processKickRequest();
   if (kick_module_->state_ == KickState::STAND) {
     //cout << "Kick: stand state" << endl;
@@ -451,16 +454,6 @@ void KickModule::calcJointTargets(const Vector3<float> &com_target, const Pose3D
     swing_foot = BodyPart::right_foot;
     stance_hip_roll = LHipRoll;
   }
-  // the offset from stance leg to torso
-  Vector3<float> stance_to_torso_offset;
-  stance_to_torso_offset = command_body_model_.abs_parts_[stance_foot].translation - command_body_model_.abs_parts_[BodyPart::torso].translation;
-
-  Vector3<float> abs_desired_com;
-  abs_desired_com.x = com_target.x + stance_to_torso_offset.x;
-  abs_desired_com.y = com_target.y + stance_to_torso_offset.y;
-  abs_desired_com.z = com_target.z;
-
-
   // stance leg starts out at current position
   // && will be offset later by com change we want
   stance_target->rotation = RotationMatrix(0,0,0);
@@ -484,59 +477,18 @@ void KickModule::calcJointTargets(const Vector3<float> &com_target, const Pose3D
   swing_target->translation += stance_target->translation;
   swing_target->rotation.rotateZ(stance_target->rotation.getZAngle());
 
-  Vector3<float> com_err;
-  float max_acceptable_com_err = 0.25; //1.0;
-  for (int i = 0; i < 100; i++) {
-    com_err = abs_desired_com - com;
-    if (!move_com)
-      com_err = Vector3<float>(0,0,0);
-    //if (com_err.abs() < max_acceptable_com_err && i > 0)
-    if (fabs(com_err.y) < max_acceptable_com_err && i > 0)
-      break;
+  if (stance_target->translation.z < -203) stance_target->translation.z = -203;
+  if (swing_target->translation.z < -203) swing_target->translation.z = -203;
+
+  // move both feet sideways relative to the torso until the com sits at
+  // com_target.y from the stance foot, the swing leg keeps its distance to the
+  // stance leg
+  setArms(command_angles);
+  CoMSolver solver(robot_info_->dimensions_, robot_info_->mass_calibration_);
+  solver.setAxes(false, move_com, false);
+  solver.solve(left_target, right_target, !is_left_swing, com_target, roll, command_angles,
+    command_body_model_.rel_parts_, command_body_model_.abs_parts_, command_body_model_.center_of_mass_);
 
-    // so we don't wildly overshoot 
-    // (z movements kind of result in double com movements... torso lowers
-    // && we lower our weight)
-    com_err.z *= 0.5;
-
-    // get stance foot position relative to torso
-    // move stance foot opposite direction from com error
-    //stance_target->translation.x -= com_err.x;
-    stance_target->translation.y -= com_err.y;
-    //stance_target->translation.z -= com_err.z;
-
-    // also move desired com by this amount...
-    // since we moved stance leg
-    //abs_desired_com.x -= com_err.x;
-    abs_desired_com.y -= com_err.y;
-
-    // Todd: desired com z is absolute now
-    //abs_desired_com.z -= pen_err.z;
-
-    // as stance leg moves one way, we have to move the swing leg relative to
-    // the torso to match it
-    // so swing leg to stance leg distance remains the same
-    //swing_target->translation.x -= com_err.x;
-    swing_target->translation.y -= com_err.y;
-    //swing_target->translation.z -= com_err.z;
-
-    if (stance_target->translation.z < -203) stance_target->translation.z = -203;
-    if (swing_target->translation.z < -203) swing_target->translation.z = -203;
-
-    bool left_compliant  = true;//false;
-    bool right_compliant = true;//false;
-
-    // calculate tilt roll from stance leg
-    TiltRoll tr = ForwardKinematics::calculateTiltRollFromLeg(!is_left_swing, commands_->angles_, robot_info_->dimensions_);
-    tr.roll_ = roll;
-    
-    commandLegsRelativeToTorso(command_angles, left_target, right_target, tr.tilt_, tr.roll_, 0.0f, left_compliant,right_compliant);
-    setArms(command_angles);
-
-    // calculate new com based on these joint commands
-    calcCenterOfMass(command_angles, com, !is_left_swing, 0.0f);
-  } 
-  
   for (int i = 0; i < NUM_JOINTS; i++) {
     previous_commands_[i] = commands_->angles_[i];
   }
@@ -582,23 +534,3 @@ void KickModule::calcCenterOfMass(float *command_angles, Vector3<float> &center_
   ForwardKinematics::calculateCoM(command_body_model_.abs_parts_, command_body_model_.center_of_mass_, robot_info_->mass_calibration_);
   center_of_mass = command_body_model_.center_of_mass_;
 }
-
-void KickModule::commandLegsRelativeToTorso(float *command_angles, Pose3D left_target, Pose3D right_target, float /*tilt*/, float roll, float /*tilt_roll_factor*/, bool left_compliant, bool right_compliant) {
-
-  RotationMatrix rot;
-  RotationMatrix foot_rotation;
-  rot.rotateX(roll);
-  foot_rotation.rotateX(-roll);
-  if (left_compliant) {
-    left_target.translation = rot * left_target.translation;
-    left_target.rotation = left_target.rotation * foot_rotation;
-  }
-  if (right_compliant) {
-    right_target.translation = rot * right_target.translation;
-    right_target.rotation = right_target.rotation * foot_rotation;
-  }
-
-  inverse_kinematics_.calcLegJoints(left_target, right_target, command_angles, robot_info_->dimensions_);
-  command_angles[LHipYawPitch] = 0.0;
-  command_angles[RHipYawPitch] = 0.0;
-}
@@ -189,35 +189,35 @@ void BodyModel::processUpdate(Odometry *odometry, const SensorValues &sensors) {
    float forwardL, forwardR, leftL, leftR, turnLR, liftL, liftR;
    walkCycle.generateWalk(forwardL, forwardR, leftL, leftR, turnLR, liftL, liftR);
    
-   boost::numeric::ublas::matrix<float> b2f =
-      kinematics->evaluateDHChain(
+   Transform b2f =
+      kinematics->chainTransform(
          Kinematics::FOOT,
          Kinematics::BODY,
          isLeftPhase ? Kinematics::RIGHT_CHAIN : Kinematics::LEFT_CHAIN);
    
-   boost::numeric::ublas::matrix<float> b2fOther =
-      kinematics->evaluateDHChain(
+   Transform b2fOther =
+      kinematics->chainTransform(
          Kinematics::FOOT,
          Kinematics::BODY,
          isLeftPhase ? Kinematics::LEFT_CHAIN : Kinematics::RIGHT_CHAIN);
 
-   boost::numeric::ublas::matrix<float> n2f =
-      kinematics->evaluateDHChain(
+   Transform n2f =
+      kinematics->chainTransform(
          Kinematics::FOOT,
          Kinematics::NECK,
          isLeftPhase ? Kinematics::RIGHT_CHAIN : Kinematics::LEFT_CHAIN);
 
 
-   boost::numeric::ublas::matrix<float> f2w =
-                  kinematics->createFootToWorldTransform(
+   Transform f2w =
+                  kinematics->footToWorld(
          isLeftPhase ? Kinematics::RIGHT_CHAIN : Kinematics::LEFT_CHAIN);
 
-   boost::numeric::ublas::matrix<float> b2w = boost::numeric::ublas::prod(f2w, b2f);
-   boost::numeric::ublas::matrix<float> n2w = boost::numeric::ublas::prod(f2w, n2f);
-   boost::numeric::ublas::matrix<float> origin = vec4<float>(0, 0, 0, 1);
-   boost::numeric::ublas::matrix<float> result = boost::numeric::ublas::prod(b2f, origin);
-   boost::numeric::ublas::matrix<float> rPend = boost::numeric::ublas::prod(b2w, origin);
-   boost::numeric::ublas::matrix<float> neckPend = boost::numeric::ublas::prod(n2w, origin);
+   Transform b2w = f2w * b2f;
+   Transform n2w = f2w * n2f;
+   Vec4 origin(0, 0, 0, 1);
+   Vec4 result = b2f * origin;
+   Vec4 rPend = b2w * origin;
+   Vec4 neckPend = n2w * origin;
    // float deg = atan2(neckPend(0, 0) - rPend(0, 0), neckPend(2, 0) - rPend(2, 0));
 //   std::cout << neckPend(0, 0) << " : " << rPend(0, 0) << " " << neckPend(1, 0) << " " << neckPend(2, 0) << " " << RAD2DEG(deg) << std::endl;
 
@@ -229,15 +229,15 @@ void BodyModel::processUpdate(Odometry *odometry, const SensorValues &sensors) {
 
    // Calculate the centre of mass, convert to frame of reference of foot
    // (ie to foot then rotated by body lean)
-   boost::numeric::ublas::matrix<float> com = kinematics->evaluateMassChain();
-   boost::numeric::ublas::matrix<float> comOther = prod(b2fOther, com); // inserted CoM for other foot - BH
-   centreOfMassOther.x = comOther(0, 0);                                // "
-   centreOfMassOther.y = comOther(1, 0);                                // "
-   centreOfMassOther.z = comOther(2, 0);                                // "
-   com = prod(b2f, com);
-   centreOfMass.x = com(0, 0);
-   centreOfMass.y = com(1, 0);
-   centreOfMass.z = com(2, 0);
+   Vec4 com = kinematics->centreOfMass();
+   Vec4 comOther = b2fOther * com; // inserted CoM for other foot - BH
+   centreOfMassOther.x = comOther[0];                                   // "
+   centreOfMassOther.y = comOther[1];                                   // "
+   centreOfMassOther.z = comOther[2];                                   // "
+   com = b2f * com;
+   centreOfMass.x = com[0];
+   centreOfMass.y = com[1];
+   centreOfMass.z = com[2];
 
    //std::cout << "COM x: " << centreOfMass.x << " y: " << centreOfMass.y << " z: " << centreOfMass.z << std::endl;
 
@@ -262,8 +262,8 @@ void BodyModel::processUpdate(Odometry *odometry, const SensorValues &sensors) {
    //std::cout << "t: " << pendulumModel.walkCycle.t << std::endl;
    
    //observation update
-   float supportFootPosition = result(0, 0); 
-   //float h = result(2, 0);
+   float supportFootPosition = result[0]; 
+   //float h = result[2];
    //float deg = atan2(supportFootPosition - zmpFootOffset, h);
    WalkCycle currentWalkCycle = walkCycle;
    
@@ -5,6 +5,7 @@
 #include "ClippedGenerator.hpp"
 
 #include <math/Geometry.h>
+#include <common/LatencyTrace.h>
 
 // Runswift files
 #include "types/JointValues.hpp"
@@ -52,6 +53,7 @@ enum FootSensorRegion
 This would be like processFrame() function as in our code
 *---------------------------------------------------------------------------*/
 void RSWalkModule2014::processFrame() {
+	LATENCY_PROBE("walk", 0);
 
 
 	// If we are changing commands we need to reset generators
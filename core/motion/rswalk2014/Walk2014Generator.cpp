@@ -56,6 +56,14 @@ void checkNaN(float n, string s){
    }
 }
 
+static void addCorrection(LegJoints &joints, const LegJoints &correction) {
+   joints.Hp += correction.Hp;
+   joints.Kp += correction.Kp;
+   joints.Ap += correction.Ap;
+   joints.Hr += correction.Hr;
+   joints.Ar += correction.Ar;
+}
+
 Walk2014Generator::Walk2014Generator()
    :t(0.0f), z(0.0f), PI(3.1415927) {
    initialise();
@@ -542,88 +550,32 @@ JointValues Walk2014Generator::makeJoints(ActionCommand::All* request,
    updateOdometry(odometry,bodyModel.isLeftPhase);
 
    // 9. Work out joint angles from walk variables above
-   // 9.1 Left foot closed form inverse kinematics
-   float leghL = hiph - foothL - ankle;                    // vertical height between ankle and hip in meters
-   float legX0L = leghL / cos(leftL);                      // leg extension (eliminating knee) when forwardL = 0
-   float legXL = sqrt(legX0L*legX0L
-		   +(forwardL+comOffset)*(forwardL+comOffset));    //leg extension at forwardL
-
-   float beta1L = acos((thigh*thigh+legXL*legXL-tibia*tibia)/(2.0f*thigh*legXL)); // acute angle at hip in thigh-tibia triangle
-   float beta2L = acos((tibia*tibia+legXL*legXL-thigh*thigh)/(2.0f*tibia*legXL)); // acute angle at ankle in thigh-tibia triangle
-   float tempL = legX0L/legXL; if(tempL>1.0f && bodyModel.walkKickStart == false) tempL=1.0f;  // sin ratio to calculate leg extension pitch. If > 1 due to numerical error round down.
-   float deltaL = asin(tempL);                             // leg extension angle
-   float dirL = 1.0f; if ((forwardL+comOffset) > 0.0f) dirL = -1.0f; // signum of position of foot
-   float HpL = beta1L + dirL*(M_PI/2.0f-deltaL);           // Hip pitch is sum of leg-extension + hip acute angle above
-   float ApL = beta2L + dirL*(deltaL - M_PI/2.0f);         // Ankle pitch is a similar calculation for the ankle joint
-   float KpL = HpL + ApL;                                  // to keep torso upright with both feet on the ground, the knee pitch is always the sum of the hip pitch and the ankle pitch.
-
-   // 9.2 right foot closed form inverse kinematics (comments as above but for right leg)
-   float leghR = hiph - foothR - ankle;
-   float legX0R = leghR / cos(leftR);
-   float legXR = sqrt(legX0R*legX0R
-		   +(forwardR+comOffset)*(forwardR+comOffset));
-   float dirR = 1.0f; if ((forwardR+comOffset) > 0.0f) dirR = -1.0f;
-   float beta1R = acos((thigh*thigh+legXR*legXR-tibia*tibia)/(2.0f*thigh*legXR));
-   float beta2R = acos((tibia*tibia+legXR*legXR-thigh*thigh)/(2.0f*tibia*legXR));
-   float tempR = legX0R/legXR; if(tempR>1.0f && bodyModel.walkKickStart == false) tempR=1.0f;
-   float deltaR = asin(tempR);
-   float HpR = beta1R + dirR*(M_PI/2.0f-deltaR);
-   float ApR = beta2R + dirR*(deltaR - M_PI/2.0f);
-   float KpR = HpR + ApR;
- 
-   // 9.3 Sert hip and ankle values
-   float HrL = -leftL;
-   float HrR = -leftR;
-   float ArL = -HrL;
-   float ArR = -HrR;
-   if (walk2014Option == KICK) {
-      HrL += rock;
-      HrR += rock;
-      ArL -= rock;
-      ArR -= rock;
-   }
-
-   // 9.4 Adjust HpL, HrL, ApL, ArL LEFT based on Hyp turn to keep ankle in situ
-   // Turning
-   XYZ_Coord tL = mf2b(z, -HpL, HrL, KpL, -ApL, ArL, z, z, z);
-   XYZ_Coord sL;
-   float Hyp = -turnRL;
-   for (int i = 0; i < 3; i++) {
-      sL = mf2b(Hyp, -HpL, HrL, KpL, -ApL, ArL, z, z, z);
-      XYZ_Coord e((tL.x-sL.x), (tL.y-sL.y), (tL.z-sL.z));
-      Hpr hpr = hipAngles(Hyp, -HpL, HrL, KpL, -ApL, ArL, z, z, z, e);
-      HpL -= hpr.Hp;
-      HrL += hpr.Hr;
-   }
-   // ApL and ArL to make sure LEFT foot is parallel to ground
-   XYZ_Coord up = mf2b(Hyp, -HpL, HrL, KpL, -ApL, ArL, 1.0f, 0.0f, 0.0f);
-   XYZ_Coord ur = mf2b(Hyp, -HpL, HrL, KpL, -ApL, ArL, 0.0f, 1.0f, 0.0f);
-   ApL = ApL + asin(sL.z-up.z);
-   ArL = ArL + asin(sL.z-ur.z);
-
-   // 9.5 Adjust HpR, HrR, ApR, ArR (RIGHT) based on Hyp turn to keep ankle in situ
-   // Map to LEFT - we reuse the left foot IK because of symmetry right foot
-   float Hr = -HrR;
-   float Ar = -ArR;
-   // Target foot origin in body coords
-   XYZ_Coord tt = mf2b(z, -HpR, Hr, KpR, -ApR, Ar, z, z, z);
-   XYZ_Coord s;
-   Hyp = -turnRL;
-   for (int i = 0; i < 3; i++) {
-      s = mf2b(Hyp, -HpR, Hr, KpR, -ApR, Ar, z, z, z);
-      XYZ_Coord e((tt.x-s.x), (tt.y-s.y), (tt.z-s.z));
-      Hpr hpr = hipAngles(Hyp, -HpR, Hr, KpR, -ApR, Ar, z, z, z, e);
-      HpR -= hpr.Hp;
-      Hr += hpr.Hr;
-   }
-   // 9.6 Ap and Ar to make sure foot is parallel to ground
-   XYZ_Coord u1 = mf2b(Hyp, -HpR, Hr, KpR, -ApR, Ar, 1.0f, 0.0f, 0.0f);
-   XYZ_Coord u2 = mf2b(Hyp, -HpR, Hr, KpR, -ApR, Ar, 0.0f, 1.0f, 0.0f);
-   ApR = ApR + asin(s.z-u1.z);
-   Ar = Ar + asin(s.z-u2.z);
+   // 9.1 Left leg closed form inverse kinematics
+   bool clampExtension = bodyModel.walkKickStart == false;
+   float legRock = (walk2014Option == KICK) ? rock : 0;
+   LegJoints jL = legJoints(forwardL+comOffset, leftL, hiph - foothL - ankle, legRock, clampExtension);
+   // 9.2 Right leg, solved as a left leg with the coronal angles mirrored
+   LegJoints jR = legJoints(forwardR+comOffset, -leftR, hiph - foothR - ankle, -legRock, clampExtension);
+
+   // 9.3 Adjust Hp, Hr, Ap, Ar based on Hyp turn to keep ankles in situ, from the table
+   //     where it covers the legs. Kicks rock the hips and walk kicks over-extend the
+   //     legs, neither of which is tabulated, so those are always solved.
+   bool useTable = !legTable.empty() && walk2014Option != KICK && bodyModel.walkKickStart == false;
+   LegJoints correction;
+   if (useTable && legTable.lookup(forwardL+comOffset, leftL, hiph - foothL - ankle, turnRL, correction))
+      addCorrection(jL, correction);
+   else
+      turnLeg(jL, turnRL);
+   if (useTable && legTable.lookup(forwardR+comOffset, -leftR, hiph - foothR - ankle, turnRL, correction))
+      addCorrection(jR, correction);
+   else
+      turnLeg(jR, turnRL);
+
+   float HpL = jL.Hp, KpL = jL.Kp, ApL = jL.Ap, HrL = jL.Hr, ArL = jL.Ar;
+   float HpR = jR.Hp, KpR = jR.Kp, ApR = jR.Ap;
    // map back from left foot to right foot
-   HrR = -Hr;
-   ArR = -Ar;
+   float HrR = -jR.Hr;
+   float ArR = -jR.Ar;
 
    // 10. Set joint values and stiffness
    JointValues j = sensors.joints;
@@ -901,6 +853,55 @@ void Walk2014Generator::addKickJoints(JointValues &j){
    j.angles[RSJoints::RShoulderPitch] -= kneePitchR;
 }
 
+LegJoints Walk2014Generator::legJoints(float forward, float left, float legh, float rock, bool clampExtension) {
+   float legX0 = legh / cos(left);                         // leg extension (eliminating knee) when forward = 0
+   float legX = sqrt(legX0*legX0+forward*forward);         // leg extension at forward
+
+   float beta1 = acos((thigh*thigh+legX*legX-tibia*tibia)/(2.0f*thigh*legX)); // acute angle at hip in thigh-tibia triangle
+   float beta2 = acos((tibia*tibia+legX*legX-thigh*thigh)/(2.0f*tibia*legX)); // acute angle at ankle in thigh-tibia triangle
+   float temp = legX0/legX; if(temp>1.0f && clampExtension) temp=1.0f; // sin ratio to calculate leg extension pitch. If > 1 due to numerical error round down.
+   float delta = asin(temp);                               // leg extension angle
+   float dir = 1.0f; if (forward > 0.0f) dir = -1.0f;      // signum of position of foot
+
+   LegJoints result;
+   result.Hp = beta1 + dir*(M_PI/2.0f-delta);              // Hip pitch is sum of leg-extension + hip acute angle above
+   result.Ap = beta2 + dir*(delta - M_PI/2.0f);            // Ankle pitch is a similar calculation for the ankle joint
+   result.Kp = result.Hp + result.Ap;                      // to keep torso upright with both feet on the ground, the knee pitch is always the sum of the hip pitch and the ankle pitch.
+   result.Hr = -left + rock;
+   result.Ar = left - rock;
+   return result;
+}
+
+void Walk2014Generator::turnLeg(LegJoints &j, float turn) {
+   // Target foot origin in body coords
+   XYZ_Coord tt = mf2b(z, -j.Hp, j.Hr, j.Kp, -j.Ap, j.Ar, z, z, z);
+   XYZ_Coord s;
+   float Hyp = -turn;
+   for (int i = 0; i < 3; i++) {
+      s = mf2b(Hyp, -j.Hp, j.Hr, j.Kp, -j.Ap, j.Ar, z, z, z);
+      XYZ_Coord e((tt.x-s.x), (tt.y-s.y), (tt.z-s.z));
+      Hpr hpr = hipAngles(Hyp, -j.Hp, j.Hr, j.Kp, -j.Ap, j.Ar, z, z, z, e);
+      j.Hp -= hpr.Hp;
+      j.Hr += hpr.Hr;
+   }
+   // Ap and Ar to make sure foot is parallel to ground
+   XYZ_Coord u1 = mf2b(Hyp, -j.Hp, j.Hr, j.Kp, -j.Ap, j.Ar, 1.0f, 0.0f, 0.0f);
+   XYZ_Coord u2 = mf2b(Hyp, -j.Hp, j.Hr, j.Kp, -j.Ap, j.Ar, 0.0f, 1.0f, 0.0f);
+   j.Ap = j.Ap + asin(s.z-u1.z);
+   j.Ar = j.Ar + asin(s.z-u2.z);
+}
+
+void Walk2014Generator::buildLegTable() {
+   legTable.build([this](float forward, float left, float legh, float turn) {
+      LegJoints straight = legJoints(forward, left, legh);
+      LegJoints turned = straight;
+      turnLeg(turned, turn);
+      LegJoints correction = {turned.Hp - straight.Hp, turned.Kp - straight.Kp, turned.Ap - straight.Ap,
+                              turned.Hr - straight.Hr, turned.Ar - straight.Ar};
+      return correction;
+   }, thigh, tibia);
+}
+
 float Walk2014Generator::leftAngle()
 {
    float left_at_t = left*parabolicStep(t,nextFootSwitchT,0.0);
@@ -985,7 +986,12 @@ bool Walk2014Generator::isStanding() {
 }
 
 
-void Walk2014Generator::readOptions(std::string path) {} //boost::program_options::variables_map &config) {}
+void Walk2014Generator::readOptions(std::string path) { //boost::program_options::variables_map &config) {
+   std::string file = path + "/walk_table.bin";
+   if (legTable.load(file, thigh, tibia)) {
+      cout << "Walk2014Generator: leg joints from " << file << endl;
+   }
+}
 void Walk2014Generator:: reset() {
    initialise();
    //llog(INFO) << "Walk2014 reset" << endl;
@@ -11,6 +11,7 @@
 #include "types/XYZ_Coord.hpp"
 #include "types/ActionCommand.hpp"
 #include "utils/Timer.hpp"
+#include "WalkTable.hpp"
 
 
 class Walk2014Generator : Generator {
@@ -48,7 +49,27 @@ class Walk2014Generator : Generator {
 
    Walk2014Option walk2014Option;
    WalkState walkState;
+   /**
+    * Loads walk_table.bin from the config path if there is one built for these leg
+    * dimensions, which switches the leg joints to the table driven mode
+    */
    void readOptions(std::string path); //boost::program_options::variables_map& config);
+
+   /**
+    * Closed form inverse kinematics of the left leg for the foot forward of the hip
+    * (including comOffset), the left swing angle and the ankle height below the hip.
+    * The right leg is the same with left and rock negated and the rolls of the result
+    * negated.
+    */
+   LegJoints legJoints(float forward, float left, float legh, float rock = 0, bool clampExtension = true);
+   /**
+    * Adjusts Hp, Hr, Ap and Ar of a leg from legJoints iteratively to keep the ankle in
+    * place and the foot flat when the hips yaw by turn. This is most of the cost of a
+    * tick, so legTable holds the change it makes over a grid of legJoints inputs.
+    */
+   void turnLeg(LegJoints &joints, float turn);
+   void buildLegTable();                                   // tabulates turnLeg into legTable
+   WalkTable legTable;                                     // turnLeg corrections, empty unless loaded or built
    void reset();
    void stop();
    friend class WalkEnginePreProcessor;
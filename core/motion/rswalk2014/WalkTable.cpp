@@ -0,0 +1,129 @@
+/**
+ * WalkTable.cpp
+ */
+
+#include "WalkTable.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+// The correction varies slowly with the leg's position and quickly with turn
+const WalkTable::Axis WalkTable::FORWARD = {-0.05f, 0.07f, 9};
+const WalkTable::Axis WalkTable::LEFT    = {-0.3f, 0.3f, 9};
+const WalkTable::Axis WalkTable::HEIGHT  = {0.165f, 0.19f, 4};
+const WalkTable::Axis WalkTable::TURN    = {-0.5f, 0.5f, 21};
+
+static const char MAGIC[4] = {'W', 'T', '1', '4'};
+
+namespace {
+   // Written ahead of the table, so a table for another grid or leg is never used
+   struct Header {
+      char magic[4];
+      WalkTable::Axis axes[4];
+      float thigh;
+      float tibia;
+   };
+}
+
+static float gridValue(const WalkTable::Axis &axis, int i) {
+   return axis.min + (axis.max - axis.min) * i / (axis.n - 1);
+}
+
+// Cell index and fraction through the cell of value along axis, false outside the grid
+static bool locate(const WalkTable::Axis &axis, float value, int &i, float &f) {
+   float x = (value - axis.min) / (axis.max - axis.min) * (axis.n - 1);
+   if (!(x >= 0 && x <= axis.n - 1)) return false;                 // NaN fails too
+   i = std::min((int)x, axis.n - 2);
+   f = x - i;
+   return true;
+}
+
+static Header makeHeader(float thigh, float tibia) {
+   Header header;
+   memcpy(header.magic, MAGIC, sizeof(MAGIC));
+   header.axes[0] = WalkTable::FORWARD;
+   header.axes[1] = WalkTable::LEFT;
+   header.axes[2] = WalkTable::HEIGHT;
+   header.axes[3] = WalkTable::TURN;
+   header.thigh = thigh;
+   header.tibia = tibia;
+   return header;
+}
+
+void WalkTable::build(const Solver &solve, float thigh, float tibia) {
+   this->thigh = thigh;
+   this->tibia = tibia;
+   joints.resize(FORWARD.n * LEFT.n * HEIGHT.n * TURN.n);
+   int index = 0;
+   for (int f = 0; f < FORWARD.n; f++)
+      for (int l = 0; l < LEFT.n; l++)
+         for (int h = 0; h < HEIGHT.n; h++)
+            for (int t = 0; t < TURN.n; t++)
+               joints[index++] = solve(gridValue(FORWARD, f), gridValue(LEFT, l), gridValue(HEIGHT, h), gridValue(TURN, t));
+}
+
+bool WalkTable::save(const std::string &file) const {
+   std::ofstream out(file.c_str(), std::ios::binary);
+   if (!out) return false;
+   Header header = makeHeader(thigh, tibia);
+   out.write((const char*)&header, sizeof(header));
+   out.write((const char*)&joints[0], joints.size() * sizeof(LegJoints));
+   return out.good();
+}
+
+bool WalkTable::load(const std::string &file, float thigh, float tibia) {
+   clear();
+   std::ifstream in(file.c_str(), std::ios::binary);
+   if (!in) return false;
+   Header header, expected = makeHeader(thigh, tibia);
+   in.read((char*)&header, sizeof(header));
+   if (!in || memcmp(&header, &expected, sizeof(header)) != 0) return false;
+   joints.resize(FORWARD.n * LEFT.n * HEIGHT.n * TURN.n);
+   in.read((char*)&joints[0], joints.size() * sizeof(LegJoints));
+   if (!in) {
+      clear();
+      return false;
+   }
+   this->thigh = thigh;
+   this->tibia = tibia;
+   return true;
+}
+
+void WalkTable::clear() {
+   joints.clear();
+}
+
+bool WalkTable::lookup(float forward, float left, float height, float turn, LegJoints &result) const {
+   if (joints.empty()) return false;
+   int i[4];
+   float f[4];
+   if (!locate(FORWARD, forward, i[0], f[0]) || !locate(LEFT, left, i[1], f[1]) ||
+       !locate(HEIGHT, height, i[2], f[2]) || !locate(TURN, turn, i[3], f[3]))
+      return false;
+
+   const int strides[4] = {LEFT.n * HEIGHT.n * TURN.n, HEIGHT.n * TURN.n, TURN.n, 1};
+   int base = 0;
+   for (int a = 0; a < 4; a++) base += i[a] * strides[a];
+   result.Hp = result.Kp = result.Ap = result.Hr = result.Ar = 0;
+   // weight each corner of the cell by the fraction of the way towards it along every axis
+   for (int corner = 0; corner < 16; corner++) {
+      float w = 1;
+      int index = base;
+      for (int a = 0; a < 4; a++) {
+         if (corner >> a & 1) {
+            w *= f[a];
+            index += strides[a];
+         } else {
+            w *= 1 - f[a];
+         }
+      }
+      const LegJoints &p = joints[index];
+      result.Hp += w * p.Hp;
+      result.Kp += w * p.Kp;
+      result.Ap += w * p.Ap;
+      result.Hr += w * p.Hr;
+      result.Ar += w * p.Ar;
+   }
+   // a corner the leg cannot reach makes the whole cell unusable
+   return result.Hp == result.Hp;
+}
@@ -0,0 +1,60 @@
+/**
+ * WalkTable.hpp
+ * Turn corrections to the leg joints of Walk2014Generator precomputed on a grid of walk variables
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Hip pitch, knee pitch, ankle pitch, hip roll and ankle roll of one leg, in the
+ * sign convention Walk2014Generator solves the left leg in
+ */
+struct LegJoints {
+   float Hp;
+   float Kp;
+   float Ap;
+   float Hr;
+   float Ar;
+};
+
+/**
+ * The change the iterative hip yaw correction of Walk2014Generator makes to a leg's
+ * joints, tabulated over the variables a leg is commanded with: forward foot
+ * position (m), left swing angle (rad), ankle height below the hip (m) and turn
+ * (rad). The sagittal joints are still solved in closed form, the knee is too close
+ * to straight for a grid. Lookups interpolate linearly between the 16 surrounding
+ * grid points and fail outside the grid or next to a point the leg cannot reach,
+ * where the caller corrects iteratively instead.
+ */
+class WalkTable {
+   public:
+   struct Axis {
+      float min;
+      float max;
+      int n;
+   };
+   // Covers every walk step of Walk2014Generator with a margin
+   static const Axis FORWARD, LEFT, HEIGHT, TURN;
+
+   typedef std::function<LegJoints(float forward, float left, float height, float turn)> Solver;
+
+   /**
+    * Fills the table by solving every grid point. thigh and tibia are the leg
+    * dimensions the solver uses, a table is only loaded for the same ones.
+    */
+   void build(const Solver &solve, float thigh, float tibia);
+   bool save(const std::string &file) const;
+   bool load(const std::string &file, float thigh, float tibia);
+   void clear();
+
+   bool empty() const { return joints.empty(); }
+   bool lookup(float forward, float left, float height, float turn, LegJoints &result) const;
+
+   private:
+   std::vector<LegJoints> joints;
+   float thigh, tibia;
+};
@@ -56,70 +56,75 @@ static const float d11Bot = d1Bot * cos(a1Bot);
 static const float a3Bot = camera_bottom_angle - M_PI;
 
 Kinematics::Kinematics() {
-   std::vector<boost::numeric::ublas::matrix<float> > chest;
+   // Nothing loads a kinematics calibration yet, so start from zero offsets
+   parameters.cameraPitchTop = parameters.cameraYawTop = parameters.cameraRollTop = 0;
+   parameters.cameraYawBottom = parameters.cameraPitchBottom = parameters.cameraRollBottom = 0;
+   parameters.bodyPitch = 0;
+
+   std::vector<Vec4> chest;
 
    // Left side of body
-   chest.push_back(vec4<float>(-96, 100, Limbs::NeckOffsetZ - 50, 1));
-   chest.push_back(vec4<float>(-96, 155, Limbs::NeckOffsetZ - 35, 1));
-   chest.push_back(vec4<float>(-91, 155, Limbs::NeckOffsetZ - 34, 1));
-
-   chest.push_back(vec4<float>(-90, 155, Limbs::NeckOffsetZ + -30, 1));
-   chest.push_back(vec4<float>(-70, 155, Limbs::NeckOffsetZ + 0, 1));
-   chest.push_back(vec4<float>(-50, 155, Limbs::NeckOffsetZ + 30, 1));
-   chest.push_back(vec4<float>(-30, 155, Limbs::NeckOffsetZ + 30, 1));
-   chest.push_back(vec4<float>(-20, 155, Limbs::NeckOffsetZ + 34, 1));
-   chest.push_back(vec4<float>(-10, 155, Limbs::NeckOffsetZ + 37, 1));
-   chest.push_back(vec4<float>(0, 155, Limbs::NeckOffsetZ + 40, 1));
-   chest.push_back(vec4<float>(10, 155, Limbs::NeckOffsetZ + 37, 1));
-   chest.push_back(vec4<float>(20, 155, Limbs::NeckOffsetZ + 34, 1));
-   chest.push_back(vec4<float>(30, 155, Limbs::NeckOffsetZ + 30, 1));
-   chest.push_back(vec4<float>(50, 155, Limbs::NeckOffsetZ + 30, 1));
-   chest.push_back(vec4<float>(70, 155, Limbs::NeckOffsetZ + 0, 1));
-   chest.push_back(vec4<float>(90, 155, Limbs::NeckOffsetZ + -30, 1));
-
-   chest.push_back(vec4<float>(60, 70, Limbs::NeckOffsetZ - 40, 1));
+   chest.push_back(Vec4(-96, 100, Limbs::NeckOffsetZ - 50, 1));
+   chest.push_back(Vec4(-96, 155, Limbs::NeckOffsetZ - 35, 1));
+   chest.push_back(Vec4(-91, 155, Limbs::NeckOffsetZ - 34, 1));
+
+   chest.push_back(Vec4(-90, 155, Limbs::NeckOffsetZ + -30, 1));
+   chest.push_back(Vec4(-70, 155, Limbs::NeckOffsetZ + 0, 1));
+   chest.push_back(Vec4(-50, 155, Limbs::NeckOffsetZ + 30, 1));
+   chest.push_back(Vec4(-30, 155, Limbs::NeckOffsetZ + 30, 1));
+   chest.push_back(Vec4(-20, 155, Limbs::NeckOffsetZ + 34, 1));
+   chest.push_back(Vec4(-10, 155, Limbs::NeckOffsetZ + 37, 1));
+   chest.push_back(Vec4(0, 155, Limbs::NeckOffsetZ + 40, 1));
+   chest.push_back(Vec4(10, 155, Limbs::NeckOffsetZ + 37, 1));
+   chest.push_back(Vec4(20, 155, Limbs::NeckOffsetZ + 34, 1));
+   chest.push_back(Vec4(30, 155, Limbs::NeckOffsetZ + 30, 1));
+   chest.push_back(Vec4(50, 155, Limbs::NeckOffsetZ + 30, 1));
+   chest.push_back(Vec4(70, 155, Limbs::NeckOffsetZ + 0, 1));
+   chest.push_back(Vec4(90, 155, Limbs::NeckOffsetZ + -30, 1));
+
+   chest.push_back(Vec4(60, 70, Limbs::NeckOffsetZ - 40, 1));
    // bodyParts.push_back(chest);
    // chest.clear();
 
-   chest.push_back(vec4<float>(60, 60, Limbs::NeckOffsetZ - 70, 1));
-   chest.push_back(vec4<float>(62, 50, Limbs::NeckOffsetZ - 70, 1));
-   chest.push_back(vec4<float>(63, 40, Limbs::NeckOffsetZ - 70, 1));
-   chest.push_back(vec4<float>(65, 20, Limbs::NeckOffsetZ - 70, 1));
-   chest.push_back(vec4<float>(65, 10, Limbs::NeckOffsetZ - 70, 1));
-   chest.push_back(vec4<float>(65, 0, Limbs::NeckOffsetZ - 70, 1));
+   chest.push_back(Vec4(60, 60, Limbs::NeckOffsetZ - 70, 1));
+   chest.push_back(Vec4(62, 50, Limbs::NeckOffsetZ - 70, 1));
+   chest.push_back(Vec4(63, 40, Limbs::NeckOffsetZ - 70, 1));
+   chest.push_back(Vec4(65, 20, Limbs::NeckOffsetZ - 70, 1));
+   chest.push_back(Vec4(65, 10, Limbs::NeckOffsetZ - 70, 1));
+   chest.push_back(Vec4(65, 0, Limbs::NeckOffsetZ - 70, 1));
    bodyParts.push_back(chest);
    chest.clear();
 
    // reflection
-   chest.push_back(vec4<float>(65, 0, Limbs::NeckOffsetZ - 70, 1));
-   chest.push_back(vec4<float>(65, -10, Limbs::NeckOffsetZ - 70, 1));
-   chest.push_back(vec4<float>(65, -20, Limbs::NeckOffsetZ - 70, 1));
-   chest.push_back(vec4<float>(63, -40, Limbs::NeckOffsetZ - 70, 1));
-   chest.push_back(vec4<float>(62, -50, Limbs::NeckOffsetZ - 70, 1));
-   chest.push_back(vec4<float>(60, -60, Limbs::NeckOffsetZ - 70, 1));
+   chest.push_back(Vec4(65, 0, Limbs::NeckOffsetZ - 70, 1));
+   chest.push_back(Vec4(65, -10, Limbs::NeckOffsetZ - 70, 1));
+   chest.push_back(Vec4(65, -20, Limbs::NeckOffsetZ - 70, 1));
+   chest.push_back(Vec4(63, -40, Limbs::NeckOffsetZ - 70, 1));
+   chest.push_back(Vec4(62, -50, Limbs::NeckOffsetZ - 70, 1));
+   chest.push_back(Vec4(60, -60, Limbs::NeckOffsetZ - 70, 1));
    // bodyParts.push_back(chest);
    // chest.clear();
 
    // right side of body
-   chest.push_back(vec4<float>(60, -70, Limbs::NeckOffsetZ - 40, 1));
-
-   chest.push_back(vec4<float>(90, -155, Limbs::NeckOffsetZ + -30, 1));
-   chest.push_back(vec4<float>(70, -155, Limbs::NeckOffsetZ + 0, 1));
-   chest.push_back(vec4<float>(50, -155, Limbs::NeckOffsetZ + 10, 1));
-   chest.push_back(vec4<float>(30, -155, Limbs::NeckOffsetZ + 10, 1));
-   chest.push_back(vec4<float>(20, -155, Limbs::NeckOffsetZ + 14, 1));
-   chest.push_back(vec4<float>(10, -155, Limbs::NeckOffsetZ + 17, 1));
-   chest.push_back(vec4<float>(0, -155, Limbs::NeckOffsetZ + 20, 1));
-   chest.push_back(vec4<float>(-10, -155, Limbs::NeckOffsetZ + 17, 1));
-   chest.push_back(vec4<float>(-20, -155, Limbs::NeckOffsetZ + 14, 1));
-   chest.push_back(vec4<float>(-30, -155, Limbs::NeckOffsetZ + 10, 1));
-   chest.push_back(vec4<float>(-50, -155, Limbs::NeckOffsetZ + 10, 1));
-   chest.push_back(vec4<float>(-70, -155, Limbs::NeckOffsetZ + 0, 1));
-   chest.push_back(vec4<float>(-90, -155, Limbs::NeckOffsetZ + -30, 1));
-
-   chest.push_back(vec4<float>(-91, -155, Limbs::NeckOffsetZ - 34, 1));
-   chest.push_back(vec4<float>(-96, -155, Limbs::NeckOffsetZ - 35, 1));
-   chest.push_back(vec4<float>(-96, -100, Limbs::NeckOffsetZ - 50, 1));
+   chest.push_back(Vec4(60, -70, Limbs::NeckOffsetZ - 40, 1));
+
+   chest.push_back(Vec4(90, -155, Limbs::NeckOffsetZ + -30, 1));
+   chest.push_back(Vec4(70, -155, Limbs::NeckOffsetZ + 0, 1));
+   chest.push_back(Vec4(50, -155, Limbs::NeckOffsetZ + 10, 1));
+   chest.push_back(Vec4(30, -155, Limbs::NeckOffsetZ + 10, 1));
+   chest.push_back(Vec4(20, -155, Limbs::NeckOffsetZ + 14, 1));
+   chest.push_back(Vec4(10, -155, Limbs::NeckOffsetZ + 17, 1));
+   chest.push_back(Vec4(0, -155, Limbs::NeckOffsetZ + 20, 1));
+   chest.push_back(Vec4(-10, -155, Limbs::NeckOffsetZ + 17, 1));
+   chest.push_back(Vec4(-20, -155, Limbs::NeckOffsetZ + 14, 1));
+   chest.push_back(Vec4(-30, -155, Limbs::NeckOffsetZ + 10, 1));
+   chest.push_back(Vec4(-50, -155, Limbs::NeckOffsetZ + 10, 1));
+   chest.push_back(Vec4(-70, -155, Limbs::NeckOffsetZ + 0, 1));
+   chest.push_back(Vec4(-90, -155, Limbs::NeckOffsetZ + -30, 1));
+
+   chest.push_back(Vec4(-91, -155, Limbs::NeckOffsetZ - 34, 1));
+   chest.push_back(Vec4(-96, -155, Limbs::NeckOffsetZ - 35, 1));
+   chest.push_back(Vec4(-96, -100, Limbs::NeckOffsetZ - 50, 1));
    bodyParts.push_back(chest);
    chest.clear();
 
@@ -160,125 +165,98 @@ Kinematics::Kinematics() {
 
    // Same order as above, but this time for the position of the centre of mass for each joint.
    massesCom.clear();
-   massesCom.push_back(vec4(Limbs::TorsoCoM)); // Torso
-   massesCom.push_back(vec4(Limbs::NeckCoM)); // Head
-   massesCom.push_back(vec4(Limbs::HeadCoM));
-   massesCom.push_back(vec4(Limbs::RightShoulderCoM)); // R Arm
-   massesCom.push_back(vec4(Limbs::RightBicepCoM));
-   massesCom.push_back(vec4(Limbs::RightElbowCoM));
-   massesCom.push_back(vec4(Limbs::RightForearmCoM));
-   massesCom.push_back(vec4(Limbs::RightHandCoM)); 
-   massesCom.push_back(vec4(Limbs::LeftShoulderCoM)); // L Arm
-   massesCom.push_back(vec4(Limbs::LeftBicepCoM));
-   massesCom.push_back(vec4(Limbs::LeftElbowCoM));
-   massesCom.push_back(vec4(Limbs::LeftForearmCoM));
-   massesCom.push_back(vec4(Limbs::LeftHandCoM));
-   massesCom.push_back(vec4(Limbs::RightPelvisCoM)); // R Leg
-   massesCom.push_back(vec4(Limbs::RightHipCoM));
-   massesCom.push_back(vec4(Limbs::RightThighCoM));
-   massesCom.push_back(vec4(Limbs::RightTibiaCoM));
-   massesCom.push_back(vec4(Limbs::RightAnkleCoM));
-   massesCom.push_back(vec4(Limbs::RightFootCoM));
-   massesCom.push_back(vec4(Limbs::LeftPelvisCoM)); // L Leg
-   massesCom.push_back(vec4(Limbs::LeftHipCoM));
-   massesCom.push_back(vec4(Limbs::LeftThighCoM));
-   massesCom.push_back(vec4(Limbs::LeftTibiaCoM));
-   massesCom.push_back(vec4(Limbs::LeftAnkleCoM));
-   massesCom.push_back(vec4(Limbs::LeftFootCoM));
+   massesCom.push_back(Vec4(Limbs::TorsoCoM)); // Torso
+   massesCom.push_back(Vec4(Limbs::NeckCoM)); // Head
+   massesCom.push_back(Vec4(Limbs::HeadCoM));
+   massesCom.push_back(Vec4(Limbs::RightShoulderCoM)); // R Arm
+   massesCom.push_back(Vec4(Limbs::RightBicepCoM));
+   massesCom.push_back(Vec4(Limbs::RightElbowCoM));
+   massesCom.push_back(Vec4(Limbs::RightForearmCoM));
+   massesCom.push_back(Vec4(Limbs::RightHandCoM)); 
+   massesCom.push_back(Vec4(Limbs::LeftShoulderCoM)); // L Arm
+   massesCom.push_back(Vec4(Limbs::LeftBicepCoM));
+   massesCom.push_back(Vec4(Limbs::LeftElbowCoM));
+   massesCom.push_back(Vec4(Limbs::LeftForearmCoM));
+   massesCom.push_back(Vec4(Limbs::LeftHandCoM));
+   massesCom.push_back(Vec4(Limbs::RightPelvisCoM)); // R Leg
+   massesCom.push_back(Vec4(Limbs::RightHipCoM));
+   massesCom.push_back(Vec4(Limbs::RightThighCoM));
+   massesCom.push_back(Vec4(Limbs::RightTibiaCoM));
+   massesCom.push_back(Vec4(Limbs::RightAnkleCoM));
+   massesCom.push_back(Vec4(Limbs::RightFootCoM));
+   massesCom.push_back(Vec4(Limbs::LeftPelvisCoM)); // L Leg
+   massesCom.push_back(Vec4(Limbs::LeftHipCoM));
+   massesCom.push_back(Vec4(Limbs::LeftThighCoM));
+   massesCom.push_back(Vec4(Limbs::LeftTibiaCoM));
+   massesCom.push_back(Vec4(Limbs::LeftAnkleCoM));
+   massesCom.push_back(Vec4(Limbs::LeftFootCoM));
    
-   // Initialise transform matrices for DH chain
-   for (int i = 0; i < CAMERA_DH_CHAIN_LEN; ++i) {
-      transformLTop[i] = boost::numeric::ublas::identity_matrix<float>(4);
-      transformRTop[i] = boost::numeric::ublas::identity_matrix<float>(4);
-      transformLBot[i] = boost::numeric::ublas::identity_matrix<float>(4);
-      transformRBot[i] = boost::numeric::ublas::identity_matrix<float>(4);
-   }
-   for (int i = 0; i < HEAD_DH_CHAIN_LEN; ++i) {
-      transformHB[i] = boost::numeric::ublas::identity_matrix<float>(4);
-   }
-   for (int i = 0; i < ARM_DH_CHAIN_LEN; ++i) {
-      transformLAB[i] = boost::numeric::ublas::identity_matrix<float>(4);
-      transformRAB[i] = boost::numeric::ublas::identity_matrix<float>(4);
-   }
-   for (int i = 0; i < LEG_DH_CHAIN_LEN; ++i) {
-      transformLFB[i] = boost::numeric::ublas::identity_matrix<float>(4);
-      transformRFB[i] = boost::numeric::ublas::identity_matrix<float>(4);
-   }
+   totalMass = 0;
+   for (unsigned int i = 0; i < masses.size(); ++i) totalMass += masses[i];
 
    // Set up constant DH transforms since they only need to be calculated once
-   boost::numeric::ublas::matrix<float> pi2AboutX = createDHMatrix<float>(0, M_PI / 2, 0, 0);
-   boost::numeric::ublas::matrix<float> negpi2AboutX = createDHMatrix<float>(0, -M_PI / 2, 0, 0);
-   boost::numeric::ublas::matrix<float> pi4AboutX = createDHMatrix<float>(0, M_PI / 4, 0, 0);
-   boost::numeric::ublas::matrix<float> negpi2AboutXnegpi2AboutZ = createDHMatrix<float>(0, -M_PI / 2, 0, -M_PI / 2);
-   boost::numeric::ublas::matrix<float> pi2AboutXpi2AboutZ = createDHMatrix<float>(0, M_PI / 2, 0, M_PI / 2);
+   cameraPanInverseHack = Transform::dh(0, 0, d2, 0.0);
 
    // Constants in camera transforms
-   transformLTop[0] = createDHMatrix<float>(0, 0, Limbs::FootHeight, M_PI / 2);
-   transformLTop[7] = createDHMatrix<float>(0, 3 * M_PI / 4, 0, 0);
-
-   transformRTop[0] = transformLTop[0];
-   transformRTop[7] = pi4AboutX;
-
-   transformLBot[0] = transformLTop[0];
-   transformLBot[7] = transformLTop[7];
-
-   transformRBot[0] = transformRTop[0];
-   transformRBot[7] = transformRTop[7];
+   for (int foot = LEFT_CHAIN; foot <= RIGHT_CHAIN; ++foot) {
+      for (int camera = 0; camera < 2; ++camera) {
+         DHChain<CAMERA_DH_CHAIN_LEN> &chain = cameraChains[foot][camera];
+         chain.set(0, 0, 0, Limbs::FootHeight, M_PI / 2);
+         if (foot == LEFT_CHAIN) chain.set(7, 0, 3 * M_PI / 4, 0, 0);
+         else chain.set(7, 0, M_PI / 4, 0, 0);
+      }
+   }
 
    // Constants in mass transforms
-   transformHB[2] = pi2AboutX;
-
-   transformRAB[0] = createDHMatrix<float>(0, 0, Limbs::ShoulderOffsetZ, 0);
-   transformRAB[1] = createDHMatrix<float>(0, M_PI / 2, Limbs::ShoulderOffsetY, 0);
-   transformRAB[3] = pi2AboutX;
-   transformRAB[5] = createDHMatrix<float>(Limbs::UpperArmLength, M_PI / 2,
-                                           Limbs::ElbowOffsetY, M_PI / 2);
-   transformRAB[7] = negpi2AboutXnegpi2AboutZ;
-   transformRAB[8] = negpi2AboutX;
-   transformRAB[10] = createDHMatrix<float>(Limbs::LowerArmLength, M_PI / 2, 0, M_PI / 2);
-   transformRAB[12] = negpi2AboutXnegpi2AboutZ;
-   transformRAB[13] = negpi2AboutX;
-
-   transformLAB[0] = transformRAB[0];
-   transformLAB[1] = createDHMatrix<float>(0, M_PI / 2, -Limbs::ShoulderOffsetY, 0);
-   transformLAB[3] = transformRAB[3];
-   transformLAB[5] = createDHMatrix<float>(Limbs::UpperArmLength, M_PI / 2,
-                                          -Limbs::ElbowOffsetY, M_PI / 2);
-   transformLAB[7] = transformRAB[7];
-   transformLAB[8] = transformRAB[8];
-   transformLAB[10] = transformRAB[10];
-   transformLAB[12] = transformRAB[12];
-   transformLAB[13] = transformRAB[13];
-
-   transformRFB[0] = createDHMatrix<float>(0, 0, -Limbs::HipOffsetZ, 0);
-   transformRFB[1] = createDHMatrix<float>(0, M_PI / 2, Limbs::HipOffsetY, 0);
-   transformRFB[3] = pi4AboutX;
-   transformRFB[4] = createDHMatrix<float>(0, M_PI / 2, 0, -M_PI / 2);
-   transformRFB[6] = pi2AboutXpi2AboutZ;
-   transformRFB[7] = negpi2AboutX;
-   transformRFB[9] = pi2AboutX;
-   transformRFB[10] = createDHMatrix<float>(0, 0, -Limbs::ThighLength, 0);
-   transformRFB[12] = pi2AboutX;
-   transformRFB[13] = createDHMatrix<float>(0, 0, -Limbs::TibiaLength, 0);
-   transformRFB[15] = pi2AboutX;
-   transformRFB[16] = createDHMatrix<float>(0, 0, 0, -M_PI / 2);
-   transformRFB[18] = pi2AboutXpi2AboutZ;
-
-   transformLFB[0] = transformRFB[0];
-   transformLFB[1] = createDHMatrix<float>(0, M_PI / 2, -Limbs::HipOffsetY, 0);
-   transformLFB[3] = createDHMatrix<float>(0, -M_PI / 4, 0, 0);
-   transformLFB[4] = transformRFB[4];
-   transformLFB[6] = transformRFB[6];
-   transformLFB[7] = transformRFB[7];
-   transformLFB[9] = transformRFB[9];
-   transformLFB[10] = transformRFB[10];
-   transformLFB[12] = transformRFB[12];
-   transformLFB[13] = transformRFB[13];
-   transformLFB[15] = transformRFB[15];
-   transformLFB[16] = transformRFB[16];
-   transformLFB[18] = transformRFB[18];
-
-
+   headToBody.set(2, 0, M_PI / 2, 0, 0);
+
+   rightArmToBody.set(0, 0, 0, Limbs::ShoulderOffsetZ, 0);
+   rightArmToBody.set(1, 0, M_PI / 2, Limbs::ShoulderOffsetY, 0);
+   rightArmToBody.set(3, 0, M_PI / 2, 0, 0);
+   rightArmToBody.set(5, Limbs::UpperArmLength, M_PI / 2, Limbs::ElbowOffsetY, M_PI / 2);
+   rightArmToBody.set(7, 0, -M_PI / 2, 0, -M_PI / 2);
+   rightArmToBody.set(8, 0, -M_PI / 2, 0, 0);
+   rightArmToBody.set(10, Limbs::LowerArmLength, M_PI / 2, 0, M_PI / 2);
+   rightArmToBody.set(12, 0, -M_PI / 2, 0, -M_PI / 2);
+   rightArmToBody.set(13, 0, -M_PI / 2, 0, 0);
+
+   leftArmToBody.copy(0, rightArmToBody);
+   leftArmToBody.set(1, 0, M_PI / 2, -Limbs::ShoulderOffsetY, 0);
+   leftArmToBody.copy(3, rightArmToBody);
+   leftArmToBody.set(5, Limbs::UpperArmLength, M_PI / 2, -Limbs::ElbowOffsetY, M_PI / 2);
+   leftArmToBody.copy(7, rightArmToBody);
+   leftArmToBody.copy(8, rightArmToBody);
+   leftArmToBody.copy(10, rightArmToBody);
+   leftArmToBody.copy(12, rightArmToBody);
+   leftArmToBody.copy(13, rightArmToBody);
+
+   rightFootToBody.set(0, 0, 0, -Limbs::HipOffsetZ, 0);
+   rightFootToBody.set(1, 0, M_PI / 2, Limbs::HipOffsetY, 0);
+   rightFootToBody.set(3, 0, M_PI / 4, 0, 0);
+   rightFootToBody.set(4, 0, M_PI / 2, 0, -M_PI / 2);
+   rightFootToBody.set(6, 0, M_PI / 2, 0, M_PI / 2);
+   rightFootToBody.set(7, 0, -M_PI / 2, 0, 0);
+   rightFootToBody.set(9, 0, M_PI / 2, 0, 0);
+   rightFootToBody.set(10, 0, 0, -Limbs::ThighLength, 0);
+   rightFootToBody.set(12, 0, M_PI / 2, 0, 0);
+   rightFootToBody.set(13, 0, 0, -Limbs::TibiaLength, 0);
+   rightFootToBody.set(15, 0, M_PI / 2, 0, 0);
+   rightFootToBody.set(16, 0, 0, 0, -M_PI / 2);
+   rightFootToBody.set(18, 0, M_PI / 2, 0, M_PI / 2);
+
+   leftFootToBody.copy(0, rightFootToBody);
+   leftFootToBody.set(1, 0, M_PI / 2, -Limbs::HipOffsetY, 0);
+   leftFootToBody.set(3, 0, -M_PI / 4, 0, 0);
+   leftFootToBody.copy(4, rightFootToBody);
+   leftFootToBody.copy(6, rightFootToBody);
+   leftFootToBody.copy(7, rightFootToBody);
+   leftFootToBody.copy(9, rightFootToBody);
+   leftFootToBody.copy(10, rightFootToBody);
+   leftFootToBody.copy(12, rightFootToBody);
+   leftFootToBody.copy(13, rightFootToBody);
+   leftFootToBody.copy(15, rightFootToBody);
+   leftFootToBody.copy(16, rightFootToBody);
+   leftFootToBody.copy(18, rightFootToBody);
 }
 
 Kinematics::Chain
@@ -295,11 +273,13 @@ Kinematics::determineSupportChain() {
    return RIGHT_CHAIN;
 }
 
+// Only the links whose joints or calibration moved are rebuilt here, and the
+// chain products are re-evaluated lazily from the first changed link on.
 void Kinematics::updateDHChain() {
    // These are the camera offsets from kinematics calibrations
    float coffsetY, coffsetX, coffsetZ;
 
-   JointValues jointValues = sensorValues.joints;
+   const JointValues &jointValues = sensorValues.joints;
 
    // Calculate the top left camera transform
    coffsetY = DEG2RAD(parameters.cameraPitchTop);
@@ -314,23 +294,24 @@ void Kinematics::updateDHChain() {
    float KpL = jointValues.angles[RSJoints::LKneePitch];
    float ApL = jointValues.angles[RSJoints::LAnklePitch];
    float ArL = jointValues.angles[RSJoints::LAnkleRoll];
-   
-   cameraPanInverseHack = createDHMatrix<float>(0, 0, d2, 0.0);
+
+   DHChain<CAMERA_DH_CHAIN_LEN> &lTop = cameraChains[LEFT_CHAIN][0];
+   DHChain<CAMERA_DH_CHAIN_LEN> &lBot = cameraChains[LEFT_CHAIN][1];
+   DHChain<CAMERA_DH_CHAIN_LEN> &rTop = cameraChains[RIGHT_CHAIN][0];
+   DHChain<CAMERA_DH_CHAIN_LEN> &rBot = cameraChains[RIGHT_CHAIN][1];
+
    // DH parameters
-   // Some of these are commented out since they're constant and can be calculated
-   // once at the start
-   //transformLTop[0] = createDHMatrix<float>(0, 0, Limbs::FootHeight, M_PI / 2);
-   transformLTop[1] = createDHMatrix<float>(0, M_PI / 2, 0, M_PI / 2 - ArL);
-   transformLTop[2] = createDHMatrix<float>(0, M_PI / 2, 0, -ApL);
-   transformLTop[3] = createDHMatrix<float>(Limbs::TibiaLength, 0, 0, -KpL);
-   transformLTop[4] = createDHMatrix<float>(Limbs::ThighLength, 0, 0, -HpL);
-   transformLTop[5] = createDHMatrix<float>(0, -M_PI / 2, 0, -M_PI / 4 - HrL);
-   transformLTop[6] = createDHMatrix<float>(0, M_PI / 2, -d3, M_PI / 2 - Hyp);
-   // transformLTop[7] = createDHMatrix<float>(0, 3 * M_PI / 4, 0, 0);
-   transformLTop[8] = createDHMatrix<float>(0, 0, d2, Cy);
-   transformLTop[9] = createDHMatrix<float>(0, -M_PI / 2, 0, a3Top + Cp);
-   transformLTop[10] = createDHMatrix<float>(0, -M_PI/2, l10Top, M_PI / 2 + coffsetX);
-   transformLTop[11] = createDHMatrix<float>(0, -M_PI/2 + coffsetY, d11Top, coffsetZ);
+   // Links 0 and 7 are constant and set up in the constructor
+   lTop.set(1, 0, M_PI / 2, 0, M_PI / 2 - ArL);
+   lTop.set(2, 0, M_PI / 2, 0, -ApL);
+   lTop.set(3, Limbs::TibiaLength, 0, 0, -KpL);
+   lTop.set(4, Limbs::ThighLength, 0, 0, -HpL);
+   lTop.set(5, 0, -M_PI / 2, 0, -M_PI / 4 - HrL);
+   lTop.set(6, 0, M_PI / 2, -d3, M_PI / 2 - Hyp);
+   lTop.set(8, 0, 0, d2, Cy);
+   lTop.set(9, 0, -M_PI / 2, 0, a3Top + Cp);
+   lTop.set(10, 0, -M_PI/2, l10Top, M_PI / 2 + coffsetX);
+   lTop.set(11, 0, -M_PI/2 + coffsetY, d11Top, coffsetZ);
 
    // Calculate the top right camera transform
    float HpR = jointValues.angles[RSJoints::RHipPitch];
@@ -339,83 +320,46 @@ void Kinematics::updateDHChain() {
    float ApR = jointValues.angles[RSJoints::RAnklePitch];
    float ArR = jointValues.angles[RSJoints::RAnkleRoll];
 
-   // DH parameters
-   // Some of these are commented out since they're constant and can be calculated once
-   // Just leaving them here so they can be seen in order
-   //transformRTop[0] = transformLTop[0];
-   transformRTop[1] = createDHMatrix<float>(0, M_PI / 2, 0, M_PI / 2 - ArR);
-   transformRTop[2] = createDHMatrix<float>(0, M_PI / 2, 0, -ApR);
-   transformRTop[3] = createDHMatrix<float>(Limbs::TibiaLength, 0, 0, -KpR);
-   transformRTop[4] = createDHMatrix<float>(Limbs::ThighLength, 0, 0, -HpR);
-   transformRTop[5] = createDHMatrix<float>(0, -M_PI / 2, 0, M_PI / 4 - HrR);
-   transformRTop[6] = createDHMatrix<float>(0, M_PI / 2, d3, M_PI / 2 - Hyp);
-   //transformRTop[7] = createDHMatrix<float>(0, M_PI / 4, 0, 0);
-   transformRTop[8] = transformLTop[8];
-   transformRTop[9] = transformLTop[9]; 
-   transformRTop[10] = transformLTop[10];
-   transformRTop[11] = transformLTop[11];
+   rTop.set(1, 0, M_PI / 2, 0, M_PI / 2 - ArR);
+   rTop.set(2, 0, M_PI / 2, 0, -ApR);
+   rTop.set(3, Limbs::TibiaLength, 0, 0, -KpR);
+   rTop.set(4, Limbs::ThighLength, 0, 0, -HpR);
+   rTop.set(5, 0, -M_PI / 2, 0, M_PI / 4 - HrR);
+   rTop.set(6, 0, M_PI / 2, d3, M_PI / 2 - Hyp);
+   for (int i = 8; i < CAMERA_DH_CHAIN_LEN; ++i) rTop.copy(i, lTop);
 
    // Calculate the bottom left camera transform
    coffsetY = DEG2RAD(parameters.cameraPitchBottom);
    coffsetX = DEG2RAD(parameters.cameraYawBottom);
    coffsetZ = DEG2RAD(parameters.cameraRollBottom);
 
-   //transformLBot[0] = transformLTop[0];
-   transformLBot[1] = transformLTop[1];
-   transformLBot[2] = transformLTop[2];
-   transformLBot[3] = transformLTop[3];
-   transformLBot[4] = transformLTop[4];
-   transformLBot[5] = transformLTop[5];
-   transformLBot[6] = transformLTop[6];
-   //transformLBot[7] = transformLTop[7];
-   transformLBot[8] = transformLTop[8];
-   transformLBot[9] = createDHMatrix<float>(0, -M_PI / 2, 0, a3Bot + Cp);
-   transformLBot[10] = createDHMatrix<float>(0, -M_PI/2, l10Bot, M_PI / 2 + coffsetX);
-   transformLBot[11] = createDHMatrix<float>(0, -M_PI/2 + coffsetY, d11Bot, coffsetZ);
+   for (int i = 1; i <= 6; ++i) lBot.copy(i, lTop);
+   lBot.copy(8, lTop);
+   lBot.set(9, 0, -M_PI / 2, 0, a3Bot + Cp);
+   lBot.set(10, 0, -M_PI/2, l10Bot, M_PI / 2 + coffsetX);
+   lBot.set(11, 0, -M_PI/2 + coffsetY, d11Bot, coffsetZ);
 
    // Calculate the bottom right transform
-   //transformRBot[0] = transformRTop[0];
-   transformRBot[1] = transformRTop[1];
-   transformRBot[2] = transformRTop[2];
-   transformRBot[3] = transformRTop[3];
-   transformRBot[4] = transformRTop[4];
-   transformRBot[5] = transformRTop[5];
-   transformRBot[6] = transformRTop[6];
-   //transformRBot[7] = transformRTop[7];
-   transformRBot[8] = transformRTop[8];
-   transformRBot[9] = transformLBot[9];
-   transformRBot[10] = transformLBot[10];
-   transformRBot[11] = transformLBot[11];
+   for (int i = 1; i <= 6; ++i) rBot.copy(i, rTop);
+   rBot.copy(8, rTop);
+   for (int i = 9; i < CAMERA_DH_CHAIN_LEN; ++i) rBot.copy(i, lBot);
 
    // Transform parameters for centre of mass
    // Head to Body
-   transformHB[0] = createDHMatrix<float>(0, 0, Limbs::NeckOffsetZ, Cy);
-   transformHB[1] = createDHMatrix<float>(0, -M_PI / 2, 0, Cp);
-   //transformHB[2] = createDHMatrix<float>(0, M_PI / 2, 0, 0);
+   headToBody.set(0, 0, 0, Limbs::NeckOffsetZ, Cy);
+   headToBody.set(1, 0, -M_PI / 2, 0, Cp);
 
-   // Right Arm to Body 
-   // Some of these are commented out since they're constant and can be calculated once
-   // Just leaving them here so they can be seen in order
+   // Right Arm to Body
    float Sp = jointValues.angles[RSJoints::RShoulderPitch];
    float Sr = jointValues.angles[RSJoints::RShoulderRoll];
    float Ey = jointValues.angles[RSJoints::RElbowYaw];
    float Er = jointValues.angles[RSJoints::RElbowRoll];
    float Wy = jointValues.angles[RSJoints::RWristYaw];
-   //transformRAB[0] = createDHMatrix<float>(0, 0, Limbs::ShoulderOffsetZ, 0);
-   //transformRAB[1] = createDHMatrix<float>(0, M_PI / 2, Limbs::ShoulderOffsetY, 0);
-   transformRAB[2] = createDHMatrix<float>(0, -M_PI, 0, Sp);
-   //transformRAB[3] = createDHMatrix<float>(0, M_PI / 2, 0, 0);
-   transformRAB[4] = createDHMatrix<float>(0, 0, 0, Sr);
-   //transformRAB[5] = createDHMatrix<float>(Limbs::UpperArmLength, M_PI / 2,
-   //                                        Limbs::ElbowOffsetY, M_PI / 2);
-   transformRAB[6] = createDHMatrix<float>(0, M_PI / 2, 0, Ey);
-   //transformRAB[7] = createDHMatrix<float>(0, -M_PI / 2, 0, -M_PI / 2);
-   //transformRAB[8] = createDHMatrix<float>(0, -M_PI / 2, 0, 0);
-   transformRAB[9] = createDHMatrix<float>(0, 0, 0, Er);
-   //transformRAB[10] = createDHMatrix<float>(Limbs::LowerArmLength, M_PI / 2, 0, M_PI / 2);
-   transformRAB[11] = createDHMatrix<float>(0, M_PI / 2, 0, Wy);
-   //transformRAB[12] = createDHMatrix<float>(0, -M_PI / 2, 0, -M_PI / 2);
-   //transformRAB[13] = createDHMatrix<float>(0, -M_PI / 2, 0, 0);
+   rightArmToBody.set(2, 0, -M_PI, 0, Sp);
+   rightArmToBody.set(4, 0, 0, 0, Sr);
+   rightArmToBody.set(6, 0, M_PI / 2, 0, Ey);
+   rightArmToBody.set(9, 0, 0, 0, Er);
+   rightArmToBody.set(11, 0, M_PI / 2, 0, Wy);
 
    // Left Arm to Body
    Sp = jointValues.angles[RSJoints::LShoulderPitch];
@@ -423,307 +367,170 @@ void Kinematics::updateDHChain() {
    Ey = jointValues.angles[RSJoints::LElbowYaw];
    Er = jointValues.angles[RSJoints::LElbowRoll];
    Wy = jointValues.angles[RSJoints::LWristYaw];
-   //transformLAB[0] = transformRAB[0];
-   //transformLAB[1] = createDHMatrix<float>(0, M_PI / 2, -Limbs::ShoulderOffsetY, 0);
-   transformLAB[2] = createDHMatrix<float>(0, -M_PI, 0, Sp);
-   //transformLAB[3] = transformRAB[3];
-   transformLAB[4] = createDHMatrix<float>(0, 0, 0, Sr);
-   //transformRAB[5] = createDHMatrix<float>(Limbs::UpperArmLength, M_PI / 2,
-   //                                       -Limbs::ElbowOffsetY, M_PI / 2);
-   transformLAB[6] = createDHMatrix<float>(0, M_PI / 2, 0, Ey);
-   //transformLAB[7] = transformRAB[7];
-   //transformLAB[8] = transformRAB[8]; 
-   transformLAB[9] = createDHMatrix<float>(0, 0, 0, Er);
-   //transformLAB[10] = transformRAB[10];
-   transformLAB[11] = createDHMatrix<float>(0, M_PI / 2, 0, Wy);
-   //transformLAB[12] = transformRAB[12];
-   //transformLAB[13] = transformRAB[13];
+   leftArmToBody.set(2, 0, -M_PI, 0, Sp);
+   leftArmToBody.set(4, 0, 0, 0, Sr);
+   leftArmToBody.set(6, 0, M_PI / 2, 0, Ey);
+   leftArmToBody.set(9, 0, 0, 0, Er);
+   leftArmToBody.set(11, 0, M_PI / 2, 0, Wy);
 
    // Right Foot to Body
-   HpR = jointValues.angles[RSJoints::RHipPitch];
-   HrR = jointValues.angles[RSJoints::RHipRoll];
-   //transformRFB[0] = createDHMatrix<float>(0, 0, -Limbs::HipOffsetZ, 0);
-   //transformRFB[1] = createDHMatrix<float>(0, M_PI / 2, Limbs::HipOffsetY, 0);
-   transformRFB[2] = createDHMatrix<float>(0, -3 * M_PI / 4, 0, Hyp);
-   //transformRFB[3] = createDHMatrix<float>(0, M_PI / 4, 0, 0);
-   //transformRFB[4] = createDHMatrix<float>(0, M_PI / 2, 0, -M_PI / 2);
-   transformRFB[5] = createDHMatrix<float>(0, -M_PI / 2, 0, HrR);
-   //transformRFB[6] = createDHMatrix<float>(0, M_PI / 2, 0, M_PI / 2);
-   //transformRFB[7] = createDHMatrix<float>(0, -M_PI / 2, 0, 0);
-   transformRFB[8] = createDHMatrix<float>(0, -M_PI / 2, 0, HpR);
-   //transformRFB[9] = createDHMatrix<float>(0, M_PI / 2, 0, 0);
-   //transformRFB[10] = createDHMatrix<float>(0, 0, -Limbs::ThighLength, 0);
-   transformRFB[11] = createDHMatrix<float>(0, -M_PI / 2, 0, KpR);
-   //transformRFB[12] = createDHMatrix<float>(0, M_PI / 2, 0, 0);
-   //transformRFB[13] = createDHMatrix<float>(0, 0, -Limbs::TibiaLength, 0);
-   transformRFB[14] = createDHMatrix<float>(0, -M_PI / 2, 0, ApR);
-   //transformRFB[15] = createDHMatrix<float>(0, M_PI / 2, 0, 0);
-   //transformRFB[16] = createDHMatrix<float>(0, 0, 0, -M_PI / 2);
-   transformRFB[17] = createDHMatrix<float>(0, -M_PI / 2, 0, ArR);
-   //transformRFB[18] = createDHMatrix<float>(0, M_PI / 2, 0, M_PI / 2);
-
-   // Left Foot to Body 
-   HpL = jointValues.angles[RSJoints::LHipPitch];
-   HrL = jointValues.angles[RSJoints::LHipRoll];
-   //transformLFB[0] = transformRFB[0];
-   //transformLFB[1] = createDHMatrix<float>(0, M_PI / 2, -Limbs::HipOffsetY, 0);
-   transformLFB[2] = createDHMatrix<float>(0, -M_PI / 4, 0, -Hyp);
-   //transformLFB[3] = createDHMatrix<float>(0, -M_PI / 4, 0, 0);
-   //transformLFB[4] = transformRFB[4];
-   transformLFB[5] = createDHMatrix<float>(0, -M_PI / 2, 0, HrL);
-   //transformLFB[6] = transformRFB[6];
-   //transformLFB[7] = transformRFB[7];
-   transformLFB[8] = createDHMatrix<float>(0, -M_PI / 2, 0, HpL);
-   //transformLFB[9] = transformRFB[9];
-   //transformLFB[10] = transformRFB[10];
-   transformLFB[11] = createDHMatrix<float>(0, -M_PI / 2, 0, KpL);
-   //transformLFB[12] = transformRFB[12];
-   //transformLFB[13] = transformRFB[13];
-   transformLFB[14] = createDHMatrix<float>(0, -M_PI / 2, 0, ApL);
-   //transformLFB[15] = transformRFB[15];
-   //transformLFB[16] = transformRFB[16];
-   transformLFB[17] = createDHMatrix<float>(0, -M_PI / 2, 0, ArL);
-   //transformLFB[18] = transformRFB[18];
+   rightFootToBody.set(2, 0, -3 * M_PI / 4, 0, Hyp);
+   rightFootToBody.set(5, 0, -M_PI / 2, 0, HrR);
+   rightFootToBody.set(8, 0, -M_PI / 2, 0, HpR);
+   rightFootToBody.set(11, 0, -M_PI / 2, 0, KpR);
+   rightFootToBody.set(14, 0, -M_PI / 2, 0, ApR);
+   rightFootToBody.set(17, 0, -M_PI / 2, 0, ArR);
+
+   // Left Foot to Body
+   leftFootToBody.set(2, 0, -M_PI / 4, 0, -Hyp);
+   leftFootToBody.set(5, 0, -M_PI / 2, 0, HrL);
+   leftFootToBody.set(8, 0, -M_PI / 2, 0, HpL);
+   leftFootToBody.set(11, 0, -M_PI / 2, 0, KpL);
+   leftFootToBody.set(14, 0, -M_PI / 2, 0, ApL);
+   leftFootToBody.set(17, 0, -M_PI / 2, 0, ArL);
 }
 
 Pose Kinematics::getPose() {
    Chain foot = determineSupportChain();
 
-   boost::numeric::ublas::matrix<float> c2wTop = createCameraToWorldTransform(foot, true);
-   boost::numeric::ublas::matrix<float> c2wBot = createCameraToWorldTransform(foot, false);
-   boost::numeric::ublas::matrix<float> n2w = createNeckToWorldTransform(foot);
-   std::pair<int, int> horizon = calculateHorizon(c2wTop);
-   Pose pose(c2wTop, c2wBot, n2w, horizon);
-
-   boost::numeric::ublas::matrix<float> b2cTop =
-      evaluateDHChain(BODY, CAMERA, foot, true);
-   determineBodyExclusionArray(b2cTop, pose.getTopExclusionArray(), true);
+   Transform c2wTop = cameraToWorld(foot, true);
+   Transform c2wBot = cameraToWorld(foot, false);
+   Transform n2w = neckToWorld(foot);
+   Pose pose(c2wTop.toMatrix(), c2wBot.toMatrix(), n2w.toMatrix(), horizon(c2wTop));
 
-   boost::numeric::ublas::matrix<float> b2cBot =
-      evaluateDHChain(BODY, CAMERA, foot, false);
-   determineBodyExclusionArray(b2cBot, pose.getBotExclusionArray(), false);
+   bodyExclusionArray(chainTransform(BODY, CAMERA, foot, true),
+                      pose.getTopExclusionArray(), true);
+   bodyExclusionArray(chainTransform(BODY, CAMERA, foot, false),
+                      pose.getBotExclusionArray(), false);
 
    return pose;
 }
 
 boost::numeric::ublas::matrix<float>
 Kinematics::createCameraToWorldTransform(Chain foot, bool top) {
-   boost::numeric::ublas::matrix<float> c2f = createCameraToFootTransform(foot,top);
-   boost::numeric::ublas::matrix<float> f2w = createFootToWorldTransform(foot,top);
-   return prod(f2w, c2f);
+   return cameraToWorld(foot, top).toMatrix();
+}
+
+Transform Kinematics::cameraToWorld(Chain foot, bool top) {
+   return footToWorld(foot, top) * cameraToFoot(foot, top);
 }
 
 boost::numeric::ublas::matrix<float>
 Kinematics::createNeckToWorldTransform(Chain foot) {
-   boost::numeric::ublas::matrix<float> n2f = createNeckToFootTransform(foot);
-   boost::numeric::ublas::matrix<float> f2w = createFootToWorldTransform(foot);
-   return prod(f2w, n2f);
+   return neckToWorld(foot).toMatrix();
+}
+
+Transform Kinematics::neckToWorld(Chain foot) {
+   Transform n2f = leanedBodyToFoot(foot, true) * cameraPanInverseHack;
+   return footToWorld(foot) * n2f;
 }
 
 boost::numeric::ublas::matrix<float>
 Kinematics::evaluateDHChain(Link from, Link to, Chain foot, bool top) {
-   boost::numeric::ublas::matrix<float> finalTransform =
-      boost::numeric::ublas::identity_matrix<float>(4);
-   if (foot == RIGHT_CHAIN) {
-      if (top) {
-         for (int i = from; i < to; i++) {
-            finalTransform = boost::numeric::ublas::prod(finalTransform,
-                                                         transformRTop[i]);
-         }
-      } else {
-         for (int i = from; i < to; i++) {
-            finalTransform = boost::numeric::ublas::prod(finalTransform,
-                                                         transformRBot[i]);
-         }
-      } 
-   } else {
-      if (top) {
-         for (int i = from; i < to; i++) {
-            finalTransform =
-               boost::numeric::ublas::prod(finalTransform, transformLTop[i]);
-         }
-      } else {
-         for (int i = from; i < to; i++) {
-            finalTransform =
-               boost::numeric::ublas::prod(finalTransform, transformLBot[i]);
-         }
-      }
+   return chainTransform(from, to, foot, top).toMatrix();
+}
+
+Transform Kinematics::chainTransform(Link from, Link to, Chain foot, bool top) {
+   return cameraChain(foot, top).between(from, to);
+}
+
+template <int LEN>
+void Kinematics::addMasses(DHChain<LEN> &chain, const int *links, int numLinks,
+                           int &joint, Vec4 &com) {
+   for (int i = 0; i < numLinks; ++i, ++joint) {
+      Vec4 p = chain.upTo(links[i] + 1) * massesCom[joint];
+      for (int k = 0; k < 4; ++k) com[k] += p[k] * masses[joint];
    }
-   return finalTransform;
 }
 
 // Evaluate kinematics chain from all limbs back to the IMU, taking into account the COM at each part.
 boost::numeric::ublas::matrix<float>
-Kinematics::evaluateMassChain() {   
-   int i, joint = 0;
-   float totalMass = 0;
-   boost::numeric::ublas::matrix<float> finalTransform(4, 1);
-   finalTransform = boost::numeric::ublas::zero_matrix<float>(4, 1);
-
-   // Mass of torso
-   finalTransform += massesCom[joint] * masses[joint]; 
-   totalMass += masses[joint];
-   ++joint;
+Kinematics::evaluateMassChain() {
+   return centreOfMass().toMatrix();
+}
 
-   // Mass of head
-   boost::numeric::ublas::matrix<float> headTransform = boost::numeric::ublas::identity_matrix<float>(4);
-   for (i = 0; i < HEAD_DH_CHAIN_LEN; ++i) {
-      headTransform = boost::numeric::ublas::prod(headTransform, transformHB[i]); 
-      // Up to head yaw, head pitch
-      if (i == 0 || i == 2) {
-         finalTransform += boost::numeric::ublas::prod(headTransform, massesCom[joint]) * masses[joint]; 
-         totalMass += masses[joint];
-         ++joint;
-      }
-   }
+Vec4 Kinematics::centreOfMass() {
+   // Links after which each joint's mass is attached
+   // Up to head yaw, head pitch
+   static const int headLinks[] = {0, 2};
+   // Up to shoulder pitch, shoulder roll, elbow yaw, elbow roll, wrist yaw
+   static const int armLinks[] = {3, 4, 8, 9, 13};
+   // Up to hip yaw pitch, hip roll, hip pitch, knee pitch, ankle pitch, ankle roll
+   static const int legLinks[] = {3, 7, 9, 12, 15, 18};
 
-   // Mass of right arm 
-   boost::numeric::ublas::matrix<float> rArmTransform = boost::numeric::ublas::identity_matrix<float>(4);
-   for (i = 0; i < ARM_DH_CHAIN_LEN; ++i) { 
-      rArmTransform = boost::numeric::ublas::prod(rArmTransform, transformRAB[i]);
-      // Up to shoulder pitch, shoulder roll, elbow yaw, elbow roll, wrist yaw
-      if (i == 3 || i == 4 || i == 8 || i == 9 || i == 13) {
-         finalTransform += boost::numeric::ublas::prod(rArmTransform, massesCom[joint]) * masses[joint]; 
-         totalMass += masses[joint];
-         ++joint;
-      }
-   }
+   int joint = 0;
+   Vec4 com;
 
-   // Mass of left arm
-   boost::numeric::ublas::matrix<float> lArmTransform = boost::numeric::ublas::identity_matrix<float>(4);
-   for (i = 0; i < ARM_DH_CHAIN_LEN; ++i) {
-      // Up to shoulder pitch, shoulder roll, elbow yaw, elbow roll, wrist yaw
-      lArmTransform = boost::numeric::ublas::prod(lArmTransform, transformLAB[i]);
-      if (i == 3 || i == 4 || i == 8 || i == 9 || i == 13) {
-         finalTransform += boost::numeric::ublas::prod(lArmTransform, massesCom[joint]) * masses[joint]; 
-         totalMass += masses[joint];
-         ++joint;
-      }
-   }
-
-   // Mass of right leg 
-   boost::numeric::ublas::matrix<float> rLegTransform = boost::numeric::ublas::identity_matrix<float>(4);
-   for (i = 0; i < LEG_DH_CHAIN_LEN; ++i) { 
-      rLegTransform = boost::numeric::ublas::prod(rLegTransform, transformRFB[i]);
-      // Up to hip yaw pitch, hip roll, hip pitch, knee pitch, ankle pitch, ankle roll
-      if (i == 3 || i == 7 || i == 9 || i == 12 || i == 15 || i == 18) {
-         finalTransform += boost::numeric::ublas::prod(rLegTransform, massesCom[joint]) * masses[joint]; 
-         totalMass += masses[joint];
-         ++joint;
-      }
-   }
+   // Mass of torso
+   for (int k = 0; k < 4; ++k) com[k] += massesCom[joint][k] * masses[joint];
+   ++joint;
 
-   // Mass of left leg 
-   boost::numeric::ublas::matrix<float> lLegTransform = boost::numeric::ublas::identity_matrix<float>(4);
-   for (i = 0; i < LEG_DH_CHAIN_LEN; ++i) { 
-      lLegTransform = boost::numeric::ublas::prod(lLegTransform, transformLFB[i]);
-      // Up to hip yaw pitch, hip roll, hip pitch, knee pitch, ankle pitch, ankle roll
-      if (i == 3 || i == 7 || i == 9 || i == 12 || i == 15 || i == 18) {
-         finalTransform += boost::numeric::ublas::prod(lLegTransform, massesCom[joint]) * masses[joint]; 
-         totalMass += masses[joint];
-         ++joint;
-      }
-   }
+   addMasses(headToBody, headLinks, 2, joint, com);
+   addMasses(rightArmToBody, armLinks, 5, joint, com);
+   addMasses(leftArmToBody, armLinks, 5, joint, com);
+   addMasses(rightFootToBody, legLinks, 6, joint, com);
+   addMasses(leftFootToBody, legLinks, 6, joint, com);
 
-   return finalTransform / totalMass;
+   for (int k = 0; k < 4; ++k) com[k] /= totalMass;
+   return com;
 }
 
-boost::numeric::ublas::matrix<float>
-Kinematics::createCameraToFootTransform(Chain foot, bool top) {
-   boost::numeric::ublas::matrix<float> b2f = evaluateDHChain(FOOT, BODY, foot, top);
+Transform Kinematics::leanedBodyToFoot(Chain foot, bool top) {
    // When we get to the torso, we need to adjust the transform by the forward and side lean to account
    // for when the robot's feet are not flat on the ground. We apply the the rotation of the lean to the
    // hip vector to account for the lean already introduced by the leg joints.
    // We also adjust by the body pitch offset from kinematics calibration.
-   boost::numeric::ublas::matrix<float> z(4, 1);
-   z(0, 0) = 0;
-   z(1, 0) = 0;
-   z(2, 0) = 0;
-   z(3, 0) = 1;
-   boost::numeric::ublas::matrix<float> hipPt = prod(b2f, z);
+   Vec4 hipPt = chainTransform(FOOT, BODY, foot, top).origin();
    float bodyPitchOffset = DEG2RAD(parameters.bodyPitch);
    float forwardLean = sensorValues.sensors[RSSensors::InertialSensor_AngleY];
    float sideLean = sensorValues.sensors[RSSensors::InertialSensor_AngleX];
 
-   boost::numeric::ublas::matrix<float> transform = createDHMatrix<float>(hipPt(0, 0), 0, 0, 0);
-   transform = prod(transform, createDHMatrix<float>(0, 0, hipPt(2, 0), M_PI / 2)); // move up by hip height
-   transform = prod(transform, createDHMatrix<float>(hipPt(1, 0), 0, 0, 0)); // move sideways
-   transform = prod(transform, createDHMatrix<float>(0, forwardLean + bodyPitchOffset, 0, -M_PI / 2));
-   transform = prod(transform, createDHMatrix<float>(0, sideLean, 0, 0));
-   
-   return prod(transform, evaluateDHChain(BODY, CAMERA, foot, top));
+   Transform transform = Transform::dh(hipPt[0], 0, 0, 0);
+   transform = transform * Transform::dh(0, 0, hipPt[2], M_PI / 2); // move up by hip height
+   transform = transform * Transform::dh(hipPt[1], 0, 0, 0); // move sideways
+   transform = transform * Transform::dh(0, forwardLean + bodyPitchOffset, 0, -M_PI / 2);
+   transform = transform * Transform::dh(0, sideLean, 0, 0);
+   return transform;
 }
 
 boost::numeric::ublas::matrix<float>
-Kinematics::createNeckToFootTransform(Chain foot) {
-   boost::numeric::ublas::matrix<float> b2f = evaluateDHChain(FOOT, BODY, foot);
-   // When we get to the torso, we need to adjust the transform by the forward and side lean to account
-   // for when the robot's feet are not flat on the ground. We apply the the rotation of the lean to the
-   // hip vector to account for the lean already introduced by the leg joints.
-   // We also adjust by the body pitch offset from kinematics calibration.
-   boost::numeric::ublas::matrix<float> z(4, 1);
-   z(0, 0) = 0;
-   z(1, 0) = 0;
-   z(2, 0) = 0;
-   z(3, 0) = 1;
-   boost::numeric::ublas::matrix<float> hipPt = prod(b2f, z);
-   float bodyPitchOffset = DEG2RAD(parameters.bodyPitch);
-   float forwardLean = sensorValues.sensors[RSSensors::InertialSensor_AngleY];
-   float sideLean = sensorValues.sensors[RSSensors::InertialSensor_AngleX];
+Kinematics::createCameraToFootTransform(Chain foot, bool top) {
+   return cameraToFoot(foot, top).toMatrix();
+}
 
-   boost::numeric::ublas::matrix<float> transform = createDHMatrix<float>(hipPt(0, 0), 0, 0, 0);
-   transform = prod(transform, createDHMatrix<float>(0, 0, hipPt(2, 0), M_PI / 2)); // move up by hip height
-   transform = prod(transform, createDHMatrix<float>(hipPt(1, 0), 0, 0, 0)); // move sideways
-   transform = prod(transform, createDHMatrix<float>(0, forwardLean + bodyPitchOffset, 0, -M_PI / 2));
-   transform = prod(transform, createDHMatrix<float>(0, sideLean, 0, 0));
+Transform Kinematics::cameraToFoot(Chain foot, bool top) {
+   return leanedBodyToFoot(foot, top) * chainTransform(BODY, CAMERA, foot, top);
+}
 
-   return prod(transform, cameraPanInverseHack);
+boost::numeric::ublas::matrix<float>
+Kinematics::createNeckToFootTransform(Chain foot) {
+   return (leanedBodyToFoot(foot, true) * cameraPanInverseHack).toMatrix();
 }
 
 // World is defined as the centre of the two feet on the ground plane,
 // with a heading equal to the average of the two feet directions
 boost::numeric::ublas::matrix<float>
 Kinematics::createFootToWorldTransform(Chain foot, bool top) {
-   boost::numeric::ublas::matrix<float> b2lf =
-      evaluateDHChain(FOOT, BODY, foot, top);
-   boost::numeric::ublas::matrix<float> b2rf =
-      evaluateDHChain(FOOT, BODY, (Chain) !foot, top);
-
-   boost::numeric::ublas::matrix<float> rf2b(4, 4);
-   invertMatrix(b2rf, rf2b);
-
-   boost::numeric::ublas::matrix<float> rf2lf(4, 4);
-   rf2lf = prod(rf2b, b2lf);
-
-   boost::numeric::ublas::matrix<float> z(4, 1);
-   z(0, 0) = 0;
-   z(1, 0) = 0;
-   z(2, 0) = 0;
-   z(3, 0) = 1;
-   boost::numeric::ublas::matrix<float> forward(4, 1);
-   forward(0, 0) = 1;
-   forward(1, 0) = 0;
-   forward(2, 0) = 0;
-   forward(3, 0) = 1;
+   return footToWorld(foot, top).toMatrix();
+}
+
+Transform Kinematics::footToWorld(Chain foot, bool top) {
+   const Transform &b2lf = chainTransform(FOOT, BODY, foot, top);
+   const Transform &b2rf = chainTransform(FOOT, BODY, (Chain) !foot, top);
+
+   Transform rf2b;
+   b2rf.invert(rf2b);
+   Transform rf2lf = rf2b * b2lf;
 
    // first find position of centre of two feet on the ground.
-   z = prod(rf2lf, z);
+   Vec4 z = rf2lf * Vec4(0, 0, 0, 1);
 
    // find direction of second foot in first foot coords
-   forward = prod(rf2lf, forward) - z;
-
-   boost::numeric::ublas::matrix<float> position = -z / 2;
-   position(3, 0) = 1;
-   position(2, 0) = 0;  // on the ground
-
-   boost::numeric::ublas::matrix<float> result =
-      boost::numeric::ublas::identity_matrix<float>(4);
-   result = prod(translateMatrix<float>(position(0, 0), position(1, 0), 0),
-                 result);
-   // result = prod(rotateZMatrix<float>(-atan2(forward(1, 0), forward(0, 0))/2.0),
-   //                            result);
-   result = prod(rotateZMatrix<float>(-atan2f(forward(1, 0), forward(0, 0)) / 2.0),
-                                      result);
+   Vec4 forward = rf2lf * Vec4(1, 0, 0, 1);
+   for (int k = 0; k < 4; ++k) forward[k] -= z[k];
+
+   Transform result = Transform::translation(-z[0] / 2, -z[1] / 2, 0);
+   result = Transform::rotationZ(-atan2f(forward[1], forward[0]) / 2.0) * result;
    return result;
 }
 
@@ -734,24 +541,27 @@ void Kinematics::setSensorValues(SensorValues sensorValues) {
 boost::numeric::ublas::matrix<float>
 Kinematics::createWorldToFOVTransform(
    const boost::numeric::ublas::matrix<float> &c2w) {
-   boost::numeric::ublas::matrix<float> w2c = c2w;
+   return worldToFOV(Transform::fromMatrix(c2w)).toMatrix();
+}
 
-   invertMatrix(c2w, w2c);
+Transform Kinematics::worldToFOV(const Transform &c2w) {
+   Transform w2c = c2w;
+   c2w.invert(w2c);
 
    float ex = 0;
    float ey = 0;
    float ez = 1.0 / tan(IMAGE_HFOV / 2);
 
-   boost::numeric::ublas::matrix<float> projection = projectionMatrix(ex, ey, ez);
-   boost::numeric::ublas::matrix<float> transform =
-      boost::numeric::ublas::prod(projection, w2c);
-
-   return transform;
+   return Transform::projection(ex, ey, ez) * w2c;
 }
 
 void Kinematics::determineBodyExclusionArray(
    const boost::numeric::ublas::matrix<float> &m,
    int16_t *points, bool top) {
+   bodyExclusionArray(Transform::fromMatrix(m), points, top);
+}
+
+void Kinematics::bodyExclusionArray(const Transform &b2c, int16_t *points, bool top) {
 
    const int COLS = (top) ? TOP_IMAGE_COLS : BOT_IMAGE_COLS;
 
@@ -760,33 +570,22 @@ void Kinematics::determineBodyExclusionArray(
       if (!top) points[i] += BOT_IMAGE_ROWS;
    }
    // pixel off screen really low
-   boost::numeric::ublas::matrix<float> transform
-      = createWorldToFOVTransform(m);
+   Transform transform = worldToFOV(b2c);
 
    for (unsigned int part = 0; part < bodyParts.size(); part++) {
-      boost::numeric::ublas::matrix<float> last =
-         fovToImageSpaceTransform(transform,
-                                  bodyParts[part][0],
-                                  top);
+      Vec4 last = fovToImageSpace(transform, bodyParts[part][0], top);
       for (unsigned int i = 0; i < bodyParts[part].size(); i++) {
-         boost::numeric::ublas::matrix<float> m
-            = fovToImageSpaceTransform(transform,
-                                       bodyParts[part][i],
-                                       top);
-         if (m(2, 0) <= 0) {
+         Vec4 m = fovToImageSpace(transform, bodyParts[part][i], top);
+         if (m[2] <= 0) {
             last = m;
             continue;
          }
-         // llog(VERBOSE) << "Pixel " << i << ": " << m << std::endl;
-         // llog(VERBOSE) << "Coord " << i << ": " <<
-         //            prod(transform, bodyParts[part][i]) << std::endl;
-         int lIndex = (int)(last(0, 0) / COLS *
+         int lIndex = (int)(last[0] / COLS *
                             Pose::EXCLUSION_RESOLUTION);
-         int cIndex = (int)(m(0, 0) / COLS *
+         int cIndex = (int)(m[0] / COLS *
                             Pose::EXCLUSION_RESOLUTION);
-         int lPixel = last(1, 0);
-         int cPixel = m(1, 0);
-         // int range = ABS(cIndex - lIndex);
+         int lPixel = last[1];
+         int cPixel = m[1];
          float gradient = 0;
          if (cIndex - lIndex != 0) {
             float denom = cIndex - lIndex;
@@ -795,10 +594,10 @@ void Kinematics::determineBodyExclusionArray(
          cIndex = MIN(MAX(cIndex, 0), (int) Pose::EXCLUSION_RESOLUTION);
          lIndex = MIN(MAX(lIndex, 0), (int) Pose::EXCLUSION_RESOLUTION);
          int index = lIndex;
-         while (index != cIndex && last(2, 0) > 0) {
+         while (index != cIndex && last[2] > 0) {
             if (index >= 0 && index < Pose::EXCLUSION_RESOLUTION &&
                 index != cIndex) {
-               int nPixel = last(1, 0) + gradient * (index - lIndex);
+               int nPixel = last[1] + gradient * (index - lIndex);
                if (nPixel < points[index]) points[index] = nPixel;
             }
             index += (cIndex - lIndex) > 0 ? 1 : -1;
@@ -806,11 +605,11 @@ void Kinematics::determineBodyExclusionArray(
 
          // get Index of last.
          // keep adding one and linearly interpolate
-         index = (int)(m(0, 0) / COLS *
+         index = (int)(m[0] / COLS *
                        Pose::EXCLUSION_RESOLUTION);
          if (index >= 0 && index < Pose::EXCLUSION_RESOLUTION) {
-            if (m(1, 0) < points[index]) {
-               points[index] = m(1, 0);
+            if (m[1] < points[index]) {
+               points[index] = m[1];
             }
          }
          last = m;
@@ -820,31 +619,31 @@ void Kinematics::determineBodyExclusionArray(
 
 std::pair<int, int> Kinematics::calculateHorizon(
    const boost::numeric::ublas::matrix<float> &c2w) {
-   boost::numeric::ublas::matrix<float> transform = createWorldToFOVTransform(c2w);
+   return horizon(Transform::fromMatrix(c2w));
+}
+
+std::pair<int, int> Kinematics::horizon(const Transform &c2w) {
+   Transform transform = worldToFOV(c2w);
 
    // set up horizon points in world coordinates.
    // the idea is to now convert these points into camera space and then
    // project them onto pixels to find out where the horizon is
    // Note: the -1000 and 1000 are completely arbitrary...
    // Assume horizon is in the top image, not bottom
-   boost::numeric::ublas::matrix<float> pixel1 = vec4<float>(-1000, INT_MAX,
-                                                     0, 1);
-   boost::numeric::ublas::matrix<float> pixel2 = vec4<float>(1000, INT_MAX,
-                                                     0, 1);
-
-   pixel1 = fovToImageSpaceTransform(transform, pixel1, true);
-   pixel2 = fovToImageSpaceTransform(transform, pixel2, true);
+   Vec4 pixel1 = fovToImageSpace(transform, Vec4(-1000, INT_MAX, 0, 1), true);
+   Vec4 pixel2 = fovToImageSpace(transform, Vec4(1000, INT_MAX, 0, 1), true);
 
    // find gradient of the horizon
-   boost::numeric::ublas::matrix<float> dir = pixel1 - pixel2;
+   float dirX = pixel1[0] - pixel2[0];
+   float dirY = pixel1[1] - pixel2[1];
 
    // we now convert the horizon to a nice format that vision can use.
    // it is just the two y intercepts at x = 0 and x = IMAGE_COLS
-   float lambda1 = -pixel1(0, 0) / dir(0, 0);
-   float lambda2 = (TOP_IMAGE_COLS - pixel1(0, 0)) / dir(0, 0);
+   float lambda1 = -pixel1[0] / dirX;
+   float lambda2 = (TOP_IMAGE_COLS - pixel1[0]) / dirX;
 
-   float y1 = lambda1 * dir(1, 0) + pixel1(1, 0);
-   float y2 = lambda2 * dir(1, 0) + pixel1(1, 0);
+   float y1 = lambda1 * dirY + pixel1[1];
+   float y2 = lambda2 * dirY + pixel1[1];
 
    return std::pair<int, int>(y1, y2);
 }
@@ -853,20 +652,24 @@ boost::numeric::ublas::matrix<float>
 Kinematics::fovToImageSpaceTransform(
    const boost::numeric::ublas::matrix<float> &transform,
    const boost::numeric::ublas::matrix<float> &point, bool top) {
+   return fovToImageSpace(Transform::fromMatrix(transform),
+                          Vec4::fromMatrix(point), top).toMatrix();
+}
+
+Vec4 Kinematics::fovToImageSpace(const Transform &transform, const Vec4 &point, bool top) {
 
    // Constants
    const int COLS = (top) ? TOP_IMAGE_COLS : BOT_IMAGE_COLS;
    const int ROWS = (top) ? TOP_IMAGE_ROWS : BOT_IMAGE_ROWS;
 
    // use image space transform to find the perspective scaling factor
-   boost::numeric::ublas::matrix<float> pixel =
-      boost::numeric::ublas::prod(transform, point);
+   Vec4 pixel = transform * point;
 
    // divide x and y by the perspective scaling factor
-   pixel(0, 0) /= pixel(3, 0);
-   pixel(1, 0) /= pixel(3, 0);
-   pixel(2, 0) = pixel(3, 0);
-   pixel(3, 0) = 1;
+   pixel[0] /= pixel[3];
+   pixel[1] /= pixel[3];
+   pixel[2] = pixel[3];
+   pixel[3] = 1;
 
    // now we have the pixel in a space that spans from (-1, 1) in the x
    // direction and (-1, 1) in the y.
@@ -875,9 +678,8 @@ Kinematics::fovToImageSpaceTransform(
    // the code below does
    float xscale = COLS / 2;
    float yscale = ROWS / 2;
-   pixel(0, 0) = (pixel(0, 0)) * xscale + xscale;
-   pixel(1, 0) = (pixel(1, 0)) * xscale + yscale;
+   pixel[0] = (pixel[0]) * xscale + xscale;
+   pixel[1] = (pixel[1]) * xscale + yscale;
    return pixel;
 }
 
-
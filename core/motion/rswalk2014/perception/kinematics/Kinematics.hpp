@@ -9,6 +9,7 @@
 
 #include <perception/kinematics/Parameters.hpp>
 #include <perception/kinematics/Pose.hpp>
+#include <perception/kinematics/Transform.hpp>
 #include <perception/vision/RSCamera.hpp>
 
 #include <utils/matrix_helpers.hpp>
@@ -90,33 +91,57 @@ class Kinematics {
 
       std::pair<int, int> calculateHorizon(
          const boost::numeric::ublas::matrix<float> &m);
+
+      /* Fixed size versions of evaluateDHChain, createFootToWorldTransform and
+       * evaluateMassChain for code that runs every motion tick. The ublas
+       * versions above are wrappers around these.
+       */
+      Transform chainTransform(Link from, Link to, Chain foot, bool top = true);
+      Transform footToWorld(Chain foot, bool top = true);
+      Vec4 centreOfMass();
    private:
+      DHChain<CAMERA_DH_CHAIN_LEN> &cameraChain(Chain foot, bool top) {
+         return cameraChains[foot][top ? 0 : 1];
+      }
+
+      /* Body to foot, corrected for the body's lean and calibrated pitch */
+      Transform leanedBodyToFoot(Chain foot, bool top);
+      Transform cameraToFoot(Chain foot, bool top);
+      Transform cameraToWorld(Chain foot, bool top);
+      Transform neckToWorld(Chain foot);
+      Transform worldToFOV(const Transform &c2w);
+      Vec4 fovToImageSpace(const Transform &transform, const Vec4 &point, bool top);
+      void bodyExclusionArray(const Transform &b2c, int16_t *points, bool top);
+      std::pair<int, int> horizon(const Transform &c2w);
+
+      template <int LEN>
+      void addMasses(DHChain<LEN> &chain, const int *links, int numLinks,
+                     int &joint, Vec4 &com);
+
       // CKF is not really tuned and not being used at the moment
       //CKF ckf;
       SensorValues sensorValues;
       Chain supportChain;
 
-      boost::numeric::ublas::matrix<float> transformLTop[CAMERA_DH_CHAIN_LEN];
-      boost::numeric::ublas::matrix<float> transformLBot[CAMERA_DH_CHAIN_LEN];
-      boost::numeric::ublas::matrix<float> transformRTop[CAMERA_DH_CHAIN_LEN];
-      boost::numeric::ublas::matrix<float> transformRBot[CAMERA_DH_CHAIN_LEN];
-      
-      boost::numeric::ublas::matrix<float> cameraPanInverseHack;
+      // Foot to camera chains, indexed by [Chain][top ? 0 : 1]
+      DHChain<CAMERA_DH_CHAIN_LEN> cameraChains[2][2];
+
+      Transform cameraPanInverseHack;
 
-      // DH matrices for mass
-      boost::numeric::ublas::matrix<float> transformHB[HEAD_DH_CHAIN_LEN];
-      boost::numeric::ublas::matrix<float> transformRAB[ARM_DH_CHAIN_LEN];
-      boost::numeric::ublas::matrix<float> transformLAB[ARM_DH_CHAIN_LEN];
-      boost::numeric::ublas::matrix<float> transformRFB[LEG_DH_CHAIN_LEN];
-      boost::numeric::ublas::matrix<float> transformLFB[LEG_DH_CHAIN_LEN];
+      // DH chains for mass
+      DHChain<HEAD_DH_CHAIN_LEN> headToBody;
+      DHChain<ARM_DH_CHAIN_LEN> rightArmToBody;
+      DHChain<ARM_DH_CHAIN_LEN> leftArmToBody;
+      DHChain<LEG_DH_CHAIN_LEN> rightFootToBody;
+      DHChain<LEG_DH_CHAIN_LEN> leftFootToBody;
 
       // Contains the masses and centre position of each joint
       std::vector<float> masses;
-      std::vector<boost::numeric::ublas::matrix<float> > massesCom;
+      std::vector<Vec4> massesCom;
+      float totalMass;
 
       Parameters<float> parameters;
 
-      std::vector<std::vector<boost::numeric::ublas::matrix<float> > >
-      bodyParts;
+      std::vector<std::vector<Vec4> > bodyParts;
 };
 
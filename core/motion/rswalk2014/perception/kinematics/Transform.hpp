@@ -0,0 +1,270 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+#include <boost/numeric/ublas/matrix.hpp>
+
+/* A homogeneous point (x, y, z, w) held inline */
+struct Vec4 {
+   float v[4];
+
+   Vec4() {
+      v[0] = v[1] = v[2] = v[3] = 0;
+   }
+
+   Vec4(float x, float y, float z, float w) {
+      v[0] = x;
+      v[1] = y;
+      v[2] = z;
+      v[3] = w;
+   }
+
+   explicit Vec4(const float a[]) {
+      for (int i = 0; i < 4; ++i) v[i] = a[i];
+   }
+
+   inline float &operator[](int i) { return v[i]; }
+   inline float operator[](int i) const { return v[i]; }
+
+   /* Converts to the 4x1 ublas matrix the rest of the walk passes around */
+   boost::numeric::ublas::matrix<float> toMatrix() const {
+      boost::numeric::ublas::matrix<float> m(4, 1);
+      for (int i = 0; i < 4; ++i) m(i, 0) = v[i];
+      return m;
+   }
+
+   static Vec4 fromMatrix(const boost::numeric::ublas::matrix<float> &m) {
+      return Vec4(m(0, 0), m(1, 0), m(2, 0), m(3, 0));
+   }
+};
+
+/* A 4x4 homogeneous transform held inline, so evaluating a chain of them
+ * never touches the heap. Every operation does its arithmetic in the same
+ * order as the ublas helpers in utils/matrix_helpers.hpp, so results match
+ * the ublas versions.
+ */
+struct Transform {
+   float m[4][4];
+
+   static Transform identity() {
+      Transform t;
+      for (int i = 0; i < 4; ++i)
+         for (int j = 0; j < 4; ++j)
+            t.m[i][j] = (i == j) ? 1 : 0;
+      return t;
+   }
+
+   /* Same as createDHMatrix */
+   static Transform dh(float a, float alpha, float d, float theta) {
+      Transform t;
+      t.m[0][0] = cos(theta);
+      t.m[0][1] = -sin(theta);
+      t.m[0][2] = 0;
+      t.m[0][3] = a;
+
+      t.m[1][0] = sin(theta) * cos(alpha);
+      t.m[1][1] = cos(theta) * cos(alpha);
+      t.m[1][2] = -sin(alpha);
+      t.m[1][3] = -sin(alpha) * d;
+
+      t.m[2][0] = sin(theta) * sin(alpha);
+      t.m[2][1] = cos(theta) * sin(alpha);
+      t.m[2][2] = cos(alpha);
+      t.m[2][3] = cos(alpha) * d;
+
+      t.m[3][0] = 0;
+      t.m[3][1] = 0;
+      t.m[3][2] = 0;
+      t.m[3][3] = 1;
+      return t;
+   }
+
+   /* Same as translateMatrix */
+   static Transform translation(float x, float y, float z) {
+      Transform t = identity();
+      t.m[0][3] = x;
+      t.m[1][3] = y;
+      t.m[2][3] = z;
+      return t;
+   }
+
+   /* Same as rotateZMatrix */
+   static Transform rotationZ(float theta) {
+      Transform t = identity();
+      t.m[0][0] = cos(theta);
+      t.m[0][1] = -sin(theta);
+      t.m[1][0] = sin(theta);
+      t.m[1][1] = cos(theta);
+      return t;
+   }
+
+   /* Same as projectionMatrix */
+   static Transform projection(float ex, float ey, float ez) {
+      Transform t = identity();
+      t.m[0][3] = -ex;
+      t.m[1][3] = -ey;
+      t.m[3][2] = 1.0 / ez;
+      t.m[3][3] = 0;
+      return t;
+   }
+
+   Transform operator*(const Transform &b) const {
+      Transform t;
+      for (int i = 0; i < 4; ++i) {
+         for (int j = 0; j < 4; ++j) {
+            float sum = 0;
+            for (int k = 0; k < 4; ++k) sum += m[i][k] * b.m[k][j];
+            t.m[i][j] = sum;
+         }
+      }
+      return t;
+   }
+
+   Vec4 operator*(const Vec4 &p) const {
+      Vec4 r;
+      for (int i = 0; i < 4; ++i) {
+         float sum = 0;
+         for (int k = 0; k < 4; ++k) sum += m[i][k] * p.v[k];
+         r.v[i] = sum;
+      }
+      return r;
+   }
+
+   /* The translation column, i.e. where this transform takes the origin */
+   Vec4 origin() const {
+      return Vec4(m[0][3], m[1][3], m[2][3], m[3][3]);
+   }
+
+   /* Same as invertMatrix. Returns false, leaving inv unscaled, when the
+    * transform is singular.
+    */
+   bool invert(Transform &inv) const {
+      const float *a = &m[0][0];
+      float *r = &inv.m[0][0];
+      r[0] =   a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15]
+             + a[9] * a[7] * a[14] + a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+      r[4] =  -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15]
+             - a[8] * a[7] * a[14] - a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+      r[8] =   a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15]
+             + a[8] * a[7] * a[13] + a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+      r[12] = -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14]
+             - a[8] * a[6] * a[13] - a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+      r[1] =  -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15]
+             - a[9] * a[3] * a[14] - a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+      r[5] =   a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15]
+             + a[8] * a[3] * a[14] + a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+      r[9] =  -a[0] * a[9] * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15]
+             - a[8] * a[3] * a[13] - a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+      r[13] =  a[0] * a[9] * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14]
+             + a[8] * a[2] * a[13] + a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+      r[2] =   a[1] * a[6] * a[15] - a[1] * a[7] * a[14] - a[5] * a[2] * a[15]
+             + a[5] * a[3] * a[14] + a[13] * a[2] * a[7] - a[13] * a[3] * a[6];
+      r[6] =  -a[0] * a[6] * a[15] + a[0] * a[7] * a[14] + a[4] * a[2] * a[15]
+             - a[4] * a[3] * a[14] - a[12] * a[2] * a[7] + a[12] * a[3] * a[6];
+      r[10] =  a[0] * a[5] * a[15] - a[0] * a[7] * a[13] - a[4] * a[1] * a[15]
+             + a[4] * a[3] * a[13] + a[12] * a[1] * a[7] - a[12] * a[3] * a[5];
+      r[14] = -a[0] * a[5] * a[14] + a[0] * a[6] * a[13] + a[4] * a[1] * a[14]
+             - a[4] * a[2] * a[13] - a[12] * a[1] * a[6] + a[12] * a[2] * a[5];
+      r[3] =  -a[1] * a[6] * a[11] + a[1] * a[7] * a[10] + a[5] * a[2] * a[11]
+             - a[5] * a[3] * a[10] - a[9] * a[2] * a[7] + a[9] * a[3] * a[6];
+      r[7] =   a[0] * a[6] * a[11] - a[0] * a[7] * a[10] - a[4] * a[2] * a[11]
+             + a[4] * a[3] * a[10] + a[8] * a[2] * a[7] - a[8] * a[3] * a[6];
+      r[11] = -a[0] * a[5] * a[11] + a[0] * a[7] * a[9] + a[4] * a[1] * a[11]
+             - a[4] * a[3] * a[9] - a[8] * a[1] * a[7] + a[8] * a[3] * a[5];
+      r[15] =  a[0] * a[5] * a[10] - a[0] * a[6] * a[9] - a[4] * a[1] * a[10]
+             + a[4] * a[2] * a[9] + a[8] * a[1] * a[6] - a[8] * a[2] * a[5];
+
+      float det = a[0] * r[0] + a[1] * r[4] + a[2] * r[8] + a[3] * r[12];
+      if (det == 0)
+         return false;
+
+      det = 1.0 / det;
+      for (int i = 0; i < 16; i++)
+         r[i] = r[i] * det;
+      return true;
+   }
+
+   boost::numeric::ublas::matrix<float> toMatrix() const {
+      boost::numeric::ublas::matrix<float> r(4, 4);
+      for (int i = 0; i < 4; ++i)
+         for (int j = 0; j < 4; ++j)
+            r(i, j) = m[i][j];
+      return r;
+   }
+
+   static Transform fromMatrix(const boost::numeric::ublas::matrix<float> &a) {
+      Transform t;
+      for (int i = 0; i < 4; ++i)
+         for (int j = 0; j < 4; ++j)
+            t.m[i][j] = a(i, j);
+      return t;
+   }
+};
+
+/* A chain of LEN DH links that keeps the products of every prefix of the
+ * chain. Setting a link to the parameters it already has is free, and
+ * changing one only invalidates the prefix products from that link on, so
+ * a joint change re-evaluates just the links downstream of it.
+ */
+template <int LEN>
+class DHChain {
+   public:
+      DHChain() : evaluated(0) {
+         for (int i = 0; i < LEN; ++i) {
+            links[i] = Transform::identity();
+            // NaN never compares equal, so the first set always builds the link
+            for (int j = 0; j < 4; ++j)
+               params[i][j] = std::numeric_limits<float>::quiet_NaN();
+         }
+         partial[0] = Transform::identity();
+      }
+
+      void set(int i, float a, float alpha, float d, float theta) {
+         float *p = params[i];
+         if (p[0] == a && p[1] == alpha && p[2] == d && p[3] == theta) return;
+         p[0] = a;
+         p[1] = alpha;
+         p[2] = d;
+         p[3] = theta;
+         links[i] = Transform::dh(a, alpha, d, theta);
+         if (i < evaluated) evaluated = i;
+      }
+
+      /* Takes link i from another chain with the same link there */
+      template <int OTHER_LEN>
+      void copy(int i, const DHChain<OTHER_LEN> &other) {
+         const float *p = other.params[i];
+         if (params[i][0] == p[0] && params[i][1] == p[1] &&
+             params[i][2] == p[2] && params[i][3] == p[3]) return;
+         for (int j = 0; j < 4; ++j) params[i][j] = p[j];
+         links[i] = other.links[i];
+         if (i < evaluated) evaluated = i;
+      }
+
+      inline const Transform &link(int i) const { return links[i]; }
+
+      /* links[0] * ... * links[n - 1] */
+      const Transform &upTo(int n) {
+         for (; evaluated < n; ++evaluated)
+            partial[evaluated + 1] = partial[evaluated] * links[evaluated];
+         return partial[n];
+      }
+
+      /* links[from] * ... * links[to - 1] */
+      Transform between(int from, int to) {
+         if (from == 0) return upTo(to);
+         Transform t = Transform::identity();
+         for (int i = from; i < to; ++i) t = t * links[i];
+         return t;
+      }
+
+   private:
+      template <int> friend class DHChain;
+
+      Transform links[LEN];
+      float params[LEN][4];
+      // partial[i] is the product of the first i links, valid up to evaluated
+      Transform partial[LEN + 1];
+      int evaluated;
+};
@@ -32,6 +32,7 @@ SET(RSWALK_SRCS
    DeadGenerator.cpp
    DistributedGenerator.cpp
    Walk2014Generator.cpp
+   WalkTable.cpp
    WalkCycle.cpp
    PendulumModel.cpp
    WalkEnginePreProcessor.cpp
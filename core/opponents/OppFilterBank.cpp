@@ -0,0 +1,351 @@
+#include "OppFilterBank.h"
+#include <algorithm>
+
+static const int N = OppFilterBank::MAX_FILTERS;
+static const int STATES = OppFilterBank::STATES;
+static const int SIGMA_POINTS = OppFilterBank::SIGMA_POINTS;
+
+// Alpha of a track when it is spawned
+static const float SPAWN_ALPHA = 0.5;
+// Keeps the square root of a covariance that has lost precision real
+static const float MIN_VARIANCE = 1e-6;
+
+OppObservation OppObservation::fromRelative(float distance, float bearing, float selfX, float selfY, float selfOrientation,
+    float selfSdX, float selfSdY, float selfSdOrientation,
+    float distanceErrorOffset, float distanceErrorRelative, float bearingError) {
+  float c = cosf(bearing + selfOrientation), s = sinf(bearing + selfOrientation);
+  float rangeVar = distanceErrorOffset + distanceErrorRelative * distance * distance;
+  // bearing and orientation errors both move the detection across the line of sight
+  float crossVar = distance * distance * (bearingError + selfSdOrientation * selfSdOrientation);
+
+  OppObservation obs;
+  obs.x = selfX + distance * c;
+  obs.y = selfY + distance * s;
+  obs.Rxx = c * c * rangeVar + s * s * crossVar + selfSdX * selfSdX;
+  obs.Rxy = c * s * (rangeVar - crossVar);
+  obs.Ryy = s * s * rangeVar + c * c * crossVar + selfSdY * selfSdY;
+  return obs;
+}
+
+OppFilterBank::OppFilterBank() {
+  SmallUKF4Params ukf = { 1, 0.975, 15, 4, 6.3, 150, 100, 10 };
+  OppTrackerParams tracker = { 4, 0.97, 0.05, 150 };
+  setParams(ukf, tracker);
+  for(int i = 0; i < STATES; i++)
+    for(int j = 0; j < STATES; j++)
+      for(int k = 0; k < N; k++)
+        L_[i][j][k] = 0;
+  clear();
+}
+
+void OppFilterBank::setParams(const SmallUKF4Params& ukf, const OppTrackerParams& tracker) {
+  ukfParams_ = ukf;
+  params_ = tracker;
+  weight0_ = 1.0f / (STATES + 1);
+  weight_ = 1.0f / (2 * (STATES + 1));
+}
+
+void OppFilterBank::clear() {
+  nextId_ = 0;
+  for(int i = 0; i < N; i++)
+    kill(i);
+}
+
+void OppFilterBank::kill(int i) {
+  active_[i] = false;
+  alpha_[i] = -1;
+  id_[i] = -1;
+  frameObserved_[i] = -1;
+  // an idle lane keeps a well conditioned covariance so the bank wide steps stay finite
+  for(int s = 0; s < STATES; s++) {
+    X_[s][i] = 0;
+    for(int t = 0; t < STATES; t++)
+      P_[s][t][i] = s == t;
+  }
+}
+
+void OppFilterBank::spawn(int i, const OppObservation& obs, int frame) {
+  kill(i);
+  active_[i] = true;
+  alpha_[i] = SPAWN_ALPHA;
+  id_[i] = nextId_++;
+  frameObserved_[i] = frame;
+  X_[0][i] = obs.x;
+  X_[1][i] = obs.y;
+  P_[0][0][i] = obs.Rxx;
+  P_[0][1][i] = P_[1][0][i] = obs.Rxy;
+  P_[1][1][i] = obs.Ryy;
+  P_[2][2][i] = P_[3][3][i] = ukfParams_.init_sd_vel * ukfParams_.init_sd_vel;
+}
+
+int OppFilterBank::activeCount() const {
+  int count = 0;
+  for(int i = 0; i < N; i++)
+    count += active_[i];
+  return count;
+}
+
+float OppFilterBank::sd(int i, int state) const {
+  return sqrtf(P_[state][state][i]);
+}
+
+void OppFilterBank::processFrame(float timePassed, const OppObservation* observations, int count, int frame) {
+  timeUpdate(timePassed);
+  measurementUpdate(observations, count, frame);
+  mergeTracks();
+  pruneTracks();
+}
+
+// The loops below run over every lane of the bank with the lane innermost, so each
+// one is a fixed number of independent operations on contiguous arrays.
+
+void OppFilterBank::timeUpdate(float timePassed) {
+  float decay = ukfParams_.vel_decay_rate;
+  for(int k = 0; k < N; k++) {
+    X_[0][k] += X_[2][k] * timePassed;
+    X_[1][k] += X_[3][k] * timePassed;
+    X_[2][k] *= decay;
+    X_[3][k] *= decay;
+  }
+
+  // P = A P A' + Q, with A the UKF4 update uncertainties, done as the rows of A P
+  // followed by its columns times A'
+  float T[STATES][STATES][N];
+  for(int j = 0; j < STATES; j++) {
+    for(int k = 0; k < N; k++) {
+      T[0][j][k] = P_[0][j][k] + timePassed * P_[2][j][k];
+      T[1][j][k] = P_[1][j][k] + timePassed * P_[3][j][k];
+      T[2][j][k] = decay * P_[2][j][k];
+      T[3][j][k] = decay * P_[3][j][k];
+    }
+  }
+  for(int i = 0; i < STATES; i++) {
+    for(int k = 0; k < N; k++) {
+      P_[i][0][k] = T[i][0][k] + timePassed * T[i][2][k];
+      P_[i][1][k] = T[i][1][k] + timePassed * T[i][3][k];
+      P_[i][2][k] = decay * T[i][2][k];
+      P_[i][3][k] = decay * T[i][3][k];
+    }
+  }
+  float posNoise = ukfParams_.robot_pos_noise * ukfParams_.robot_pos_noise;
+  float velNoise = ukfParams_.robot_vel_noise * ukfParams_.robot_vel_noise;
+  for(int k = 0; k < N; k++) {
+    P_[0][0][k] += posNoise;
+    P_[1][1][k] += posNoise;
+    P_[2][2][k] += velNoise;
+    P_[3][3][k] += velNoise;
+  }
+}
+
+void OppFilterBank::predictMeasurements() {
+  // Cholesky factor of every covariance, a column at a time
+  for(int j = 0; j < STATES; j++) {
+    float d[N];
+    for(int k = 0; k < N; k++)
+      d[k] = P_[j][j][k];
+    for(int m = 0; m < j; m++)
+      for(int k = 0; k < N; k++)
+        d[k] -= L_[j][m][k] * L_[j][m][k];
+    for(int k = 0; k < N; k++)
+      L_[j][j][k] = sqrtf(std::max(d[k], MIN_VARIANCE));
+    for(int i = j + 1; i < STATES; i++) {
+      float s[N];
+      for(int k = 0; k < N; k++)
+        s[k] = P_[i][j][k];
+      for(int m = 0; m < j; m++)
+        for(int k = 0; k < N; k++)
+          s[k] -= L_[i][m][k] * L_[j][m][k];
+      for(int k = 0; k < N; k++)
+        L_[i][j][k] = s[k] / L_[j][j][k];
+    }
+  }
+
+  // Sigma points spread sqrt(n + kappa) along each column, as in UKF4::opponentDetection
+  float spread = sqrtf(STATES + ukfParams_.kappa);
+  for(int s = 0; s < STATES; s++)
+    for(int k = 0; k < N; k++)
+      sigma_[0][s][k] = X_[s][k];
+  for(int c = 0; c < STATES; c++) {
+    for(int s = 0; s < STATES; s++) {
+      for(int k = 0; k < N; k++) {
+        float offset = spread * L_[s][c][k];
+        sigma_[1 + c][s][k] = X_[s][k] + offset;
+        sigma_[1 + STATES + c][s][k] = X_[s][k] - offset;
+      }
+    }
+  }
+
+  // Opponents are observed at their x/y, so sigma point p predicts the measurement
+  // sigma_[p][0..1]
+  for(int r = 0; r < 2; r++) {
+    for(int k = 0; k < N; k++)
+      yBar_[r][k] = weight0_ * sigma_[0][r][k];
+    for(int p = 1; p < SIGMA_POINTS; p++)
+      for(int k = 0; k < N; k++)
+        yBar_[r][k] += weight_ * sigma_[p][r][k];
+  }
+  for(int k = 0; k < N; k++)
+    Pyy_[0][k] = Pyy_[1][k] = Pyy_[2][k] = 0;
+  for(int s = 0; s < STATES; s++)
+    for(int k = 0; k < N; k++)
+      Pxy_[s][0][k] = Pxy_[s][1][k] = 0;
+  for(int p = 0; p < SIGMA_POINTS; p++) {
+    float w = p ? weight_ : weight0_;
+    for(int k = 0; k < N; k++) {
+      float dx = sigma_[p][0][k] - yBar_[0][k], dy = sigma_[p][1][k] - yBar_[1][k];
+      Pyy_[0][k] += w * dx * dx;
+      Pyy_[1][k] += w * dx * dy;
+      Pyy_[2][k] += w * dy * dy;
+    }
+    for(int s = 0; s < STATES; s++) {
+      for(int k = 0; k < N; k++) {
+        float ds = w * (sigma_[p][s][k] - X_[s][k]);
+        Pxy_[s][0][k] += ds * (sigma_[p][0][k] - yBar_[0][k]);
+        Pxy_[s][1][k] += ds * (sigma_[p][1][k] - yBar_[1][k]);
+      }
+    }
+  }
+}
+
+void OppFilterBank::measurementUpdate(const OppObservation* observations, int count, int frame) {
+  count = std::min(count, (int)MAX_OBSERVATIONS);
+  predictMeasurements();
+
+  // Innovation of every observation against every track
+  for(int j = 0; j < count; j++) {
+    const OppObservation& obs = observations[j];
+    for(int k = 0; k < N; k++) {
+      float Sxx = Pyy_[0][k] + obs.Rxx, Sxy = Pyy_[1][k] + obs.Rxy, Syy = Pyy_[2][k] + obs.Ryy;
+      float dx = obs.x - yBar_[0][k], dy = obs.y - yBar_[1][k];
+      innovation2_[j][k] = (Syy * dx * dx - 2 * Sxy * dx * dy + Sxx * dy * dy) / (Sxx * Syy - Sxy * Sxy);
+    }
+  }
+
+  // Closest pairs first, each observation and track at most once
+  int track[MAX_OBSERVATIONS];
+  bool taken[N];
+  for(int j = 0; j < count; j++)
+    track[j] = -1;
+  for(int k = 0; k < N; k++)
+    taken[k] = false;
+  while(true) {
+    float best = ukfParams_.outlier_rejection_thresh;
+    int bestObs = -1, bestTrack = -1;
+    for(int j = 0; j < count; j++) {
+      if(track[j] >= 0) continue;
+      for(int k = 0; k < N; k++) {
+        if(active_[k] && !taken[k] && innovation2_[j][k] < best) {
+          best = innovation2_[j][k];
+          bestObs = j;
+          bestTrack = k;
+        }
+      }
+    }
+    if(bestObs < 0) break;
+    track[bestObs] = bestTrack;
+    taken[bestTrack] = true;
+  }
+
+  // One masked update for the whole bank. Lanes without an observation get a zero
+  // gain, and a unit R to keep the inverse finite.
+  float gain[N], ox[N], oy[N], Rxx[N], Rxy[N], Ryy[N];
+  for(int k = 0; k < N; k++) {
+    gain[k] = 0;
+    ox[k] = yBar_[0][k];
+    oy[k] = yBar_[1][k];
+    Rxx[k] = Ryy[k] = 1;
+    Rxy[k] = 0;
+  }
+  for(int j = 0; j < count; j++) {
+    int k = track[j];
+    if(k < 0) continue;
+    gain[k] = 1;
+    ox[k] = observations[j].x;
+    oy[k] = observations[j].y;
+    Rxx[k] = observations[j].Rxx;
+    Rxy[k] = observations[j].Rxy;
+    Ryy[k] = observations[j].Ryy;
+    frameObserved_[k] = frame;
+  }
+
+  float K[STATES][2][N], dx[N], dy[N];
+  for(int k = 0; k < N; k++) {
+    float Sxx = Pyy_[0][k] + Rxx[k], Sxy = Pyy_[1][k] + Rxy[k], Syy = Pyy_[2][k] + Ryy[k];
+    float det = Sxx * Syy - Sxy * Sxy;
+    float Ixx = Syy / det, Ixy = -Sxy / det, Iyy = Sxx / det;
+    dx[k] = ox[k] - yBar_[0][k];
+    dy[k] = oy[k] - yBar_[1][k];
+    for(int s = 0; s < STATES; s++) {
+      K[s][0][k] = gain[k] * (Pxy_[s][0][k] * Ixx + Pxy_[s][1][k] * Ixy);
+      K[s][1][k] = gain[k] * (Pxy_[s][0][k] * Ixy + Pxy_[s][1][k] * Iyy);
+    }
+  }
+  for(int s = 0; s < STATES; s++)
+    for(int k = 0; k < N; k++)
+      X_[s][k] += K[s][0][k] * dx[k] + K[s][1][k] * dy[k];
+  // P -= K S K', which is K Pxy' as K S = Pxy, kept symmetric
+  for(int s = 0; s < STATES; s++) {
+    for(int t = 0; t <= s; t++) {
+      for(int k = 0; k < N; k++) {
+        float p = P_[s][t][k] - K[s][0][k] * Pxy_[t][0][k] - K[s][1][k] * Pxy_[t][1][k];
+        P_[s][t][k] = P_[t][s][k] = p;
+      }
+    }
+  }
+  // Alpha shrinks every frame a track goes unseen, and an observation closes the gap
+  // to 1 by a fraction that falls with its innovation against R, as UKF4 weighs alpha
+  for(int k = 0; k < N; k++) {
+    float e2 = (Ryy[k] * dx[k] * dx[k] - 2 * Rxy[k] * dx[k] * dy[k] + Rxx[k] * dy[k] * dy[k]) / (Rxx[k] * Ryy[k] - Rxy[k] * Rxy[k]);
+    float observed = alpha_[k] + (1 - alpha_[k]) / (1 + e2);
+    alpha_[k] = gain[k] * observed + (1 - gain[k]) * alpha_[k] * params_.miss_decay;
+  }
+
+  for(int j = 0; j < count; j++) {
+    if(track[j] >= 0) continue;
+    int free = std::find(active_, active_ + N, false) - active_;
+    if(free == N) break;
+    spawn(free, observations[j], frame);
+  }
+}
+
+void OppFilterBank::mergeTracks() {
+  for(int i = 0; i < N; i++) {
+    for(int j = i + 1; j < N && active_[i]; j++) {
+      // two tracks observed in the same frame were seen as two robots
+      if(!active_[j] || frameObserved_[i] == frameObserved_[j]) continue;
+      float dx = X_[0][i] - X_[0][j], dy = X_[1][i] - X_[1][j];
+      float Sxx = P_[0][0][i] + P_[0][0][j], Sxy = P_[0][1][i] + P_[0][1][j], Syy = P_[1][1][i] + P_[1][1][j];
+      float d2 = (Syy * dx * dx - 2 * Sxy * dx * dy + Sxx * dy * dy) / (Sxx * Syy - Sxy * Sxy);
+      if(d2 > params_.merge_thresh) continue;
+      // the stronger track carries on, with the latest observation of the two
+      int keep = alpha_[i] >= alpha_[j] ? i : j, drop = i + j - keep;
+      frameObserved_[keep] = std::max(frameObserved_[keep], frameObserved_[drop]);
+      kill(drop);
+    }
+  }
+}
+
+void OppFilterBank::pruneTracks() {
+  float maxVar = params_.max_sd * params_.max_sd;
+  for(int i = 0; i < N; i++)
+    if(active_[i] && (alpha_[i] < params_.min_alpha || std::max(P_[0][0][i], P_[1][1][i]) > maxVar))
+      kill(i);
+}
+
+void OppFilterBank::fillModel(int i, OpponentModel& model) const {
+  model.modelNumber = id_[i];
+  model.alpha = active_[i] ? alpha_[i] : -1;
+  model.frameLastObserved = frameObserved_[i];
+  model.X00 = X_[0][i];
+  model.X10 = X_[1][i];
+  model.X20 = X_[2][i];
+  model.X30 = X_[3][i];
+  model.P00 = sd(i, 0);
+  model.P11 = sd(i, 1);
+  model.P22 = sd(i, 2);
+  model.P33 = sd(i, 3);
+  // square root of the position covariance, lower triangular
+  model.SRXX = model.P00;
+  model.SRXY = model.P10 = model.P01 = P_[1][0][i] / std::max(model.SRXX, MIN_VARIANCE);
+  model.SRYY = sqrtf(std::max(P_[1][1][i] - model.SRXY * model.SRXY, MIN_VARIANCE));
+}
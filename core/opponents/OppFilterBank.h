@@ -0,0 +1,97 @@
+#pragma once
+
+#include <opponents/UKF4.h>
+#include <memory/OpponentBlock.h>
+
+/// An opponent detection on the field: global position and its covariance, in cm
+struct OppObservation {
+  float x, y;
+  float Rxx, Rxy, Ryy;
+
+  /* Places a detection at distance and bearing from the robot pose on the field, with
+   * the range and bearing errors of UKF4::opponentDetection and the robot's own
+   * position and orientation sds folded into the covariance. */
+  static OppObservation fromRelative(float distance, float bearing, float selfX, float selfY, float selfOrientation,
+      float selfSdX, float selfSdY, float selfSdOrientation,
+      float distanceErrorOffset, float distanceErrorRelative, float bearingError);
+};
+
+struct OppTrackerParams {
+  float merge_thresh;   // tracks with positions closer than this squared Mahalanobis distance are merged
+  float miss_decay;     // alpha is multiplied by this every frame a track goes unobserved
+  float min_alpha;      // tracks are dropped below this alpha
+  float max_sd;         // or when their position sd grows over this (cm)
+};
+
+/* A bank of UKF4 style filters, one per tracked opponent, with the x/y/vx/vy state of
+ * UKF4 in cm. The state, covariance and sigma points of every filter are stored
+ * structure of arrays, each value contiguous across the MAX_FILTERS filters, and every
+ * step runs across the whole bank at once with a fixed trip count, so the filters
+ * are updated side by side in SIMD lanes. Filters that aren't tracking anything ride
+ * along in their lanes and are ignored.
+ *
+ * Each frame every detection is gated against every track with the innovation test
+ * of UKF4 (SmallUKF4Params::outlier_rejection_thresh) and the closest pairs are
+ * associated one to one. Associated tracks take their detection in a single masked
+ * measurement update, the rest spawn new tracks in free filters. Tracks that end up
+ * on top of each other without being seen apart are merged, and tracks that lose
+ * too much alpha or grow too uncertain are dropped. */
+class OppFilterBank {
+  public:
+    static const int MAX_FILTERS = MAX_OPP_MODELS_IN_MEM;
+    static const int STATES = UKF4::STATES;
+    static const int SIGMA_POINTS = UKF4::SIGMA_POINTS;
+    static const int MAX_OBSERVATIONS = MAX_FILTERS;
+
+    OppFilterBank();
+    void setParams(const SmallUKF4Params& ukf, const OppTrackerParams& tracker);
+    void clear();
+
+    // Runs every step of the frame in turn
+    void processFrame(float timePassed, const OppObservation* observations, int count, int frame);
+
+    void timeUpdate(float timePassed);
+    // Associates the observations with tracks and updates them, spawning tracks for the rest
+    void measurementUpdate(const OppObservation* observations, int count, int frame);
+    void mergeTracks();
+    void pruneTracks();
+
+    inline bool active(int i) const { return active_[i]; }
+    int activeCount() const;
+    inline float x(int i) const { return X_[0][i]; }
+    inline float y(int i) const { return X_[1][i]; }
+    inline float alpha(int i) const { return alpha_[i]; }
+    float sd(int i, int state) const;
+
+    // Fills the OpponentBlock model of filter i, alpha -1 if it isn't tracking anything
+    void fillModel(int i, OpponentModel& model) const;
+
+  private:
+    void predictMeasurements();
+    void spawn(int i, const OppObservation& observation, int frame);
+    void kill(int i);
+
+    SmallUKF4Params ukfParams_;
+    OppTrackerParams params_;
+    // Weight of the mean and of each other sigma point, as the squares of UKF4::sqrtOfTestWeightings
+    float weight0_, weight_;
+
+    float X_[STATES][MAX_FILTERS];
+    float P_[STATES][STATES][MAX_FILTERS];
+    float alpha_[MAX_FILTERS];
+    bool active_[MAX_FILTERS];
+    int id_[MAX_FILTERS];
+    int frameObserved_[MAX_FILTERS];
+    int nextId_;
+
+    // Lower triangular square root of P and the sigma points drawn from it
+    float L_[STATES][STATES][MAX_FILTERS];
+    float sigma_[SIGMA_POINTS][STATES][MAX_FILTERS];
+    // Predicted measurement, its covariance and its cross covariance with the state
+    float yBar_[2][MAX_FILTERS];
+    float Pyy_[3][MAX_FILTERS];
+    float Pxy_[STATES][2][MAX_FILTERS];
+
+    // Squared Mahalanobis distance of each observation from each track
+    float innovation2_[MAX_OBSERVATIONS][MAX_FILTERS];
+};
@@ -1,16 +1,78 @@
 #include "OppModule.h"
+#include <common/Field.h>
+#include <memory/WorldObjectBlock.h>
+#include <memory/RobotStateBlock.h>
+#include <memory/FrameInfoBlock.h>
+#include <memory/OpponentBlock.h>
+#include <algorithm>
+
+// Range variance is DIST_ERROR_OFFSET + DIST_ERROR_RELATIVE * distance^2 (cm^2), the
+// bearing variance is BEARING_ERROR (rad^2), as passed to UKF4::opponentDetection
+#define DIST_ERROR_OFFSET 400
+#define DIST_ERROR_RELATIVE 0.01
+#define BEARING_ERROR 0.01
+
+// Longest gap between frames the filters are predicted across, in seconds
+#define MAX_TIME_PASSED 0.5
+
+OppModule::OppModule() : world_objects_(NULL), robot_state_(NULL), frame_info_(NULL), opponents_(NULL), last_time_(-1) {
+}
 
 void OppModule::specifyMemoryDependency() {
+  requiresMemoryBlock("world_objects");
+  requiresMemoryBlock("robot_state");
+  requiresMemoryBlock("vision_frame_info");
+  requiresMemoryBlock("opponents");
 }
 
 void OppModule::specifyMemoryBlocks() {
+  getOrAddMemoryBlock(world_objects_,"world_objects");
+  getOrAddMemoryBlock(robot_state_,"robot_state");
+  getOrAddMemoryBlock(frame_info_,"vision_frame_info");
+  getOrAddMemoryBlock(opponents_,"opponents");
 }
 
 void OppModule::initSpecificModule(){
+  reInit();
 }
 
 void OppModule::reInit(){
+  bank_.clear();
+  last_time_ = -1;
+  if (opponents_) publish();
 }
 
 void OppModule::processFrame(){
+  double now = frame_info_->seconds_since_start;
+  float timePassed = last_time_ < 0 ? 0 : std::min(std::max(now - last_time_, 0.0), (double)MAX_TIME_PASSED);
+  last_time_ = now;
+
+  // the filters run in cm, world objects are in mm
+  WorldObject& self = world_objects_->objects_[robot_state_->WO_SELF];
+  OppObservation observations[OppFilterBank::MAX_OBSERVATIONS];
+  int count = 0;
+  for (int i = WO_OPPONENT_FIRST; i <= WO_OPPONENT_LAST && count < OppFilterBank::MAX_OBSERVATIONS; i++) {
+    WorldObject& opp = world_objects_->objects_[i];
+    if (!opp.seen) continue;
+    OppObservation& obs = observations[count];
+    obs = OppObservation::fromRelative(opp.visionDistance / 10.0, opp.visionBearing, self.loc.x / 10.0, self.loc.y / 10.0,
+        self.orientation, self.sd.x / 10.0, self.sd.y / 10.0, self.sdOrientation,
+        DIST_ERROR_OFFSET, DIST_ERROR_RELATIVE, BEARING_ERROR);
+    if (fabs(obs.x) > GRASS_X / 20.0 || fabs(obs.y) > GRASS_Y / 20.0) {
+      oppLog((10, "observed opponent %i off field at (%5.1f, %5.1f), outlier", i, obs.x, obs.y));
+      continue;
+    }
+    oppLog((70, "opponent %i at dist %5.1f, bear %5.3f, global (%5.1f, %5.1f)", i, opp.visionDistance, opp.visionBearing, obs.x, obs.y));
+    count++;
+  }
+
+  bank_.processFrame(timePassed, observations, count, frame_info_->frame_id);
+  oppLog((50, "%i observations, %i opponents tracked", count, bank_.activeCount()));
+  publish();
+}
+
+void OppModule::publish(){
+  for (int i = 0; i < OppFilterBank::MAX_FILTERS; i++)
+    bank_.fillModel(i, opponents_->locModels[i]);
+  opponents_->syncModels();
 }
@@ -1,13 +1,27 @@
 #pragma once
 
 #include <Module.h>
+#include <opponents/OppFilterBank.h>
 
+/// Tracks the opponents seen by vision with a bank of filters and publishes them to the opponents block
 class OppModule: public Module {
   public:
+    OppModule();
     void specifyMemoryDependency();
     void specifyMemoryBlocks();
     void initSpecificModule();
     void reInit();
 
     void processFrame();
+
+  private:
+    void publish();
+
+    WorldObjectBlock* world_objects_;
+    RobotStateBlock* robot_state_;
+    FrameInfoBlock* frame_info_;
+    OpponentBlock* opponents_;
+
+    OppFilterBank bank_;
+    double last_time_;
 };
@@ -25,32 +25,32 @@ UKF4::UKF4()
   frameUpdated = -1000;
 
   // Set Update Uncertainty
-  updateUncertainties = NMatrix(4, 4, true);
+  updateUncertainties = FixedMatrix<STATES,STATES>(true);
   updateUncertainties[2][2] = 0.975; // velocity x
   updateUncertainties[3][3] = 0.975; // velocity y
   
   //Initialisation of Xhat and S
   init();
 
-  // Process Noise - NMatrix Square Root of Q
+  // Process Noise - Matrix Square Root of Q
   // For regular update
   // Todd: I doubled these
-  sqrtOfProcessNoise = NMatrix(4,4,true);
+  sqrtOfProcessNoise = FixedMatrix<STATES,STATES>(true);
   sqrtOfProcessNoise[0][0] = 2.0* 2.0; // Robot X coord.
   sqrtOfProcessNoise[1][1] = 2.0* 2.0; // Robot Y coord.
   sqrtOfProcessNoise[2][2] = 2.0* 3.16228; // Robot X Velocity.
   sqrtOfProcessNoise[3][3] = 2.0* 3.16228; // Robot Y Velocity.
 
   // side of the field if it managed to localise to the incorrect half.
-  sqrtOfProcessNoiseReset = NMatrix(4,4,false);
+  sqrtOfProcessNoiseReset = FixedMatrix<STATES,STATES>();
   sqrtOfProcessNoiseReset[0][0] = 150.0; // extra 150cm sd 
   sqrtOfProcessNoiseReset[1][1] = 100.0; // extra 100cm sd
 
-  nStates = stateEstimates.getm(); // number of states.
+  nStates = STATES; // number of states.
 
   // Create square root of W matrix
   // This is used to weight the sigma points.
-  sqrtOfTestWeightings = NMatrix(1,2*nStates+1,false);
+  sqrtOfTestWeightings = FixedMatrix<1,SIGMA_POINTS>();
   sqrtOfTestWeightings[0][0] = sqrtf(1.0/(nStates+1.0));
   float outerWeighting = sqrtf(1.0/(2*(nStates+1.0)));
   for(int i=1; i <= 2*nStates; i++){
@@ -73,11 +73,11 @@ void UKF4::init()
 {
   alpha = 1.0;
   // Initial state estimates
-  stateEstimates= NMatrix(4,1,true);
+  stateEstimates = FixedMatrix<STATES,1>();
 
   // S = Standard deviation matrix.
   // Initial Uncertainty
-  stateStandardDeviations = NMatrix(4,4,false);
+  stateStandardDeviations = FixedMatrix<STATES,STATES>();
   stateStandardDeviations[0][0] = 150; // 150 cm
   stateStandardDeviations[1][1] = 100; // 100 cm
   stateStandardDeviations[2][2] = 10;  // 10 cm/s
@@ -182,7 +182,7 @@ ukf4UpdateResult UKF4::opponentDetection(float obsDistance, float obsBearing, fl
   float R_bearing = bearingError;
 
   // Calculate update uncertainties - S_obj_rel & R_obj_rel
-  NMatrix S_obj_rel = NMatrix(2,5,false);
+  FixedMatrix<2,5> S_obj_rel;
 
   // Todd: convert dist/bearing/locx/y/theta error to abs x/y error
   S_obj_rel[0][0] = cos(obsBearing + self->orientation) * sqrtf(R_range);              // oppX/drange   * r_range
@@ -201,13 +201,13 @@ ukf4UpdateResult UKF4::opponentDetection(float obsDistance, float obsBearing, fl
   //oppLog((10, "from those errors to globalx: %5.3f, %5.3f, %5.3f, %5.3f, %5.3f", S_obj_rel[0][0], S_obj_rel[0][1], S_obj_rel[0][2], S_obj_rel[0][3], S_obj_rel[0][4]));
   //oppLog((10, "from those errors to globaly: %5.3f, %5.3f, %5.3f, %5.3f, %5.3f", S_obj_rel[1][0], S_obj_rel[1][1], S_obj_rel[1][2], S_obj_rel[1][3], S_obj_rel[1][4]));
 
-  NMatrix R_obj_rel = S_obj_rel * S_obj_rel.transp(); // R = S^2
+  FixedMatrix<2,2> R_obj_rel = S_obj_rel * S_obj_rel.transp(); // R = S^2
 
   // Unscented KF Stuff.
-  NMatrix yBar;                                    //reset
-  NMatrix Py;
-  NMatrix Pxy=NMatrix(4, 2, false);                    //Pxy=[0;0;0];
-  NMatrix scriptX=NMatrix(stateEstimates.getm(), 2 * nStates + 1, false);
+  FixedMatrix<2,1> yBar;                               //reset
+  FixedMatrix<2,2> Py;
+  FixedMatrix<STATES,2> Pxy;                           //Pxy=[0;0;0];
+  FixedMatrix<STATES,SIGMA_POINTS> scriptX;
   scriptX.setCol(0, stateEstimates);                         //scriptX(:,1)=Xhat;
 
   //----------------Saturate ScriptX angle sigma points to not wrap
@@ -218,8 +218,8 @@ ukf4UpdateResult UKF4::opponentDetection(float obsDistance, float obsBearing, fl
     scriptX.setCol(nStates + i,stateEstimates - sqrtf((float)nStates + ukfParams.kappa) * stateStandardDeviations.getCol(i - 1));
   }
   //----------------------------------------------------------------
-  NMatrix scriptY = NMatrix(2, 2 * nStates + 1, false);
-  NMatrix temp = NMatrix(2, 1, false);
+  FixedMatrix<2,SIGMA_POINTS> scriptY;
+  FixedMatrix<2,1> temp;
 
   for(int i = 0; i < 2 * nStates + 1; i++){
     // expected values for each sigma point (abs x/y location)
@@ -227,21 +227,21 @@ ukf4UpdateResult UKF4::opponentDetection(float obsDistance, float obsBearing, fl
     temp[1][0] = scriptX[1][i];
     scriptY.setCol(i, temp.getCol(0));
   }
-  NMatrix Mx = NMatrix(scriptX.getm(), 2 * nStates + 1, false);
-  NMatrix My = NMatrix(scriptY.getm(), 2 * nStates + 1, false);
+  FixedMatrix<STATES,SIGMA_POINTS> Mx;
+  FixedMatrix<2,SIGMA_POINTS> My;
   for(int i = 0; i < 2 * nStates + 1; i++){
     Mx.setCol(i, sqrtOfTestWeightings[0][i] * scriptX.getCol(i));
     My.setCol(i, sqrtOfTestWeightings[0][i] * scriptY.getCol(i));
   }
 
-  NMatrix M1 = sqrtOfTestWeightings;
+  const FixedMatrix<1,SIGMA_POINTS>& M1 = sqrtOfTestWeightings;
   yBar = My * M1.transp(); // Predicted Measurement.
   Py = (My - yBar * M1) * (My - yBar * M1).transp();
   Pxy = (Mx - stateEstimates * M1) * (My - yBar * M1).transp();
 
-  NMatrix K = Pxy * Invert22(Py + R_obj_rel); // K = Kalman filter gain.
+  FixedMatrix<STATES,2> K = Pxy * Invert22(Py + R_obj_rel); // K = Kalman filter gain.
 
-  NMatrix y = NMatrix(2,1,false); // Measurement. I terms of relative (x,y).
+  FixedMatrix<2,1> y; // Measurement. I terms of relative (x,y).
   y[0][0] = oppX;
   y[1][0] = oppY; 
   //end of standard ukf stuff
@@ -279,9 +279,6 @@ ukf4UpdateResult UKF4::opponentDetection(float obsDistance, float obsBearing, fl
 
   oppLog((70, "Y: %5.3f, %5.3f, Ybar: %5.3f, %5.3f, yBar-y: %5.3f, %5.3f", y[0][0], y[1][0], yBar[0][0], yBar[1][0], yBar[0][0]-y[0][0], yBar[1][0]-y[1][0]));
 
-  NMatrix change = NMatrix(4,1,false) - K*(yBar - y);
-  //  oppLog((70, "Change: %5.3f, %5.3f, %5.3f, %5.3f", change[0][0], change[1][0], change[2][0], change[3][0]));
-
   stateStandardDeviations = HT( horzcat(Mx - stateEstimates*M1 - K*My + K*yBar*M1, K*S_obj_rel) );
   stateEstimates = stateEstimates - K*(yBar - y);
   return UKF4_OK;
@@ -314,8 +311,7 @@ bool UKF4::clipState(int stateIndex, float minValue, float maxValue){
   bool clipped = false;
   if(stateEstimates[stateIndex][0] > maxValue){
     float mult, Pii;
-    NMatrix Si;
-    Si = stateStandardDeviations.getRow(stateIndex);
+    FixedMatrix<1,STATES> Si = stateStandardDeviations.getRow(stateIndex);
     Pii = convDble(Si * Si.transp());
     mult = (stateEstimates[stateIndex][0] - maxValue) / Pii;
     stateEstimates = stateEstimates - mult * stateStandardDeviations * Si.transp();
@@ -324,8 +320,7 @@ bool UKF4::clipState(int stateIndex, float minValue, float maxValue){
   }
   if(stateEstimates[stateIndex][0] < minValue){
     float mult, Pii;
-    NMatrix Si;
-    Si = stateStandardDeviations.getRow(stateIndex);
+    FixedMatrix<1,STATES> Si = stateStandardDeviations.getRow(stateIndex);
     Pii = convDble(Si * Si.transp());
     mult = (stateEstimates[stateIndex][0] - minValue) / Pii;
     stateEstimates = stateEstimates - mult * stateStandardDeviations * Si.transp();
@@ -349,31 +344,30 @@ ukf4UpdateResult UKF4::linear2MeasurementUpdate(float Y1,float Y2, float SR11, f
 // Example Call (given data from wireless: ballX, ballY, SRballXX, SRballXY, SRballYY)
 //      linear2MeasurementUpdate( ballX, ballY, SRballXX, SRballXY, SRballYY, 3, 4 )
 {
-  NMatrix SR = NMatrix(2,2,false);
+  FixedMatrix<2,2> SR;
   SR[0][0] = SR11;
   SR[0][1] = SR12;
   SR[1][1] = SR22;
 
-  NMatrix R = NMatrix(2,2,false);
-  R = SR * SR.transp();
+  FixedMatrix<2,2> R = SR * SR.transp();
 
-  NMatrix Py = NMatrix(2, 2, false);
-  NMatrix Pxy = NMatrix(4, 2, false);
+  FixedMatrix<2,2> Py;
+  FixedMatrix<STATES,2> Pxy;
 
-  NMatrix CS = NMatrix(2, 4, false);
+  FixedMatrix<2,STATES> CS;
   CS.setRow(0, stateStandardDeviations.getRow(index1));
   CS.setRow(1, stateStandardDeviations.getRow(index2));
 
   Py = CS * CS.transp();
   Pxy = stateStandardDeviations * CS.transp();
 
-  NMatrix K = Pxy * Invert22(Py + R);   //Invert22
+  FixedMatrix<STATES,2> K = Pxy * Invert22(Py + R);   //Invert22
 
-  NMatrix y = NMatrix(2, 1, false);
+  FixedMatrix<2,1> y;
   y[0][0] = Y1;
   y[1][0] = Y2;
 
-  NMatrix yBar = NMatrix(2, 1, false); //Estimated values of the measurements Y1,Y2
+  FixedMatrix<2,1> yBar; //Estimated values of the measurements Y1,Y2
   yBar[0][0] = stateEstimates[index1][0];
   yBar[1][0] = stateEstimates[index2][0];
   //RHM: (3) Outlier rejection.
@@ -401,6 +395,6 @@ ukf4UpdateResult UKF4::linear2MeasurementUpdate(float Y1,float Y2, float SR11, f
   return UKF4_OK;
 }
 
-NMatrix UKF4::GetLocSR(){
+FixedMatrix<2,2> UKF4::GetLocSR(){
   return HT(vertcat(stateStandardDeviations.getRow(0), stateStandardDeviations.getRow(1)));
 }
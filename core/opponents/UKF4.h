@@ -2,7 +2,7 @@
 #define _UKF4_h_DEFINED
 
 #include <math.h>
-#include <common/NMatrix.h>
+#include <common/FixedMatrix.h>
 #include <common/WorldObject.h>
 
 #include <memory/WorldObjectBlock.h>
@@ -39,6 +39,9 @@ struct SmallUKF4Params {
 
 class UKF4 {
  public:
+  static const int STATES = 4;
+  static const int SIGMA_POINTS = 2 * STATES + 1;
+
   // Constructor
   UKF4();
 
@@ -54,7 +57,7 @@ class UKF4 {
   float sd(int Xi);
   float variance(int Xi);
   float getState(int stateID);
-  NMatrix GetLocSR();
+  FixedMatrix<2,2> GetLocSR();
 
   // Utility
   void init();
@@ -74,15 +77,15 @@ class UKF4 {
   bool toBeActivated;
 
   // State data
-  NMatrix updateUncertainties;     // Update Uncertainty.          (A matrix)
-  NMatrix stateEstimates;          // State estimates.             (Xhat NMatrix)
-  NMatrix stateStandardDeviations; // Standard Deviation NMatrix.   (S NMatrix)
+  FixedMatrix<STATES,STATES> updateUncertainties;     // Update Uncertainty.          (A matrix)
+  FixedMatrix<STATES,1> stateEstimates;               // State estimates.             (Xhat matrix)
+  FixedMatrix<STATES,STATES> stateStandardDeviations; // Standard Deviation matrix.   (S matrix)
 
   // Constants
   int nStates;                    // Number of states.            (Constant)
-  NMatrix sqrtOfTestWeightings;    // Square root of W             (Constant)
-  NMatrix sqrtOfProcessNoise;      // Square root of Process Noise (Q matrix). (Constant)
-  NMatrix sqrtOfProcessNoiseReset; // Square root of Q for reset.  (Conastant)
+  FixedMatrix<1,SIGMA_POINTS> sqrtOfTestWeightings;    // Square root of W             (Constant)
+  FixedMatrix<STATES,STATES> sqrtOfProcessNoise;      // Square root of Process Noise (Q matrix). (Constant)
+  FixedMatrix<STATES,STATES> sqrtOfProcessNoiseReset; // Square root of Q for reset.  (Conastant)
 
   // Tuning Values 
   SmallUKF4Params ukfParams;
@@ -90,8 +93,8 @@ class UKF4 {
   TextLogger* textlogger;
 
   float lastInnov2;
-  NMatrix lastStateEstimates;
-  NMatrix lastStateStandardDeviations;
+  FixedMatrix<STATES,1> lastStateEstimates;
+  FixedMatrix<STATES,STATES> lastStateStandardDeviations;
   int lastFrameUpdated;
 
   int frameUpdated;
@@ -28,11 +28,11 @@ void InertialFilter::init(bool in_simulation) {
   gyro_scale = DEG_TO_RAD*0.405;  // (rad/sec) // lower is smoother, slower, higher responds faster and overshoots a lot (at only 2x)
   //numFramesToMeanOver = 30;
   
-  xhRoll = NMatrix(4,1,false);
-  xhTilt = NMatrix(4,1,false);
+  xhRoll = FixedMatrix<4,1>();
+  xhTilt = FixedMatrix<4,1>();
   
-  xhTiltFuture = NMatrix(4,1,false);
-  xhRollFuture = NMatrix(4,1,false);
+  xhTiltFuture = FixedMatrix<4,1>();
+  xhRollFuture = FixedMatrix<4,1>();
 
   initMatrices(in_simulation);
 }
@@ -54,7 +54,7 @@ void InertialFilter::processFrame(bool calibrated) {
   float y_g=(y_gyro) * gyro_scale;
 
   //Now do KF calculations for roll axis
-  NMatrix xSen(2,1,false);
+  FixedMatrix<2,1> xSen;
   xSen[0][0] = -y_acc; 
   xSen[1][0] = x_g;
   xhRoll=A*xhRoll-L*(C*xhRoll - xSen);
@@ -62,7 +62,7 @@ void InertialFilter::processFrame(bool calibrated) {
   filtRollVel=convDble(Cz1*xhRoll);
   
   //Now do KF calculations for tilt axis
-  NMatrix ySen(2,1,false);
+  FixedMatrix<2,1> ySen;
   ySen[0][0] = -x_acc; 
   ySen[1][0] = y_g;
   xhTilt=A*xhTilt-L*(C*xhTilt - ySen);
@@ -2,7 +2,7 @@
 #define _InertialFilter_h_DEFINED
 
 
-#include <common/NMatrix.h>
+#include <common/FixedMatrix.h>
 
 class InertialFilter {
 public:
@@ -35,6 +35,13 @@ public:
 
   void predictFuture(int numFrames, float &tilt, float &roll);
 
+  // The filter model, so ports of the filter can be checked against it
+  const FixedMatrix<4,4>& getA() const { return A; };
+  const FixedMatrix<2,4>& getC() const { return C; };
+  const FixedMatrix<4,2>& getL() const { return L; };
+  const FixedMatrix<1,4>& getCz() const { return Cz; };
+  const FixedMatrix<1,4>& getCz1() const { return Cz1; };
+
   //------ Variables ----- // Note: I generally don't believe in public/private  
 private:
   // inputs and outputs
@@ -61,21 +68,21 @@ private:
   //float gyro_drift_rms; // rad/sample
 
   // KF variables
-  NMatrix A;
-  NMatrix B;
-  NMatrix C;
-  NMatrix Cz;
-  NMatrix Cz1;
+  FixedMatrix<4,4> A;
+  FixedMatrix<4,2> B;
+  FixedMatrix<2,4> C;
+  FixedMatrix<1,4> Cz;
+  FixedMatrix<1,4> Cz1;
   
-  NMatrix Q;  // Weighting Matricies
-  NMatrix R;
-  NMatrix L;
+  FixedMatrix<4,4> Q;  // Weighting Matricies
+  FixedMatrix<2,2> R;
+  FixedMatrix<4,2> L;
   
-  NMatrix xhRoll;
-  NMatrix xhTilt;
+  FixedMatrix<4,1> xhRoll;
+  FixedMatrix<4,1> xhTilt;
   
-  NMatrix xhRollFuture;
-  NMatrix xhTiltFuture;
+  FixedMatrix<4,1> xhRollFuture;
+  FixedMatrix<4,1> xhTiltFuture;
 };
 
 #endif
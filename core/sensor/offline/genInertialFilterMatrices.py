@@ -6,7 +6,7 @@ import subprocess, sys
 
 def writeMatrix(name,res,indentation=2):
   mat = res[name]
-  output = indentation * '  ' + '%s = NMatrix(%i,%i,false);\n' % (name,mat.shape[0],mat.shape[1])
+  output = indentation * '  ' + '%s = FixedMatrix<%i,%i>();\n' % (name,mat.shape[0],mat.shape[1])
   for i in range(mat.shape[0]):
     output += indentation * '  '
     for j in range(mat.shape[1]):
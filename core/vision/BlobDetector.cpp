@@ -0,0 +1,126 @@
+#include <vision/BlobDetector.h>
+#include <algorithm>
+
+static bool sortBlobPixelPredicate(Blob* left, Blob* right) {
+  return left->pixelCount > right->pixelCount;
+}
+
+BlobDetector::BlobDetector() {
+}
+
+Blob* BlobDetector::getLargestBlob(Color c) const {
+  if(sorted_[c].empty()) return NULL;
+  return sorted_[c][0];
+}
+
+int BlobDetector::find(int i) {
+  while(parent_[i] != i) {
+    parent_[i] = parent_[parent_[i]];
+    i = parent_[i];
+  }
+  return i;
+}
+
+void BlobDetector::merge(int i, int j) {
+  i = find(i);
+  j = find(j);
+  // The lower index becomes the root so blobs come out in scan order
+  if(i < j) parent_[j] = i;
+  else if(j < i) parent_[i] = j;
+}
+
+void BlobDetector::formBlobs(RunLengthImage& rle, int colorFlags) {
+  for(int c = 0; c < NUM_COLORS; c++) {
+    sorted_[c].clear();
+    if(c == c_UNDEFINED || !isInFlags(c, colorFlags)) continue;
+    formColorBlobs(rle, (Color)c);
+  }
+}
+
+// Unites runs in [a1, a2) with the runs in [b1, b2) on row yi that they touch. Both
+// ranges are ordered by xi, so one sweep visits every pair whose x ranges meet.
+void BlobDetector::connectRows(const VisionPoint* runs, int a1, int a2, int b1, int b2, int yi) {
+  int i = a1, j = b1;
+  while(i < a2 && j < b2) {
+    const VisionPoint &a = runs[i], &b = runs[j];
+    if(a.yf + 1 >= yi && a.xi <= b.xf + 1 && b.xi <= a.xf + 1)
+      merge(i, j);
+    if(a.xf < b.xf) i++;
+    else j++;
+  }
+}
+
+void BlobDetector::formColorBlobs(RunLengthImage& rle, Color c) {
+  int n = rle.numRuns(c);
+  if(n == 0) return;
+  VisionPoint* runs = rle.getRuns(c);
+  parent_.resize(n);
+  for(int i = 0; i < n; i++)
+    parent_[i] = i;
+
+  int maxDy = rle.maxRunHeight(c);
+  for(int y = 0; y < rle.height(); y++) {
+    int b1 = rle.rowBegin(c, y), b2 = rle.rowBegin(c, y + 1);
+    if(b1 == b2) continue;
+    // Neighbors on the same row can only be the run directly to the left
+    for(int j = b1 + 1; j < b2; j++)
+      if(runs[j - 1].xf + 1 >= runs[j].xi)
+        merge(j - 1, j);
+    // Runs from earlier rows touch this one if they reach down to the row above it
+    for(int r = std::max(0, y - maxDy); r < y; r++) {
+      int a1 = rle.rowBegin(c, r), a2 = rle.rowBegin(c, r + 1);
+      if(a1 < a2) connectRows(runs, a1, a2, b1, b2, y);
+    }
+  }
+
+  // Roots are visited before the rest of their set, so each root opens its blob
+  std::vector<Blob>& blobs = blobs_[c];
+  int count = 0;
+  sumX_.clear();
+  sumY_.clear();
+  for(int i = 0; i < n; i++) {
+    VisionPoint& run = runs[i];
+    int root = find(i);
+    uint32_t pixels = run.dx * run.dy;
+    Blob* blob;
+    if(root == i) {
+      if(count == (int)blobs.size()) blobs.push_back(Blob());
+      run.lbIndex = count++;
+      blob = &blobs[run.lbIndex];
+      blob->xi = run.xi;
+      blob->xf = run.xf;
+      blob->yi = run.yi;
+      blob->yf = run.yf;
+      blob->lpCount = 0;
+      blob->pixelCount = 0;
+      blob->color = c;
+      blob->invalid = false;
+      sumX_.push_back(0);
+      sumY_.push_back(0);
+    } else {
+      run.lbIndex = runs[root].lbIndex;
+      blob = &blobs[run.lbIndex];
+      blob->xi = std::min(blob->xi, run.xi);
+      blob->xf = std::max(blob->xf, run.xf);
+      blob->yf = std::max(blob->yf, run.yf);
+    }
+    blob->pixelCount += pixels;
+    if(blob->lpCount < MAX_BLOB_VISIONPOINTS)
+      blob->lpIndex[blob->lpCount++] = i;
+    // Twice the centroid of each run, weighted by its area
+    sumX_[run.lbIndex] += (uint64_t)(run.xi + run.xf) * pixels;
+    sumY_[run.lbIndex] += (uint64_t)(run.yi + run.yf) * pixels;
+  }
+
+  for(int i = 0; i < count; i++) {
+    Blob& blob = blobs[i];
+    blob.dx = blob.xf - blob.xi + 1;
+    blob.dy = blob.yf - blob.yi + 1;
+    // Rounded to the nearest pixel, the centroid is stored as an integer
+    blob.avgX = (sumX_[i] + blob.pixelCount) / (2 * blob.pixelCount);
+    blob.avgY = (sumY_[i] + blob.pixelCount) / (2 * blob.pixelCount);
+    blob.correctPixelRatio = (float)blob.pixelCount / (blob.dx * blob.dy);
+    sorted_[c].push_back(&blob);
+  }
+  std::sort(sorted_[c].begin(), sorted_[c].end(), sortBlobPixelPredicate);
+}
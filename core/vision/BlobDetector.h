@@ -0,0 +1,38 @@
+#ifndef BLOB_DETECTOR_H
+#define BLOB_DETECTOR_H
+
+#include <vector>
+#include <vision/RunLengthImage.h>
+#include <vision/structures/Blob.h>
+
+/// @ingroup vision
+/* Forms blobs from the runs of a RunLengthImage with a union-find over runs that
+ * touch, including diagonally. Every color selected by the flags is handled in the
+ * same pass so the ball, goal post and robot detectors can share the result. For
+ * each blob the bounding box, centroid (avgX, avgY), pixel count and color are
+ * filled in, and lpIndex lists the blob's runs in the RunLengthImage. Pixel counts
+ * are in image pixels, i.e. each sample counts for the hstep x vstep block it
+ * stands for. */
+class BlobDetector {
+  public:
+    BlobDetector();
+
+    void formBlobs(RunLengthImage& rle, int colorFlags);
+
+    // Blobs of color c, largest pixel count first
+    inline const std::vector<Blob*>& getBlobs(Color c) const { return sorted_[c]; }
+    Blob* getLargestBlob(Color c) const;
+
+  private:
+    void formColorBlobs(RunLengthImage& rle, Color c);
+    void connectRows(const VisionPoint* runs, int a1, int a2, int b1, int b2, int yi);
+    int find(int i);
+    void merge(int i, int j);
+
+    std::vector<int> parent_;
+    std::vector<Blob> blobs_[NUM_COLORS];
+    std::vector<Blob*> sorted_[NUM_COLORS];
+    std::vector<uint64_t> sumX_, sumY_;
+};
+
+#endif
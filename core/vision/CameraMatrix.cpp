@@ -97,6 +97,13 @@ Coordinates CameraMatrix::undistort(float x, float y) const {
 Coordinates CameraMatrix::getImageCoordinates(Vector3f worldPosition) const {
   return getImageCoordinates(worldPosition[0], worldPosition[1], worldPosition[2]);
 }
+
+float CameraMatrix::getCameraDepth(float x, float y, float z) const {
+  Vector4f v;
+  v << x, y, z, 1;
+  Vector4f c = worldToCam_ * v;
+  return c[2];
+}
   
 void CameraMatrix::setCalibration(const RobotCalibration& cal) {
   cal_ = cal;
@@ -57,6 +57,7 @@ class CameraMatrix {
     
     Coordinates getImageCoordinates(float x, float y, float z) const;
     Coordinates getImageCoordinates(Eigen::Vector3f worldPosition) const;
+    float getCameraDepth(float x, float y, float z) const;
     Coordinates undistort(float x, float y) const;
     
     void updateCameraPose(Pose3D& pose);
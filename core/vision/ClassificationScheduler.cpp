@@ -0,0 +1,165 @@
+#include <vision/ClassificationScheduler.h>
+#include <algorithm>
+
+ClassificationScheduler::ClassificationScheduler(const ImageParams& iparams) :
+  aboveHorizon(8, 8), belowHorizon(4, 2), focus(2, 1), focusRadius(32), focusTimeout(30),
+  iparams_(iparams), focusX_(0), focusY_(0), focusFrame_(0), hasFocus_(false),
+  pixelsClassified_(0), fullFramePixels_(0) {
+  stripWidth_ = (iparams_.width + NUM_STRIPS - 1) / NUM_STRIPS;
+  for(int i = 0; i < NUM_STRIPS; i++)
+    bodyTop_[i] = iparams_.height;
+}
+
+void ClassificationScheduler::setHorizon(const HorizonLine& horizon) {
+  horizon_ = horizon;
+}
+
+void ClassificationScheduler::setFocus(int imageX, int imageY, unsigned int frame) {
+  focusX_ = imageX;
+  focusY_ = imageY;
+  focusFrame_ = frame;
+  hasFocus_ = true;
+}
+
+void ClassificationScheduler::setBodyExclusion(const CameraMatrix& cmatrix, const Pose3D* absParts, const RobotDimensions& dimensions) {
+  for(int i = 0; i < NUM_STRIPS; i++)
+    bodyTop_[i] = iparams_.height;
+
+  // Each leg is traced from the hip down to the outline of the sole, the arms from shoulder to hand
+  float front = dimensions.values_[RobotDimensions::footLength] - dimensions.values_[RobotDimensions::backOfFootToAnkle];
+  float rear = -dimensions.values_[RobotDimensions::backOfFootToAnkle];
+  float side = dimensions.values_[RobotDimensions::footWidth] / 2;
+  BodyPart::Part feet[] = { BodyPart::left_bottom_foot, BodyPart::right_bottom_foot };
+  BodyPart::Part legs[][3] = {
+    { BodyPart::left_hip, BodyPart::left_tibia, BodyPart::left_ankle },
+    { BodyPart::right_hip, BodyPart::right_tibia, BodyPart::right_ankle }
+  };
+  for(int i = 0; i < 2; i++) {
+    std::vector<Vector3<float> > chain;
+    for(int j = 0; j < 3; j++)
+      chain.push_back(absParts[legs[i][j]].translation);
+    const Pose3D& foot = absParts[feet[i]];
+    chain.push_back(foot * Vector3<float>(rear, side, 0));
+    chain.push_back(foot * Vector3<float>(front, side, 0));
+    chain.push_back(foot * Vector3<float>(front, -side, 0));
+    chain.push_back(foot * Vector3<float>(rear, -side, 0));
+    chain.push_back(foot * Vector3<float>(rear, side, 0));
+    addChain(cmatrix, chain);
+  }
+  BodyPart::Part arms[][4] = {
+    { BodyPart::left_shoulder, BodyPart::left_elbow, BodyPart::left_forearm, BodyPart::left_hand },
+    { BodyPart::right_shoulder, BodyPart::right_elbow, BodyPart::right_forearm, BodyPart::right_hand }
+  };
+  for(int i = 0; i < 2; i++) {
+    std::vector<Vector3<float> > chain;
+    for(int j = 0; j < 4; j++)
+      chain.push_back(absParts[arms[i][j]].translation);
+    addChain(cmatrix, chain);
+  }
+}
+
+void ClassificationScheduler::addChain(const CameraMatrix& cmatrix, const std::vector<Vector3<float> >& chain) {
+  bool lastVisible = false;
+  Coordinates last;
+  for(unsigned int i = 0; i < chain.size(); i++) {
+    const Vector3<float>& p = chain[i];
+    // Points behind the camera project to meaningless coordinates
+    bool visible = cmatrix.getCameraDepth(p.x, p.y, p.z) > 0;
+    Coordinates c;
+    if(visible) c = cmatrix.getImageCoordinates(p.x, p.y, p.z);
+    if(visible && lastVisible)
+      addSegment(last.x, last.y, c.x, c.y);
+    else if(visible)
+      addSegment(c.x, c.y, c.x, c.y);
+    last = c;
+    lastVisible = visible;
+  }
+}
+
+void ClassificationScheduler::addSegment(int x1, int y1, int x2, int y2) {
+  if(x1 > x2) {
+    std::swap(x1, x2);
+    std::swap(y1, y2);
+  }
+  if(x2 < 0 || x1 >= iparams_.width) return;
+  int s1 = std::max(0, x1 / stripWidth_), s2 = std::min(NUM_STRIPS - 1, x2 / stripWidth_);
+  for(int s = s1; s <= s2; s++) {
+    // Take the highest point of the segment within this strip
+    int sx1 = std::max(x1, s * stripWidth_), sx2 = std::min(x2, (s + 1) * stripWidth_ - 1);
+    int top;
+    if(x1 == x2) top = std::min(y1, y2);
+    else {
+      float gradient = (float)(y2 - y1) / (x2 - x1);
+      top = std::min(y1 + gradient * (sx1 - x1), y1 + gradient * (sx2 - x1));
+    }
+    top = std::max(0, top);
+    if(top < bodyTop_[s]) bodyTop_[s] = top;
+  }
+}
+
+void ClassificationScheduler::addIntervals(std::vector<Interval>& intervals, int y1, int y2, const ScanDensity& density, int fy1, int fy2) {
+  if(y1 > y2) return;
+  // Cut the focus rows out so they aren't classified twice
+  if(fy1 > fy2 || fy2 < y1 || fy1 > y2) {
+    intervals.push_back(Interval(y1, y2, density));
+    return;
+  }
+  if(y1 < fy1) intervals.push_back(Interval(y1, fy1 - 1, density));
+  if(fy2 < y2) intervals.push_back(Interval(fy2 + 1, y2, density));
+}
+
+void ClassificationScheduler::addArea(int x1, int x2, const Interval& interval) {
+  // Extend an area from the previous strip when it covers the same rows at the same stride
+  for(unsigned int i = 0; i < areas_.size(); i++) {
+    ScheduledArea& a = areas_[i];
+    if(a.area.x2 == x1 - 1 && a.area.y1 == interval.y1 && a.area.y2 == interval.y2 &&
+        a.hstep == interval.density.hstep && a.vstep == interval.density.vstep) {
+      a.area.x2 = x2;
+      a.area.init();
+      return;
+    }
+  }
+  areas_.push_back(ScheduledArea(FocusArea(x1, interval.y1, x2, interval.y2), interval.density.hstep, interval.density.vstep));
+}
+
+void ClassificationScheduler::schedule(unsigned int frame) {
+  areas_.clear();
+  if(hasFocus_ && frame - focusFrame_ > focusTimeout)
+    hasFocus_ = false;
+
+  // The focus window is widened to strip boundaries so strips are either in or out of it
+  int fs1 = NUM_STRIPS, fs2 = -1, fy1 = 0, fy2 = -1;
+  if(hasFocus_) {
+    fs1 = std::max(0, (focusX_ - focusRadius) / stripWidth_);
+    fs2 = std::min(NUM_STRIPS - 1, (focusX_ + focusRadius) / stripWidth_);
+    fy1 = std::max(0, focusY_ - focusRadius);
+    fy2 = std::min(iparams_.height - 1, focusY_ + focusRadius);
+  }
+
+  for(int s = 0; s < NUM_STRIPS; s++) {
+    int x1 = s * stripWidth_, x2 = std::min(iparams_.width, (s + 1) * stripWidth_) - 1;
+    if(x1 > x2) break;
+    int bottom = bodyTop_[s] - 1;
+    int horizonY = 0;
+    if(horizon_.exists) {
+      float hy = std::min(horizon_.gradient * x1 + horizon_.offset, horizon_.gradient * x2 + horizon_.offset);
+      horizonY = std::max(0, std::min(bottom + 1, (int)hy));
+      // Snapping to the sparse grid lets neighboring strips along a shallow horizon merge
+      horizonY -= horizonY % aboveHorizon.vstep;
+    }
+    bool focused = s >= fs1 && s <= fs2;
+    std::vector<Interval> intervals;
+    addIntervals(intervals, 0, horizonY - 1, aboveHorizon, focused ? fy1 : 0, focused ? fy2 : -1);
+    addIntervals(intervals, horizonY, bottom, belowHorizon, focused ? fy1 : 0, focused ? fy2 : -1);
+    if(focused && fy1 <= std::min(fy2, bottom))
+      intervals.push_back(Interval(fy1, std::min(fy2, bottom), focus));
+    for(unsigned int i = 0; i < intervals.size(); i++)
+      addArea(x1, x2, intervals[i]);
+  }
+
+  pixelsClassified_ = 0;
+  for(unsigned int i = 0; i < areas_.size(); i++)
+    pixelsClassified_ += areas_[i].pixels();
+  FocusArea full(0, 0, iparams_.width - 1, iparams_.height - 1);
+  fullFramePixels_ = ScheduledArea(full, belowHorizon.hstep, belowHorizon.vstep).pixels();
+}
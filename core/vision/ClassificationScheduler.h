@@ -0,0 +1,65 @@
+#ifndef CLASSIFICATION_SCHEDULER_H
+#define CLASSIFICATION_SCHEDULER_H
+
+#include <vector>
+#include <common/RobotInfo.h>
+#include <common/RobotDimensions.h>
+#include <math/Pose3D.h>
+#include <vision/CameraMatrix.h>
+#include <vision/structures/HorizonLine.h>
+#include <vision/structures/ScheduledArea.h>
+
+/// @ingroup vision
+struct ScanDensity {
+  int hstep, vstep;
+  ScanDensity(int hstep, int vstep) : hstep(hstep), vstep(vstep) { }
+};
+
+/// @ingroup vision
+/* Splits the image into vertical strips and decides per strip which rows to
+ * classify and at what stride: sparse above the horizon, the default grid below
+ * it, dense around the last ball detection, and nothing over the robot's own body. */
+class ClassificationScheduler {
+  public:
+    static const int NUM_STRIPS = 16;
+
+    ClassificationScheduler(const ImageParams& iparams);
+
+    void setHorizon(const HorizonLine& horizon);
+    void setBodyExclusion(const CameraMatrix& cmatrix, const Pose3D* absParts, const RobotDimensions& dimensions);
+    void setFocus(int imageX, int imageY, unsigned int frame);
+    void schedule(unsigned int frame);
+
+    inline const std::vector<ScheduledArea>& areas() const { return areas_; }
+    inline int pixelsClassified() const { return pixelsClassified_; }
+    inline int fullFramePixels() const { return fullFramePixels_; }
+    inline int bodyTop(int strip) const { return bodyTop_[strip]; }
+
+    ScanDensity aboveHorizon, belowHorizon, focus;
+    int focusRadius;
+    unsigned int focusTimeout;
+
+  private:
+    struct Interval {
+      int y1, y2;
+      ScanDensity density;
+      Interval(int y1, int y2, const ScanDensity& density) : y1(y1), y2(y2), density(density) { }
+    };
+
+    void addChain(const CameraMatrix& cmatrix, const std::vector<Vector3<float> >& chain);
+    void addSegment(int x1, int y1, int x2, int y2);
+    void addIntervals(std::vector<Interval>& intervals, int y1, int y2, const ScanDensity& density, int fy1, int fy2);
+    void addArea(int x1, int x2, const Interval& interval);
+
+    const ImageParams& iparams_;
+    int stripWidth_;
+    int bodyTop_[NUM_STRIPS];
+    HorizonLine horizon_;
+    int focusX_, focusY_;
+    unsigned int focusFrame_;
+    bool hasFocus_;
+    std::vector<ScheduledArea> areas_;
+    int pixelsClassified_, fullFramePixels_;
+};
+
+#endif
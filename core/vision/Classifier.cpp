@@ -1,10 +1,11 @@
 #include "Classifier.h"
+#include <vision/SegmentationKernels.h>
 #include <iostream>
 
 using namespace cv;
 
 Classifier::Classifier(const VisionBlocks& vblocks, const VisionParams& vparams, const ImageParams& iparams, const Camera::Type& camera) :
-    vblocks_(vblocks), vparams_(vparams), iparams_(iparams), camera_(camera), initialized_(false) {
+    vblocks_(vblocks), vparams_(vparams), iparams_(iparams), camera_(camera), initialized_(false), rle_(iparams) {
   segImg_ = new unsigned char[iparams.size];
   segImgLocal_ = segImg_;
   setImagePointers();
@@ -14,6 +15,11 @@ Classifier::~Classifier() {
   delete [] segImgLocal_;
 }
 
+void Classifier::init(TextLogger* tl) {
+  textlogger = tl;
+  visionLog((20, "Classifier using %s segmentation kernel", SegmentationKernels::name()));
+}
+
 bool Classifier::setImagePointers() {
   if(vblocks_.image == NULL) {
     printf("No image block loaded! Classification failed.\n");
@@ -63,22 +69,44 @@ bool Classifier::setImagePointers() {
 bool Classifier::classifyImage(unsigned char *colorTable) {
   if(!setImagePointers()) return false;
   FocusArea area(0, 0, iparams_.width - 1, iparams_.height - 1);
+  rle_.clear();
   classifyImage(area, colorTable);
+  rle_.finish();
+  return true;
+}
+
+bool Classifier::classifyImage(const std::vector<ScheduledArea>& areas, unsigned char *colorTable) {
+  if(!setImagePointers()) return false;
+  // Areas change from frame to frame, so clear out anything left over from the last schedule
+#ifdef TOOL
+  if(vblocks_.image->loaded_)
+#endif
+  memset(segImg_, c_UNDEFINED, sizeof(unsigned char) * iparams_.size);
+  rle_.clear();
+  for(unsigned int i = 0; i < areas.size(); i++)
+    classifyImage(areas[i], colorTable);
+  rle_.finish();
   return true;
 }
 
 void Classifier::classifyImage(const FocusArea& area, unsigned char* colorTable){
+  int vstep = 1 << 1;
+  int hstep = 1 << 2;
+  classifyImage(ScheduledArea(area, hstep, vstep), colorTable);
+}
+
+void Classifier::classifyImage(const ScheduledArea& area, unsigned char* colorTable){
   bool imageLoaded = vblocks_.image->loaded_;
   if(!imageLoaded) {
     visionLog((20, "Classifying with no raw image"));
   }
   colorTable_ = colorTable;
-  int vstep = 1 << 1;
-  int hstep = 1 << 2;
-  for (int y = area.y1; y <= area.y2; y += vstep) {
-    for(int x = area.x1; x <= area.x2; x += hstep) {
-      auto c = ColorTableMethods::xy2color(img_, colorTable, x, y, iparams_.width);
-      segImg_[iparams_.width * y + x] = c;
-    }
+  int x1 = area.firstX();
+  for (int y = area.firstY(); y <= area.area.y2; y += area.vstep) {
+    const unsigned char* row = img_ + iparams_.width * y * 2;
+    unsigned char* segRow = segImg_ + iparams_.width * y;
+    SegmentationKernels::classifyRow(row, colorTable, segRow, x1, area.area.x2, area.hstep);
+    // The row is still in cache, so encode it while we're here
+    rle_.encodeRow(segRow, y, x1, area.area.x2, area.hstep, area.vstep);
   }
 }
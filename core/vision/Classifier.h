@@ -15,6 +15,8 @@
 #include <vision/ColorTableMethods.h>
 #include <vision/VisionBlocks.h>
 #include <vision/structures/FocusArea.h>
+#include <vision/structures/ScheduledArea.h>
+#include <vision/RunLengthImage.h>
 #include <vision/Macros.h>
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
@@ -26,15 +28,18 @@ class Classifier {
  public:
   Classifier(const VisionBlocks& vblocks, const VisionParams& vparams, const ImageParams& iparams, const Camera::Type& camera);
   ~Classifier();
-  void init(TextLogger* tl){textlogger = tl;};
+  void init(TextLogger* tl);
 
   bool classifyImage(unsigned char*);
+  bool classifyImage(const std::vector<ScheduledArea>& areas, unsigned char*);
   inline Color xy2color(int x, int y) {
     return (Color)segImg_[y * iparams_.width + x];
   }
+  inline RunLengthImage& getRunLengthImage() { return rle_; }
 
  private:
   void classifyImage(const FocusArea& area, unsigned char*);
+  void classifyImage(const ScheduledArea& area, unsigned char*);
   bool setImagePointers();
   
   const VisionBlocks& vblocks_;
@@ -48,5 +53,6 @@ class Classifier {
   unsigned char* segImg_, *segImgLocal_;
   HorizonLine horizon_;
   unsigned char* colorTable_;
+  RunLengthImage rle_;
 };
 #endif
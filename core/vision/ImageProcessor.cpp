@@ -2,9 +2,10 @@
 #include <iostream>
 
 ImageProcessor::ImageProcessor(VisionBlocks& vblocks, const ImageParams& iparams, Camera::Type camera) :
-  vblocks_(vblocks), iparams_(iparams), camera_(camera), cmatrix_(iparams_, camera), calibration_(NULL)
+  vblocks_(vblocks), iparams_(iparams), camera_(camera), cmatrix_(iparams_, camera), calibration_(NULL), scheduler_(iparams_)
 {
   enableCalibration_ = false;
+  enableScheduler_ = false;
   classifier_ = new Classifier(vblocks_, vparams_, iparams_, camera_);
 }
 
@@ -102,10 +103,20 @@ void ImageProcessor::processFrame(){
   
   // Horizon calculation
   visionLog((30, "Calculating horizon line"));
-  HorizonLine horizon = HorizonLine::generate(iparams_, cmatrix_, 30000);
-  vblocks_.robot_vision->horizon = horizon;
+  // Published to robot_vision by VisionModule once both cameras are done
+  horizon_ = HorizonLine::generate(iparams_, cmatrix_, 30000);
   visionLog((30, "Classifying Image", camera_));
-  if(!classifier_->classifyImage(color_table_)) return;	
+  if(enableScheduler_) {
+    scheduler_.setHorizon(horizon_);
+    scheduler_.setBodyExclusion(cmatrix_, vblocks_.body_model->abs_parts_, vblocks_.robot_info->dimensions_);
+    scheduler_.schedule(vblocks_.frame_info->frame_id);
+    if(!classifier_->classifyImage(scheduler_.areas(), color_table_)) return;
+    visionLog((30, "Classified %i of %i full frame pixels in %i areas", scheduler_.pixelsClassified(), scheduler_.fullFramePixels(), (int)scheduler_.areas().size()));
+  }
+  else if(!classifier_->classifyImage(color_table_)) return;
+  // One pass for every color the ball, goal post and robot detectors look at
+  visionLog((30, "Forming blobs"));
+  blob_detector_.formBlobs(classifier_->getRunLengthImage(), FLAG_ORANGE | FLAG_PINK | FLAG_BLUE | FLAG_YELLOW);
   detectBall();
 }
 
@@ -125,58 +136,19 @@ void ImageProcessor::detectBall() {
   ball->visionElevation = cmatrix_.elevation(p);
   ball->visionDistance = cmatrix_.groundDistance(p);
   ball->seen = true;
+  scheduler_.setFocus(imageX, imageY, vblocks_.frame_info->frame_id);
 }
 
 bool ImageProcessor::findBall(int& imageX, int& imageY) {
-	auto total = 0;
-	int countX=0, countY=0;
-	// Process from left to right
-	for(int x = 0; x < 320; x++) {
-	  // Process from top to bottom
-	  for(int y = 0; y < 240; y++) {
-	    // Retrieve the segmented color of the pixel at (x,y)
-	    auto c = getSegImg()[y * iparams_.width + x];
-	    //if(c == c_ORANGE)
-          if(c == c_BLUE)
-		{
-			countX+=x;
-			countY+=y;
-	      		total++;
-		}
-	  }
-	}
-	printf("total orange pixels: %i\n", total);
-	if (total<200)
-	{
-		return false;
-	}
-	else
-	{
-		imageX = countX/total;
-		imageY = countY/total;
-		printf("Detect ball successfully!!\n");
-		printf("Location: X:%d, Y:%d\n",imageX, imageY);
-		return true;
-	}	
-/*auto seg = getSegImg();
-        cout<<"seg[0]: "<<seg[0]<<endl;
-	if(seg[0]==c_ORANGE)
-    	//imageX = imageY = 1; int total = 0;
-	  return trcd ue;
-	else
-	  return false;*/
-
-/*
-  for(int x = 0; x < iparams_.width; x++){
-    for(int y = 0; y < iparams_.height; y++){
-      if(getBottomSegPixelValueAt(x,y) == c_ORANGE){
-       		return true;
-	}
-	}
-	}
-return false;
-*/
-
+  Blob* blob = blob_detector_.getLargestBlob(c_BLUE);
+  if(blob == NULL) return false;
+  visionLog((40, "Largest ball blob: %i pixels", (int)blob->pixelCount));
+  if(blob->pixelCount < MIN_BALL_BLOB_PIXELS) return false;
+  imageX = blob->avgX;
+  imageY = blob->avgY;
+  printf("Detect ball successfully!!\n");
+  printf("Location: X:%d, Y:%d\n",imageX, imageY);
+  return true;
 }
 
 int ImageProcessor::getTeamColor() {
@@ -205,6 +177,10 @@ void ImageProcessor::enableCalibration(bool value) {
   enableCalibration_ = value;
 }
 
+void ImageProcessor::enableClassificationScheduler(bool value) {
+  enableScheduler_ = value;
+}
+
 bool ImageProcessor::isImageLoaded() {
   return vblocks_.image->loaded_;
 }
@@ -9,6 +9,8 @@
 #include <vision/VisionBlocks.h>
 #include <common/RobotInfo.h>
 #include <vision/Classifier.h>
+#include <vision/ClassificationScheduler.h>
+#include <vision/BlobDetector.h>
 #include <common/RobotCalibration.h>
 #include <vision/structures/BallCandidate.h>
 #include <math/Pose3D.h>
@@ -30,8 +32,12 @@ class ImageProcessor {
     int getImageWidth();
     const ImageParams& getImageParams() const { return iparams_; }
     const CameraMatrix& getCameraMatrix();
+    const HorizonLine& getHorizon() const { return horizon_; }
     void setCalibration(RobotCalibration);
     void enableCalibration(bool value);
+    void enableClassificationScheduler(bool value);
+    ClassificationScheduler& getClassificationScheduler() { return scheduler_; }
+    const BlobDetector& getBlobDetector() const { return blob_detector_; }
     void updateTransform();
     std::vector<BallCandidate*> getBallCandidates();
     BallCandidate* getBestBallCandidate();
@@ -46,6 +52,7 @@ class ImageProcessor {
     const ImageParams& iparams_;
     Camera::Type camera_;
     CameraMatrix cmatrix_;
+    HorizonLine horizon_;
     
     VisionParams vparams_;
     unsigned char* color_table_;
@@ -57,6 +64,11 @@ class ImageProcessor {
 
     RobotCalibration* calibration_;
     bool enableCalibration_;
+
+    ClassificationScheduler scheduler_;
+    bool enableScheduler_;
+
+    BlobDetector blob_detector_;
 };
 
 #endif
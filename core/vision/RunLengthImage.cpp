@@ -0,0 +1,73 @@
+#include <vision/RunLengthImage.h>
+#include <algorithm>
+
+static bool sortRunPredicate(const VisionPoint& left, const VisionPoint& right) {
+  return left.xi < right.xi;
+}
+
+RunLengthImage::RunLengthImage(const ImageParams& iparams) : iparams_(iparams) {
+  for(int c = 0; c < NUM_COLORS; c++) {
+    rowStart_[c].resize(iparams_.height + 1, 0);
+    maxDy_[c] = 0;
+  }
+}
+
+void RunLengthImage::clear() {
+  for(int c = 0; c < NUM_COLORS; c++) {
+    runs_[c].clear();
+    maxDy_[c] = 0;
+  }
+}
+
+void RunLengthImage::encodeRow(const unsigned char* segRow, int y, int x1, int x2, int hstep, int vstep) {
+  if(x1 > x2) return;
+  uint16_t yf = std::min(y + vstep, iparams_.height) - 1;
+  uint16_t dy = yf - y + 1;
+  int start = x1;
+  unsigned char color = segRow[x1];
+  for(int x = x1 + hstep; ; x += hstep) {
+    bool end = x > x2;
+    if(!end && segRow[x] == color) continue;
+    if(color != c_UNDEFINED) {
+      VisionPoint run;
+      run.xi = start;
+      run.xf = std::min(x, x2 + 1) - 1;
+      run.dx = run.xf - run.xi + 1;
+      run.yi = y;
+      run.yf = yf;
+      run.dy = dy;
+      run.lbIndex = 0;
+      run.isValid = true;
+      runs_[color].push_back(run);
+      if(dy > maxDy_[color]) maxDy_[color] = dy;
+    }
+    if(end) break;
+    start = x;
+    color = segRow[x];
+  }
+}
+
+void RunLengthImage::finish() {
+  // Areas are classified one after another, so rows arrive out of order; a counting sort on yi fixes that
+  for(int c = 0; c < NUM_COLORS; c++) {
+    std::vector<VisionPoint>& runs = runs_[c];
+    std::vector<int>& start = rowStart_[c];
+    std::fill(start.begin(), start.end(), 0);
+    for(unsigned int i = 0; i < runs.size(); i++)
+      start[runs[i].yi + 1]++;
+    for(int y = 0; y < iparams_.height; y++)
+      start[y + 1] += start[y];
+    sorted_[c].resize(runs.size());
+    for(unsigned int i = 0; i < runs.size(); i++)
+      sorted_[c][start[runs[i].yi]++] = runs[i];
+    // The fill pass left each entry at the start of the following row
+    for(int y = iparams_.height; y > 0; y--)
+      start[y] = start[y - 1];
+    start[0] = 0;
+    for(int y = 0; y < iparams_.height; y++) {
+      VisionPoint *begin = sorted_[c].data() + start[y], *end = sorted_[c].data() + start[y + 1];
+      if(!std::is_sorted(begin, end, sortRunPredicate))
+        std::sort(begin, end, sortRunPredicate);
+    }
+  }
+}
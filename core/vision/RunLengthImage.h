@@ -0,0 +1,41 @@
+#ifndef RUN_LENGTH_IMAGE_H
+#define RUN_LENGTH_IMAGE_H
+
+#include <vector>
+#include <common/RobotInfo.h>
+#include <vision/enums/Colors.h>
+#include <vision/structures/VisionPoint.h>
+
+/// @ingroup vision
+/* Run length encoded segmented image, filled by the Classifier as it scans rows.
+ * Each run is a VisionPoint covering the block of pixels its samples stand for:
+ * a sample at (x, y) on an (hstep, vstep) grid covers [x, x + hstep) x [y, y + vstep),
+ * clipped to the scanned area. Runs of differently strided areas therefore tile
+ * the image, and touching runs are touching regions of the image. */
+class RunLengthImage {
+  public:
+    RunLengthImage(const ImageParams& iparams);
+
+    void clear();
+    void encodeRow(const unsigned char* segRow, int y, int x1, int x2, int hstep, int vstep);
+    // Groups the runs of each color by starting row, ordered left to right within a row
+    void finish();
+
+    inline int numRuns(Color c) const { return sorted_[c].size(); }
+    inline VisionPoint* getRuns(Color c) { return sorted_[c].data(); }
+    inline const VisionPoint* getRuns(Color c) const { return sorted_[c].data(); }
+    // Runs of color c starting on row y are [rowBegin(c, y), rowBegin(c, y + 1))
+    inline int rowBegin(Color c, int y) const { return rowStart_[c][y]; }
+    // The tallest run of color c, which bounds how far back touching runs can start
+    inline int maxRunHeight(Color c) const { return maxDy_[c]; }
+    inline int height() const { return iparams_.height; }
+
+  private:
+    const ImageParams& iparams_;
+    std::vector<VisionPoint> runs_[NUM_COLORS];
+    std::vector<VisionPoint> sorted_[NUM_COLORS];
+    std::vector<int> rowStart_[NUM_COLORS];
+    int maxDy_[NUM_COLORS];
+};
+
+#endif
@@ -0,0 +1,193 @@
+#include <vision/SegmentationKernels.h>
+#include <vision/ColorTableMethods.h>
+#include <stdint.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SEG_KERNEL_AVX2
+#define SEG_KERNEL_WIDTH 8
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SEG_KERNEL_SSE2
+#define SEG_KERNEL_WIDTH 4
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SEG_KERNEL_NEON
+#define SEG_KERNEL_WIDTH 4
+#endif
+
+// A YUYV macropixel read as a little endian 32 bit word is V:Y1:U:Y0 from the
+// high byte down, so the color table index (y >> 1 << 14) + (u >> 1 << 7) + (v >> 1)
+// can be built with a mask and a shift per channel:
+//   Y0 -> (w & 0x000000FE) << 13
+//   Y1 -> (w & 0x00FE0000) >> 3
+//   U  -> (w & 0x0000FE00) >> 2
+//   V  ->  w >> 25
+
+#if defined(SEG_KERNEL_AVX2)
+
+static inline __m256i indexY0(__m256i w) {
+  __m256i y = _mm256_slli_epi32(_mm256_and_si256(w, _mm256_set1_epi32(0xFE)), 13);
+  __m256i u = _mm256_srli_epi32(_mm256_and_si256(w, _mm256_set1_epi32(0xFE00)), 2);
+  return _mm256_or_si256(_mm256_or_si256(y, u), _mm256_srli_epi32(w, 25));
+}
+
+static inline __m256i indexY1(__m256i w) {
+  __m256i y = _mm256_srli_epi32(_mm256_and_si256(w, _mm256_set1_epi32(0xFE0000)), 3);
+  __m256i u = _mm256_srli_epi32(_mm256_and_si256(w, _mm256_set1_epi32(0xFE00)), 2);
+  return _mm256_or_si256(_mm256_or_si256(y, u), _mm256_srli_epi32(w, 25));
+}
+
+// Gathers 8 table entries. The table is gathered as 32 bit words from 4-byte aligned
+// offsets so that no lane reads past the end of the LUT_SIZE table.
+static inline void lookup(const unsigned char* colorTable, __m256i idx, uint32_t* out) {
+  __m256i aligned = _mm256_andnot_si256(_mm256_set1_epi32(3), idx);
+  __m256i shift = _mm256_slli_epi32(_mm256_and_si256(idx, _mm256_set1_epi32(3)), 3);
+  __m256i words = _mm256_i32gather_epi32((const int*)colorTable, aligned, 1);
+  __m256i colors = _mm256_and_si256(_mm256_srlv_epi32(words, shift), _mm256_set1_epi32(0xFF));
+  _mm256_storeu_si256((__m256i*)out, colors);
+}
+
+static inline void store(const unsigned char* colorTable, __m256i idx, unsigned char* seg, int hstep) {
+  uint32_t colors[8];
+  lookup(colorTable, idx, colors);
+  for(int i = 0; i < 8; i++)
+    seg[i * hstep] = colors[i];
+}
+
+// Classifies one group of 8 output pixels (16 for hstep 1) starting at macropixel mp.
+static inline void classifyGroup(const unsigned char* mp, const unsigned char* colorTable, unsigned char* seg, int hstep) {
+  if(hstep == 4) {
+    __m256 a = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)mp));
+    __m256 b = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(mp + 32)));
+    __m256i even = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0)));
+    even = _mm256_permute4x64_epi64(even, _MM_SHUFFLE(3,1,2,0));
+    store(colorTable, indexY0(even), seg, 4);
+  } else if(hstep == 2) {
+    __m256i w = _mm256_loadu_si256((const __m256i*)mp);
+    store(colorTable, indexY0(w), seg, 2);
+  } else {
+    __m256i w = _mm256_loadu_si256((const __m256i*)mp);
+    __m256i i0 = indexY0(w), i1 = indexY1(w);
+    __m256i lo = _mm256_unpacklo_epi32(i0, i1), hi = _mm256_unpackhi_epi32(i0, i1);
+    store(colorTable, _mm256_permute2x128_si256(lo, hi, 0x20), seg, 1);
+    store(colorTable, _mm256_permute2x128_si256(lo, hi, 0x31), seg + 8, 1);
+  }
+}
+
+#elif defined(SEG_KERNEL_SSE2)
+
+static inline __m128i indexY0(__m128i w) {
+  __m128i y = _mm_slli_epi32(_mm_and_si128(w, _mm_set1_epi32(0xFE)), 13);
+  __m128i u = _mm_srli_epi32(_mm_and_si128(w, _mm_set1_epi32(0xFE00)), 2);
+  return _mm_or_si128(_mm_or_si128(y, u), _mm_srli_epi32(w, 25));
+}
+
+static inline __m128i indexY1(__m128i w) {
+  __m128i y = _mm_srli_epi32(_mm_and_si128(w, _mm_set1_epi32(0xFE0000)), 3);
+  __m128i u = _mm_srli_epi32(_mm_and_si128(w, _mm_set1_epi32(0xFE00)), 2);
+  return _mm_or_si128(_mm_or_si128(y, u), _mm_srli_epi32(w, 25));
+}
+
+// SSE2 has no gather, so the indices are spilled and looked up one at a time.
+static inline void store(const unsigned char* colorTable, __m128i idx, unsigned char* seg, int hstep) {
+  uint32_t indices[4];
+  _mm_storeu_si128((__m128i*)indices, idx);
+  seg[0] = colorTable[indices[0]];
+  seg[hstep] = colorTable[indices[1]];
+  seg[2 * hstep] = colorTable[indices[2]];
+  seg[3 * hstep] = colorTable[indices[3]];
+}
+
+// Classifies one group of 4 output pixels (8 for hstep 1) starting at macropixel mp.
+static inline void classifyGroup(const unsigned char* mp, const unsigned char* colorTable, unsigned char* seg, int hstep) {
+  if(hstep == 4) {
+    __m128 a = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)mp));
+    __m128 b = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(mp + 16)));
+    __m128i even = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0)));
+    store(colorTable, indexY0(even), seg, 4);
+  } else if(hstep == 2) {
+    __m128i w = _mm_loadu_si128((const __m128i*)mp);
+    store(colorTable, indexY0(w), seg, 2);
+  } else {
+    __m128i w = _mm_loadu_si128((const __m128i*)mp);
+    __m128i i0 = indexY0(w), i1 = indexY1(w);
+    store(colorTable, _mm_unpacklo_epi32(i0, i1), seg, 1);
+    store(colorTable, _mm_unpackhi_epi32(i0, i1), seg + 4, 1);
+  }
+}
+
+#elif defined(SEG_KERNEL_NEON)
+
+static inline uint32x4_t indexY0(uint32x4_t w) {
+  uint32x4_t y = vshlq_n_u32(vandq_u32(w, vdupq_n_u32(0xFE)), 13);
+  uint32x4_t u = vshrq_n_u32(vandq_u32(w, vdupq_n_u32(0xFE00)), 2);
+  return vorrq_u32(vorrq_u32(y, u), vshrq_n_u32(w, 25));
+}
+
+static inline uint32x4_t indexY1(uint32x4_t w) {
+  uint32x4_t y = vshrq_n_u32(vandq_u32(w, vdupq_n_u32(0xFE0000)), 3);
+  uint32x4_t u = vshrq_n_u32(vandq_u32(w, vdupq_n_u32(0xFE00)), 2);
+  return vorrq_u32(vorrq_u32(y, u), vshrq_n_u32(w, 25));
+}
+
+static inline void store(const unsigned char* colorTable, uint32x4_t idx, unsigned char* seg, int hstep) {
+  uint32_t indices[4];
+  vst1q_u32(indices, idx);
+  seg[0] = colorTable[indices[0]];
+  seg[hstep] = colorTable[indices[1]];
+  seg[2 * hstep] = colorTable[indices[2]];
+  seg[3 * hstep] = colorTable[indices[3]];
+}
+
+// Classifies one group of 4 output pixels (8 for hstep 1) starting at macropixel mp.
+static inline void classifyGroup(const unsigned char* mp, const unsigned char* colorTable, unsigned char* seg, int hstep) {
+  const uint32_t* words = (const uint32_t*)mp;
+  if(hstep == 4) {
+    uint32x4x2_t w = vld2q_u32(words);
+    store(colorTable, indexY0(w.val[0]), seg, 4);
+  } else if(hstep == 2) {
+    store(colorTable, indexY0(vld1q_u32(words)), seg, 2);
+  } else {
+    uint32x4_t w = vld1q_u32(words);
+    uint32x4x2_t px = vzipq_u32(indexY0(w), indexY1(w));
+    store(colorTable, px.val[0], seg, 1);
+    store(colorTable, px.val[1], seg + 4, 1);
+  }
+}
+
+#endif
+
+void SegmentationKernels::classifyRowScalar(const unsigned char* row, const unsigned char* colorTable, unsigned char* segRow, int x1, int x2, int hstep) {
+  for(int x = x1; x <= x2; x += hstep) {
+    const unsigned char* mp = row + ((x >> 1) << 2);
+    int y = mp[(x & 1) << 1];
+    segRow[x] = ColorTableMethods::yuv2color(colorTable, y, mp[1], mp[3]);
+  }
+}
+
+void SegmentationKernels::classifyRow(const unsigned char* row, const unsigned char* colorTable, unsigned char* segRow, int x1, int x2, int hstep) {
+  int x = x1;
+#ifdef SEG_KERNEL_WIDTH
+  if((x1 & 1) == 0 && (hstep == 1 || hstep == 2 || hstep == 4)) {
+    // hstep 1 produces two pixels per macropixel, so a group covers twice the lanes
+    int pixels = hstep == 1 ? 2 * SEG_KERNEL_WIDTH : SEG_KERNEL_WIDTH * hstep;
+    // only run full groups whose loads stay within [x1, x2]
+    for(; x + pixels - 1 <= x2; x += pixels)
+      classifyGroup(row + (x << 1), colorTable, segRow + x, hstep);
+  }
+#endif
+  classifyRowScalar(row, colorTable, segRow, x, x2, hstep);
+}
+
+const char* SegmentationKernels::name() {
+#if defined(SEG_KERNEL_AVX2)
+  return "avx2";
+#elif defined(SEG_KERNEL_SSE2)
+  return "sse2";
+#elif defined(SEG_KERNEL_NEON)
+  return "neon";
+#else
+  return "scalar";
+#endif
+}
@@ -0,0 +1,17 @@
+#ifndef SEGMENTATION_KERNELS_H
+#define SEGMENTATION_KERNELS_H
+
+/// @ingroup vision
+/// Row kernels for YUYV -> color table segmentation. Each kernel classifies
+/// pixels x1, x1 + hstep, ..., <= x2 of a single image row and writes the result
+/// to segRow[x], giving exactly the same output as ColorTableMethods::xy2color.
+/// The vectorized paths (AVX2, SSE2 or NEON, chosen at compile time) handle even
+/// x1 with hstep 1, 2 or 4; anything else falls back to the scalar kernel.
+class SegmentationKernels {
+  public:
+    static void classifyRow(const unsigned char* row, const unsigned char* colorTable, unsigned char* segRow, int x1, int x2, int hstep);
+    static void classifyRowScalar(const unsigned char* row, const unsigned char* colorTable, unsigned char* segRow, int x1, int x2, int hstep);
+    static const char* name();
+};
+
+#endif
@@ -0,0 +1,263 @@
+#include <vision/SparseColorTable.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// File layout: an 8 byte header ("UTCT", version, brick bits, 2 reserved bytes)
+// followed by one tag byte per brick in brick order. A tag below DENSE_TAG is the
+// color of a uniform brick; DENSE_TAG is followed by (count, color) pairs that run
+// length encode the brick's cells.
+static const char MAGIC[] = { 'U', 'T', 'C', 'T' };
+static const unsigned char VERSION = 1;
+static const int HEADER_SIZE = 8;
+static const unsigned char DENSE_TAG = 0x80;
+
+SparseColorTable::SparseColorTable() {
+  clear();
+}
+
+void SparseColorTable::clear(Color c) {
+  memset(uniform_, c, sizeof(uniform_));
+  std::fill(dense_, dense_ + NUM_BRICKS, -1);
+  pool_.clear();
+  free_.clear();
+}
+
+unsigned char* SparseColorTable::densify(int brick) {
+  if(dense_[brick] < 0) {
+    int block;
+    if(free_.empty()) {
+      block = pool_.size() / BRICK_CELLS;
+      pool_.resize(pool_.size() + BRICK_CELLS);
+    } else {
+      block = free_.back();
+      free_.pop_back();
+    }
+    dense_[brick] = block;
+    memset(&pool_[block * BRICK_CELLS], uniform_[brick], BRICK_CELLS);
+    uniform_[brick] = NO_COLOR;
+  }
+  return &pool_[dense_[brick] * BRICK_CELLS];
+}
+
+void SparseColorTable::release(int brick) {
+  if(dense_[brick] < 0) return;
+  free_.push_back(dense_[brick]);
+  dense_[brick] = -1;
+}
+
+void SparseColorTable::collapse(int brick) {
+  if(dense_[brick] < 0) return;
+  const unsigned char* cells = &pool_[dense_[brick] * BRICK_CELLS];
+  for(int i = 1; i < BRICK_CELLS; i++)
+    if(cells[i] != cells[0]) return;
+  uniform_[brick] = cells[0];
+  release(brick);
+}
+
+void SparseColorTable::fromDense(const unsigned char* table) {
+  clear();
+  for(int b = 0; b < NUM_BRICKS; b++) {
+    int by = b / (BRICKS_PER_AXIS * BRICKS_PER_AXIS), bu = b / BRICKS_PER_AXIS % BRICKS_PER_AXIS, bv = b % BRICKS_PER_AXIS;
+    unsigned char* cells = densify(b);
+    for(int y = 0; y < BRICK_SIZE; y++)
+      for(int u = 0; u < BRICK_SIZE; u++)
+        memcpy(cells + cellIndex(y, u, 0), table + ((by * BRICK_SIZE + y) << 14) + ((bu * BRICK_SIZE + u) << 7) + bv * BRICK_SIZE, BRICK_SIZE);
+    collapse(b);
+  }
+}
+
+void SparseColorTable::bake(unsigned char* table) const {
+  for(int b = 0; b < NUM_BRICKS; b++) {
+    int by = b / (BRICKS_PER_AXIS * BRICKS_PER_AXIS), bu = b / BRICKS_PER_AXIS % BRICKS_PER_AXIS, bv = b % BRICKS_PER_AXIS;
+    const unsigned char* cells = dense_[b] < 0 ? NULL : &pool_[dense_[b] * BRICK_CELLS];
+    for(int y = 0; y < BRICK_SIZE; y++) {
+      for(int u = 0; u < BRICK_SIZE; u++) {
+        unsigned char* row = table + ((by * BRICK_SIZE + y) << 14) + ((bu * BRICK_SIZE + u) << 7) + bv * BRICK_SIZE;
+        if(cells) memcpy(row, cells + cellIndex(y, u, 0), BRICK_SIZE);
+        else memset(row, uniform_[b], BRICK_SIZE);
+      }
+    }
+  }
+}
+
+Color SparseColorTable::get(int y, int u, int v) const {
+  y >>= 1; u >>= 1; v >>= 1;
+  int b = brickIndex(y, u, v);
+  if(dense_[b] < 0) return (Color)uniform_[b];
+  return (Color)pool_[dense_[b] * BRICK_CELLS + cellIndex(y, u, v)];
+}
+
+void SparseColorTable::assign(int y, int u, int v, Color c) {
+  y >>= 1; u >>= 1; v >>= 1;
+  int b = brickIndex(y, u, v);
+  if(dense_[b] < 0 && uniform_[b] == c) return;
+  densify(b)[cellIndex(y, u, v)] = c;
+}
+
+void SparseColorTable::assign(int y, int u, int v, Color c, int yrad, int urad, int vrad, bool ignorePreviousAssignments) {
+  // The box is given in 8 bit YUV, the table holds 7 bit cells
+  int y1 = std::max(0, y - yrad), y2 = std::min(255, y + yrad);
+  int u1 = std::max(0, u - urad), u2 = std::min(255, u + urad);
+  int v1 = std::max(0, v - vrad), v2 = std::min(255, v + vrad);
+  if(y1 > y2 || u1 > u2 || v1 > v2) return;
+  y1 >>= 1; y2 >>= 1; u1 >>= 1; u2 >>= 1; v1 >>= 1; v2 >>= 1;
+  for(int by = y1 >> BRICK_BITS; by <= y2 >> BRICK_BITS; by++) {
+    for(int bu = u1 >> BRICK_BITS; bu <= u2 >> BRICK_BITS; bu++) {
+      for(int bv = v1 >> BRICK_BITS; bv <= v2 >> BRICK_BITS; bv++) {
+        int b = (by * BRICKS_PER_AXIS + bu) * BRICKS_PER_AXIS + bv;
+        int oy = by << BRICK_BITS, ou = bu << BRICK_BITS, ov = bv << BRICK_BITS;
+        fill(b,
+          std::max(y1, oy) - oy, std::min(y2, oy + BRICK_SIZE - 1) - oy,
+          std::max(u1, ou) - ou, std::min(u2, ou + BRICK_SIZE - 1) - ou,
+          std::max(v1, ov) - ov, std::min(v2, ov + BRICK_SIZE - 1) - ov,
+          c, ignorePreviousAssignments);
+      }
+    }
+  }
+}
+
+void SparseColorTable::fill(int brick, int y1, int y2, int u1, int u2, int v1, int v2, Color c, bool ignorePreviousAssignments) {
+  bool full = y1 == 0 && u1 == 0 && v1 == 0 && y2 == BRICK_SIZE - 1 && u2 == BRICK_SIZE - 1 && v2 == BRICK_SIZE - 1;
+  if(dense_[brick] < 0) {
+    unsigned char current = uniform_[brick];
+    if(current == c) return;
+    if(!ignorePreviousAssignments && current != c_UNDEFINED) return;
+    if(full) {
+      uniform_[brick] = c;
+      return;
+    }
+  }
+  unsigned char* cells = densify(brick);
+  for(int y = y1; y <= y2; y++) {
+    for(int u = u1; u <= u2; u++) {
+      unsigned char* cell = cells + cellIndex(y, u, v1);
+      for(int v = v1; v <= v2; v++, cell++)
+        if(ignorePreviousAssignments || *cell == c_UNDEFINED)
+          *cell = c;
+    }
+  }
+  if(full) collapse(brick);
+}
+
+void SparseColorTable::clearColors(int flags) {
+  for(int b = 0; b < NUM_BRICKS; b++) {
+    if(dense_[b] < 0) {
+      if(isInFlags(uniform_[b], flags)) uniform_[b] = c_UNDEFINED;
+      continue;
+    }
+    unsigned char* cells = &pool_[dense_[b] * BRICK_CELLS];
+    for(int i = 0; i < BRICK_CELLS; i++)
+      if(isInFlags(cells[i], flags)) cells[i] = c_UNDEFINED;
+    collapse(b);
+  }
+}
+
+int SparseColorTable::denseBricks() const {
+  int count = 0;
+  for(int b = 0; b < NUM_BRICKS; b++)
+    if(dense_[b] >= 0) count++;
+  return count;
+}
+
+bool SparseColorTable::serialize(std::vector<unsigned char>& data) const {
+  data.assign(MAGIC, MAGIC + sizeof(MAGIC));
+  data.push_back(VERSION);
+  data.push_back(BRICK_BITS);
+  data.push_back(0);
+  data.push_back(0);
+  for(int b = 0; b < NUM_BRICKS; b++) {
+    if(dense_[b] < 0) {
+      if(uniform_[b] >= DENSE_TAG) return false;
+      data.push_back(uniform_[b]);
+      continue;
+    }
+    data.push_back(DENSE_TAG);
+    const unsigned char* cells = &pool_[dense_[b] * BRICK_CELLS];
+    for(int i = 0; i < BRICK_CELLS; ) {
+      int count = 1;
+      while(i + count < BRICK_CELLS && count < 255 && cells[i + count] == cells[i]) count++;
+      data.push_back(count);
+      data.push_back(cells[i]);
+      i += count;
+    }
+  }
+  return true;
+}
+
+bool SparseColorTable::deserialize(const unsigned char* data, int size) {
+  if(size < HEADER_SIZE || memcmp(data, MAGIC, sizeof(MAGIC)) != 0) return false;
+  if(data[4] != VERSION || data[5] != BRICK_BITS) return false;
+  clear();
+  int pos = HEADER_SIZE;
+  for(int b = 0; b < NUM_BRICKS; b++) {
+    if(pos >= size) return false;
+    unsigned char tag = data[pos++];
+    if(tag != DENSE_TAG) {
+      uniform_[b] = tag;
+      continue;
+    }
+    unsigned char* cells = densify(b);
+    for(int i = 0; i < BRICK_CELLS; ) {
+      if(pos + 2 > size) return false;
+      int count = data[pos], color = data[pos + 1];
+      pos += 2;
+      if(count == 0 || i + count > BRICK_CELLS) return false;
+      memset(cells + i, color, count);
+      i += count;
+    }
+  }
+  return true;
+}
+
+bool SparseColorTable::write(const std::string& file) const {
+  std::vector<unsigned char> data;
+  if(!serialize(data)) return false;
+  FILE* f = fopen(file.c_str(), "wb");
+  if(f == NULL) return false;
+  bool ok = fwrite(&data[0], data.size(), 1, f) == 1;
+  fclose(f);
+  return ok;
+}
+
+static bool readFile(const std::string& file, std::vector<unsigned char>& data) {
+  FILE* f = fopen(file.c_str(), "rb");
+  if(f == NULL) return false;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  data.resize(size);
+  bool ok = size > 0 && fread(&data[0], size, 1, f) == 1;
+  fclose(f);
+  return ok;
+}
+
+bool SparseColorTable::read(const std::string& file) {
+  std::vector<unsigned char> data;
+  if(!readFile(file, data)) return false;
+  if(deserialize(&data[0], data.size())) return true;
+  // Fall back to the raw table format
+  if(data.size() < LUT_SIZE) return false;
+  fromDense(&data[0]);
+  return true;
+}
+
+bool SparseColorTable::readTable(const std::string& file, unsigned char* table) {
+  std::vector<unsigned char> data;
+  if(!readFile(file, data)) return false;
+  if(data.size() >= sizeof(MAGIC) && memcmp(&data[0], MAGIC, sizeof(MAGIC)) == 0) {
+    SparseColorTable sparse;
+    if(!sparse.deserialize(&data[0], data.size())) return false;
+    sparse.bake(table);
+    return true;
+  }
+  if(data.size() < LUT_SIZE) return false;
+  memcpy(table, &data[0], LUT_SIZE);
+  return true;
+}
+
+bool SparseColorTable::writeTable(const std::string& file, const unsigned char* table) {
+  SparseColorTable sparse;
+  sparse.fromDense(table);
+  return sparse.write(file);
+}
@@ -0,0 +1,69 @@
+#ifndef SPARSE_COLOR_TABLE_H
+#define SPARSE_COLOR_TABLE_H
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include <common/RobotInfo.h>
+#include <vision/enums/Colors.h>
+
+/// @ingroup vision
+/* Editable color table. The 128^3 table cells are split into 8^3 bricks, each of
+ * which is either a single color or a dense 512 cell block. Most of the table is
+ * one color, so edits over large radii mostly touch uniform bricks in O(1), and the
+ * bricks double as a compact file format. bake() writes out the dense LUT_SIZE
+ * table that ColorTableMethods and the classifier use. */
+class SparseColorTable {
+  public:
+    static const int BRICK_BITS = 3;
+    static const int BRICK_SIZE = 1 << BRICK_BITS;
+    static const int BRICK_CELLS = BRICK_SIZE * BRICK_SIZE * BRICK_SIZE;
+    static const int BRICKS_PER_AXIS = 128 / BRICK_SIZE;
+    static const int NUM_BRICKS = BRICKS_PER_AXIS * BRICKS_PER_AXIS * BRICKS_PER_AXIS;
+
+    SparseColorTable();
+
+    void clear(Color c = c_UNDEFINED);
+    void fromDense(const unsigned char* table);
+    void bake(unsigned char* table) const;
+
+    Color get(int y, int u, int v) const;
+    void assign(int y, int u, int v, Color c);
+    // Same semantics as ColorTableMethods::assignColor with radii
+    void assign(int y, int u, int v, Color c, int yrad, int urad, int vrad, bool ignorePreviousAssignments = false);
+    // Sets every cell whose color is in flags back to c_UNDEFINED
+    void clearColors(int flags);
+
+    int denseBricks() const;
+
+    bool write(const std::string& file) const;
+    bool read(const std::string& file);
+
+    // Reads either a compressed table or a raw LUT_SIZE one into a dense table
+    static bool readTable(const std::string& file, unsigned char* table);
+    static bool writeTable(const std::string& file, const unsigned char* table);
+
+  private:
+    static inline int brickIndex(int y, int u, int v) {
+      return ((y >> BRICK_BITS) * BRICKS_PER_AXIS + (u >> BRICK_BITS)) * BRICKS_PER_AXIS + (v >> BRICK_BITS);
+    }
+    static inline int cellIndex(int y, int u, int v) {
+      return ((y & (BRICK_SIZE - 1)) << (2 * BRICK_BITS)) | ((u & (BRICK_SIZE - 1)) << BRICK_BITS) | (v & (BRICK_SIZE - 1));
+    }
+
+    unsigned char* densify(int brick);
+    void release(int brick);
+    void collapse(int brick);
+    void fill(int brick, int y1, int y2, int u1, int u2, int v1, int v2, Color c, bool ignorePreviousAssignments);
+    bool serialize(std::vector<unsigned char>& data) const;
+    bool deserialize(const unsigned char* data, int size);
+
+    // Cell color of uniform bricks, or NO_COLOR when the brick has a dense block
+    static const unsigned char NO_COLOR = 0xFF;
+    unsigned char uniform_[NUM_BRICKS];
+    int dense_[NUM_BRICKS];
+    std::vector<unsigned char> pool_;
+    std::vector<int> free_;
+};
+
+#endif
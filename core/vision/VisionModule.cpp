@@ -9,6 +9,9 @@
 #include <memory/CameraBlock.h>
 #include <memory/WorldObjectBlock.h>
 #include <memory/RobotInfoBlock.h>
+#include <common/WorkerPool.h>
+#include <common/RobotConfig.h>
+#include <vision/SparseColorTable.h>
 
 #include <boost/lexical_cast.hpp>
 
@@ -41,6 +44,7 @@ void VisionModule::specifyMemoryBlocks() {
   getOrAddMemoryBlock(camera_info_,"camera_info");
   getOrAddMemoryBlock(game_state_, "game_state");
   getOrAddMemoryBlock(robot_info_,"robot_info");
+  top_world_objects_ = bottom_world_objects_ = world_objects_;
   *top_params_ = image_->top_params_;
   *bottom_params_ = image_->bottom_params_;
 }
@@ -57,15 +61,64 @@ bool VisionModule::areFeetOnGround() {
 void VisionModule::processFrame() {
   // reset world objects
   world_objects_->reset();
-  printf("processing vision frame\n");
+  top_world_objects_ = bottom_world_objects_ = world_objects_;
+  visionLog((30, "Processing vision frame"));
   if(!areFeetOnGround()) {
     return;
   }
-  visionLog((30, "Processing bottom camera"));
-  bottom_processor_->processFrame();
+  if(parallel_cameras_) {
+    processCamerasParallel();
+  } else {
+    visionLog((30, "Processing bottom camera"));
+    bottom_timer_.start();
+    bottom_processor_->processFrame();
+    bottom_timer_.stop();
+
+    visionLog((30, "Processing top camera"));
+    top_timer_.start();
+    top_processor_->processFrame();
+    top_timer_.stop();
+  }
+  robot_vision_->horizon = top_processor_->getHorizon();
+  visionLog((30, "Camera times: bottom %2.2fms, top %2.2fms", bottom_timer_.lasttime() * 1000, top_timer_.lasttime() * 1000));
+  bottom_timer_.printAtInterval();
+  top_timer_.printAtInterval();
+}
+
+void VisionModule::processCamerasParallel() {
+  *bottom_staging_ = *world_objects_;
+  *top_staging_ = *world_objects_;
+  bottom_world_objects_ = bottom_staging_;
+  top_world_objects_ = top_staging_;
+
+  std::vector<WorkerPool::Job> jobs;
+  jobs.push_back([this] {
+    bottom_timer_.start();
+    bottom_processor_->processFrame();
+    bottom_timer_.stop();
+  });
+  jobs.push_back([this] {
+    top_timer_.start();
+    top_processor_->processFrame();
+    top_timer_.stop();
+  });
+  visionLog((30, "Processing bottom and top cameras in parallel"));
+  pool_->run(jobs);
+
+  // Publish in the serial order, so the top camera overwrites anything the bottom camera also saw
+  top_world_objects_ = bottom_world_objects_ = world_objects_;
+  for(int i = 0; i < NUM_WORLD_OBJS; i++) {
+    if(bottom_staging_->objects_[i].seen)
+      world_objects_->objects_[i] = bottom_staging_->objects_[i];
+    if(top_staging_->objects_[i].seen)
+      world_objects_->objects_[i] = top_staging_->objects_[i];
+  }
+}
 
-  visionLog((30, "Processing top camera"));
-  top_processor_->processFrame();
+void VisionModule::setParallelCameras(bool value) {
+  if(value && !pool_)
+    pool_ = new WorkerPool(1);
+  parallel_cameras_ = value;
 }
 
 void VisionModule::updateTransforms() {
@@ -88,13 +141,20 @@ int VisionModule::getRobotId() {
 void VisionModule::initSpecificModule() {
   loadColorTables();
   if(top_processor_) delete top_processor_;
-  top_processor_ = new ImageProcessor(*vblocks_, *top_params_, Camera::TOP);
+  top_processor_ = new ImageProcessor(*top_vblocks_, *top_params_, Camera::TOP);
   if(bottom_processor_) delete bottom_processor_;
-  bottom_processor_ = new ImageProcessor(*vblocks_, *bottom_params_, Camera::BOTTOM);
+  bottom_processor_ = new ImageProcessor(*bottom_vblocks_, *bottom_params_, Camera::BOTTOM);
   top_processor_->SetColorTable(topColorTable);
   bottom_processor_->SetColorTable(bottomColorTable);
   top_processor_->init(textlogger);
   bottom_processor_->init(textlogger);
+  RobotConfig config;
+  config.loadFromFile(getDataBase() + "config.yaml");
+  top_processor_->enableClassificationScheduler(config.vision_scheduler);
+  bottom_processor_->enableClassificationScheduler(config.vision_scheduler);
+  setParallelCameras(config.vision_parallel_cameras);
+  visionLog((20, "Classification scheduler %s, cameras %s", config.vision_scheduler ? "on" : "off",
+    config.vision_parallel_cameras ? "in parallel" : "one after the other"));
   if(robot_state_->WO_SELF == WO_TEAM_COACH) {
     top_params_->defaultHorizontalStepScale = 0;
     top_params_->defaultVerticalStepScale = 0;
@@ -117,6 +177,17 @@ VisionModule::VisionModule() {
   top_processor_ = bottom_processor_ = NULL;
 
   vblocks_ = new VisionBlocks(world_objects_, body_model_, joint_angles_, image_, robot_vision_, vision_frame_info_, robot_state_, robot_info_, sensors_, game_state_);
+  top_world_objects_ = bottom_world_objects_ = NULL;
+  top_vblocks_ = new VisionBlocks(top_world_objects_, body_model_, joint_angles_, image_, robot_vision_, vision_frame_info_, robot_state_, robot_info_, sensors_, game_state_);
+  bottom_vblocks_ = new VisionBlocks(bottom_world_objects_, body_model_, joint_angles_, image_, robot_vision_, vision_frame_info_, robot_state_, robot_info_, sensors_, game_state_);
+  top_staging_ = new WorldObjectBlock();
+  bottom_staging_ = new WorldObjectBlock();
+  pool_ = NULL;
+  parallel_cameras_ = false;
+  top_timer_.setMessage("Vision top camera");
+  bottom_timer_.setMessage("Vision bottom camera");
+  top_timer_.setInterval(30 * 5);
+  bottom_timer_.setInterval(30 * 5);
 
 
   puts(" Done!");
@@ -129,6 +200,11 @@ VisionModule::~VisionModule() {
   delete [] bottomColorTable;
   if(top_processor_) delete top_processor_;
   if(bottom_processor_) delete bottom_processor_;
+  if(pool_) delete pool_;
+  delete top_staging_;
+  delete bottom_staging_;
+  delete top_vblocks_;
+  delete bottom_vblocks_;
 }
 
 bool VisionModule::loadColorTables() {
@@ -194,15 +270,13 @@ bool VisionModule::loadColorTable(Camera::Type camera, std::string fileName, boo
     colorTableName = fileName;
   }
 
-  FILE* f=fopen(colorTableName.c_str(), "rb");
-  if (f==NULL) {
+  // Handles both compressed and raw tables
+  if (!SparseColorTable::readTable(colorTableName, colorTable)) {
     std::cout << "Vision: *** ERROR can't load " << colorTableName << " *** for camera " << camera << std::endl << std::flush;
     colorTableName = "none";
     return false;
   }
   std::cout << "Vision: Loaded " << colorTableName << " ! for camera " << camera << std::endl << std::flush;
-  bool ok = fread(colorTable,LUT_SIZE,1,f);
-  fclose(f);
 
   if (camera==Camera::TOP) {
     topColorTableName = colorTableName;
@@ -210,5 +284,5 @@ bool VisionModule::loadColorTable(Camera::Type camera, std::string fileName, boo
     bottomColorTableName = colorTableName;
   }
 
- return ok;
+ return true;
 }
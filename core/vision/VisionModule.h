@@ -17,6 +17,7 @@ class BodyModelBlock;
 class CameraBlock;
 class RobotInfoBlock;
 class GameStateBlock;
+class WorkerPool;
 
 /// @ingroup vision
 class VisionModule: public Module {
@@ -31,6 +32,8 @@ public:
   void processFrame();
   void updateTransforms();
 
+  void setParallelCameras(bool value);
+
   bool loadColorTables();
   bool loadColorTable(Camera::Type camera, std::string fileName, bool fullpath=false);
 
@@ -57,6 +60,16 @@ private:
 
   VisionBlocks* vblocks_;
 
+  // Each camera sees world_objects_ through its own pointer so the parallel
+  // pipeline can point them at private copies while the cameras run
+  WorldObjectBlock *top_world_objects_, *bottom_world_objects_;
+  WorldObjectBlock *top_staging_, *bottom_staging_;
+  VisionBlocks *top_vblocks_, *bottom_vblocks_;
+  WorkerPool* pool_;
+  bool parallel_cameras_;
+  Timer top_timer_, bottom_timer_;
+
+  void processCamerasParallel();
   bool isBottomCamera();
   bool useSimColorTable();
   std::string getDataBase();
@@ -2,6 +2,7 @@
 #define BLOB_H
 
 #include <constants/VisionConstants.h>
+#include <vision/enums/Colors.h>
 #include <vector>
 #include <inttypes.h>
 
@@ -20,6 +21,8 @@ struct Blob {
   float avgWidth;
   float correctPixelRatio;
   bool invalid;
+  Color color;
+  uint32_t pixelCount;
 
   // GOAL DETECTION
   int edgeSize;
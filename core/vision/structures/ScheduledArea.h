@@ -0,0 +1,24 @@
+#ifndef SCHEDULED_AREA_H
+#define SCHEDULED_AREA_H
+
+#include <vision/structures/FocusArea.h>
+
+/// @ingroup vision
+/* A region of the image to classify at a fixed stride. Sampled pixels lie on the
+ * global (hstep, vstep) grid so overlapping areas with equal strides agree. */
+struct ScheduledArea {
+  FocusArea area;
+  int hstep, vstep;
+
+  ScheduledArea(const FocusArea& area, int hstep, int vstep) : area(area), hstep(hstep), vstep(vstep) { }
+
+  inline int firstX() const { return area.x1 + (hstep - area.x1 % hstep) % hstep; }
+  inline int firstY() const { return area.y1 + (vstep - area.y1 % vstep) % vstep; }
+  inline int pixels() const {
+    int x = firstX(), y = firstY();
+    if(x > area.x2 || y > area.y2) return 0;
+    return ((area.x2 - x) / hstep + 1) * ((area.y2 - y) / vstep + 1);
+  }
+};
+
+#endif
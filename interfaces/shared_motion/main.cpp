@@ -55,7 +55,8 @@ int main(int argc, char* argv[]) {
   FrameInfoBlock *frame_info;
   core->memory_.getOrAddBlockByName(frame_info,"frame_info");
   WalkRequestBlock *walk_request;
-  core->memory_.getOrAddBlockByName(walk_request,"sync_walk_request",MemoryOwner::SYNC);
+  // vision is the only writer of sync_walk_request, motion holds its own request until vision sends a new one
+  core->memory_.getOrAddBlockByName(walk_request,"walk_request");
 
   core->memory_.setBlockLogging("frame_info",true);
   //core->memory_.setBlockLogging("body_model",true);
@@ -60,18 +60,15 @@ void ClassificationWidget::generateColorTable() {
   std::cout << "Generating color table...";
   ImageProcessor* processor = (currentCamera_ == Camera::TOP ? topProcessor_ : bottomProcessor_);
   unsigned char* colorTable = processor->getColorTable();
-  unsigned char original[LUT_SIZE];
+  std::vector<unsigned char> original(colorTable, colorTable + LUT_SIZE);
   int width = processor->getImageWidth();
-  memcpy(original, colorTable, LUT_SIZE);
-  for(int y = 0; y < 256; y+=2) {
-    for(int u = 0; u < 256; u+=2) {
-      for(int v = 0; v < 256; v+=2) {
-        Color assignment = ColorTableMethods::yuv2color(colorTable, y, u, v);
-        if(generateForColor(assignment))
-          ColorTableMethods::assignColor(colorTable, y, u, v, c_UNDEFINED);
-      }
-    }
-  }
+  // Edit the sparse table and bake it into the processor's table once at the end
+  SparseColorTable table;
+  table.fromDense(colorTable);
+  table.clearColors(flags);
+  // Repeating a (yuv, color) assignment changes nothing, so each is only applied once.
+  // Keyed on the full 8 bit yuv since the radius box is placed before halving.
+  std::vector<unsigned char> applied(1 << 24, 0);
   int yrad = yradius->value(), urad = uradius->value(), vrad = vradius->value();
   std::vector<unsigned char*> images = (currentCamera_ == Camera::TOP ? log_->getRawTopImages() : log_->getRawBottomImages());
   std::vector<ImageParams> iparams = (currentCamera_ == Camera::TOP ? log_->getTopParams() : log_->getBottomParams());
@@ -90,13 +87,19 @@ void ClassificationWidget::generateColorTable() {
       for(int j=0; j < pcount; j++){
         Point p = points[j];
         if(p.x >= iparams[frame].width || p.y >= iparams[frame].height) continue;
-        Color current = ColorTableMethods::xy2color(image, original, p.x, p.y, width);
+        int yy, u, v;
+        ColorTableMethods::xy2yuv(image, p.x, p.y, width, yy, u, v);
+        Color current = ColorTableMethods::yuv2color(&original[0], yy, u, v);
         if(!generateForColor(current)) continue;
-        ColorTableMethods::assignColor(image, colorTable, p.x, p.y, width, c, yrad, urad, vrad);
+        unsigned char& sample = applied[(yy << 16) + (u << 8) + v];
+        if(sample & (1 << c)) continue;
+        sample |= 1 << c;
+        table.assign(yy, u, v, c, yrad, urad, vrad);
       }
     }
   }
   for(auto image : images) delete image;
+  table.bake(colorTable);
   std::cout << "done\n";
   emit colorTableGenerated();
 }
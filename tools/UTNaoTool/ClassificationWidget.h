@@ -6,6 +6,7 @@
 
 #include <vision/VisionModule.h>
 #include <vision/ColorTableMethods.h>
+#include <vision/SparseColorTable.h>
 #include <memory/Log.h>
 
 #include "annotations/Annotation.h"
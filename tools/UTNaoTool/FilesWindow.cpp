@@ -7,7 +7,7 @@
 
 using namespace std;
 
-FilesWindow::FilesWindow(QMainWindow* p) : ConfigWindow(p) {
+FilesWindow::FilesWindow(QMainWindow* p) : ConfigWindow(p), traceUDP(NULL) {
   setupUi(this);
   setWindowTitle(tr("Files Window"));
   basePath = QString(getenv("NAO_HOME")) + "/";
@@ -96,6 +96,7 @@ FilesWindow::FilesWindow(QMainWindow* p) : ConfigWindow(p) {
   connect (locationBox, SIGNAL(currentIndexChanged(int)), this, SLOT(locationChanged(int)));
   connect (resetTopButton, SIGNAL(clicked()), this, SLOT(resetTopCamera()));
   connect (resetBottomButton, SIGNAL(clicked()), this, SLOT(resetBottomCamera()));
+  connect (motionTraceButton, SIGNAL(clicked()), this, SLOT(dumpMotionTrace()));
 
   connect (stopNaoqiButton, SIGNAL(clicked()), this, SLOT(stopNaoqi()));
   connect (startNaoqiButton, SIGNAL(clicked()), this, SLOT(startNaoqi()));
@@ -201,6 +202,27 @@ void FilesWindow::resetBottomCamera() {
   ((UTMainWnd*)parent)->sendUDPCommand(locationBox->currentText(), ToolPacket::ResetCameraParameters);
 }
 
+void FilesWindow::dumpMotionTrace() {
+  // the report comes back from vision once motion has published it
+  QString address = locationBox->currentText();
+  if (traceUDP != NULL)
+    delete traceUDP;
+  traceUDP = new UDPWrapper(CommInfo::TOOL_UDP_PORT, false, address.toStdString().c_str(), UDPWrapper::Inbound);
+  traceUDP->startListenThread(FilesWindow::listenMotionTrace, this);
+  ((UTMainWnd*)parent)->sendUDPCommand(address, ToolPacket::MotionTraceDump);
+}
+
+void FilesWindow::listenMotionTrace(void* arg) {
+  FilesWindow* window = reinterpret_cast<FilesWindow*>(arg);
+  ToolPacket tp;
+  bool res = window->traceUDP->recv(tp);
+  if(!res) return;
+  if(tp.message == ToolPacket::MotionTraceDump) {
+    tp.data[ToolPacket::DATA_LENGTH - 1] = 0;
+    printf("Motion latency on %s:\n%s", window->traceUDP->senderAddress().to_string().c_str(), tp.data);
+  }
+}
+
 void FilesWindow::stopNaoqi() {
   naoqiCommand("stop");
 }
@@ -513,6 +535,7 @@ void FilesWindow::enableButtons(bool b){
   restartNaoQiButton->setEnabled(b);
   stopNaoqiButton->setEnabled(b);
   startNaoqiButton->setEnabled(b);
+  motionTraceButton->setEnabled(b);
 
   upVisionButton->setEnabled(b);
   upMotionButton->setEnabled(b);
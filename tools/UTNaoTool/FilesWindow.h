@@ -8,6 +8,7 @@
 #include <QDateTime>
 #include <QPalette>
 #include <common/RobotConfig.h>
+#include <communications/UDPWrapper.h>
 
 #include <tool/ProcessExecutor.h>
 #include <tool/ConfigWindow.h>
@@ -18,6 +19,8 @@ class FilesWindow : public ConfigWindow, public Ui_UTFilesWindow {
   private:
    ProcessExecutor executor_;
    ProcessExecutor::Callback getStatusCallback(QString message);
+   UDPWrapper* traceUDP;
+   static void listenMotionTrace(void*);
 
   public:
     FilesWindow(QMainWindow* pa);
@@ -66,6 +69,7 @@ class FilesWindow : public ConfigWindow, public Ui_UTFilesWindow {
 
     void resetTopCamera();
     void resetBottomCamera();
+    void dumpMotionTrace();
 
     void sendLua(bool verbose = true);
     void verifyLua(bool verbose = true);
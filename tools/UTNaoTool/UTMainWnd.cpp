@@ -242,19 +242,17 @@ void UTMainWnd::processStream(socket_ptr sock) {
         return;
       }
       ret = boost::asio::read(*sock,boost::asio::buffer(&stream_msg_.data_,send_len - 2 * expected_len));
-      char *msg = (char*)stream_msg_.postReceive(ret);
-      if (msg == NULL) {
+      BufferSpan msg = stream_msg_.postReceive(ret);
+      if (msg.data == NULL) {
         std::cout << "Invalid tcp message" << std::endl << std::flush;
         return;
       }
-      StreamBuffer sb(msg, stream_msg_.orig_len_);
-      LogReader stream_reader(sb);
+      LogReader stream_reader(msg);
       bool res = stream_reader.readMemory(stream_memory_);
       if (!res) {
         std::cout << "Problem reading memory from tcp message" << std::endl;
         return;
       }
-      delete []msg;
       emit newStreamFrame();
 
       // Log the stream
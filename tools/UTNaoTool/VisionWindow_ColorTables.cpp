@@ -1,4 +1,5 @@
 #include <VisionWindow.h>
+#include <vision/SparseColorTable.h>
 
 void VisionWindow::bottomNewTable() {
   newTable(Camera::BOTTOM);
@@ -69,9 +70,10 @@ void VisionWindow::writeTable(Camera::Type camera, std::string fileName) {
     displayMessage += "Bottom Table";
   }
 
-  FILE* f = fopen(fileName.c_str(), "wb");
-  fwrite(colorTable, LUT_SIZE, 1, f);
-  fclose(f);
+  if(!SparseColorTable::writeTable(fileName, colorTable)) {
+    std::cout << "Failed to write " << displayMessage << " to file: " << fileName << std::endl;
+    return;
+  }
 
   displayMessage = "Wrote " + displayMessage + "to file: " + std::string(fileName);
   std::cout << displayMessage << std::endl;
@@ -53,6 +53,7 @@ BehaviorSimulation::BehaviorSimulation(int n, bool penaltyKick, bool lMode) : lm
   simPenaltyKick = penaltyKick;
   nplayers = n;
   timeInc = 1.0/30.0;
+  behaviorPeriod_ = 1;
 
   // init our world object mem
   memory_ = new Memory(false, MemoryOwner::VISION, 0, 1);
@@ -573,12 +574,18 @@ void BehaviorSimulation::stepPlayerComm(int i) {
 }
 
 
+void BehaviorSimulation::setBehaviorPeriod(int frames) {
+  behaviorPeriod_ = std::max(frames, 1);
+}
+
 void BehaviorSimulation::simulationStep(){
   std::string oldSimInfo = simInfo;
   simInfo = "";
 
+  double t = SimulationProfile::now();
   physics_.setObjects(worldObjects);
   physics_.step();
+  t = profile_.add(SimulationProfile::Physics, t);
   Point2D ballVel = worldObjects->objects_[WO_BALL].absVel;
   Point2D ballLoc = worldObjects->objects_[WO_BALL].loc;
   
@@ -591,6 +598,7 @@ void BehaviorSimulation::simulationStep(){
   // save new loc and vel back to wo
   worldObjects->objects_[WO_BALL].absVel = ballVel;
   worldObjects->objects_[WO_BALL].loc = ballLoc;
+  t = profile_.add(SimulationProfile::Rules, t);
 
 
   // step the simulation ahead
@@ -599,7 +607,12 @@ void BehaviorSimulation::simulationStep(){
       continue;
     stepPlayerFallen(i);
     stepPlayerBounds(i);
-    bool kicked = sims[i]->processFrame(worldObjects,gameState);
+    t = profile_.add(SimulationProfile::Rules, t);
+    // players think on staggered frames so the behavior load is spread evenly
+    bool think = (frameInfo->frame_id + i) % behaviorPeriod_ == 0;
+    if (think) profile_.behaviorFrames++;
+    bool kicked = sims[i]->processFrame(worldObjects,gameState,think,&profile_);
+    t = SimulationProfile::now();
     if (kicked)
       stepPlayerKick(i);
 
@@ -620,7 +633,9 @@ void BehaviorSimulation::simulationStep(){
       stepPlayerCollisions(i,robot);
       stepPlayerComm(i);
     }
+    t = profile_.add(SimulationProfile::Rules, t);
   } // simulate step for this robot
+  profile_.frames++;
 
   // keep old text around until we have new text
 #ifdef TOOL
@@ -10,6 +10,7 @@
 #include "SimulatedPlayer.h"
 #include "Simulation.h"
 #include "PhysicsSimulator.h"
+#include "SimulationProfile.h"
 
 class WorldObjectBlock;
 class GameStateBlock;
@@ -26,6 +27,10 @@ class BehaviorSimulation : public Simulation {
     ~BehaviorSimulation();
 
     void simulationStep();
+    // Runs the behaviors every period frames, players hold their last requests in between
+    void setBehaviorPeriod(int frames);
+    void setPhysicsSubsteps(int substeps) { physics_.setSubsteps(substeps); }
+    const SimulationProfile& profile() const { return profile_; }
     
     int defaultPlayer() { return activePlayers_[0]; }
     MemoryCache getGtMemoryCache(int player);
@@ -106,12 +111,14 @@ class BehaviorSimulation : public Simulation {
     bool simOn;
     int nplayers;
     float timeInc;
+    int behaviorPeriod_;
     bool PRINT;
 
     void setSimScore(bool blue);
 
     Memory* memory_;
     PhysicsSimulator physics_;
+    SimulationProfile profile_;
 };
 
 
@@ -1,8 +1,8 @@
 #ifndef COMMUNICATION_GENERATOR_H
 #define COMMUNICATION_GENERATOR_H
 
-#include <common/Random.h>
 #include <memory/MemoryCache.h>
+#include <vector>
 
 class CommunicationGenerator {
   public:
@@ -18,7 +18,6 @@ class CommunicationGenerator {
 
     MemoryCache gtcache_, bcache_;
     std::vector<MemoryCache> bcaches_;
-    Random rand_;
     int teamBroadcastFrame_, teamSilenceFrame_, coachframe_;
     bool teamMode_;
 };
@@ -2,6 +2,7 @@
 #include <localization/LocalizationModule.h>
 #include <common/File.h>
 #include <sstream>
+#include <time.h>
 
 #define SECONDS_PER_FRAME (1.0/30.0)
 #define RADS_PER_FRAME (DEG_T_RAD * 1.0)
@@ -15,6 +16,14 @@ const string PATH_DIR = string(getenv("NAO_HOME")) + "/data/paths";
 #define player_ 1
 #define team_ 0
 
+long (*LocalizationSimulation::allocationCount)() = NULL;
+
+static double cpuSeconds() {
+  timespec t;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
 LocalizationSimulation::LocalizationSimulation(string pathfile) : iparams_(Camera::TOP), cg_(team_, player_) {
   vector<LocSimAgent::Type> types = { LocSimAgent::Default };
   init(types);
@@ -253,8 +262,14 @@ void LocalizationSimulation::generateCommunications() {
 
 void LocalizationSimulation::processLocalizationFrame() {
   for(auto& kvp : agents_) {
-    auto& core = kvp.second.core;
-    core->localization_->processFrame();
+    auto& agent = kvp.second;
+    long allocations = allocationCount ? allocationCount() : 0;
+    double start = cpuSeconds();
+    agent.core->localization_->processFrame();
+    double elapsed = cpuSeconds() - start;
+    agent.cpuTime += elapsed;
+    agent.maxCpuTime = max(agent.maxCpuTime, elapsed);
+    if(allocationCount) agent.allocations += allocationCount() - allocations;
   }
 }
 
@@ -268,14 +283,18 @@ AgentError LocalizationSimulation::getError(LocSimAgent::Type type) {
   e.dist = sqrtf(agent.distError/agent.steps);
   e.rot = sqrtf(agent.rotError/agent.steps);
   e.steps = agent.steps;
+  e.cpu = 1000 * agent.cpuTime / agent.steps;
+  e.maxCpu = 1000 * agent.maxCpuTime;
+  e.allocations = (float)agent.allocations / agent.steps;
   return e;
 }
 
 void LocalizationSimulation::printError() {
   for(auto& kvp : agents_) {
     auto& agent = kvp.second;
-    fprintf(stderr, "%s RMSE dist error: %2.2f, rot error: %2.2f, steps: %i\n",
-      agent.name.c_str(), sqrtf(agent.distError / agent.steps), sqrtf(agent.rotError / agent.steps), agent.steps);
+    fprintf(stderr, "%s RMSE dist error: %2.2f, rot error: %2.2f, steps: %i, cpu: %2.3f ms/frame\n",
+      agent.name.c_str(), sqrtf(agent.distError / agent.steps), sqrtf(agent.rotError / agent.steps), agent.steps,
+      1000 * agent.cpuTime / agent.steps);
   }
 }
 
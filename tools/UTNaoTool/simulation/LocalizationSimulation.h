@@ -15,24 +15,34 @@ struct AgentError {
   float dist;
   float rot;
   float steps;
-  AgentError() : dist(0), rot(0), steps(0) {}
+  // localization cost, mean and worst cpu ms per frame and heap allocations per frame
+  float cpu;
+  float maxCpu;
+  float allocations;
+  AgentError() : dist(0), rot(0), steps(0), cpu(0), maxCpu(0), allocations(0) {}
   static AgentError average(std::vector<AgentError> errors) {
     AgentError error;
     for(auto e : errors) {
       error.dist += e.dist;
       error.rot += e.rot;
       error.steps += e.steps;
+      error.cpu += e.cpu;
+      error.maxCpu = std::max(error.maxCpu, e.maxCpu);
+      error.allocations += e.allocations;
     }
     error.dist /= errors.size();
     error.rot /= errors.size();
     error.steps /= errors.size();
+    error.cpu /= errors.size();
+    error.allocations /= errors.size();
     return error;
   }
 };
 
 struct LocSimAgent {
   enum Type {
-    Default = 0
+    Default = 0,
+    Particle = 1
   };
   LocalizationMethod::Type method;
   MemoryCache cache;
@@ -40,6 +50,8 @@ struct LocSimAgent {
   float distError;
   float rotError;
   int steps;
+  double cpuTime, maxCpuTime;
+  long allocations;
   Type type;
   std::string name;
   float distRMSE() { return sqrtf(distError / steps); }
@@ -50,8 +62,14 @@ struct LocSimAgent {
         method = LocalizationMethod::Default;
         name = "Default";
         break;
+      case Particle:
+        method = LocalizationMethod::Particle;
+        name = "Particle";
+        break;
     }
     distError = rotError = 0;
+    cpuTime = maxCpuTime = 0;
+    allocations = 0;
   }
 };
 
@@ -76,6 +94,10 @@ class LocalizationSimulation : public Simulation {
     void printError();
     void flip();
     void outputBadPaths(float maxDistError, float maxRotError);
+
+    // Heap allocations so far, set by programs that count them to have each
+    // localization frame's allocations recorded
+    static long (*allocationCount)();
   private:
     int ballmove_;
     std::map<LocSimAgent::Type, LocSimAgent> agents_;
@@ -11,10 +11,11 @@
   auto& gt = gt_object_->objects_[idx]; \
   auto& obs = obs_object_->objects_[idx];
 
-#define getSelf(gt,obs,idx) getObject(gt,obs,team_ == TEAM_RED ? idx + WO_TEAM_LAST : idx)
+// player_ is already the global index, red robots included
+#define getSelf(gt,obs,idx) getObject(gt,obs,idx)
 
 #define isVisible(idx) \
-  (fabs(normalizeAngle(gt_object_->objects_[player_].loc.getBearingTo(gt_object_->objects_[idx].loc, gt_object_->objects_[player_].orientation + joint_->values_[HeadPan]))) < FOVx/2.0)
+  (fabs(normalizeAngle(geometry_.bearing(player_, idx) - joint_->values_[HeadPan])) < FOVx/2.0)
 
 ObservationGenerator::ObservationGenerator() : iparams_(Camera::TOP) {
   obs_object_ = new WorldObjectBlock();
@@ -23,6 +24,7 @@ ObservationGenerator::ObservationGenerator() : iparams_(Camera::TOP) {
   opponent_mem_ = NULL;
   frame_info_ = NULL;
   joint_ = NULL;
+  player_ = team_ = -1;
 }
 
 ObservationGenerator::~ObservationGenerator() {
@@ -39,6 +41,9 @@ ObservationGenerator::ObservationGenerator(const ObservationGenerator& og) : ipa
 }
 
 void ObservationGenerator::setPlayer(int player, int team) {
+  // players set this every frame, so the stream only restarts for a new player
+  if(player != player_)
+    rand_ = Random::stream("observations", player);
   player_ = player;
   team_ = team;
 }
@@ -65,8 +70,8 @@ void ObservationGenerator::setInfoBlocks(FrameInfoBlock* frameInfo, JointBlock*
 void ObservationGenerator::generateBallObservations() {
   getSelf(gtSelf,obsSelf,player_);
   getObject(gtBall,obsBall,WO_BALL);
-  float bearing = gtSelf.loc.getBearingTo(gtBall.loc,gtSelf.orientation);
-  float distance = gtSelf.loc.getDistanceTo(gtBall.loc);
+  float bearing = geometry_.bearing(player_, WO_BALL);
+  float distance = geometry_.distance(player_, WO_BALL);
   if (isVisible(WO_BALL)) {
     float maxDist = 5500.f;
     // Sigmoid shape
@@ -75,16 +80,8 @@ void ObservationGenerator::generateBallObservations() {
     bool visible = true;
     if(distance > maxDist) visible = false;
     // check for other robots obstructing us
-    for (int j = WO_PLAYERS_FIRST; j <= WO_PLAYERS_LAST; j++){
-      if (player_ == j) continue;
-      auto& gtOther = gt_object_->objects_[j];
-      float otherBearing = gtSelf.loc.getBearingTo(gtOther.loc,gtSelf.orientation);
-      float otherDistance = gtSelf.loc.getDistanceTo(gtOther.loc);
-      if (otherDistance < distance && fabs(normalizeAngle(otherBearing - bearing)) < 4.0*DEG_T_RAD){
-        visible = false;
-        break;
-      }
-    }
+    if (geometry_.occluded(player_, bearing, distance, 4.0*DEG_T_RAD))
+      visible = false;
     gtBall.relVel = gtBall.absVel;
     gtBall.relVel.rotate(-gtSelf.orientation);
     if(fabs(gtBall.relVel.y) > 2000)
@@ -112,13 +109,13 @@ void ObservationGenerator::generateLineObservations() {
     if (seenLines >= 4) break;
     WorldObject& truthWO = gt_object_->objects_[i];
    
-    Line2D visionLine(gtSelf.loc, gtSelf.orientation);
-    Point2D point = truthWO.lineLoc.getSegmentIntersection(visionLine);
+    // where our heading meets the line, precomputed for every line at once
+    int line = i - WO_OPP_GOAL_LINE;
     int idx = WO_UNKNOWN_FIELD_LINE_1+seenLines;
     if(i == WO_CENTER_LINE) idx = WO_CENTER_LINE;
     auto& obsWO = obs_object_->objects_[idx];
-    float bearing = gtSelf.loc.getBearingTo(point, gtSelf.orientation);
-    float distance = gtSelf.loc.getDistanceTo(point);
+    float bearing = geometry_.lineBearing(player_, line);
+    float distance = geometry_.lineDistance(player_, line);
     float pan = joint_->values_[HeadPan];
     if (fabs(pan - bearing) > FOVx/2.0)
       continue;
@@ -153,24 +150,19 @@ void ObservationGenerator::generateLineObservations() {
       obsWO.imageCenterX = iparams_.width/2.0 + (diff / (FOVx/2.0) * iparams_.width/2.0);
       obsWO.imageCenterY = iparams_.height/2.0;
       obsWO.seen = true;
-      
-      
-      point = point.globalToRelative(gtSelf.loc, gtSelf.orientation);
     } // line was seen with random prob
   } // line loop
 }
 
 void ObservationGenerator::generateOpponentObservations() {
-  getSelf(gtSelf,obsSelf,player_);
   int firstOpp = 1;
   if (team_ == TEAM_BLUE) firstOpp += WO_TEAM_LAST;
   int oppSeen = 0;
   for (int i = 0; i < 4; i++){
-    WorldObject& truthWO = gt_object_->objects_[i+firstOpp];
-    float bearing = gtSelf.loc.getBearingTo(truthWO.loc,gtSelf.orientation);
-    float distance = gtSelf.loc.getDistanceTo(truthWO.loc);
+    float bearing = geometry_.bearing(player_, i+firstOpp);
+    float distance = geometry_.distance(player_, i+firstOpp);
 
-    auto& obsWO = obs_object_->objects_[5+oppSeen];
+    auto& obsWO = obs_object_->objects_[WO_OPPONENT_FIRST+oppSeen];
     // in FOV
     if (fabs(joint_->values_[HeadPan] - bearing) < FOVx/2.0){
       float missedObsRate = 1.0/5.0;
@@ -195,10 +187,9 @@ void ObservationGenerator::generateOpponentObservations() {
 }
 
 void ObservationGenerator::generateCenterCircleObservations() {
-  getSelf(gtSelf,obsSelf,player_);
-  getObject(gtCircle, obsCircle, WO_CENTER_CIRCLE);
-  float bearing = gtSelf.loc.getBearingTo(gtCircle.loc,gtSelf.orientation);
-  float distance = gtSelf.loc.getDistanceTo(gtCircle.loc);
+  auto& obsCircle = obs_object_->objects_[WO_CENTER_CIRCLE];
+  float bearing = geometry_.bearing(player_, WO_CENTER_CIRCLE);
+  float distance = geometry_.distance(player_, WO_CENTER_CIRCLE);
   if (isVisible(WO_CENTER_CIRCLE)) {
     float missedObsRate = 1.0/5.0;
     float randPct = rand_.sampleU();
@@ -219,13 +210,12 @@ void ObservationGenerator::generateCenterCircleObservations() {
 }
 
 void ObservationGenerator::generateGoalObservations() {
-  getSelf(gtSelf, obsSelf, player_);
   int seenPostCount = 0;
   int firstPost = 0;
   for (int i = WO_OWN_LEFT_GOALPOST; i <= WO_OPP_RIGHT_GOALPOST; i++){
-    getObject(gtPost, obsPost, i);
-    float bearing = gtSelf.loc.getBearingTo(gtPost.loc,gtSelf.orientation);
-    float distance = gtSelf.loc.getDistanceTo(gtPost.loc);
+    auto& obsPost = obs_object_->objects_[i];
+    float bearing = geometry_.bearing(player_, i);
+    float distance = geometry_.distance(player_, i);
     if(isVisible(i)) {
       float missedObsRate = 1.0/10.0;
       if (distance > 3000) 
@@ -303,6 +293,9 @@ void ObservationGenerator::generateGoalObservations() {
 
 void ObservationGenerator::generateAllObservations() {
   obs_object_->reset();
+  // Only this player's row: the simulation writes each robot's new pose back to the
+  // ground truth after its frame, so later players must see the table refreshed
+  geometry_.compute(gt_object_, player_);
   generateBallObservations();
   generateLineObservations();
   generateOpponentObservations();
@@ -404,12 +397,11 @@ void ObservationGenerator::generateGroundTruthObservations(){
 }
 
 void ObservationGenerator::generatePenaltyCrossObservations() {
-  getSelf(gtSelf,obsSelf,player_);
   std::vector<WorldObjectType> crosses = { WO_OWN_PENALTY_CROSS, WO_OPP_PENALTY_CROSS };
   for(auto cross : crosses) {
-    getObject(gtCross, obsCross, cross);
-    float bearing = gtSelf.loc.getBearingTo(gtCross.loc,gtSelf.orientation);
-    float distance = gtSelf.loc.getDistanceTo(gtCross.loc);
+    auto& obsCross = obs_object_->objects_[cross];
+    float bearing = geometry_.bearing(player_, cross);
+    float distance = geometry_.distance(player_, cross);
     if (isVisible(cross)) {
       float missedObsRate = 4.0/5.0;
       float randPct = rand_.sampleU();
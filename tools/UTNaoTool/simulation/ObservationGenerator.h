@@ -5,6 +5,7 @@
 #include <math/Geometry.h>
 #include <common/Random.h>
 #include <common/RobotInfo.h>
+#include "ObservationGeometry.h"
 
 
 class ObservationGenerator {
@@ -30,6 +31,7 @@ class ObservationGenerator {
     void fillObservationObjects();
     ImageParams iparams_;
     Random rand_;
+    ObservationGeometry geometry_;
     WorldObjectBlock *gt_object_, *obs_object_;
     OpponentBlock* opponent_mem_;
     FrameInfoBlock* frame_info_;
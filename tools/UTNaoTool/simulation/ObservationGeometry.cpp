@@ -0,0 +1,164 @@
+#include <tool/simulation/ObservationGeometry.h>
+#include <memory/WorldObjectBlock.h>
+#include <algorithm>
+
+typedef ObservationGeometry OG;
+
+namespace {
+  struct Targets {
+    int objects[OG::NUM_TARGETS];
+    int index[NUM_WORLD_OBJS];
+
+    Targets() {
+      int fixed[] = {
+        WO_BALL, WO_CENTER_CIRCLE,
+        WO_OWN_LEFT_GOALPOST, WO_OPP_LEFT_GOALPOST, WO_OWN_RIGHT_GOALPOST, WO_OPP_RIGHT_GOALPOST,
+        WO_OWN_PENALTY_CROSS, WO_OPP_PENALTY_CROSS
+      };
+      int n = 0;
+      for(int wo : fixed) objects[n++] = wo;
+      for(int i = WO_PLAYERS_FIRST; i <= WO_PLAYERS_LAST; i++) objects[n++] = i;
+      for(int i = 0; i < NUM_WORLD_OBJS; i++) index[i] = -1;
+      for(int i = 0; i < OG::NUM_TARGETS; i++) index[objects[i]] = i;
+    }
+  };
+
+  const Targets& targets() {
+    static Targets t;
+    return t;
+  }
+
+  inline void squaredDistances(const float *__restrict__ px, const float *__restrict__ py, float x, float y, float *__restrict__ d2, int n) {
+    for(int i = 0; i < n; i++) {
+      float dx = px[i] - x, dy = py[i] - y;
+      d2[i] = dx * dx + dy * dy;
+    }
+  }
+
+  // Where the line through (x,y) along u crosses each segment, clamped to the segment.
+  // Lines parallel to u are redone one at a time afterwards, since a select in the loop
+  // keeps it from vectorizing; like Line2D they take the point nearest the field origin.
+  inline void crossings(const float *__restrict__ sx, const float *__restrict__ sy, const float *__restrict__ dx,
+      const float *__restrict__ dy, const float *__restrict__ length2, float x, float y, float ux, float uy,
+      float *__restrict__ px, float *__restrict__ py, int n) {
+    // px holds the fraction along the segment until the second pass, which keeps the
+    // clamp from being turned into branches
+    for(int i = 0; i < n; i++) {
+      float ax = sx[i] - x, ay = sy[i] - y;
+      float s = (ay * ux - ax * uy) / (dx[i] * uy - dy[i] * ux);
+      s = s < 0 ? 0 : s;
+      px[i] = s > 1 ? 1 : s;
+    }
+    for(int i = 0; i < n; i++) {
+      py[i] = sy[i] + px[i] * dy[i];
+      px[i] = sx[i] + px[i] * dx[i];
+    }
+    for(int i = 0; i < n; i++) {
+      float denom = dx[i] * uy - dy[i] * ux;
+      if(denom * denom > 1e-8f * length2[i]) continue;
+      float s = -(sx[i] * dx[i] + sy[i] * dy[i]) / length2[i];
+      s = std::min(std::max(s, 0.0f), 1.0f);
+      px[i] = sx[i] + s * dx[i];
+      py[i] = sy[i] + s * dy[i];
+    }
+  }
+}
+
+ObservationGeometry::ObservationGeometry() : linesReady_(false) {
+  // padding lanes hold harmless values so the vector loops need no tail
+  for(int i = 0; i < PADDED_TARGETS; i++) targetX_[i] = targetY_[i] = 0;
+  for(int i = 0; i < PADDED_LINES; i++) {
+    startX_[i] = startY_[i] = dirY_[i] = 0;
+    dirX_[i] = length2_[i] = 1;
+  }
+  for(int i = 0; i < MAX_OBSERVERS; i++) occluders_[i] = 0;
+}
+
+int ObservationGeometry::target(int wo) {
+  return targets().index[wo];
+}
+
+void ObservationGeometry::layoutLines(const WorldObjectBlock* gt) {
+  for(int i = 0; i < NUM_FIELD_LINES; i++) {
+    const LineSegment& line = gt->objects_[WO_OPP_GOAL_LINE + i].lineLoc;
+    startX_[i] = line.start.x;
+    startY_[i] = line.start.y;
+    dirX_[i] = line.end.x - line.start.x;
+    dirY_[i] = line.end.y - line.start.y;
+    length2_[i] = dirX_[i] * dirX_[i] + dirY_[i] * dirY_[i];
+    if(length2_[i] == 0) length2_[i] = 1;
+  }
+  linesReady_ = true;
+}
+
+void ObservationGeometry::compute(const WorldObjectBlock* gt, const int* observers, int count) {
+  if(!linesReady_) layoutLines(gt);
+  const Targets& t = targets();
+  for(int i = 0; i < NUM_TARGETS; i++) {
+    const Point2D& loc = gt->objects_[t.objects[i]].loc;
+    targetX_[i] = loc.x;
+    targetY_[i] = loc.y;
+  }
+
+  for(int k = 0; k < count; k++) {
+    int o = observers[k];
+    const WorldObject& self = gt->objects_[o];
+    float x = self.loc.x, y = self.loc.y, orientation = self.orientation;
+
+    // squared distances to every target in lanes, then the square roots and bearings,
+    // which need libm, one at a time
+    float* distance = distance_[o];
+    squaredDistances(targetX_, targetY_, x, y, distance, PADDED_TARGETS);
+    float* bearing = bearing_[o];
+    for(int i = 0; i < NUM_TARGETS; i++) {
+      distance[i] = sqrtf(distance[i]);
+      bearing[i] = normalizeAngle(atan2f(targetY_[i] - y, targetX_[i] - x) - orientation);
+    }
+
+    // other robots by bearing, insertion sort since there are only a handful
+    float* ob = occluderBearing_[o];
+    float* od = occluderDistance_[o];
+    int n = 0;
+    for(int j = WO_PLAYERS_FIRST; j <= WO_PLAYERS_LAST; j++) {
+      if(j == o) continue;
+      int ti = t.index[j];
+      int m = n++;
+      for(; m > 0 && ob[m - 1] > bearing[ti]; m--) {
+        ob[m] = ob[m - 1];
+        od[m] = od[m - 1];
+      }
+      ob[m] = bearing[ti];
+      od[m] = distance[ti];
+    }
+    occluders_[o] = n;
+
+    // heading line against every field line
+    float* lx = lineX_[o];
+    float* ly = lineY_[o];
+    float* ld = lineDistance_[o];
+    crossings(startX_, startY_, dirX_, dirY_, length2_, x, y, cosf(orientation), sinf(orientation), lx, ly, PADDED_LINES);
+    squaredDistances(lx, ly, x, y, ld, PADDED_LINES);
+    float* lb = lineBearing_[o];
+    for(int i = 0; i < NUM_FIELD_LINES; i++) {
+      ld[i] = sqrtf(ld[i]);
+      lb[i] = normalizeAngle(atan2f(ly[i] - y, lx[i] - x) - orientation);
+    }
+  }
+}
+
+bool ObservationGeometry::occludedBetween(int observer, float low, float high, float distance) const {
+  const float* ob = occluderBearing_[observer];
+  const float* od = occluderDistance_[observer];
+  int n = occluders_[observer];
+  for(int i = std::upper_bound(ob, ob + n, low) - ob; i < n && ob[i] < high; i++)
+    if(od[i] < distance) return true;
+  return false;
+}
+
+bool ObservationGeometry::occluded(int observer, float bearing, float distance, float width) const {
+  // intervals that cross +-pi are checked on both sides
+  if(occludedBetween(observer, bearing - width, bearing + width, distance)) return true;
+  if(bearing - width < -M_PI && occludedBetween(observer, bearing - width + 2 * M_PI, M_PI, distance)) return true;
+  if(bearing + width > M_PI && occludedBetween(observer, -M_PI, bearing + width - 2 * M_PI, distance)) return true;
+  return false;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <common/WorldObject.h>
+#include <math/Geometry.h>
+
+class WorldObjectBlock;
+
+/* Ground truth geometry behind the simulated observations, kept in structure of
+ * arrays form. compute() fills the distance and bearing from each requested observer
+ * to every point target, the ball, robots, goal posts, center circle and penalty
+ * crosses, in one pass over the whole (observer, target) matrix. It also sorts the
+ * other robots around each observer by bearing, so an occlusion check is a binary
+ * search over their angular intervals rather than a scan with normalizeAngle, and
+ * finds where each observer's heading line meets every field line. The line segments
+ * never move and are laid out once from the first ground truth block seen. */
+class ObservationGeometry {
+  public:
+    static const int LANES = 8;
+    static const int NUM_PLAYERS = WO_PLAYERS_LAST - WO_PLAYERS_FIRST + 1;
+    static const int NUM_TARGETS = NUM_PLAYERS + 8;
+    static const int PADDED_TARGETS = (NUM_TARGETS + LANES - 1) & ~(LANES - 1);
+    static const int NUM_FIELD_LINES = WO_BOTTOM_SIDE_LINE - WO_OPP_GOAL_LINE + 1;
+    static const int PADDED_LINES = (NUM_FIELD_LINES + LANES - 1) & ~(LANES - 1);
+    static const int MAX_OBSERVERS = WO_PLAYERS_LAST + 1;
+
+    ObservationGeometry();
+
+    // Computes the rows of the given observers, indexed by world object, from the ground truth
+    void compute(const WorldObjectBlock* gt, const int* observers, int count);
+    void compute(const WorldObjectBlock* gt, int observer) { compute(gt, &observer, 1); }
+
+    // Index of a world object among the targets, -1 if it isn't one
+    static int target(int wo);
+
+    float distance(int observer, int wo) const { return distance_[observer][target(wo)]; }
+    float bearing(int observer, int wo) const { return bearing_[observer][target(wo)]; }
+    // Whether another robot closer than distance lies strictly within width of the bearing
+    bool occluded(int observer, float bearing, float distance, float width) const;
+
+    // Closest point on field line WO_OPP_GOAL_LINE + i to where the observer's heading
+    // line crosses it, with its distance and bearing from the observer
+    Point2D lineIntersection(int observer, int i) const { return Point2D(lineX_[observer][i], lineY_[observer][i]); }
+    float lineDistance(int observer, int i) const { return lineDistance_[observer][i]; }
+    float lineBearing(int observer, int i) const { return lineBearing_[observer][i]; }
+
+  private:
+    void layoutLines(const WorldObjectBlock* gt);
+    bool occludedBetween(int observer, float low, float high, float distance) const;
+
+    bool linesReady_;
+    float startX_[PADDED_LINES], startY_[PADDED_LINES], dirX_[PADDED_LINES], dirY_[PADDED_LINES], length2_[PADDED_LINES];
+
+    float targetX_[PADDED_TARGETS], targetY_[PADDED_TARGETS];
+    float distance_[MAX_OBSERVERS][PADDED_TARGETS];
+    float bearing_[MAX_OBSERVERS][PADDED_TARGETS];
+
+    // other robots around each observer, sorted by bearing
+    float occluderBearing_[MAX_OBSERVERS][NUM_PLAYERS];
+    float occluderDistance_[MAX_OBSERVERS][NUM_PLAYERS];
+    int occluders_[MAX_OBSERVERS];
+
+    float lineX_[MAX_OBSERVERS][PADDED_LINES], lineY_[MAX_OBSERVERS][PADDED_LINES];
+    float lineDistance_[MAX_OBSERVERS][PADDED_LINES], lineBearing_[MAX_OBSERVERS][PADDED_LINES];
+};
@@ -1,5 +1,6 @@
 #include <tool/simulation/PhysicsSimulator.h>
 #include <memory/WorldObjectBlock.h>
+#include <algorithm>
 
 #define TIME_INC (1.0f/30.0f)
 #define DECAY_RATE 0.966
@@ -9,19 +10,30 @@
 
 #define getObject(obj, idx) auto& obj = world_object_->objects_[idx]
 
+PhysicsSimulator::PhysicsSimulator() : world_object_(NULL) {
+  setSubsteps(1);
+}
+
+void PhysicsSimulator::setSubsteps(int substeps) {
+  substeps_ = std::max(substeps, 1);
+  // decay over the substeps of a frame matches one full step
+  substepDecay_ = pow(DECAY_RATE, 1.0 / substeps_);
+}
+
 void PhysicsSimulator::setObjects(WorldObjectBlock* objects) {
   world_object_ = objects;
 }
 
 void PhysicsSimulator::step() {
-  stepBall();
+  for(int i = 0; i < substeps_; i++)
+    stepBall(TIME_INC / substeps_, substepDecay_);
 }
 
-void PhysicsSimulator::stepBall() {
+void PhysicsSimulator::stepBall(float timeInc, float decay) {
   getObject(ball, WO_BALL);
-  Point2D delta = ball.absVel * TIME_INC;
+  Point2D delta = ball.absVel * timeInc;
   ball.loc += delta;
-  ball.absVel *= DECAY_RATE;
+  ball.absVel *= decay;
   for (int i = WO_PLAYERS_FIRST; i <= WO_PLAYERS_LAST; i++){
     getObject(player, i);
     auto relBall = ball.loc.globalToRelative(player.loc, player.orientation);
@@ -6,11 +6,16 @@ class Point2D;
 
 class PhysicsSimulator {
   public:
+    PhysicsSimulator();
     void setObjects(WorldObjectBlock* objects);
+    // Splits every frame into this many ball steps, so fast kicks can't pass through feet
+    void setSubsteps(int substeps);
     void step();
     void moveBall(Point2D target);
 
   private:
-    void stepBall();
+    void stepBall(float timeInc, float decay);
     WorldObjectBlock* world_object_;
+    int substeps_;
+    float substepDecay_;
 };
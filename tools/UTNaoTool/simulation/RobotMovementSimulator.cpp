@@ -13,7 +13,7 @@
 #define ROTATE_EXP 2.5
 #define CROP(x,MIN,MAX) x = std::max(std::min(((float)x),((float)(MAX))),((float)(MIN)))
 
-RobotMovementSimulator::RobotMovementSimulator(int player) : player_(player) {
+RobotMovementSimulator::RobotMovementSimulator(int player) : player_(player), rand_(Random::stream("movement", player)) {
   maxVel_ = Pose2D(130.0 * DEG_T_RAD, 240.0f, 120.0f);
   rotateTimer_ = 0;
   rotatePhase_ = false;
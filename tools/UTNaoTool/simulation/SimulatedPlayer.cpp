@@ -39,7 +39,8 @@
 bool SimulatedPlayer::DEBUGGING_POSITIONING = false;
 bool SimulatedPlayer::ALLOW_FALLING = false;
 
-SimulatedPlayer::SimulatedPlayer(int team, int self, bool lMode) : iparams_(Camera::TOP), rmsim_(self + (team == TEAM_BLUE ? 0 : WO_TEAM_LAST)) {
+SimulatedPlayer::SimulatedPlayer(int team, int self, bool lMode) : iparams_(Camera::TOP),
+  rand_(Random::stream("player", self + (team == TEAM_BLUE ? 0 : WO_TEAM_LAST))), rmsim_(self + (team == TEAM_BLUE ? 0 : WO_TEAM_LAST)) {
   team_ = team;
   self_ = self;
   penaltySeconds = 0;
@@ -157,13 +158,19 @@ bool SimulatedPlayer::processFrame() {
 }
 
 bool SimulatedPlayer::processFrame(WorldObjectBlock* simulationMem, GameStateBlock* simulationState){
+  return processFrame(simulationMem, simulationState, true, NULL);
+}
+
+bool SimulatedPlayer::processFrame(WorldObjectBlock* simulationMem, GameStateBlock* simulationState, bool runBehavior, SimulationProfile* profile){
+  double t = profile ? SimulationProfile::now() : 0;
   updateBasicInputs(simulationMem, simulationState);
   og_.setObjectBlocks(simulationMem, cache_.world_object);
   og_.setInfoBlocks(cache_.frame_info, cache_.joint);
   og_.setModelBlocks(cache_.opponent_mem);
   og_.setPlayer(index_, team_);
+  if (profile) t = profile->add(SimulationProfile::Movement, t);
 
-  // run localization
+  // run localization, every frame so no odometry is dropped while behaviors hold
   if (locMode){
     og_.generateAllObservations();
     core->localization_->processFrame();
@@ -176,13 +183,18 @@ bool SimulatedPlayer::processFrame(WorldObjectBlock* simulationMem, GameStateBlo
     cache_.behavior->keeperRelBallVel = ball->absVel.globalToRelative(Point2D(0,0),robot->orientation);
     cache_.localization_mem->bestAlpha = 1.0;
   }
+  if (profile) t = profile->add(SimulationProfile::Localization, t);
 
-  // call cache_.behavior process frame
-  core->interpreter_->processBehaviorFrame();
-  core->communications_->processFrame();
-
-  return updateOutputs(simulationMem);
+  // call cache_.behavior process frame, otherwise the last requests are held
+  if (runBehavior) {
+    core->interpreter_->processBehaviorFrame();
+    core->communications_->processFrame();
+    if (profile) t = profile->add(SimulationProfile::Behavior, t);
+  }
 
+  bool kicked = updateOutputs(simulationMem);
+  if (profile) profile->add(SimulationProfile::Outputs, t);
+  return kicked;
 }
 
 void SimulatedPlayer::updateBasicInputs(WorldObjectBlock* simulationMem, GameStateBlock* simulationState){
@@ -11,6 +11,7 @@
 
 #include "ObservationGenerator.h"
 #include "RobotMovementSimulator.h"
+#include "SimulationProfile.h"
 
 class VisionCore;
 class Memory;
@@ -30,6 +31,9 @@ class SimulatedPlayer {
   void setPenalty(WorldObjectBlock* simMem);
   bool processFrame();
   bool processFrame(WorldObjectBlock* wo, GameStateBlock* gs);
+  // Steps the robot one frame, running the behaviors only if asked and holding their
+  // last walk, kick and head requests otherwise
+  bool processFrame(WorldObjectBlock* wo, GameStateBlock* gs, bool runBehavior, SimulationProfile* profile);
   std::vector<std::string> getTextDebug();
   
   MemoryCache cache_;
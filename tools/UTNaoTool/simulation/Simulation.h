@@ -7,6 +7,7 @@
 
 class Simulation {
   public:
+    Simulation() : rand_(Random::stream("simulation")) { }
     virtual bool lmode() { return true; }
     virtual bool complete() { return false; }
     virtual void simulationStep() = 0;
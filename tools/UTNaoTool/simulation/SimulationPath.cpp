@@ -1,7 +1,5 @@
 #include "SimulationPath.h"
 
-Random SimulationPath::rand_ = Random();
-
 void SimulationPath::flip() {
   for(auto& p : points_)
     p = -p;
@@ -14,10 +12,12 @@ void SimulationPath::pop() {
 }
 
 SimulationPath SimulationPath::generate(int length) {
+  // made on first use, once the seed has been set
+  static Random random = Random::stream("paths");
   SimulationPath path;
   for(int i = 0; i < length; i++) {
-    int x = rand_.sampleU(-FIELD_X / 2, FIELD_X / 2);
-    int y = rand_.sampleU(-FIELD_Y / 2, FIELD_Y / 2);
+    int x = random.sampleU(-FIELD_X / 2, FIELD_X / 2);
+    int y = random.sampleU(-FIELD_Y / 2, FIELD_Y / 2);
     path.points_.push_back(Point2D(x,y));
   }
   return path;
@@ -27,7 +27,6 @@ class SimulationPath : public YamlConfig {
     virtual void deserialize(const YAML::Node& node);
     void serialize(YAML::Emitter& emitter) const;
   private:
-    static Random rand_;
     std::list<Point2D> points_;
     Point2D last_;
 };
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <time.h>
+#include <stdio.h>
+#include <string>
+
+/* Wall time spent in each part of a simulated frame, summed over a run. Read with
+ * a monotonic clock rather than the tic/toc ids in common/Profiling since it is
+ * sampled several times per player per frame. */
+struct SimulationProfile {
+  enum Section { Physics, Rules, Movement, Localization, Behavior, Outputs, NUM_SECTIONS };
+
+  double seconds[NUM_SECTIONS];
+  int frames;
+  int behaviorFrames;
+
+  SimulationProfile() { reset(); }
+
+  void reset() {
+    for(int i = 0; i < NUM_SECTIONS; i++) seconds[i] = 0;
+    frames = behaviorFrames = 0;
+  }
+
+  static double now() {
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+  }
+
+  // Adds the time since start to the section and returns the current time, so calls chain
+  double add(Section section, double start) {
+    double t = now();
+    seconds[section] += t - start;
+    return t;
+  }
+
+  double total() const {
+    double sum = 0;
+    for(int i = 0; i < NUM_SECTIONS; i++) sum += seconds[i];
+    return sum;
+  }
+
+  std::string toString() const {
+    static const char* names[NUM_SECTIONS] = { "physics", "rules", "movement", "localization", "behavior", "outputs" };
+    char buffer[128];
+    double sum = total();
+    std::string s;
+    for(int i = 0; i < NUM_SECTIONS; i++) {
+      snprintf(buffer, sizeof(buffer), "%s: %2.3fs (%2.1f%%, %2.4fms/frame)\n", names[i], seconds[i],
+          sum > 0 ? 100 * seconds[i] / sum : 0, frames > 0 ? 1000 * seconds[i] / frames : 0);
+      s += buffer;
+    }
+    snprintf(buffer, sizeof(buffer), "frames: %i, behavior frames: %i\n", frames, behaviorFrames);
+    s += buffer;
+    return s;
+  }
+};
@@ -1,30 +1,52 @@
 #include <stdio.h>
 #include <string.h>
-#include "../UTNaoTool/BehaviorSimulation.h"
-#include <lua/LuaModule.h>
+#include <stdlib.h>
+#include <tool/simulation/BehaviorSimulation.h>
+#include <common/Random.h>
+#include <common/Profiling.h>
 #include <VisionCore.h>
 
+// Plays one simulated half and prints its score, where the time went and the manifest of
+// random streams it drew from. runBatch.py runs many of these side by side and parses
+// the Score, Frames, Time and Manifest lines of each.
 int main(int argc, char **argv) {
 
-  if (argc != 2){
-    cout << "Please provide a red team config file" << endl;
-    exit(0);
+  if (argc < 2 || argc > 5){
+    cout << "Usage: behaviorSim <strategy config> [seed] [behavior period] [physics substeps]" << endl;
+    exit(1);
   }
-  
-  std::string cmd = std::string("roleSwitch.setupRoles('") + argv[1] + "')";
-  BehaviorSimulation behaviorSim(WO_OPPONENT_LAST,false,false);
-  for (int i = 1; i <= WO_OPPONENT_LAST; i++) {
-    if (behaviorSim.sims[i] != NULL)
-      //behaviorSim.sims[i]->core->interpreter_->call(cmd);
+  if (FILE* config = fopen(argv[1], "r"))
+    fclose(config);
+  else {
+    cout << "Could not open strategy config " << argv[1] << endl;
+    exit(1);
   }
-  if ((((float)rand())/((float)RAND_MAX)) < 0.5) {
+
+  // every random stream the simulation makes is keyed from here
+  int seed = argc >= 3 ? atoi(argv[2]) : 0;
+  srand(seed);
+  Random::SEED = seed;
+
+  Timer timer;
+  timer.start();
+  BehaviorSimulation behaviorSim(WO_OPPONENT_LAST,false,false);
+  // fast forward: behaviors think every few frames and the ball steps finer
+  if (argc >= 4) behaviorSim.setBehaviorPeriod(atoi(argv[3]));
+  if (argc >= 5) behaviorSim.setPhysicsSubsteps(atoi(argv[4]));
+  if (Random::stream("kickoff").sampleB()) {
     behaviorSim.changeSimulationKickoff();
   }
+  int frames = 0;
   while (behaviorSim.numHalves < 1) {
     behaviorSim.simulationStep();
-    //if (((int)behaviorSim.halfTimer % 50) == 0)
-      //std::cout << behaviorSim.halfTimer << std::endl;
+    frames++;
   }
+  timer.stop();
+  std::cout << "Seed: " << seed << std::endl;
+  std::cout << "Frames: " << frames << std::endl;
+  std::cout << "Time: " << timer.lasttime() << std::endl;
+  std::cout << behaviorSim.profile().toString();
+  std::cout << "Manifest: " << Random::manifest() << std::endl;
   std::cout << "Score: " << behaviorSim.simBlueScore << " " << behaviorSim.simRedScore << std::endl;
   return 0;
 
@@ -0,0 +1,159 @@
+#!/usr/bin/env python
+# encoding: utf-8
+
+# Runs simulated halves of behaviorSim locally, one worker process per seed spread
+# over every core, and aggregates the scores and timing into a json report.
+#
+#   runBatch.py base.json 100 -o report.json
+
+from __future__ import print_function
+import json, sys, os, subprocess, re, time, math, argparse, multiprocessing
+from multiprocessing.pool import ThreadPool
+
+DEFAULT_BINARY = os.path.join(os.environ.get('NAO_HOME',''),'build','behaviorsim','behaviorSim')
+DEFAULT_TIMEOUT = 600
+
+def parseOutput(contents):
+  res = {}
+  score = re.search(r'Score:\s*([0-9]+)\s*([0-9]+)',contents)
+  if score is None:
+    return None
+  res['blue'] = int(score.group(1))
+  res['red'] = int(score.group(2))
+  frames = re.search(r'Frames:\s*([0-9]+)',contents)
+  if frames is not None:
+    res['frames'] = int(frames.group(1))
+  simTime = re.search(r'Time:\s*([0-9.eE+-]+)',contents)
+  if simTime is not None:
+    res['simTime'] = float(simTime.group(1))
+  # the random streams the run drew from, enough to replay it exactly
+  manifest = re.search(r'Manifest:\s*(\{.*\})',contents)
+  if manifest is not None:
+    res['manifest'] = json.loads(manifest.group(1))
+  return res
+
+def runOne(job):
+  binary,config,seed,timeout = job[:4]
+  extra = [str(a) for a in job[4:]]
+  start = time.time()
+  res = {'seed': seed}
+  try:
+    p = subprocess.Popen([binary,config,str(seed)] + extra,stdout=subprocess.PIPE,stderr=subprocess.STDOUT)
+    # the simulation runs in its own process, so a thread only waits on it
+    timer = _Killer(p,timeout)
+    out = p.communicate()[0]
+    timer.cancel()
+    if not isinstance(out,str):
+      out = out.decode('utf-8','replace')
+    parsed = parseOutput(out)
+    if parsed is None:
+      res['error'] = 'killed after %is' % timeout if timer.fired else 'exit %i, no score' % p.returncode
+    else:
+      res.update(parsed)
+  except OSError as e:
+    res['error'] = str(e)
+  res['wallTime'] = time.time() - start
+  return res
+
+class _Killer(object):
+  def __init__(self,p,timeout):
+    import threading
+    self.fired = False
+    self.p = p
+    self.t = threading.Timer(timeout,self.kill)
+    self.t.daemon = True
+    self.t.start()
+  def kill(self):
+    self.fired = True
+    try:
+      self.p.kill()
+    except OSError:
+      pass
+  def cancel(self):
+    self.t.cancel()
+
+def runSeeds(config,seeds,binary=DEFAULT_BINARY,workers=None,timeout=DEFAULT_TIMEOUT,pool=None,behaviorPeriod=1,substeps=1):
+  '''Runs config once per seed, returns the per-seed results in seed order.'''
+  config = os.path.abspath(config)
+  jobs = [(binary,config,s,timeout,behaviorPeriod,substeps) for s in seeds]
+  if pool is not None:
+    return pool.map(runOne,jobs)
+  p = ThreadPool(workers or multiprocessing.cpu_count())
+  try:
+    return p.map(runOne,jobs)
+  finally:
+    p.close()
+    p.join()
+
+def mean(xs):
+  return sum(xs) / float(len(xs)) if xs else 0.0
+
+def stdErr(xs):
+  if len(xs) < 2:
+    return 0.0
+  m = mean(xs)
+  return math.sqrt(sum((x - m) ** 2 for x in xs) / (len(xs) - 1) / len(xs))
+
+def summarize(results,wallTime):
+  ok = [r for r in results if 'error' not in r]
+  diffs = [r['blue'] - r['red'] for r in ok]
+  runTimes = [r['wallTime'] for r in ok]
+  frames = sum(r.get('frames',0) for r in ok)
+  summary = {
+    'runs': len(results),
+    'succeeded': len(ok),
+    'failed': len(results) - len(ok),
+    'blueWins': sum(1 for d in diffs if d > 0),
+    'draws': sum(1 for d in diffs if d == 0),
+    'redWins': sum(1 for d in diffs if d < 0),
+    'meanBlue': mean([r['blue'] for r in ok]),
+    'meanRed': mean([r['red'] for r in ok]),
+    'meanGoalDiff': mean(diffs),
+    'goalDiffStdErr': stdErr(diffs),
+    'meanRunTime': mean(runTimes),
+    'maxRunTime': max(runTimes) if runTimes else 0.0,
+    'wallTime': wallTime,
+    'halvesPerHour': 3600.0 * len(ok) / wallTime if wallTime > 0 else 0.0,
+    'framesPerSecond': frames / wallTime if wallTime > 0 else 0.0,
+  }
+  return summary
+
+def main():
+  parser = argparse.ArgumentParser(description='Run behaviorSim halves in parallel on this machine')
+  parser.add_argument('config',help='strategy json passed to every run')
+  parser.add_argument('seeds',type=int,help='number of seeds to run')
+  parser.add_argument('--first-seed',type=int,default=0)
+  parser.add_argument('-j','--workers',type=int,default=multiprocessing.cpu_count())
+  parser.add_argument('--binary',default=DEFAULT_BINARY)
+  parser.add_argument('--behavior-period',type=int,default=1,help='frames between behavior evaluations')
+  parser.add_argument('--substeps',type=int,default=1,help='ball physics steps per frame')
+  parser.add_argument('--timeout',type=int,default=DEFAULT_TIMEOUT,help='seconds before a run is killed')
+  parser.add_argument('-o','--output',help='write the report here instead of stdout')
+  args = parser.parse_args()
+
+  seeds = list(range(args.first_seed,args.first_seed + args.seeds))
+  start = time.time()
+  results = runSeeds(args.config,seeds,args.binary,args.workers,args.timeout,behaviorPeriod=args.behavior_period,substeps=args.substeps)
+  wallTime = time.time() - start
+  report = {
+    'config': os.path.abspath(args.config),
+    'binary': args.binary,
+    'workers': args.workers,
+    'behaviorPeriod': args.behavior_period,
+    'substeps': args.substeps,
+    'summary': summarize(results,wallTime),
+    'results': results,
+  }
+  text = json.dumps(report,sort_keys=True,indent=2)
+  if args.output:
+    with open(args.output,'w') as f:
+      f.write(text + '\n')
+    s = report['summary']
+    print('%i/%i halves, goal diff %.2f +- %.2f, %.1fs wall' % (s['succeeded'],s['runs'],s['meanGoalDiff'],s['goalDiffStdErr'],s['wallTime']),file=sys.stderr)
+  else:
+    print(text)
+  if report['summary']['succeeded'] == 0:
+    sys.exit(1)
+
+if __name__ == '__main__':
+  main()
@@ -3,6 +3,9 @@
 
 import json, sys, os, shutil, subprocess, re, time
 from cma import CMAEvolutionStrategy, Options
+import multiprocessing
+from multiprocessing.pool import ThreadPool
+import runBatch
 
 NUM_GENS = 150
 POP_SIZE = 50
@@ -107,18 +110,44 @@ def runEvals(paramNames,xs,gen,thisGenDir,condorConfig):
   #sys.exit(1)
   return xs,ys
 
+def runLocalEvals(paramNames,xs,gen,thisGenDir,pool):
+  # every individual of a generation plays the same seeds, so they are compared on
+  # equal terms, and the whole generation goes to the pool at once to fill every core
+  seeds = [gen * EVALS_PER_IND + j for j in range(EVALS_PER_IND)]
+  jobs = []
+  for i,x in enumerate(xs):
+    filename = os.path.abspath(os.path.join(thisGenDir,'%i.json' % i))
+    paramsToJsonFile(filename,paramNames,x)
+    jobs += [(runBatch.DEFAULT_BINARY,filename,s,runBatch.DEFAULT_TIMEOUT) for s in seeds]
+  results = pool.map(runBatch.runOne,jobs)
+  with open(os.path.join(thisGenDir,'results.json'),'w') as f:
+    json.dump(results,f,sort_keys=True,indent=2)
+  resXs = []
+  resYs = []
+  for i,x in enumerate(xs):
+    ok = [r for r in results[i * EVALS_PER_IND:(i + 1) * EVALS_PER_IND] if 'error' not in r]
+    if len(ok) > EVALS_PER_IND * MIN_EVAL_FRAC_SUCCEEDED:
+      resXs.append(x)
+      resYs.append(sum(r['blue'] - r['red'] for r in ok) / float(len(ok))) # minimizing, so higher red score is better
+  return resXs,resYs
+
 def optMkdir(dirName):
   if not(os.path.exists(dirName)):
     os.mkdir(dirName)
 
-def main(filename,directory):
+def main(filename,directory,local=False):
   initialFilename = os.path.join(directory,'initial.json')
   genDir = os.path.join(directory,'gens')
   finalFilename = os.path.join(directory,'final.json')
   baseCondor = 'base.condor'
 
-  with open(baseCondor,'r') as f:
-    condorConfig = f.read()
+  condorConfig = None
+  pool = None
+  if local:
+    pool = ThreadPool(multiprocessing.cpu_count())
+  else:
+    with open(baseCondor,'r') as f:
+      condorConfig = f.read()
 
   optMkdir(directory)
   optMkdir(genDir)
@@ -137,14 +166,19 @@ def main(filename,directory):
     thisGenDir = os.path.join(genDir,str(cma.countiter))
     optMkdir(thisGenDir)
     xs = cma.ask()
-    xs,fits = runEvals(paramNames,xs,cma.countiter,thisGenDir,condorConfig)
+    if local:
+      xs,fits = runLocalEvals(paramNames,xs,cma.countiter,thisGenDir,pool)
+    else:
+      xs,fits = runEvals(paramNames,xs,cma.countiter,thisGenDir,condorConfig)
     cma.tell(xs,fits)
   res = cma.result()
   paramsToJsonFile(finalFilename,paramNames,res[0])
 
 if __name__ == '__main__':
   args = sys.argv[1:]
+  local = '--local' in args
+  args = [a for a in args if a != '--local']
   if len(args) < 2:
-    print >>sys.stderr,'Usage: runCMAES.py baseConfFilename directory'
+    print >>sys.stderr,'Usage: runCMAES.py [--local] baseConfFilename directory'
     sys.exit(2)
-  main(args[0],args[1])
+  main(args[0],args[1],local)
@@ -9,5 +9,5 @@ numEvals = int(sys.argv[3])
 ind = jobNum / numEvals
 filename = dir + '/%i.json' % ind
 
-import subprocess
-subprocess.call(['/u/sbarrett/Nao/trunk/bin/behaviorSim',filename])
+import subprocess, os
+subprocess.call([os.path.join(os.environ['NAO_HOME'],'build','behaviorsim','behaviorSim'),filename])